@@ -0,0 +1,36 @@
+#version 460 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+
+// One per instance, bound past the culling pass's storage bindings
+struct InstanceData
+{
+    mat4 model;
+    vec4 colour;
+};
+
+// core::ClusterCuller::draw binds its cluster list here
+layout (std430, binding = 5) readonly buffer Clusters { uvec2 clusters[]; };// instance, meshlet
+layout (std430, binding = 6) readonly buffer InstanceTransforms { InstanceData instanceData[]; };
+
+uniform mat4 viewProjection;
+uniform bool tintClusters;
+
+out vec3 Normal;
+out vec3 Colour;
+
+vec3 hashColour(uint id)
+{
+    uint hash = id * 2654435761u;
+    return vec3((hash >> 8) & 255u, (hash >> 16) & 255u, (hash >> 24) & 255u) / 255.0 * 0.7 + 0.3;
+}
+
+void main()
+{
+    // The culling pass passes the cluster's index as baseInstance
+    uvec2 cluster = clusters[gl_BaseInstance];
+    InstanceData instance = instanceData[cluster.x];
+    Normal = mat3(instance.model) * aNormal;
+    Colour = tintClusters ? hashColour(cluster.y) : instance.colour.rgb;
+    gl_Position = viewProjection * instance.model * vec4(aPos, 1.0);
+}
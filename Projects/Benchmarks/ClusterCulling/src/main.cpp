@@ -0,0 +1,350 @@
+#include <glad/gl.h>
+#include  <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <imgui.h>
+#include <Camera.h>
+#include <Window.h>
+#include <FPSCounter.h>
+#include <glfwHelpers.h>
+#include <Shader.h>
+#include <Mesh.h>
+#include <Meshlets.h>
+#include <HiZPyramid.h>
+#include <ClusterCuller.h>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <span>
+#include <vector>
+
+/* A field of dense spheres (37k triangles each) between rows of walls, split into meshlets and
+ * culled per cluster on the GPU by core::ClusterCuller. Objects mode gives every mesh a single
+ * cluster around all of it, the same pass then culls whole objects, which is what GpuCulling
+ * does. In Clusters mode the far side of every sphere goes to the normal cone test and the
+ * parts behind a wall's edge to the Hi-Z, so watch the triangle count next to the FPS.
+ * Tint the clusters to see the meshlets. */
+
+struct Vertex
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+};
+
+using VertexFormat = core::VertexLayoutOf<&Vertex::position, &Vertex::normal>;
+
+// Per-instance data the vertex shader reads through the cluster list, std430 layout of cluster.vert
+struct InstanceData
+{
+    glm::mat4 model;
+    glm::vec4 colour;
+};
+
+enum class CullMode : int { Objects, Clusters };
+
+void pushVertex(std::vector<float>& vertices, const glm::vec3& position, const glm::vec3& normal)
+{
+    vertices.insert(vertices.end(), { position.x, position.y, position.z, normal.x, normal.y, normal.z });
+}
+
+// Radius 1 sphere as a triangle soup, MeshBuilder welds it
+std::vector<float> makeSphere(const int rings, const int segments)
+{
+    auto pointAt = [rings, segments](const int ring, const int segment)
+    {
+        const float theta = static_cast<float>( ring ) / static_cast<float>( rings ) * glm::pi<float>();
+        const float phi = static_cast<float>( segment ) / static_cast<float>( segments ) * glm::two_pi<float>();
+        return glm::vec3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+    };
+
+    std::vector<float> vertices;
+    for(int ring = 0; ring < rings; ring++)
+    {
+        for(int segment = 0; segment < segments; segment++)
+        {
+            const std::array quad = { pointAt(ring, segment), pointAt(ring + 1, segment), pointAt(ring + 1, segment + 1), pointAt(ring, segment + 1) };
+            for(const int corner : { 0, 1, 2, 0, 2, 3 })
+                pushVertex(vertices, quad[static_cast<std::size_t>( corner )], quad[static_cast<std::size_t>( corner )]);
+        }
+    }
+    return vertices;
+}
+
+// Cube from (0, 0, 0) to (1, 1, 1) with flat normals
+std::vector<float> makeCube()
+{
+    std::vector<float> vertices;
+    for(int axis = 0; axis < 3; axis++)
+    {
+        for(const float side : { 0.0f, 1.0f })
+        {
+            glm::vec3 normal(0.0f);
+            normal[axis] = side * 2.0f - 1.0f;
+            const int u = (axis + 1) % 3, v = (axis + 2) % 3;
+            std::array<glm::vec3, 4> quad;
+            for(int corner = 0; corner < 4; corner++)
+            {
+                quad[static_cast<std::size_t>( corner )][axis] = side;
+                quad[static_cast<std::size_t>( corner )][u] = corner == 1 || corner == 2 ? 1.0f : 0.0f;
+                quad[static_cast<std::size_t>( corner )][v] = corner >= 2 ? 1.0f : 0.0f;
+            }
+            // Counter-clockwise seen from outside
+            if(side == 0.0f) std::swap(quad[1], quad[3]);
+            for(const int corner : { 0, 1, 2, 0, 2, 3 })
+                pushVertex(vertices, quad[static_cast<std::size_t>( corner )], normal);
+        }
+    }
+    return vertices;
+}
+
+// One cluster around a whole mesh's meshlets, its cone never culls
+core::Meshlet wholeMesh(const std::span<const core::Meshlet> meshlets)
+{
+    glm::vec3 boundsMin(std::numeric_limits<float>::max());
+    glm::vec3 boundsMax(-std::numeric_limits<float>::max());
+    core::Meshlet whole{ .firstIndex = meshlets.front().firstIndex, .baseVertex = meshlets.front().baseVertex };
+    for(const core::Meshlet& meshlet : meshlets)
+    {
+        boundsMin = glm::min(boundsMin, meshlet.center - meshlet.radius);
+        boundsMax = glm::max(boundsMax, meshlet.center + meshlet.radius);
+        whole.indexCount += meshlet.indexCount;
+        whole.vertexCount += meshlet.vertexCount;
+    }
+    whole.center = (boundsMin + boundsMax) * 0.5f;
+    whole.radius = glm::length(boundsMax - boundsMin) * 0.5f;
+    return whole;
+}
+
+// Colour and depth textures to draw into, the Hi-Z is built from the depth texture
+struct RenderTarget
+{
+    unsigned int framebuffer = 0;
+    unsigned int colour = 0;
+    unsigned int depth = 0;
+    int width = 0;
+    int height = 0;
+
+    void resize(const int newWidth, const int newHeight)
+    {
+        if(newWidth == width && newHeight == height) return;
+        release();
+        width = newWidth;
+        height = newHeight;
+        if(width <= 0 || height <= 0) return;
+
+        glCreateTextures(GL_TEXTURE_2D, 1, &colour);
+        glTextureStorage2D(colour, 1, GL_RGBA8, width, height);
+        glCreateTextures(GL_TEXTURE_2D, 1, &depth);
+        glTextureStorage2D(depth, 1, GL_DEPTH_COMPONENT32F, width, height);
+
+        glCreateFramebuffers(1, &framebuffer);
+        glNamedFramebufferTexture(framebuffer, GL_COLOR_ATTACHMENT0, colour, 0);
+        glNamedFramebufferTexture(framebuffer, GL_DEPTH_ATTACHMENT, depth, 0);
+    }
+
+    void release()
+    {
+        if(framebuffer != 0) glDeleteFramebuffers(1, &framebuffer);
+        if(colour != 0) glDeleteTextures(1, &colour);
+        if(depth != 0) glDeleteTextures(1, &depth);
+        framebuffer = colour = depth = 0;
+    }
+};
+
+int main()
+{
+    core::Window window({ .name = "ClusterCulling", .vSync = false });
+    glfwSetInputMode(window.getGLFWWindow(), GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+    glfwSetFramebufferSizeCallback(window.getGLFWWindow(), framebuffer_size_callback);
+
+    WindowState state{};
+    state.lastX = static_cast<float>( window.getFramebufferWidth() ) / 2.0f;
+    state.lastY = static_cast<float>( window.getFramebufferHeight() ) / 2.0f;
+    glfwSetWindowUserPointer(window.getGLFWWindow(), &state);
+
+    glfwSetKeyCallback(window.getGLFWWindow(), key_callback);
+    glfwSetCursorPosCallback(window.getGLFWWindow(), mouse_callback);
+    glfwSetScrollCallback(window.getGLFWWindow(), scroll_callback);
+
+    const core::Shader clusterShader{ "assets/shaders/cluster.vert", "assets/shaders/cluster.frag" };
+    core::HiZPyramid hiZ("core/shaders/hiz.comp");
+    core::ClusterCuller culler("core/shaders/cluster.comp");
+
+    core::MeshBuilder sphereBuilder(VertexFormat::desc());
+    sphereBuilder.addTriangleList(makeSphere(96, 192));
+    core::MeshData sphereData = sphereBuilder.build();
+    std::vector<core::Meshlet> meshlets = core::buildMeshlets(sphereData);
+    const std::size_t sphereMeshlets = meshlets.size();
+
+    core::MeshBuilder cubeBuilder(VertexFormat::desc());
+    cubeBuilder.addTriangleList(makeCube());
+    core::MeshData cubeData = cubeBuilder.build();
+    const std::vector<core::Meshlet> cubeMeshlets = core::buildMeshlets(cubeData);
+
+    // Both meshes in one vertex and index buffer, the cube's meshlets move behind the sphere's
+    core::MeshData sceneData = sphereData;
+    sceneData.vertices.insert(sceneData.vertices.end(), cubeData.vertices.begin(), cubeData.vertices.end());
+    sceneData.indices.insert(sceneData.indices.end(), cubeData.indices.begin(), cubeData.indices.end());
+    for(core::Meshlet meshlet : cubeMeshlets)
+    {
+        meshlet.firstIndex += static_cast<std::uint32_t>( sphereData.indices.size() );
+        meshlet.baseVertex = static_cast<std::int32_t>( sphereData.vertexCount() );
+        meshlets.push_back(meshlet);
+    }
+
+    // Then one whole-mesh cluster per mesh for Objects mode
+    const auto sphereWhole = static_cast<std::uint32_t>( meshlets.size() );
+    meshlets.push_back(wholeMesh(std::span(meshlets).first(sphereMeshlets)));
+    const auto cubeWhole = static_cast<std::uint32_t>( meshlets.size() );
+    meshlets.push_back(wholeMesh(std::span(meshlets).subspan(sphereMeshlets, cubeMeshlets.size())));
+
+    core::VertexArrayCache vertexArrays;
+    const core::Mesh sceneMesh(sceneData, vertexArrays);
+    culler.setMeshlets(meshlets);
+
+    constexpr int GridSize = 16;
+    constexpr float Spacing = 8.0f;
+    constexpr float SphereRadius = 2.0f;
+    constexpr int WallEvery = 4;// rows of spheres between walls
+
+    // Both modes address the same instances, only the clusters they cover differ
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> angle(0.0f, glm::two_pi<float>());
+    std::vector<core::GpuClusterInstance> clusterInstances;
+    std::vector<core::GpuClusterInstance> objectInstances;
+    std::vector<InstanceData> instanceData;
+    std::size_t sceneTriangles = 0;
+    for(int z = 0; z < GridSize; z++)
+    {
+        for(int x = 0; x < GridSize; x++)
+        {
+            const glm::vec3 position(static_cast<float>( x ) * Spacing, SphereRadius, static_cast<float>( z ) * Spacing);
+            const glm::mat4 model = glm::scale(glm::rotate(glm::translate(glm::mat4(1.0f), position), angle(random), glm::vec3(0.0f, 1.0f, 0.0f)),
+                                               glm::vec3(SphereRadius));
+            clusterInstances.push_back({ model, 0, static_cast<std::uint32_t>( sphereMeshlets ), SphereRadius });
+            objectInstances.push_back({ model, sphereWhole, 1, SphereRadius });
+            instanceData.push_back({ model, glm::vec4(0.9f, 0.35f, 0.2f, 1.0f) });
+            sceneTriangles += sphereData.indices.size() / 3;
+        }
+    }
+
+    // Walls across the field, their cube's cone never culls so the non-uniform scale is harmless
+    for(int row = WallEvery; row < GridSize; row += WallEvery)
+    {
+        const glm::vec3 corner(-Spacing, 0.0f, (static_cast<float>( row ) - 0.5f) * Spacing);
+        const glm::vec3 size(static_cast<float>( GridSize + 1 ) * Spacing, SphereRadius * 3.0f, 0.5f);
+        const glm::mat4 model = glm::scale(glm::translate(glm::mat4(1.0f), corner), size);
+        const float scale = std::max(std::max(size.x, size.y), size.z);
+        clusterInstances.push_back({ model, static_cast<std::uint32_t>( sphereMeshlets ), static_cast<std::uint32_t>( cubeMeshlets.size() ), scale });
+        objectInstances.push_back({ model, cubeWhole, 1, scale });
+        instanceData.push_back({ model, glm::vec4(0.6f, 0.6f, 0.65f, 1.0f) });
+        sceneTriangles += cubeData.indices.size() / 3;
+    }
+
+    int mode = static_cast<int>( CullMode::Clusters );
+    culler.setInstances(clusterInstances);
+
+    unsigned int instanceDataBuffer = 0;
+    glCreateBuffers(1, &instanceDataBuffer);
+    glNamedBufferStorage(instanceDataBuffer, static_cast<GLsizeiptr>( instanceData.size() * sizeof(InstanceData) ), instanceData.data(), 0);
+
+    core::Camera camera({ .Pos = glm::vec3(-12.0f, 3.0f, -12.0f), .zFar = 500.0f, .Yaw = 45.0f, .Speed = 20.0f, .MouseSens = 0.1f });
+    state.pCamera = &camera;
+
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+
+    core::FPSCounter fps;
+    RenderTarget target;
+    bool testCones = true;
+    bool testOcclusion = true;
+    bool tintClusters = false;
+    const glm::vec4 clearColour(0.55f, 0.7f, 0.85f, 1.0f);
+    constexpr float ClearDepth = 1.0f;
+
+    while(!window.shouldClose())
+    {
+        window.updateTime();
+        fps.update(window.getDeltaTime());
+        processInput(window.getGLFWWindow(), camera, window.getDeltaTime());
+
+        const int width = window.getFramebufferWidth();
+        const int height = window.getFramebufferHeight();
+        target.resize(width, height);
+
+        window.clear();
+        window.beginImgui();
+        fps.drawUI();
+
+        if(target.framebuffer != 0)
+        {
+            const glm::mat4 viewProjection = camera.getProjectionMatrix(width, height, 0.1f, 500.0f) * camera.getViewMatrix();
+
+            glBindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+            glViewport(0, 0, width, height);
+            glClearNamedFramebufferfv(target.framebuffer, GL_COLOR, 0, &clearColour.x);
+            glClearNamedFramebufferfv(target.framebuffer, GL_DEPTH, 0, &ClearDepth);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 6, instanceDataBuffer);
+
+            auto drawPhase = [&](const core::CullPhase phase)
+            {
+                clusterShader.use();
+                clusterShader.setUniform("viewProjection", viewProjection);
+                clusterShader.setUniform("tintClusters", tintClusters);
+                sceneMesh.bind();
+                culler.draw(phase, sceneMesh.getIndexType());
+            };
+
+            if(testOcclusion)
+            {
+                culler.cull(core::CullPhase::Early, viewProjection, camera.getCamPos(), nullptr, testCones);
+                drawPhase(core::CullPhase::Early);
+                hiZ.build(target.depth, width, height);
+                culler.cull(core::CullPhase::Late, viewProjection, camera.getCamPos(), &hiZ, testCones);
+                drawPhase(core::CullPhase::Late);
+            }
+            else
+            {
+                culler.cull(core::CullPhase::All, viewProjection, camera.getCamPos(), nullptr, testCones);
+                drawPhase(core::CullPhase::All);
+            }
+            culler.endFrame();
+
+            glBlitNamedFramebuffer(target.framebuffer, 0, 0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        }
+
+        const core::ClusterCullStats stats = culler.getStats();
+        ImGui::SetNextWindowPos(ImVec2(10, 60), ImGuiCond_FirstUseEver);
+        ImGui::Begin("Cluster Culling");
+        ImGui::Text("%zu instances, %zu meshlets per sphere (%.1f triangles each)", culler.getInstanceCount(), sphereMeshlets,
+                    static_cast<double>( sphereData.indices.size() / 3 ) / static_cast<double>( sphereMeshlets ));
+        const int previousMode = mode;
+        ImGui::RadioButton("Objects", &mode, static_cast<int>( CullMode::Objects ));
+        ImGui::SameLine();
+        ImGui::RadioButton("Clusters", &mode, static_cast<int>( CullMode::Clusters ));
+        if(mode != previousMode)
+            culler.setInstances(static_cast<CullMode>( mode ) == CullMode::Objects ? objectInstances : clusterInstances);
+        ImGui::Checkbox("Normal cones", &testCones);
+        ImGui::Checkbox("Occlusion (two phase)", &testOcclusion);
+        ImGui::Checkbox("Tint clusters", &tintClusters);
+        ImGui::Text("Clusters     %u", stats.clusters);
+        ImGui::Text("Drawn        %u (%u early, %u late)", stats.earlyDraws + stats.lateDraws, stats.earlyDraws, stats.lateDraws);
+        ImGui::Text("Frustum      %u culled", stats.frustumCulled);
+        ImGui::Text("Normal cone  %u culled", stats.backfaceCulled);
+        ImGui::Text("Occlusion    %u culled", stats.occlusionCulled);
+        ImGui::Text("Triangles    %.2f M of %.2f M", static_cast<double>( stats.triangles ) / 1e6, static_cast<double>( sceneTriangles ) / 1e6);
+        ImGui::Text("Hi-Z         %dx%d, %d levels", hiZ.getWidth(), hiZ.getHeight(), hiZ.getLevels());
+        ImGui::End();
+
+        window.endImgui();
+        window.swapBuffers();
+        window.pollEvents();
+    }
+    glDeleteBuffers(1, &instanceDataBuffer);
+    target.release();
+    glfwTerminate();
+    return 0;
+}
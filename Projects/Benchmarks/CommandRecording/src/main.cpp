@@ -0,0 +1,274 @@
+#include <glad/gl.h>
+#include  <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <imgui.h>
+#include <Camera.h>
+#include <Window.h>
+#include <FPSCounter.h>
+#include <glfwHelpers.h>
+#include <Shader.h>
+#include <Mesh.h>
+#include <Geometry.h>
+#include <JobSystem.h>
+#include <CommandBuffer.h>
+#include <AllocationTracker.h>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <optional>
+#include <random>
+#include <vector>
+
+/* Forty thousand spinning objects whose model matrices, frustum tests and uniforms are
+ * worked out every frame. Direct does that work and the GL calls on the main thread, one
+ * object at a time. Recorded writes the same calls into core::CommandBuffers, on one thread
+ * or spread over the JobSystem, and the main thread replays them afterwards, so only the
+ * replay is tied to the context. Compare the preparation and GL times in the window. */
+
+enum class SubmitMode : int { Direct, Recorded, RecordedParallel };
+
+struct Vertex
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+};
+
+using VertexFormat = core::VertexLayoutOf<&Vertex::position, &Vertex::normal>;
+
+void pushVertex(std::vector<float>& vertices, const glm::vec3& position, const glm::vec3& normal)
+{
+    vertices.insert(vertices.end(), { position.x, position.y, position.z, normal.x, normal.y, normal.z });
+}
+
+// Radius 1 sphere as a triangle soup, MeshBuilder welds it
+std::vector<float> makeSphere(const int rings, const int segments)
+{
+    auto pointAt = [rings, segments](const int ring, const int segment)
+    {
+        const float theta = static_cast<float>( ring ) / static_cast<float>( rings ) * glm::pi<float>();
+        const float phi = static_cast<float>( segment ) / static_cast<float>( segments ) * glm::two_pi<float>();
+        return glm::vec3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+    };
+
+    std::vector<float> vertices;
+    for(int ring = 0; ring < rings; ring++)
+    {
+        for(int segment = 0; segment < segments; segment++)
+        {
+            const std::array quad = { pointAt(ring, segment), pointAt(ring + 1, segment), pointAt(ring + 1, segment + 1), pointAt(ring, segment + 1) };
+            for(const int corner : { 0, 1, 2, 0, 2, 3 })
+                pushVertex(vertices, quad[static_cast<std::size_t>( corner )], quad[static_cast<std::size_t>( corner )]);
+        }
+    }
+    return vertices;
+}
+
+// Cube from -1 to 1, flat normals
+std::vector<float> makeCube()
+{
+    std::vector<float> vertices;
+    for(int axis = 0; axis < 3; axis++)
+    {
+        for(const float side : { -1.0f, 1.0f })
+        {
+            glm::vec3 normal(0.0f);
+            normal[axis] = side;
+            const int u = (axis + 1) % 3, v = (axis + 2) % 3;
+            std::array<glm::vec3, 4> quad;
+            for(int corner = 0; corner < 4; corner++)
+            {
+                quad[static_cast<std::size_t>( corner )][axis] = side;
+                quad[static_cast<std::size_t>( corner )][u] = corner == 1 || corner == 2 ? 1.0f : -1.0f;
+                quad[static_cast<std::size_t>( corner )][v] = corner >= 2 ? 1.0f : -1.0f;
+            }
+            // Counter-clockwise seen from outside
+            if(side < 0.0f) std::swap(quad[1], quad[3]);
+            for(const int corner : { 0, 1, 2, 0, 2, 3 })
+                pushVertex(vertices, quad[static_cast<std::size_t>( corner )], normal);
+        }
+    }
+    return vertices;
+}
+
+struct Object
+{
+    glm::vec3 position;
+    glm::vec3 axis;
+    glm::vec3 colour;
+    float size;
+    float spin;
+    std::uint32_t mesh;
+};
+
+// What every mode computes per object: the animated model matrix, false when it's off screen
+bool prepareObject(const Object& object, const float time, const core::Frustum& frustum, glm::mat4& model)
+{
+    // The bounding sphere of a cube from -1 to 1 covers every rotation
+    if(!frustum.intersects(core::Sphere{ object.position, object.size * 1.7320508f })) return false;
+    model = glm::translate(glm::mat4(1.0f), object.position);
+    model = glm::rotate(model, time * object.spin, object.axis);
+    model = glm::scale(model, glm::vec3(object.size));
+    return true;
+}
+
+int main()
+{
+    // Each object records about 110 bytes, give the arena room for all of them on one thread
+    core::Window window({ .name = "CommandRecording", .vSync = false, .frameArenaBytes = 16 * 1024 * 1024 });
+    glfwSetInputMode(window.getGLFWWindow(), GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+    glfwSetFramebufferSizeCallback(window.getGLFWWindow(), framebuffer_size_callback);
+
+    WindowState state{};
+    state.lastX = static_cast<float>( window.getFramebufferWidth() ) / 2.0f;
+    state.lastY = static_cast<float>( window.getFramebufferHeight() ) / 2.0f;
+    glfwSetWindowUserPointer(window.getGLFWWindow(), &state);
+
+    glfwSetKeyCallback(window.getGLFWWindow(), key_callback);
+    glfwSetCursorPosCallback(window.getGLFWWindow(), mouse_callback);
+    glfwSetScrollCallback(window.getGLFWWindow(), scroll_callback);
+
+    const core::Shader sceneShader{ "assets/shaders/scene.vert", "assets/shaders/scene.frag" };
+    // Workers can't ask GL for locations, so they are looked up here once
+    const int viewProjectionLocation = sceneShader.getUniformLocation("viewProjection");
+    const int modelLocation = sceneShader.getUniformLocation("model");
+    const int colourLocation = sceneShader.getUniformLocation("colour");
+
+    core::MeshBuilder cubeBuilder(VertexFormat::desc());
+    cubeBuilder.addTriangleList(makeCube());
+    core::MeshBuilder sphereBuilder(VertexFormat::desc());
+    sphereBuilder.addTriangleList(makeSphere(8, 16));
+
+    core::VertexArrayCache vertexArrays;
+    const core::Mesh cubeMesh(cubeBuilder.build({ .logStats = false }), vertexArrays);
+    const core::Mesh sphereMesh(sphereBuilder.build({ .logStats = false }), vertexArrays);
+    const std::array<const core::Mesh*, 2> meshes = { &cubeMesh, &sphereMesh };
+
+    constexpr std::size_t ObjectCount = 40000;
+    constexpr float Extent = 400.0f;
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<Object> objects;
+    objects.reserve(ObjectCount);
+    for(std::size_t i = 0; i < ObjectCount; i++)
+    {
+        Object object{};
+        object.size = 0.5f + unit(random);
+        object.position = glm::vec3(unit(random) * Extent, object.size + unit(random) * 10.0f, unit(random) * Extent);
+        object.axis = glm::normalize(glm::vec3(unit(random) - 0.5f, 1.0f, unit(random) - 0.5f));
+        object.colour = glm::vec3(0.3f + 0.7f * unit(random), 0.3f + 0.7f * unit(random), 0.3f + 0.7f * unit(random));
+        object.spin = 0.5f + 2.0f * unit(random);
+        // Runs of the same mesh, like objects sorted by mesh would come
+        object.mesh = static_cast<std::uint32_t>( (i / 256) % meshes.size() );
+        objects.push_back(object);
+    }
+
+    core::Camera camera({ .Pos = glm::vec3(-10.0f, 25.0f, -10.0f), .zFar = 1000.0f, .Yaw = 45.0f, .Pitch = -15.0f,
+                          .Speed = 30.0f, .MouseSens = 0.1f });
+    state.pCamera = &camera;
+
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+
+    core::FPSCounter fps;
+    window.setClearColour(glm::vec4(0.55f, 0.7f, 0.85f, 1.0f));
+
+    core::JobSystem jobs;
+    core::CommandRecorder recorder(window.getFrameArena());
+    int mode = static_cast<int>( SubmitMode::RecordedParallel );
+    // A mode's first frames grow the recorder's buffers and make the arena's blocks, after that it must not allocate
+    constexpr int WarmupFrames = 8;
+    int lastMode = mode;
+    int framesInMode = 0;
+    double directMs = 0.0;
+
+    while(!window.shouldClose())
+    {
+        window.updateTime();
+        fps.update(window.getDeltaTime());
+        processInput(window.getGLFWWindow(), camera, window.getDeltaTime());
+
+        window.clear();
+        window.beginImgui();
+        fps.drawUI();
+
+        const glm::mat4 viewProjection = camera.getProjectionMatrix(window.getFramebufferWidth(), window.getFramebufferHeight(),
+                                                                    0.1f, 1000.0f) * camera.getViewMatrix();
+        const core::Frustum frustum = core::Frustum::fromMatrix(viewProjection);
+        const auto time = static_cast<float>( glfwGetTime() );
+
+        /* Steady state recording and replay stay off the heap (pages come from the frame arena,
+         * jobs from the JobSystem's pool), a TRACK_ALLOCATIONS build counts anything that doesn't
+         * and debug builds abort on it */
+        framesInMode = mode == lastMode ? framesInMode + 1 : 0;
+        lastMode = mode;
+        std::optional<core::NoAllocScope> noAlloc;
+        if(framesInMode >= WarmupFrames) noAlloc.emplace("CommandRecording frame");
+
+        recorder.reset();
+        if(static_cast<SubmitMode>( mode ) == SubmitMode::Direct)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            sceneShader.use();
+            sceneShader.setUniform(viewProjectionLocation, viewProjection);
+            for(const Object& object : objects)
+            {
+                glm::mat4 model;
+                if(!prepareObject(object, time, frustum, model)) continue;
+                sceneShader.setUniform(modelLocation, model);
+                sceneShader.setUniform(colourLocation, object.colour);
+                meshes[object.mesh]->drawLod(0);
+            }
+            directMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+        else
+        {
+            // Every chunk starts by binding the program, the replay drops the repeats
+            recorder.record(static_cast<SubmitMode>( mode ) == SubmitMode::RecordedParallel ? &jobs : nullptr, objects.size(),
+                            [&](core::CommandBuffer& buffer, const std::size_t first, const std::size_t last)
+                            {
+                                buffer.useShader(sceneShader);
+                                buffer.setUniform(viewProjectionLocation, viewProjection);
+                                for(std::size_t i = first; i < last; i++)
+                                {
+                                    glm::mat4 model;
+                                    if(!prepareObject(objects[i], time, frustum, model)) continue;
+                                    buffer.setUniform(modelLocation, model);
+                                    buffer.setUniform(colourLocation, objects[i].colour);
+                                    buffer.drawMesh(*meshes[objects[i].mesh]);
+                                }
+                            });
+            recorder.execute();
+        }
+        noAlloc.reset();
+
+        // The recorder publishes a frame's stats at the next reset(), so these are last frame's
+        const core::CommandStats& stats = recorder.getStats();
+        ImGui::SetNextWindowPos(ImVec2(10, 160), ImGuiCond_FirstUseEver);
+        ImGui::Begin("Command Recording");
+        ImGui::Text("%zu objects, %u job threads", objects.size(), jobs.getThreadCount());
+        ImGui::RadioButton("Direct", &mode, static_cast<int>( SubmitMode::Direct ));
+        ImGui::SameLine();
+        ImGui::RadioButton("Recorded", &mode, static_cast<int>( SubmitMode::Recorded ));
+        ImGui::SameLine();
+        ImGui::RadioButton("Recorded on jobs", &mode, static_cast<int>( SubmitMode::RecordedParallel ));
+        if(static_cast<SubmitMode>( mode ) == SubmitMode::Direct)
+        {
+            ImGui::Text("Prepare + GL %.3f ms", directMs);
+        }
+        else
+        {
+            ImGui::Text("Record %.3f ms, replay %.3f ms", stats.recordMs, stats.replayMs);
+            ImGui::Text("%zu commands in %zu buffers, %.1f KiB", stats.commands, stats.buffers, static_cast<double>( stats.bytes ) / 1024.0);
+            ImGui::Text("%zu redundant binds skipped", stats.skipped);
+        }
+        ImGui::End();
+
+        window.endImgui();
+        window.swapBuffers();
+        window.pollEvents();
+    }
+    glfwTerminate();
+    return 0;
+}
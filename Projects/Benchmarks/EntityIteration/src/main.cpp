@@ -0,0 +1,193 @@
+#include <glm/glm.hpp>
+#include <Components.h>
+#include <Ecs.h>
+#include <JobSystem.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <vector>
+
+/* Creates a scene of entities in a core::ecs::World and integrates their velocities, against
+ * the same scene as heap allocated objects holding every component, the layout the lessons
+ * used before the ECS. A quarter of the entities also have a Light, so the query spans two
+ * archetypes. Exits with 1 when the two scenes end up in different places.
+ * Usage: EntityIteration [entities] [runs] */
+
+struct Velocity
+{
+    glm::vec3 value = glm::vec3(0.0f);
+};
+
+// Everything an entity can have, whether it uses it or not
+struct SceneObject
+{
+    core::Transform transform;
+    Velocity velocity;
+    core::Material material;
+    core::Bounds bounds;
+    core::Light light;
+    bool hasLight = false;
+};
+
+constexpr float DeltaTime = 1.0f / 60.0f;
+
+double elapsedMs(const std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+template <typename Function>
+double medianMs(const int runs, const Function& function)
+{
+    std::vector<double> times;
+    for(int run = 0; run < runs + 2; run++)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        function();
+        const auto end = std::chrono::steady_clock::now();
+        // The first runs only warm caches
+        if(run >= 2) times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+void report(const char* name, const double objectsMs, const double worldMs, const std::size_t entityCount)
+{
+    std::cout << std::left << std::setw(20) << name << std::right << std::fixed << std::setprecision(3)
+            << std::setw(11) << objectsMs << std::setw(11) << worldMs << std::setprecision(2)
+            << std::setw(9) << objectsMs / worldMs << "x" << std::setprecision(1)
+            << std::setw(11) << worldMs * 1e6 / static_cast<double>( entityCount ) << '\n';
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t entityCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    const int runs = std::max(1, argc > 2 ? std::atoi(argv[2]) : 15);
+
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> spread(-500.0f, 500.0f);
+    std::uniform_real_distribution<float> speed(-5.0f, 5.0f);
+    std::vector<core::Transform> transforms(entityCount);
+    std::vector<Velocity> velocities(entityCount);
+    for(std::size_t i = 0; i < entityCount; i++)
+    {
+        transforms[i].position = glm::vec3(spread(random), spread(random), spread(random));
+        velocities[i].value = glm::vec3(speed(random), speed(random), speed(random));
+    }
+    const auto hasLight = [](const std::size_t i) { return i % 4 == 0; };
+
+    std::vector<std::unique_ptr<SceneObject>> objects;
+    const auto createObjects = [&]
+    {
+        objects.clear();
+        objects.reserve(entityCount);
+        for(std::size_t i = 0; i < entityCount; i++)
+        {
+            auto object = std::make_unique<SceneObject>();
+            object->transform = transforms[i];
+            object->velocity = velocities[i];
+            object->hasLight = hasLight(i);
+            objects.push_back(std::move(object));
+        }
+    };
+
+    core::ecs::World world;
+    const auto createEntities = [&]
+    {
+        for(std::size_t i = 0; i < entityCount; i++)
+        {
+            if(hasLight(i))
+                world.create(transforms[i], velocities[i], core::Bounds{}, core::Light{});
+            else
+                world.create(transforms[i], velocities[i], core::Bounds{});
+        }
+    };
+
+    // The first fill allocates every chunk, refills after clear() reuse them
+    auto start = std::chrono::steady_clock::now();
+    createObjects();
+    const double objectsColdMs = elapsedMs(start);
+    start = std::chrono::steady_clock::now();
+    createEntities();
+    const double worldColdMs = elapsedMs(start);
+
+    const double objectsCreateMs = medianMs(runs, createObjects);
+    const double worldCreateMs = medianMs(runs, [&]
+    {
+        world.clear();
+        createEntities();
+    });
+
+    const double objectsUpdateMs = medianMs(runs, [&]
+    {
+        for(const std::unique_ptr<SceneObject>& object : objects)
+            object->transform.position += object->velocity.value * DeltaTime;
+    });
+    const double worldUpdateMs = medianMs(runs, [&]
+    {
+        world.each<core::Transform, const Velocity>([](core::Transform& transform, const Velocity& velocity)
+        {
+            transform.position += velocity.value * DeltaTime;
+        });
+    });
+    const double worldChunkMs = medianMs(runs, [&]
+    {
+        world.eachChunk<core::Transform, const Velocity>([](const core::ecs::ChunkView<core::Transform, const Velocity>& view)
+        {
+            const std::span<core::Transform> chunkTransforms = view.get<core::Transform>();
+            const std::span<const Velocity> chunkVelocities = view.get<const Velocity>();
+            for(std::size_t i = 0; i < view.count; i++)
+                chunkTransforms[i].position += chunkVelocities[i].value * DeltaTime;
+        });
+    });
+
+    core::JobSystem jobs;
+    const double worldParallelMs = medianMs(runs, [&]
+    {
+        world.parallelEach<core::Transform, const Velocity>(jobs, [](core::Transform& transform, const Velocity& velocity)
+        {
+            transform.position += velocity.value * DeltaTime;
+        });
+    });
+
+    std::cout << entityCount << " entities, " << world.getArchetypeCount() << " archetypes, median of " << runs << " runs, "
+            << jobs.getThreadCount() << " threads" << '\n';
+    std::cout << "pass                 objects ms   world ms  speedup  ns/entity" << '\n';
+    report("create (first)", objectsColdMs, worldColdMs, entityCount);
+    report("create (refill)", objectsCreateMs, worldCreateMs, entityCount);
+    report("update each", objectsUpdateMs, worldUpdateMs, entityCount);
+    report("update eachChunk", objectsUpdateMs, worldChunkMs, entityCount);
+    report("update parallel", objectsUpdateMs, worldParallelMs, entityCount);
+
+    // Objects took runs + 2 steps, the world three times that, both from the same start
+    const double objectSteps = runs + 2;
+    const double worldSteps = 3.0 * objectSteps;
+    glm::dvec3 origin(0.0), travel(0.0);
+    for(std::size_t i = 0; i < entityCount; i++)
+    {
+        origin += glm::dvec3(transforms[i].position);
+        travel += glm::dvec3(velocities[i].value) * static_cast<double>( DeltaTime );
+    }
+    glm::dvec3 objectsSum(0.0), worldSum(0.0);
+    for(const std::unique_ptr<SceneObject>& object : objects)
+        objectsSum += glm::dvec3(object->transform.position);
+    world.each<const core::Transform>([&worldSum](const core::Transform& transform) { worldSum += glm::dvec3(transform.position); });
+
+    // Float rounding per step stays far below a millimetre per entity
+    const double scale = 1.0 / static_cast<double>( std::max<std::size_t>(entityCount, 1) );
+    const double objectsError = glm::length(objectsSum - (origin + travel * objectSteps)) * scale;
+    const double worldError = glm::length(worldSum - (origin + travel * worldSteps)) * scale;
+    if(world.getEntityCount() != entityCount || objectsError > 1e-3 || worldError > 1e-3)
+    {
+        std::cout << "FAIL: " << world.getEntityCount() << " entities, positions off by " << std::scientific
+                << objectsError << " and " << worldError << " per entity" << '\n';
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,10 @@
+#version 460 core
+out vec4 FragColour;
+in vec3 Normal;
+in vec3 Colour;
+
+void main()
+{
+    float diffuse = max(dot(normalize(Normal), normalize(vec3(0.4, 1.0, 0.6))), 0.0);
+    FragColour = vec4(Colour * (0.15 + diffuse), 1.0);
+}
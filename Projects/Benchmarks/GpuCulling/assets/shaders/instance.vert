@@ -0,0 +1,26 @@
+#version 460 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+
+// One per GpuInstance, the culling pass passes the instance's index as baseInstance
+struct InstanceData
+{
+    mat4 model;
+    vec4 colour;
+};
+
+layout (std430, binding = 5) readonly buffer InstanceTransforms { InstanceData instanceData[]; };
+
+uniform mat4 viewProjection;
+
+out vec3 Normal;
+out vec3 Colour;
+
+void main()
+{
+    InstanceData instance = instanceData[gl_BaseInstance];
+    // Only axis aligned scales and translations here, so mat3(model) keeps the normals' directions
+    Normal = mat3(instance.model) * aNormal;
+    Colour = instance.colour.rgb;
+    gl_Position = viewProjection * instance.model * vec4(aPos, 1.0);
+}
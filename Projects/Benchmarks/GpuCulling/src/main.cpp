@@ -0,0 +1,324 @@
+#include <glad/gl.h>
+#include  <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <imgui.h>
+#include <Camera.h>
+#include <Window.h>
+#include <FPSCounter.h>
+#include <glfwHelpers.h>
+#include <Shader.h>
+#include <Mesh.h>
+#include <HiZPyramid.h>
+#include <GpuCuller.h>
+#include <array>
+#include <cmath>
+#include <random>
+#include <vector>
+
+/* The city from OcclusionQueries with a hundred thousand props, every building and prop an
+ * instance culled on the GPU by core::GpuCuller and drawn with one indirect count draw per
+ * pass. Compare three modes:
+ * Frustum draws everything in the frustum, LastFrame also tests against the Hi-Z of the
+ * previous frame's depth (cheap, but what the camera just uncovered pops in a frame late),
+ * TwoPhase draws last frame's visible set, builds the Hi-Z from that and draws what the
+ * second test finds, so nothing pops. */
+
+struct Vertex
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+};
+
+using VertexFormat = core::VertexLayoutOf<&Vertex::position, &Vertex::normal>;
+
+// Per-instance data the vertex shader reads with gl_BaseInstance, std430 layout of instance.vert
+struct InstanceData
+{
+    glm::mat4 model;
+    glm::vec4 colour;
+};
+
+enum class CullMode : int { Frustum, LastFrame, TwoPhase };
+
+void pushVertex(std::vector<float>& vertices, const glm::vec3& position, const glm::vec3& normal)
+{
+    vertices.insert(vertices.end(), { position.x, position.y, position.z, normal.x, normal.y, normal.z });
+}
+
+// Radius 1 sphere as a triangle soup, MeshBuilder welds it
+std::vector<float> makeSphere(const int rings, const int segments)
+{
+    auto pointAt = [rings, segments](const int ring, const int segment)
+    {
+        const float theta = static_cast<float>( ring ) / static_cast<float>( rings ) * glm::pi<float>();
+        const float phi = static_cast<float>( segment ) / static_cast<float>( segments ) * glm::two_pi<float>();
+        return glm::vec3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+    };
+
+    std::vector<float> vertices;
+    for(int ring = 0; ring < rings; ring++)
+    {
+        for(int segment = 0; segment < segments; segment++)
+        {
+            const std::array quad = { pointAt(ring, segment), pointAt(ring + 1, segment), pointAt(ring + 1, segment + 1), pointAt(ring, segment + 1) };
+            for(const int corner : { 0, 1, 2, 0, 2, 3 })
+                pushVertex(vertices, quad[static_cast<std::size_t>( corner )], quad[static_cast<std::size_t>( corner )]);
+        }
+    }
+    return vertices;
+}
+
+// Cube from (0, 0, 0) to (1, 1, 1) with flat normals
+std::vector<float> makeCube()
+{
+    std::vector<float> vertices;
+    for(int axis = 0; axis < 3; axis++)
+    {
+        for(const float side : { 0.0f, 1.0f })
+        {
+            glm::vec3 normal(0.0f);
+            normal[axis] = side * 2.0f - 1.0f;
+            const int u = (axis + 1) % 3, v = (axis + 2) % 3;
+            std::array<glm::vec3, 4> quad;
+            for(int corner = 0; corner < 4; corner++)
+            {
+                quad[static_cast<std::size_t>( corner )][axis] = side;
+                quad[static_cast<std::size_t>( corner )][u] = corner == 1 || corner == 2 ? 1.0f : 0.0f;
+                quad[static_cast<std::size_t>( corner )][v] = corner >= 2 ? 1.0f : 0.0f;
+            }
+            // Counter-clockwise seen from outside
+            if(side == 0.0f) std::swap(quad[1], quad[3]);
+            for(const int corner : { 0, 1, 2, 0, 2, 3 })
+                pushVertex(vertices, quad[static_cast<std::size_t>( corner )], normal);
+        }
+    }
+    return vertices;
+}
+
+// Colour and depth textures to draw into, the Hi-Z is built from the depth texture
+struct RenderTarget
+{
+    unsigned int framebuffer = 0;
+    unsigned int colour = 0;
+    unsigned int depth = 0;
+    int width = 0;
+    int height = 0;
+
+    void resize(const int newWidth, const int newHeight)
+    {
+        if(newWidth == width && newHeight == height) return;
+        release();
+        width = newWidth;
+        height = newHeight;
+        if(width <= 0 || height <= 0) return;
+
+        glCreateTextures(GL_TEXTURE_2D, 1, &colour);
+        glTextureStorage2D(colour, 1, GL_RGBA8, width, height);
+        glCreateTextures(GL_TEXTURE_2D, 1, &depth);
+        glTextureStorage2D(depth, 1, GL_DEPTH_COMPONENT32F, width, height);
+
+        glCreateFramebuffers(1, &framebuffer);
+        glNamedFramebufferTexture(framebuffer, GL_COLOR_ATTACHMENT0, colour, 0);
+        glNamedFramebufferTexture(framebuffer, GL_DEPTH_ATTACHMENT, depth, 0);
+    }
+
+    void release()
+    {
+        if(framebuffer != 0) glDeleteFramebuffers(1, &framebuffer);
+        if(colour != 0) glDeleteTextures(1, &colour);
+        if(depth != 0) glDeleteTextures(1, &depth);
+        framebuffer = colour = depth = 0;
+    }
+};
+
+int main()
+{
+    core::Window window({ .name = "GpuCulling", .vSync = false });
+    glfwSetInputMode(window.getGLFWWindow(), GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+    glfwSetFramebufferSizeCallback(window.getGLFWWindow(), framebuffer_size_callback);
+
+    WindowState state{};
+    state.lastX = static_cast<float>( window.getFramebufferWidth() ) / 2.0f;
+    state.lastY = static_cast<float>( window.getFramebufferHeight() ) / 2.0f;
+    glfwSetWindowUserPointer(window.getGLFWWindow(), &state);
+
+    glfwSetKeyCallback(window.getGLFWWindow(), key_callback);
+    glfwSetCursorPosCallback(window.getGLFWWindow(), mouse_callback);
+    glfwSetScrollCallback(window.getGLFWWindow(), scroll_callback);
+
+    const core::Shader instanceShader{ "assets/shaders/instance.vert", "assets/shaders/instance.frag" };
+    core::HiZPyramid hiZ("core/shaders/hiz.comp");
+    core::GpuCuller culler("core/shaders/cull.comp");
+
+    // Both meshes in one vertex and index buffer, the culler addresses them by range
+    core::MeshBuilder cubeBuilder(VertexFormat::desc());
+    cubeBuilder.addTriangleList(makeCube());
+    const core::MeshData cubeData = cubeBuilder.build();
+    core::MeshBuilder sphereBuilder(VertexFormat::desc());
+    sphereBuilder.addTriangleList(makeSphere(12, 24));
+    const core::MeshData sphereData = sphereBuilder.build();
+
+    core::MeshData sceneData = cubeData;
+    sceneData.vertices.insert(sceneData.vertices.end(), sphereData.vertices.begin(), sphereData.vertices.end());
+    sceneData.indices.insert(sceneData.indices.end(), sphereData.indices.begin(), sphereData.indices.end());
+    const std::array<core::GpuMeshRange, 2> meshRanges = {
+        core::GpuMeshRange{ .indexCount = static_cast<std::uint32_t>( cubeData.indices.size() ) },
+        core::GpuMeshRange{ .indexCount = static_cast<std::uint32_t>( sphereData.indices.size() ),
+                            .firstIndex = static_cast<std::uint32_t>( cubeData.indices.size() ),
+                            .baseVertex = static_cast<std::int32_t>( cubeData.vertexCount() ) }
+    };
+    constexpr std::uint32_t CubeMesh = 0;
+    constexpr std::uint32_t SphereMesh = 1;
+
+    core::VertexArrayCache vertexArrays;
+    const core::Mesh sceneMesh(sceneData, vertexArrays);
+    culler.setMeshes(meshRanges);
+
+    // 24 m blocks with 8 m streets, one building per block
+    constexpr int Blocks = 16;
+    constexpr float BlockSize = 24.0f;
+    constexpr float StreetWidth = 8.0f;
+    constexpr float Pitch = BlockSize + StreetWidth;
+    constexpr float CitySize = Pitch * Blocks;
+    constexpr int PropCount = 100000;
+
+    std::mt19937 random(1234);
+    std::vector<core::GpuInstance> instances;
+    std::vector<InstanceData> instanceData;
+    std::uniform_real_distribution<float> storeys(8.0f, 60.0f);
+    for(int z = 0; z < Blocks; z++)
+    {
+        for(int x = 0; x < Blocks; x++)
+        {
+            const glm::vec3 corner(static_cast<float>( x ) * Pitch + StreetWidth, 0.0f, static_cast<float>( z ) * Pitch + StreetWidth);
+            const glm::vec3 size(BlockSize, storeys(random), BlockSize);
+            instances.push_back({ .boundsMin = corner, .mesh = CubeMesh, .boundsMax = corner + size });
+            instanceData.push_back({ glm::scale(glm::translate(glm::mat4(1.0f), corner), size), glm::vec4(0.6f, 0.6f, 0.65f, 1.0f) });
+        }
+    }
+
+    // Props along the streets
+    std::uniform_real_distribution<float> along(0.0f, CitySize);
+    std::uniform_real_distribution<float> across(1.0f, StreetWidth - 1.0f);
+    std::uniform_real_distribution<float> radius(0.2f, 0.8f);
+    std::uniform_int_distribution<int> street(0, Blocks - 1);
+    for(int i = 0; i < PropCount; i++)
+    {
+        const float offset = static_cast<float>( street(random) ) * Pitch + across(random);
+        const glm::vec3 center = i % 2 == 0 ? glm::vec3(offset, 0.0f, along(random)) : glm::vec3(along(random), 0.0f, offset);
+        const float size = radius(random);
+        const glm::vec3 position = center + glm::vec3(0.0f, size, 0.0f);
+        instances.push_back({ .boundsMin = position - glm::vec3(size), .mesh = SphereMesh, .boundsMax = position + glm::vec3(size) });
+        instanceData.push_back({ glm::scale(glm::translate(glm::mat4(1.0f), position), glm::vec3(size)), glm::vec4(0.9f, 0.35f, 0.2f, 1.0f) });
+    }
+    culler.setInstances(instances);
+
+    unsigned int instanceDataBuffer = 0;
+    glCreateBuffers(1, &instanceDataBuffer);
+    glNamedBufferStorage(instanceDataBuffer, static_cast<GLsizeiptr>( instanceData.size() * sizeof(InstanceData) ), instanceData.data(), 0);
+
+    core::Camera camera({ .Pos = glm::vec3(StreetWidth * 0.5f, 1.8f, 0.0f), .zFar = 800.0f, .Yaw = 90.0f, .Speed = 20.0f,
+                          .MouseSens = 0.1f });
+    state.pCamera = &camera;
+
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+
+    core::FPSCounter fps;
+    RenderTarget target;
+    int mode = static_cast<int>( CullMode::TwoPhase );
+    const glm::vec4 clearColour(0.55f, 0.7f, 0.85f, 1.0f);
+    constexpr float ClearDepth = 1.0f;
+
+    while(!window.shouldClose())
+    {
+        window.updateTime();
+        fps.update(window.getDeltaTime());
+        processInput(window.getGLFWWindow(), camera, window.getDeltaTime());
+
+        const int width = window.getFramebufferWidth();
+        const int height = window.getFramebufferHeight();
+        target.resize(width, height);
+
+        window.clear();
+        window.beginImgui();
+        fps.drawUI();
+
+        if(target.framebuffer != 0)
+        {
+            const glm::mat4 viewProjection = camera.getProjectionMatrix(width, height, 0.1f, 800.0f) * camera.getViewMatrix();
+
+            glBindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+            glViewport(0, 0, width, height);
+            glClearNamedFramebufferfv(target.framebuffer, GL_COLOR, 0, &clearColour.x);
+            glClearNamedFramebufferfv(target.framebuffer, GL_DEPTH, 0, &ClearDepth);
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 5, instanceDataBuffer);
+
+            auto drawPhase = [&](const core::CullPhase phase)
+            {
+                instanceShader.use();
+                instanceShader.setUniform("viewProjection", viewProjection);
+                sceneMesh.bind();
+                culler.draw(phase, sceneMesh.getIndexType());
+            };
+
+            switch(static_cast<CullMode>( mode ))
+            {
+                case CullMode::Frustum:
+                    culler.cull(core::CullPhase::All, viewProjection, nullptr);
+                    drawPhase(core::CullPhase::All);
+                    break;
+                case CullMode::LastFrame:
+                    // The pyramid still holds the previous frame's depth
+                    culler.cull(core::CullPhase::All, viewProjection, &hiZ);
+                    drawPhase(core::CullPhase::All);
+                    hiZ.build(target.depth, width, height);
+                    break;
+                case CullMode::TwoPhase:
+                    culler.cull(core::CullPhase::Early, viewProjection, nullptr);
+                    drawPhase(core::CullPhase::Early);
+                    hiZ.build(target.depth, width, height);
+                    culler.cull(core::CullPhase::Late, viewProjection, &hiZ);
+                    drawPhase(core::CullPhase::Late);
+                    break;
+            }
+            culler.endFrame();
+
+            glBlitNamedFramebuffer(target.framebuffer, 0, 0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+            glBindFramebuffer(GL_FRAMEBUFFER, 0);
+        }
+
+        const std::array<std::uint32_t, 2> drawCounts = culler.getDrawCounts();
+        ImGui::SetNextWindowPos(ImVec2(10, 60), ImGuiCond_FirstUseEver);
+        ImGui::Begin("GPU Culling");
+        ImGui::Text("%zu instances, %zu buildings and %d spheres of %zu triangles", culler.getInstanceCount(),
+                    culler.getInstanceCount() - PropCount, PropCount, sphereData.indices.size() / 3);
+        ImGui::RadioButton("Frustum", &mode, static_cast<int>( CullMode::Frustum ));
+        ImGui::SameLine();
+        ImGui::RadioButton("Last frame Hi-Z", &mode, static_cast<int>( CullMode::LastFrame ));
+        ImGui::SameLine();
+        ImGui::RadioButton("Two phase", &mode, static_cast<int>( CullMode::TwoPhase ));
+        if(static_cast<CullMode>( mode ) == CullMode::TwoPhase)
+        {
+            ImGui::Text("Early draws  %u", drawCounts[0]);
+            ImGui::Text("Late draws   %u", drawCounts[1]);
+            ImGui::Text("Total        %u", drawCounts[0] + drawCounts[1]);
+        }
+        else
+        {
+            ImGui::Text("Draws        %u", drawCounts[0]);
+        }
+        ImGui::Text("Hi-Z         %dx%d, %d levels", hiZ.getWidth(), hiZ.getHeight(), hiZ.getLevels());
+        ImGui::End();
+
+        window.endImgui();
+        window.swapBuffers();
+        window.pollEvents();
+    }
+    glDeleteBuffers(1, &instanceDataBuffer);
+    target.release();
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,139 @@
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <JobSystem.h>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <vector>
+
+/* Runs the per-object part of a frame (spin the object, rebuild its model matrix, cull its
+ * bounding sphere against the camera frustum) over a large scene with the job system at
+ * 1, 2, ... N threads, and prints the median frame time and speedup for each.
+ * Usage: JobSystemScaling [objects] [frames] */
+
+struct Object
+{
+    glm::vec3 position;
+    float scale;
+    glm::vec3 angles;
+    float radius;
+    glm::vec3 spin;
+};
+
+using Frustum = std::array<glm::vec4, 6>;
+
+// Gribb-Hartmann planes, rows of the view-projection matrix added and subtracted
+Frustum extractFrustum(const glm::mat4& viewProjection)
+{
+    auto row = [&viewProjection](const int i)
+    {
+        return glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+    };
+
+    Frustum planes = { row(3) + row(0), row(3) - row(0), row(3) + row(1), row(3) - row(1), row(3) + row(2), row(3) - row(2) };
+    for(glm::vec4& plane : planes)
+        plane /= glm::length(glm::vec3(plane));
+    return planes;
+}
+
+// Euler XYZ rotation, scale and translation written out, the same work a transform update does
+glm::mat4 composeModel(const Object& object)
+{
+    const float sx = std::sin(object.angles.x), cx = std::cos(object.angles.x);
+    const float sy = std::sin(object.angles.y), cy = std::cos(object.angles.y);
+    const float sz = std::sin(object.angles.z), cz = std::cos(object.angles.z);
+    const float s = object.scale;
+
+    glm::mat4 model(1.0f);
+    model[0] = glm::vec4(cy * cz, cy * sz, -sy, 0.0f) * s;
+    model[1] = glm::vec4(sx * sy * cz - cx * sz, sx * sy * sz + cx * cz, sx * cy, 0.0f) * s;
+    model[2] = glm::vec4(cx * sy * cz + sx * sz, cx * sy * sz - sx * cz, cx * cy, 0.0f) * s;
+    model[3] = glm::vec4(object.position, 1.0f);
+    return model;
+}
+
+bool sphereVisible(const Frustum& frustum, const glm::vec3& center, const float radius)
+{
+    for(const glm::vec4& plane : frustum)
+    {
+        if(glm::dot(glm::vec3(plane), center) + plane.w < -radius) return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t objectCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    const int frames = std::max(1, argc > 2 ? std::atoi(argv[2]) : 30);
+
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> spread(-200.0f, 200.0f);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    std::vector<Object> objects(objectCount);
+    for(Object& object : objects)
+    {
+        object.position = glm::vec3(spread(random), spread(random) * 0.25f, spread(random));
+        object.scale = 0.5f + unit(random);
+        object.angles = glm::vec3(unit(random), unit(random), unit(random)) * 6.2831853f;
+        object.radius = 0.87f;
+        object.spin = glm::vec3(unit(random), unit(random), unit(random));
+    }
+    std::vector<glm::mat4> models(objectCount);
+    std::vector<unsigned char> visible(objectCount);
+
+    const glm::mat4 viewProjection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 500.0f) *
+                                     glm::lookAt(glm::vec3(0.0f, 20.0f, 150.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    const Frustum frustum = extractFrustum(viewProjection);
+    constexpr float deltaTime = 1.0f / 60.0f;
+
+    auto updateRange = [&](const std::size_t begin, const std::size_t end)
+    {
+        for(std::size_t i = begin; i < end; i++)
+        {
+            Object& object = objects[i];
+            object.angles += object.spin * deltaTime;
+            models[i] = composeModel(object);
+            visible[i] = sphereVisible(frustum, object.position, object.radius * object.scale) ? 1 : 0;
+        }
+    };
+
+    const unsigned int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    std::cout << objectCount << " objects, " << frames << " frames per run, up to " << maxThreads << " threads" << '\n';
+    std::cout << "threads   median ms   speedup   efficiency   visible" << '\n';
+
+    double singleThreadMs = 0.0;
+    for(unsigned int threads = 1; threads <= maxThreads; threads++)
+    {
+        core::JobSystem jobs({ .threadCount = threads, .pinThreads = true });
+
+        std::vector<double> times;
+        for(int frame = 0; frame < frames + 3; frame++)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            jobs.parallelFor(objectCount, 4096, updateRange);
+            const auto end = std::chrono::steady_clock::now();
+            // The first frames only warm caches and wake the workers
+            if(frame >= 3) times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+        }
+
+        std::sort(times.begin(), times.end());
+        const double medianMs = times[times.size() / 2];
+        if(threads == 1) singleThreadMs = medianMs;
+        const double speedup = singleThreadMs / medianMs;
+        const auto visibleCount = std::count(visible.begin(), visible.end(), 1);
+
+        std::cout << std::setw(7) << threads << std::fixed << std::setprecision(3)
+                << std::setw(12) << medianMs << std::setprecision(2)
+                << std::setw(9) << speedup << "x"
+                << std::setw(11) << speedup / threads * 100.0 << "%"
+                << std::setw(11) << visibleCount << '\n';
+    }
+    return 0;
+}
@@ -0,0 +1,15 @@
+#version 460 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+
+uniform mat4 model;
+uniform mat4 viewProjection;
+
+out vec3 Normal;
+
+void main()
+{
+    // Only axis aligned scales and translations here, so mat3(model) keeps the normals' directions
+    Normal = mat3(model) * aNormal;
+    gl_Position = viewProjection * model * vec4(aPos, 1.0);
+}
@@ -0,0 +1,180 @@
+#include <glad/gl.h>
+#include  <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <imgui.h>
+#include <Camera.h>
+#include <Window.h>
+#include <FPSCounter.h>
+#include <glfwHelpers.h>
+#include <Shader.h>
+#include <Mesh.h>
+#include <Geometry.h>
+#include <LodSelector.h>
+#include <array>
+#include <cmath>
+#include <random>
+#include <vector>
+
+/* A field of ten thousand spheres, each drawn at the level core::LodSelector picks from its
+ * projected error. The chain is the same sphere tessellated coarser and coarser, so each
+ * level's error is known exactly: the sagitta of its longest edge. Tint the levels to watch
+ * the switches, raise the hysteresis to stop the ones on a boundary from flickering, and
+ * compare triangle counts in the overlay with LODs off. */
+
+struct Vertex
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+};
+
+using VertexFormat = core::VertexLayoutOf<&Vertex::position, &Vertex::normal>;
+
+void pushVertex(std::vector<float>& vertices, const glm::vec3& position, const glm::vec3& normal)
+{
+    vertices.insert(vertices.end(), { position.x, position.y, position.z, normal.x, normal.y, normal.z });
+}
+
+// Radius 1 sphere as a triangle soup, MeshBuilder welds it
+std::vector<float> makeSphere(const int rings, const int segments)
+{
+    auto pointAt = [rings, segments](const int ring, const int segment)
+    {
+        const float theta = static_cast<float>( ring ) / static_cast<float>( rings ) * glm::pi<float>();
+        const float phi = static_cast<float>( segment ) / static_cast<float>( segments ) * glm::two_pi<float>();
+        return glm::vec3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+    };
+
+    std::vector<float> vertices;
+    for(int ring = 0; ring < rings; ring++)
+    {
+        for(int segment = 0; segment < segments; segment++)
+        {
+            const std::array quad = { pointAt(ring, segment), pointAt(ring + 1, segment), pointAt(ring + 1, segment + 1), pointAt(ring, segment + 1) };
+            for(const int corner : { 0, 1, 2, 0, 2, 3 })
+                pushVertex(vertices, quad[static_cast<std::size_t>( corner )], quad[static_cast<std::size_t>( corner )]);
+        }
+    }
+    return vertices;
+}
+
+int main()
+{
+    core::Window window({ .name = "LodSelection", .vSync = false });
+    glfwSetInputMode(window.getGLFWWindow(), GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+    glfwSetFramebufferSizeCallback(window.getGLFWWindow(), framebuffer_size_callback);
+
+    WindowState state{};
+    state.lastX = static_cast<float>( window.getFramebufferWidth() ) / 2.0f;
+    state.lastY = static_cast<float>( window.getFramebufferHeight() ) / 2.0f;
+    glfwSetWindowUserPointer(window.getGLFWWindow(), &state);
+
+    glfwSetKeyCallback(window.getGLFWWindow(), key_callback);
+    glfwSetCursorPosCallback(window.getGLFWWindow(), mouse_callback);
+    glfwSetScrollCallback(window.getGLFWWindow(), scroll_callback);
+
+    const core::Shader sceneShader{ "assets/shaders/scene.vert", "assets/shaders/scene.frag" };
+
+    // Rings halve per level, segments stay twice the rings so both angular steps match
+    core::MeshData sphereData;
+    for(const int rings : { 48, 24, 12, 6, 3 })
+    {
+        core::MeshBuilder builder(VertexFormat::desc());
+        builder.addTriangleList(makeSphere(rings, rings * 2));
+        const core::MeshData level = builder.build({ .logStats = false });
+        // Farthest a radius 1 sphere is from an edge spanning pi / rings
+        const float error = 1.0f - std::cos(glm::pi<float>() / static_cast<float>( rings * 2 ));
+        if(sphereData.indices.empty())
+            sphereData = level;
+        else
+            core::MeshBuilder::appendLod(sphereData, level, error);
+    }
+
+    core::VertexArrayCache vertexArrays;
+    const core::Mesh sphereMesh(sphereData, vertexArrays);
+
+    constexpr int GridSize = 100;
+    constexpr float Spacing = 6.0f;
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> jitter(-2.0f, 2.0f);
+    std::uniform_real_distribution<float> radius(0.5f, 2.5f);
+    std::vector<glm::mat4> models;
+    std::vector<core::Sphere> bounds;
+    for(int z = 0; z < GridSize; z++)
+    {
+        for(int x = 0; x < GridSize; x++)
+        {
+            const float size = radius(random);
+            const glm::vec3 position(static_cast<float>( x ) * Spacing + jitter(random), size, static_cast<float>( z ) * Spacing + jitter(random));
+            models.push_back(glm::scale(glm::translate(glm::mat4(1.0f), position), glm::vec3(size)));
+            bounds.push_back({ position, size });
+        }
+    }
+
+    core::Camera camera({ .Pos = glm::vec3(-10.0f, 8.0f, -10.0f), .zFar = 1000.0f, .Yaw = 45.0f, .Pitch = -10.0f,
+                          .Speed = 20.0f, .MouseSens = 0.1f });
+    state.pCamera = &camera;
+
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+
+    core::FPSCounter fps;
+    window.setClearColour(glm::vec4(0.55f, 0.7f, 0.85f, 1.0f));
+
+    core::LodSelector selector;
+    core::LodSelector::setMain(&selector);
+    core::LodSelectorOptions options = selector.getOptions();
+    bool useLods = true;
+    bool tintLevels = true;
+    const std::array<glm::vec3, core::MaxLodLevels> levelColours = {
+        glm::vec3(0.9f, 0.35f, 0.2f), glm::vec3(0.9f, 0.8f, 0.2f), glm::vec3(0.3f, 0.8f, 0.3f), glm::vec3(0.2f, 0.6f, 0.9f),
+        glm::vec3(0.6f, 0.3f, 0.9f), glm::vec3(0.9f, 0.3f, 0.7f), glm::vec3(0.5f, 0.5f, 0.5f), glm::vec3(1.0f)
+    };
+
+    while(!window.shouldClose())
+    {
+        window.updateTime();
+        fps.update(window.getDeltaTime());
+        processInput(window.getGLFWWindow(), camera, window.getDeltaTime());
+
+        window.clear();
+        window.beginImgui();
+        fps.drawUI();
+
+        const glm::mat4 viewProjection = camera.getProjectionMatrix(window.getFramebufferWidth(), window.getFramebufferHeight(),
+                                                                    0.1f, 1000.0f) * camera.getViewMatrix();
+        sceneShader.use();
+        sceneShader.setUniform("viewProjection", viewProjection);
+
+        selector.setOptions(options);
+        selector.beginFrame(camera, window.getFramebufferHeight());
+        const std::span<const core::MeshLod> lods = sphereMesh.getLods();
+        for(core::LodSelector::ObjectId id = 0; id < models.size(); id++)
+        {
+            /* Without LODs every sphere still goes through the selector, pinned to level 0, so the overlay counts them.
+             * The unit sphere is scaled by its radius, which scales the lods' errors too. */
+            const std::size_t level = selector.select(id, useLods ? lods : lods.first(1), bounds[id], bounds[id].radius);
+            sceneShader.setUniform("colour", tintLevels ? levelColours[level] : levelColours[0]);
+            sceneShader.setUniform("model", models[id]);
+            sphereMesh.drawLod(level);
+        }
+
+        ImGui::SetNextWindowPos(ImVec2(10, 160), ImGuiCond_FirstUseEver);
+        ImGui::Begin("LOD Selection");
+        ImGui::Text("%zu spheres, %zu levels", models.size(), lods.size());
+        for(std::size_t level = 0; level < lods.size(); level++)
+            ImGui::Text("  LOD%zu %6u triangles, error %.4f", level, lods[level].indexCount / 3, lods[level].error);
+        ImGui::Checkbox("LODs", &useLods);
+        ImGui::Checkbox("Tint levels", &tintLevels);
+        ImGui::SliderFloat("Pixel threshold", &options.pixelThreshold, 0.1f, 8.0f);
+        ImGui::SliderFloat("Hysteresis", &options.hysteresis, 0.0f, 0.9f);
+        ImGui::End();
+
+        window.endImgui();
+        window.swapBuffers();
+        window.pollEvents();
+    }
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,133 @@
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <MathSIMD.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <vector>
+
+/* Times the per-object matrix work of a frame, written the way the lessons do it with glm
+ * against the core::simd batch kernels, and checks the kernels agree with glm:
+ * model = translate * rotate * scale, viewProjection * model and the normal matrix.
+ * Exits with 1 when a kernel strays further than Tolerance from glm.
+ * Usage: MatrixKernels [objects] [runs] */
+
+// Relative to the element's magnitude, float rounding alone stays well below it
+constexpr float Tolerance = 1e-4f;
+
+template <typename Function>
+double medianMs(const int runs, const Function& function)
+{
+    std::vector<double> times;
+    for(int run = 0; run < runs + 2; run++)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        function();
+        const auto end = std::chrono::steady_clock::now();
+        // The first runs only warm caches
+        if(run >= 2) times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+// Elements below 1 are compared absolutely, larger ones relative to glm's value
+template <typename Matrix>
+float maxDifference(const std::vector<Matrix>& a, const std::vector<Matrix>& b, const int columns)
+{
+    float difference = 0.0f;
+    for(std::size_t i = 0; i < a.size(); i++)
+    {
+        for(int column = 0; column < columns; column++)
+        {
+            for(int row = 0; row < columns; row++)
+            {
+                const float scale = std::max(1.0f, std::abs(a[i][column][row]));
+                const float element = std::abs(a[i][column][row] - b[i][column][row]) / scale;
+                // std::max would drop a NaN
+                if(std::isnan(element)) return std::numeric_limits<float>::infinity();
+                difference = std::max(difference, element);
+            }
+        }
+    }
+    return difference;
+}
+
+// False when the kernel is out of tolerance
+bool report(const char* name, const double glmMs, const double simdMs, const float difference)
+{
+    const bool passed = difference <= Tolerance;
+    std::cout << std::left << std::setw(18) << name << std::right << std::fixed << std::setprecision(3)
+            << std::setw(10) << glmMs << std::setw(11) << simdMs << std::setprecision(2)
+            << std::setw(9) << glmMs / simdMs << "x" << std::scientific << std::setprecision(1)
+            << std::setw(11) << difference << std::defaultfloat << (passed ? "" : "  FAIL") << '\n';
+    return passed;
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t objectCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    const int runs = std::max(1, argc > 2 ? std::atoi(argv[2]) : 15);
+
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> spread(-200.0f, 200.0f);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+
+    // The same objects twice, as glm values and as the kernels' SoA streams
+    std::vector<glm::vec3> positions(objectCount), scales(objectCount);
+    std::vector<glm::quat> rotations(objectCount);
+    core::simd::TransformArrays transforms;
+    transforms.resize(objectCount);
+    for(std::size_t i = 0; i < objectCount; i++)
+    {
+        positions[i] = glm::vec3(spread(random), spread(random), spread(random));
+        rotations[i] = glm::normalize(glm::quat(unit(random), unit(random), unit(random), unit(random)));
+        scales[i] = glm::vec3(1.0f + 0.5f * unit(random), 1.0f + 0.5f * unit(random), 1.0f + 0.5f * unit(random));
+        transforms.set(i, positions[i], rotations[i], scales[i]);
+    }
+
+    const glm::mat4 viewProjection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 500.0f) *
+                                     glm::lookAt(glm::vec3(0.0f, 20.0f, 150.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+    std::vector<glm::mat4> glmModels(objectCount), simdModels(objectCount);
+    std::vector<glm::mat4> glmClip(objectCount), simdClip(objectCount);
+    std::vector<glm::mat3> glmNormals(objectCount), simdNormals(objectCount);
+
+    const double glmCompose = medianMs(runs, [&]
+    {
+        for(std::size_t i = 0; i < objectCount; i++)
+        {
+            const glm::mat4 model = glm::translate(glm::mat4(1.0f), positions[i]) * glm::mat4_cast(rotations[i]);
+            glmModels[i] = glm::scale(model, scales[i]);
+        }
+    });
+    const double simdCompose = medianMs(runs, [&] { core::simd::composeTRS(transforms.getStreams(), objectCount, simdModels.data()); });
+
+    const double glmMultiply = medianMs(runs, [&]
+    {
+        for(std::size_t i = 0; i < objectCount; i++)
+            glmClip[i] = viewProjection * glmModels[i];
+    });
+    const double simdMultiply = medianMs(runs, [&] { core::simd::multiply(viewProjection, simdModels.data(), objectCount, simdClip.data()); });
+
+    const double glmNormal = medianMs(runs, [&]
+    {
+        for(std::size_t i = 0; i < objectCount; i++)
+            glmNormals[i] = glm::transpose(glm::inverse(glm::mat3(glmModels[i])));
+    });
+    const double simdNormal = medianMs(runs, [&] { core::simd::normalMatrices(simdModels.data(), objectCount, simdNormals.data()); });
+
+    std::cout << objectCount << " objects, median of " << runs << " runs" << '\n';
+    std::cout << "kernel               glm ms    simd ms   speedup   max diff" << '\n';
+    bool passed = report("compose TRS", glmCompose, simdCompose, maxDifference(glmModels, simdModels, 4));
+    passed &= report("view-projection", glmMultiply, simdMultiply, maxDifference(glmClip, simdClip, 4));
+    passed &= report("normal matrix", glmNormal, simdNormal, maxDifference(glmNormals, simdNormals, 3));
+    if(!passed) std::cout << "FAIL: a kernel differs from glm by more than " << Tolerance << '\n';
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,100 @@
+#include <glm/glm.hpp>
+#include <JobSystem.h>
+#include <MeshBuilder.h>
+#include <MeshSimplifier.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <vector>
+
+/* Generates a LOD chain for a bumpy sphere of about a million triangles (the size of a
+ * scanned or sculpted asset) with core::MeshSimplifier, once on the calling thread and once
+ * with a JobSystem, and prints each level's triangles and geometric error. The UV seam and
+ * the poles keep the seam and attribute handling honest.
+ * Usage: MeshSimplification [rings] (triangles = 4 * rings^2) */
+
+using Clock = std::chrono::steady_clock;
+
+struct Vertex
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 texCoord;
+};
+
+using VertexFormat = core::VertexLayoutOf<&Vertex::position, &Vertex::normal, &Vertex::texCoord>;
+
+double elapsedMs(const Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// Radius 1 sphere displaced by a low frequency bump, so flat and curved regions both show up
+core::MeshData makeBumpySphere(const int rings, const int segments)
+{
+    constexpr float Pi = 3.14159265f;
+    std::vector<Vertex> vertices;
+    for(int ring = 0; ring <= rings; ring++)
+    {
+        for(int segment = 0; segment <= segments; segment++)
+        {
+            const float theta = static_cast<float>( ring ) / static_cast<float>( rings ) * Pi;
+            const float phi = static_cast<float>( segment ) / static_cast<float>( segments ) * 2.0f * Pi;
+            const glm::vec3 direction(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+            const float height = 1.0f + 0.05f * std::sin(direction.x * 13.0f) * std::sin(direction.y * 11.0f) * std::sin(direction.z * 7.0f);
+            vertices.push_back({ direction * height, direction,
+                                 glm::vec2(static_cast<float>( segment ) / static_cast<float>( segments ),
+                                           static_cast<float>( ring ) / static_cast<float>( rings )) });
+        }
+    }
+
+    core::MeshData mesh;
+    mesh.layout = VertexFormat::desc();
+    mesh.vertices.resize(vertices.size() * sizeof(Vertex));
+    std::memcpy(mesh.vertices.data(), vertices.data(), mesh.vertices.size());
+    const auto row = static_cast<unsigned int>( segments + 1 );
+    for(unsigned int ring = 0; ring < static_cast<unsigned int>( rings ); ring++)
+    {
+        for(unsigned int segment = 0; segment < static_cast<unsigned int>( segments ); segment++)
+        {
+            const unsigned int a = ring * row + segment, b = a + row;
+            mesh.indices.insert(mesh.indices.end(), { a, b, b + 1, a, b + 1, a + 1 });
+        }
+    }
+    return mesh;
+}
+
+void report(const char* name, const double ms, const core::MeshData& mesh)
+{
+    std::cout << name << ": " << mesh.lods.size() << " levels in " << std::fixed << std::setprecision(1) << ms << " ms" << '\n';
+    for(std::size_t level = 0; level < mesh.lods.size(); level++)
+    {
+        std::cout << "  LOD" << level << std::setw(10) << mesh.lods[level].indexCount / 3 << " triangles, error "
+                << std::setprecision(5) << mesh.lods[level].error << '\n';
+    }
+}
+
+int main(int argc, char** argv)
+{
+    const int rings = std::max(4, argc > 1 ? std::atoi(argv[1]) : 512);
+    const core::MeshData source = makeBumpySphere(rings, rings * 2);
+    std::cout << source.indices.size() / 3 << " triangles, " << source.vertexCount() << " vertices" << '\n';
+
+    const core::LodChainOptions options{ .maxLevels = 6 };
+
+    core::MeshData serial = source;
+    auto start = Clock::now();
+    core::MeshSimplifier::generateLods(serial, options);
+    report("Serial", elapsedMs(start), serial);
+
+    core::JobSystem jobs;
+    core::MeshData parallel = source;
+    start = Clock::now();
+    core::MeshSimplifier::generateLods(parallel, options, &jobs);
+    report("JobSystem", elapsedMs(start), parallel);
+    return 0;
+}
@@ -0,0 +1,162 @@
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <Geometry.h>
+#include <JobSystem.h>
+#include <OcclusionCuller.h>
+#include <array>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/* Walks a camera down a street of a procedural city, culls the props to the frustum and
+ * then tests the survivors against the buildings with the CPU occlusion culler, once on the
+ * calling thread and once on the job system. Prints the per-frame averages: how much the
+ * rasteriser and the tests cost and what share of the frustum's props they hide.
+ * Usage: OcclusionCulling [blocks per side] [props] [frames] */
+
+struct FrameTotals
+{
+    double rasteriseMs = 0.0;
+    double testMs = 0.0;
+    std::size_t occluders = 0;
+    std::size_t triangles = 0;
+    std::size_t tested = 0;
+    std::size_t occluded = 0;
+};
+
+// Unit cube from (0, 0, 0) to (1, 1, 1) without its bottom, wound counter-clockwise from outside
+void makeBuildingMesh(std::vector<glm::vec3>& positions, std::vector<unsigned int>& indices)
+{
+    for(int corner = 0; corner < 8; corner++)
+        positions.emplace_back(corner & 1 ? 1.0f : 0.0f, corner & 2 ? 1.0f : 0.0f, corner & 4 ? 1.0f : 0.0f);
+
+    const std::array<std::array<unsigned int, 4>, 5> faces = { {
+        { 1, 3, 7, 5 }, { 0, 4, 6, 2 }, { 2, 6, 7, 3 }, { 4, 5, 7, 6 }, { 0, 2, 3, 1 }
+    } };
+    const glm::vec3 center(0.5f);
+    for(std::array<unsigned int, 4> face : faces)
+    {
+        // Flip any face whose normal points into the cube
+        const glm::vec3 normal = glm::cross(positions[face[1]] - positions[face[0]], positions[face[2]] - positions[face[0]]);
+        if(glm::dot(normal, positions[face[0]] - center) < 0.0f) std::swap(face[1], face[3]);
+        indices.insert(indices.end(), { face[0], face[1], face[2], face[0], face[2], face[3] });
+    }
+}
+
+void report(const char* name, const FrameTotals& totals, const int frames)
+{
+    const double perFrame = 1.0 / frames;
+    std::cout << std::left << std::setw(12) << name << std::right << std::fixed << std::setprecision(3)
+            << std::setw(11) << totals.rasteriseMs * perFrame << std::setw(10) << totals.testMs * perFrame
+            << std::setprecision(0) << std::setw(11) << static_cast<double>( totals.occluders ) * perFrame
+            << std::setw(11) << static_cast<double>( totals.triangles ) * perFrame
+            << std::setw(10) << static_cast<double>( totals.tested ) * perFrame << std::setprecision(1)
+            << std::setw(12) << (totals.tested == 0 ? 0.0 : 100.0 * static_cast<double>( totals.occluded ) / static_cast<double>( totals.tested ))
+            << '\n';
+}
+
+int main(int argc, char** argv)
+{
+    const int blocks = std::max(2, argc > 1 ? std::atoi(argv[1]) : 40);
+    const std::size_t propCount = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 200000;
+    const int frames = std::max(1, argc > 3 ? std::atoi(argv[3]) : 120);
+
+    // Blocks of 24 m with one building each and 8 m streets between them
+    constexpr float BlockSize = 24.0f;
+    constexpr float StreetWidth = 8.0f;
+    constexpr float Pitch = BlockSize + StreetWidth;
+    const float citySize = Pitch * static_cast<float>( blocks );
+
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> storeys(8.0f, 60.0f);
+    std::vector<core::Aabb> buildings;
+    std::vector<glm::mat4> buildingModels;
+    for(int z = 0; z < blocks; z++)
+    {
+        for(int x = 0; x < blocks; x++)
+        {
+            const glm::vec3 corner(static_cast<float>( x ) * Pitch + StreetWidth, 0.0f, static_cast<float>( z ) * Pitch + StreetWidth);
+            const glm::vec3 size(BlockSize, storeys(random), BlockSize);
+            buildings.push_back({ corner, corner + size });
+            buildingModels.push_back(glm::scale(glm::translate(glm::mat4(1.0f), corner), size));
+        }
+    }
+
+    std::vector<glm::vec3> positions;
+    std::vector<unsigned int> indices;
+    makeBuildingMesh(positions, indices);
+
+    // Props on the streets and the roofs, never inside a building
+    std::uniform_real_distribution<float> spread(0.0f, citySize);
+    std::uniform_real_distribution<float> propSize(0.3f, 1.5f);
+    std::vector<core::Aabb> props;
+    while(props.size() < propCount)
+    {
+        glm::vec3 base(spread(random), 0.0f, spread(random));
+        const int blockX = static_cast<int>( base.x / Pitch ), blockZ = static_cast<int>( base.z / Pitch );
+        const core::Aabb& building = buildings[static_cast<std::size_t>( std::min(blockZ, blocks - 1) * blocks + std::min(blockX, blocks - 1) )];
+        if(base.x > building.min.x && base.x < building.max.x && base.z > building.min.z && base.z < building.max.z) base.y = building.max.y;
+
+        const float size = propSize(random);
+        props.push_back({ base - glm::vec3(size, 0.0f, size), base + glm::vec3(size, 2.0f * size, size) });
+    }
+
+    const glm::mat4 projection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 1000.0f);
+    core::OcclusionCuller culler;
+    std::vector<core::Aabb> candidates;
+    std::vector<std::uint8_t> visible;
+
+    auto runFrames = [&](core::JobSystem* jobs)
+    {
+        FrameTotals totals;
+        for(int frame = 0; frame < frames; frame++)
+        {
+            // Down the middle of a street at head height, glancing to the side as it goes
+            const float along = citySize * (0.1f + 0.8f * static_cast<float>( frame ) / static_cast<float>( frames ));
+            const glm::vec3 eye(Pitch * static_cast<float>( blocks / 2 ) + StreetWidth * 0.5f, 1.8f, along);
+            const float yaw = 0.6f * std::sin(static_cast<float>( frame ) * 0.05f);
+            const glm::mat4 viewProjection = projection * glm::lookAt(eye, eye + glm::vec3(std::sin(yaw), 0.0f, std::cos(yaw)), glm::vec3(0.0f, 1.0f, 0.0f));
+            const core::Frustum frustum = core::Frustum::fromMatrix(viewProjection);
+
+            culler.beginFrame(viewProjection);
+            for(std::size_t i = 0; i < buildings.size(); i++)
+            {
+                if(frustum.intersects(buildings[i])) culler.addOccluder(positions, indices, buildingModels[i]);
+            }
+            culler.rasterise(jobs);
+
+            candidates.clear();
+            for(const core::Aabb& prop : props)
+            {
+                if(frustum.intersects(prop)) candidates.push_back(prop);
+            }
+            visible.resize(candidates.size());
+            culler.test(candidates, visible, jobs);
+
+            const core::OcclusionStats& stats = culler.getStats();
+            totals.rasteriseMs += stats.rasteriseMs;
+            totals.testMs += stats.testMs;
+            totals.occluders += stats.occluderTriangles / (indices.size() / 3);
+            totals.triangles += stats.rasterisedTriangles;
+            totals.tested += stats.tested;
+            totals.occluded += stats.occluded;
+        }
+        return totals;
+    };
+
+    std::cout << buildings.size() << " buildings, " << props.size() << " props, " << frames << " frames at "
+            << culler.getWidth() << "x" << culler.getHeight() << '\n';
+    std::cout << "per frame    raster ms   test ms  occluders  triangles    tested  occluded %" << '\n';
+
+    report("serial", runFrames(nullptr), frames);
+
+    core::JobSystem jobs;
+    const FrameTotals threaded = runFrames(&jobs);
+    const std::string name = std::to_string(jobs.getThreadCount()) + " threads";
+    report(name.c_str(), threaded, frames);
+    return 0;
+}
@@ -0,0 +1,8 @@
+#version 460 core
+// Colour writes are masked off, the query only counts samples that pass the depth test
+out vec4 FragColour;
+
+void main()
+{
+    FragColour = vec4(1.0);
+}
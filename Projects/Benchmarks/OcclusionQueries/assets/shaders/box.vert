@@ -0,0 +1,13 @@
+#version 460 core
+/* Occlusion query proxy: the unit cube stretched over each instance's bounding box,
+ * see core::OcclusionQueries::queryHidden */
+layout (location = 0) in vec3 aCorner;
+layout (location = 1) in vec3 aBoxMin;
+layout (location = 2) in vec3 aBoxMax;
+
+uniform mat4 viewProjection;
+
+void main()
+{
+    gl_Position = viewProjection * vec4(mix(aBoxMin, aBoxMax, aCorner), 1.0);
+}
@@ -0,0 +1,11 @@
+#version 460 core
+out vec4 FragColour;
+in vec3 Normal;
+
+uniform vec3 colour;
+
+void main()
+{
+    float diffuse = max(dot(normalize(Normal), normalize(vec3(0.4, 1.0, 0.6))), 0.0);
+    FragColour = vec4(colour * (0.15 + diffuse), 1.0);
+}
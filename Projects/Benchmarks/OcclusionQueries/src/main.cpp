@@ -0,0 +1,237 @@
+#include <glad/gl.h>
+#include  <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <imgui.h>
+#include <Camera.h>
+#include <Window.h>
+#include <FPSCounter.h>
+#include <glfwHelpers.h>
+#include <Shader.h>
+#include <Mesh.h>
+#include <Geometry.h>
+#include <OcclusionQueries.h>
+#include <array>
+#include <cmath>
+#include <random>
+#include <vector>
+
+/* A city block grid with thousands of dense spheres on its streets, most of them behind the
+ * buildings from street level. The buildings are always drawn, the spheres go through
+ * core::OcclusionQueries: the ones seen last time are drawn, the others only get their box
+ * tested and are drawn under conditional rendering. Toggle the queries to compare frame
+ * times, turn conditional rendering off to see what the hysteresis and same-frame draw
+ * save in popping. */
+
+struct Vertex
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+};
+
+using VertexFormat = core::VertexLayoutOf<&Vertex::position, &Vertex::normal>;
+
+void pushVertex(std::vector<float>& vertices, const glm::vec3& position, const glm::vec3& normal)
+{
+    vertices.insert(vertices.end(), { position.x, position.y, position.z, normal.x, normal.y, normal.z });
+}
+
+// Radius 1 sphere as a triangle soup, MeshBuilder welds it
+std::vector<float> makeSphere(const int rings, const int segments)
+{
+    auto pointAt = [rings, segments](const int ring, const int segment)
+    {
+        const float theta = static_cast<float>( ring ) / static_cast<float>( rings ) * glm::pi<float>();
+        const float phi = static_cast<float>( segment ) / static_cast<float>( segments ) * glm::two_pi<float>();
+        return glm::vec3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+    };
+
+    std::vector<float> vertices;
+    for(int ring = 0; ring < rings; ring++)
+    {
+        for(int segment = 0; segment < segments; segment++)
+        {
+            const std::array quad = { pointAt(ring, segment), pointAt(ring + 1, segment), pointAt(ring + 1, segment + 1), pointAt(ring, segment + 1) };
+            for(const int corner : { 0, 1, 2, 0, 2, 3 })
+                pushVertex(vertices, quad[static_cast<std::size_t>( corner )], quad[static_cast<std::size_t>( corner )]);
+        }
+    }
+    return vertices;
+}
+
+// Cube from (0, 0, 0) to (1, 1, 1) with flat normals
+std::vector<float> makeCube()
+{
+    std::vector<float> vertices;
+    for(int axis = 0; axis < 3; axis++)
+    {
+        for(const float side : { 0.0f, 1.0f })
+        {
+            glm::vec3 normal(0.0f);
+            normal[axis] = side * 2.0f - 1.0f;
+            const int u = (axis + 1) % 3, v = (axis + 2) % 3;
+            std::array<glm::vec3, 4> quad;
+            for(int corner = 0; corner < 4; corner++)
+            {
+                quad[static_cast<std::size_t>( corner )][axis] = side;
+                quad[static_cast<std::size_t>( corner )][u] = corner == 1 || corner == 2 ? 1.0f : 0.0f;
+                quad[static_cast<std::size_t>( corner )][v] = corner >= 2 ? 1.0f : 0.0f;
+            }
+            // Counter-clockwise seen from outside
+            if(side == 0.0f) std::swap(quad[1], quad[3]);
+            for(const int corner : { 0, 1, 2, 0, 2, 3 })
+                pushVertex(vertices, quad[static_cast<std::size_t>( corner )], normal);
+        }
+    }
+    return vertices;
+}
+
+int main()
+{
+    core::Window window({ .name = "OcclusionQueries", .vSync = false });
+    glfwSetInputMode(window.getGLFWWindow(), GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+    glfwSetFramebufferSizeCallback(window.getGLFWWindow(), framebuffer_size_callback);
+
+    WindowState state{};
+    state.lastX = static_cast<float>( window.getFramebufferWidth() ) / 2.0f;
+    state.lastY = static_cast<float>( window.getFramebufferHeight() ) / 2.0f;
+    glfwSetWindowUserPointer(window.getGLFWWindow(), &state);
+
+    glfwSetKeyCallback(window.getGLFWWindow(), key_callback);
+    glfwSetCursorPosCallback(window.getGLFWWindow(), mouse_callback);
+    glfwSetScrollCallback(window.getGLFWWindow(), scroll_callback);
+
+    const core::Shader sceneShader{ "assets/shaders/scene.vert", "assets/shaders/scene.frag" };
+    const core::Shader boxShader{ "assets/shaders/box.vert", "assets/shaders/box.frag" };
+
+    core::VertexArrayCache vertexArrays;
+    core::MeshBuilder sphereBuilder(VertexFormat::desc());
+    sphereBuilder.addTriangleList(makeSphere(32, 64));
+    const core::Mesh sphereMesh(sphereBuilder.build(), vertexArrays);
+    core::MeshBuilder cubeBuilder(VertexFormat::desc());
+    cubeBuilder.addTriangleList(makeCube());
+    const core::Mesh cubeMesh(cubeBuilder.build(), vertexArrays);
+
+    // 24 m blocks with 8 m streets, one building per block
+    constexpr int Blocks = 16;
+    constexpr float BlockSize = 24.0f;
+    constexpr float StreetWidth = 8.0f;
+    constexpr float Pitch = BlockSize + StreetWidth;
+    constexpr float CitySize = Pitch * Blocks;
+
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> storeys(8.0f, 60.0f);
+    std::vector<glm::mat4> buildings;
+    for(int z = 0; z < Blocks; z++)
+    {
+        for(int x = 0; x < Blocks; x++)
+        {
+            const glm::vec3 corner(static_cast<float>( x ) * Pitch + StreetWidth, 0.0f, static_cast<float>( z ) * Pitch + StreetWidth);
+            buildings.push_back(glm::scale(glm::translate(glm::mat4(1.0f), corner), glm::vec3(BlockSize, storeys(random), BlockSize)));
+        }
+    }
+
+    // Spheres along the streets, each one an occlusion query object
+    std::uniform_real_distribution<float> along(0.0f, CitySize);
+    std::uniform_real_distribution<float> across(1.5f, StreetWidth - 1.5f);
+    std::uniform_real_distribution<float> radius(0.5f, 1.5f);
+    std::uniform_int_distribution<int> street(0, Blocks - 1);
+    std::vector<glm::mat4> props;
+    std::vector<core::Aabb> propBounds;
+    for(int i = 0; i < 6000; i++)
+    {
+        const float offset = static_cast<float>( street(random) ) * Pitch + across(random);
+        const glm::vec3 center = i % 2 == 0 ? glm::vec3(offset, 0.0f, along(random)) : glm::vec3(along(random), 0.0f, offset);
+        const float size = radius(random);
+        const glm::vec3 position = center + glm::vec3(0.0f, size, 0.0f);
+        props.push_back(glm::scale(glm::translate(glm::mat4(1.0f), position), glm::vec3(size)));
+        propBounds.push_back({ position - glm::vec3(size), position + glm::vec3(size) });
+    }
+
+    core::Camera camera({ .Pos = glm::vec3(StreetWidth * 0.5f, 1.8f, 0.0f), .zFar = 800.0f, .Yaw = 90.0f, .Speed = 20.0f,
+                          .MouseSens = 0.1f });
+    state.pCamera = &camera;
+
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+
+    core::FPSCounter fps;
+    window.setClearColour(glm::vec4(0.55f, 0.7f, 0.85f, 1.0f));
+
+    core::OcclusionQueries occlusion;
+    bool useQueries = true;
+    bool conditionalRender = true;
+
+    while(!window.shouldClose())
+    {
+        window.updateTime();
+        fps.update(window.getDeltaTime());
+        processInput(window.getGLFWWindow(), camera, window.getDeltaTime());
+
+        window.clear();
+        window.beginImgui();
+        fps.drawUI();
+
+        const glm::mat4 viewProjection = camera.getProjectionMatrix(window.getFramebufferWidth(), window.getFramebufferHeight(),
+                                                                    0.1f, 800.0f) * camera.getViewMatrix();
+        sceneShader.use();
+        sceneShader.setUniform("viewProjection", viewProjection);
+
+        // The buildings go first, they are the occluders the queries are tested against
+        sceneShader.setUniform("colour", glm::vec3(0.6f, 0.6f, 0.65f));
+        for(const glm::mat4& model : buildings)
+        {
+            sceneShader.setUniform("model", model);
+            cubeMesh.draw();
+        }
+
+        sceneShader.setUniform("colour", glm::vec3(0.9f, 0.35f, 0.2f));
+        auto drawProp = [&](const core::OcclusionQueries::ObjectId id)
+        {
+            sceneShader.setUniform("model", props[id]);
+            sphereMesh.draw();
+        };
+
+        if(useQueries)
+        {
+            occlusion.setConditionalRender(conditionalRender);
+            occlusion.beginFrame(props.size());
+            occlusion.drawVisible(drawProp);
+
+            boxShader.use();
+            boxShader.setUniform("viewProjection", viewProjection);
+            occlusion.queryHidden(propBounds, camera.getCamPos());
+
+            sceneShader.use();
+            occlusion.drawHidden(drawProp);
+        }
+        else
+        {
+            for(core::OcclusionQueries::ObjectId id = 0; id < props.size(); id++)
+                drawProp(id);
+        }
+
+        const core::OcclusionQueryStats& stats = occlusion.getStats();
+        ImGui::SetNextWindowPos(ImVec2(10, 60), ImGuiCond_FirstUseEver);
+        ImGui::Begin("Occlusion Queries");
+        ImGui::Text("%zu spheres of %zu triangles, %zu buildings", props.size(), sphereMesh.getIndexCount() / 3, buildings.size());
+        ImGui::Checkbox("Occlusion queries", &useQueries);
+        ImGui::Checkbox("Conditional render", &conditionalRender);
+        if(useQueries)
+        {
+            ImGui::Text("Visible      %zu", stats.visible);
+            ImGui::Text("Conditional  %zu", stats.conditional);
+            ImGui::Text("Skipped      %zu", stats.skipped);
+            ImGui::Text("Queries      %zu issued, %zu read", stats.queriesIssued, stats.resultsRead);
+            ImGui::Text("Query pool   %zu in use of %zu", occlusion.getPool().getInUseCount(), occlusion.getPool().getAllocatedCount());
+        }
+        ImGui::End();
+
+        window.endImgui();
+        window.swapBuffers();
+        window.pollEvents();
+    }
+    glfwTerminate();
+    return 0;
+}
@@ -0,0 +1,14 @@
+#version 460 core
+out vec4 FragColour;
+in vec3 Normal;
+in vec2 TexCoord;
+
+uniform sampler2D diffuseMap;
+uniform vec4 colour;
+
+void main()
+{
+    float diffuse = max(dot(normalize(Normal), normalize(vec3(0.4, 1.0, 0.6))), 0.0);
+    vec4 albedo = texture(diffuseMap, TexCoord) * colour;
+    FragColour = vec4(albedo.rgb * (0.15 + diffuse), albedo.a);
+}
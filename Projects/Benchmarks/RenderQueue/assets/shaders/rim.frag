@@ -0,0 +1,17 @@
+#version 460 core
+out vec4 FragColour;
+in vec3 Normal;
+in vec2 TexCoord;
+
+uniform sampler2D diffuseMap;
+uniform vec4 colour;
+
+void main()
+{
+    vec3 normal = normalize(Normal);
+    float diffuse = max(dot(normal, normalize(vec3(0.4, 1.0, 0.6))), 0.0);
+    // Brightens the edges, which face away from an overhead light
+    float rim = pow(1.0 - abs(normal.y), 3.0);
+    vec4 albedo = texture(diffuseMap, TexCoord) * colour;
+    FragColour = vec4(albedo.rgb * (0.15 + diffuse) + rim * 0.4, albedo.a);
+}
@@ -0,0 +1,19 @@
+#version 460 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+
+uniform mat4 model;
+uniform mat4 viewProjection;
+
+out vec3 Normal;
+out vec2 TexCoord;
+
+void main()
+{
+    // Only translations and uniform scales here, so mat3(model) keeps the normals' directions
+    Normal = mat3(model) * aNormal;
+    // Planar mapping along the normal's largest axis, neither mesh has texture coordinates
+    vec3 axis = abs(aNormal);
+    TexCoord = 2.0 * (axis.x > 0.5 ? aPos.zy : axis.y > 0.5 ? aPos.xz : aPos.xy);
+    gl_Position = viewProjection * model * vec4(aPos, 1.0);
+}
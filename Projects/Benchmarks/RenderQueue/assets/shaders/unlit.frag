@@ -0,0 +1,12 @@
+#version 460 core
+out vec4 FragColour;
+in vec3 Normal;
+in vec2 TexCoord;
+
+uniform sampler2D diffuseMap;
+uniform vec4 colour;
+
+void main()
+{
+    FragColour = texture(diffuseMap, TexCoord) * colour;
+}
@@ -0,0 +1,293 @@
+#include <glad/gl.h>
+#include  <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <imgui.h>
+#include <Camera.h>
+#include <Window.h>
+#include <FPSCounter.h>
+#include <glfwHelpers.h>
+#include <Shader.h>
+#include <Mesh.h>
+#include <JobSystem.h>
+#include <RenderQueue.h>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <vector>
+
+/* Up to a hundred thousand objects with a random shader, material, texture and mesh each,
+ * pushed to a core::RenderQueue in creation order like a scene graph walk would. Sorted, draws
+ * that share state run together, opaque ones front to back and translucent ones back to front
+ * after them; unsorted, nearly every draw switches something and the translucent objects
+ * blend in the wrong order. The window compares state changes and CPU submit time. Past about
+ * 32 thousand objects the sort splits its passes over the job system, move the object slider
+ * across that to compare. */
+
+struct Vertex
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+};
+
+using VertexFormat = core::VertexLayoutOf<&Vertex::position, &Vertex::normal>;
+
+void pushVertex(std::vector<float>& vertices, const glm::vec3& position, const glm::vec3& normal)
+{
+    vertices.insert(vertices.end(), { position.x, position.y, position.z, normal.x, normal.y, normal.z });
+}
+
+// Radius 1 sphere as a triangle soup, MeshBuilder welds it
+std::vector<float> makeSphere(const int rings, const int segments)
+{
+    auto pointAt = [rings, segments](const int ring, const int segment)
+    {
+        const float theta = static_cast<float>( ring ) / static_cast<float>( rings ) * glm::pi<float>();
+        const float phi = static_cast<float>( segment ) / static_cast<float>( segments ) * glm::two_pi<float>();
+        return glm::vec3(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+    };
+
+    std::vector<float> vertices;
+    for(int ring = 0; ring < rings; ring++)
+    {
+        for(int segment = 0; segment < segments; segment++)
+        {
+            const std::array quad = { pointAt(ring, segment), pointAt(ring + 1, segment), pointAt(ring + 1, segment + 1), pointAt(ring, segment + 1) };
+            for(const int corner : { 0, 1, 2, 0, 2, 3 })
+                pushVertex(vertices, quad[static_cast<std::size_t>( corner )], quad[static_cast<std::size_t>( corner )]);
+        }
+    }
+    return vertices;
+}
+
+// Unit cube from -1 to 1, flat normals
+std::vector<float> makeCube()
+{
+    std::vector<float> vertices;
+    for(int axis = 0; axis < 3; axis++)
+    {
+        for(const float side : { -1.0f, 1.0f })
+        {
+            glm::vec3 normal(0.0f);
+            normal[axis] = side;
+            const int u = (axis + 1) % 3, v = (axis + 2) % 3;
+            std::array<glm::vec3, 4> quad;
+            for(int corner = 0; corner < 4; corner++)
+            {
+                quad[static_cast<std::size_t>( corner )][axis] = side;
+                quad[static_cast<std::size_t>( corner )][u] = corner == 1 || corner == 2 ? 1.0f : -1.0f;
+                quad[static_cast<std::size_t>( corner )][v] = corner >= 2 ? 1.0f : -1.0f;
+            }
+            // Counter-clockwise seen from outside
+            if(side < 0.0f) std::swap(quad[1], quad[3]);
+            for(const int corner : { 0, 1, 2, 0, 2, 3 })
+                pushVertex(vertices, quad[static_cast<std::size_t>( corner )], normal);
+        }
+    }
+    return vertices;
+}
+
+// Two colour checkerboard with a full mip chain
+unsigned int makeCheckerTexture(const glm::vec3& first, const glm::vec3& second, const int cells)
+{
+    constexpr int Size = 64;
+    std::vector<std::uint8_t> pixels;
+    pixels.reserve(Size * Size * 4);
+    for(int y = 0; y < Size; y++)
+    {
+        for(int x = 0; x < Size; x++)
+        {
+            const glm::vec3& colour = ((x * cells / Size) + (y * cells / Size)) % 2 == 0 ? first : second;
+            for(int channel = 0; channel < 3; channel++)
+                pixels.push_back(static_cast<std::uint8_t>( colour[channel] * 255.0f ));
+            pixels.push_back(255);
+        }
+    }
+
+    unsigned int texture = 0;
+    glCreateTextures(GL_TEXTURE_2D, 1, &texture);
+    glTextureStorage2D(texture, 7, GL_RGBA8, Size, Size);
+    glTextureSubImage2D(texture, 0, 0, 0, Size, Size, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    glGenerateTextureMipmap(texture);
+    glTextureParameteri(texture, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTextureParameteri(texture, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    return texture;
+}
+
+struct Object
+{
+    glm::mat4 model;
+    glm::vec3 position;
+    std::uint32_t shader;
+    std::uint32_t material;
+    std::uint32_t texture;
+    std::uint32_t mesh;
+};
+
+int main()
+{
+    core::Window window({ .name = "RenderQueue", .vSync = false });
+    glfwSetInputMode(window.getGLFWWindow(), GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+    glfwSetFramebufferSizeCallback(window.getGLFWWindow(), framebuffer_size_callback);
+
+    WindowState state{};
+    state.lastX = static_cast<float>( window.getFramebufferWidth() ) / 2.0f;
+    state.lastY = static_cast<float>( window.getFramebufferHeight() ) / 2.0f;
+    glfwSetWindowUserPointer(window.getGLFWWindow(), &state);
+
+    glfwSetKeyCallback(window.getGLFWWindow(), key_callback);
+    glfwSetCursorPosCallback(window.getGLFWWindow(), mouse_callback);
+    glfwSetScrollCallback(window.getGLFWWindow(), scroll_callback);
+
+    const std::array<core::Shader, 4> shaders = {
+        core::Shader{ "assets/shaders/scene.vert", "assets/shaders/lit.frag" },
+        core::Shader{ "assets/shaders/scene.vert", "assets/shaders/toon.frag" },
+        core::Shader{ "assets/shaders/scene.vert", "assets/shaders/rim.frag" },
+        core::Shader{ "assets/shaders/scene.vert", "assets/shaders/unlit.frag" }
+    };
+
+    core::MeshBuilder cubeBuilder(VertexFormat::desc());
+    cubeBuilder.addTriangleList(makeCube());
+    core::MeshBuilder sphereBuilder(VertexFormat::desc());
+    sphereBuilder.addTriangleList(makeSphere(12, 24));
+
+    core::VertexArrayCache vertexArrays;
+    const core::Mesh cubeMesh(cubeBuilder.build({ .logStats = false }), vertexArrays);
+    const core::Mesh sphereMesh(sphereBuilder.build({ .logStats = false }), vertexArrays);
+    const std::array<const core::Mesh*, 2> meshes = { &cubeMesh, &sphereMesh };
+
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+    constexpr std::size_t TextureCount = 16;
+    std::array<unsigned int, TextureCount> textures{};
+    for(std::size_t i = 0; i < TextureCount; i++)
+    {
+        const glm::vec3 colour(0.5f + 0.5f * unit(random), 0.5f + 0.5f * unit(random), 0.5f + 0.5f * unit(random));
+        textures[i] = makeCheckerTexture(colour, colour * 0.6f, 2 + static_cast<int>( i % 4 ) * 2);
+    }
+
+    // The last few materials are see-through, their objects go in the translucent half of the queue
+    constexpr std::size_t MaterialCount = 24;
+    constexpr std::size_t TranslucentMaterials = 4;
+    std::array<glm::vec4, MaterialCount> materials{};
+    for(std::size_t i = 0; i < MaterialCount; i++)
+    {
+        const float alpha = i >= MaterialCount - TranslucentMaterials ? 0.35f : 1.0f;
+        materials[i] = glm::vec4(0.3f + 0.7f * unit(random), 0.3f + 0.7f * unit(random), 0.3f + 0.7f * unit(random), alpha);
+    }
+
+    constexpr std::size_t ObjectCount = 100000;
+    constexpr float Extent = 300.0f;
+    std::vector<Object> objects;
+    objects.reserve(ObjectCount);
+    for(std::size_t i = 0; i < ObjectCount; i++)
+    {
+        Object object{};
+        const float size = 0.5f + 1.5f * unit(random);
+        object.position = glm::vec3(unit(random) * Extent, size + unit(random) * 20.0f, unit(random) * Extent);
+        object.model = glm::scale(glm::translate(glm::mat4(1.0f), object.position), glm::vec3(size));
+        object.shader = static_cast<std::uint32_t>( random() % shaders.size() );
+        object.material = static_cast<std::uint32_t>( random() % MaterialCount );
+        object.texture = static_cast<std::uint32_t>( random() % TextureCount );
+        object.mesh = static_cast<std::uint32_t>( random() % meshes.size() );
+        objects.push_back(object);
+    }
+
+    core::Camera camera({ .Pos = glm::vec3(-10.0f, 30.0f, -10.0f), .zFar = 1000.0f, .Yaw = 45.0f, .Pitch = -15.0f,
+                          .Speed = 30.0f, .MouseSens = 0.1f });
+    state.pCamera = &camera;
+
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    core::FPSCounter fps;
+    window.setClearColour(glm::vec4(0.55f, 0.7f, 0.85f, 1.0f));
+
+    core::JobSystem jobs;
+    core::RenderQueue queue;
+    core::RenderQueue::setMain(&queue);
+    bool sortQueue = true;
+    bool parallelSort = true;
+    // Starts past the queue's parallel sort threshold
+    int drawCount = 50000;
+    double submitMs = 0.0;
+
+    while(!window.shouldClose())
+    {
+        window.updateTime();
+        fps.update(window.getDeltaTime());
+        processInput(window.getGLFWWindow(), camera, window.getDeltaTime());
+
+        window.clear();
+        window.beginImgui();
+        fps.drawUI();
+
+        const glm::mat4 view = camera.getViewMatrix();
+        const glm::mat4 viewProjection = camera.getProjectionMatrix(window.getFramebufferWidth(), window.getFramebufferHeight(),
+                                                                    0.1f, 1000.0f) * view;
+
+        queue.clear();
+        for(std::uint32_t i = 0; i < static_cast<std::uint32_t>( drawCount ); i++)
+        {
+            const Object& object = objects[i];
+            // The camera looks down -z in view space
+            const float depth = -(view * glm::vec4(object.position, 1.0f)).z;
+            const bool translucent = object.material >= MaterialCount - TranslucentMaterials;
+            const std::uint64_t key = translucent
+                                          ? core::RenderQueue::makeTranslucentKey(0, object.shader, object.material, object.texture, depth)
+                                          : core::RenderQueue::makeOpaqueKey(0, object.shader, object.material, object.texture, depth);
+            queue.push({ .key = key, .shader = &shaders[object.shader], .mesh = meshes[object.mesh], .texture = textures[object.texture],
+                         .material = object.material, .lod = 0, .userData = i });
+        }
+        if(sortQueue) queue.sort(parallelSort ? &jobs : nullptr);
+
+        const auto start = std::chrono::steady_clock::now();
+        queue.submit([&](const core::DrawPacket& packet, const std::uint32_t changes)
+        {
+            if((changes & core::PassChanged) != 0)
+            {
+                const bool translucent = core::RenderQueue::isTranslucent(packet.key);
+                if(translucent) glEnable(GL_BLEND);
+                else glDisable(GL_BLEND);
+                glDepthMask(translucent ? GL_FALSE : GL_TRUE);
+            }
+            if((changes & core::ShaderChanged) != 0) packet.shader->setUniform("viewProjection", viewProjection);
+            if((changes & (core::ShaderChanged | core::MaterialChanged)) != 0) packet.shader->setUniform("colour", materials[packet.material]);
+            packet.shader->setUniform("model", objects[packet.userData].model);
+        });
+        submitMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        // The next clear needs depth writes on
+        glDisable(GL_BLEND);
+        glDepthMask(GL_TRUE);
+
+        // The queue publishes a frame's stats at the next clear(), so these are last frame's
+        const core::RenderQueueStats& stats = queue.getStats();
+        ImGui::SetNextWindowPos(ImVec2(10, 160), ImGuiCond_FirstUseEver);
+        ImGui::Begin("Render Queue");
+        ImGui::Text("%zu draws, %zu translucent", stats.packets, stats.translucent);
+        ImGui::SliderInt("Objects", &drawCount, 1000, static_cast<int>( ObjectCount ));
+        ImGui::Checkbox("Sort", &sortQueue);
+        ImGui::Checkbox("Sort on the job system", &parallelSort);
+        if(stats.sorted)
+            ImGui::Text("Sort %.3f ms (%s)", stats.sortMs, stats.sortedInParallel ? "job system" : "one thread");
+        ImGui::Text("Submit %.3f ms (CPU)", submitMs);
+        ImGui::Text("%-10s %10s %10s", "Changes", "submitted", "unsorted");
+        ImGui::Text("%-10s %10zu %10zu", "Passes", stats.submitted.passes, stats.insertionOrder.passes);
+        ImGui::Text("%-10s %10zu %10zu", "Shaders", stats.submitted.shaders, stats.insertionOrder.shaders);
+        ImGui::Text("%-10s %10zu %10zu", "Materials", stats.submitted.materials, stats.insertionOrder.materials);
+        ImGui::Text("%-10s %10zu %10zu", "Textures", stats.submitted.textures, stats.insertionOrder.textures);
+        ImGui::Text("%-10s %10zu %10zu", "Meshes", stats.submitted.meshes, stats.insertionOrder.meshes);
+        ImGui::End();
+
+        window.endImgui();
+        window.swapBuffers();
+        window.pollEvents();
+    }
+    glDeleteTextures(static_cast<GLsizei>( textures.size() ), textures.data());
+    glfwTerminate();
+    return 0;
+}
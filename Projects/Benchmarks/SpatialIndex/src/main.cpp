@@ -0,0 +1,167 @@
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <Bvh.h>
+#include <LooseOctree.h>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+/* Builds the BVH and the loose octree over a large scene of boxes and times the queries a
+ * frame makes (one camera frustum, a batch of light spheres, a batch of picking rays) against
+ * a linear scan, then moves a tenth of the objects and times the BVH refit and octree update.
+ * Usage: SpatialIndex [objects] [queries] */
+
+using Clock = std::chrono::steady_clock;
+
+// Keeps the linear scans' results alive so the compiler can't drop the loops
+volatile std::size_t g_Sink = 0;
+
+double elapsedMs(const Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+void report(const char* name, const double linearMs, const double bvhMs, const double octreeMs, const std::size_t hits)
+{
+    std::cout << std::left << std::setw(16) << name << std::right << std::fixed << std::setprecision(3)
+            << std::setw(12) << linearMs << std::setw(11) << bvhMs << std::setw(11) << octreeMs
+            << std::setw(12) << hits << '\n';
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t objectCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    const std::size_t queryCount = std::max<std::size_t>(1, argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1000);
+    // The linear scan is too slow to run the whole batch, it runs the first few and is scaled up
+    const std::size_t linearQueries = std::min<std::size_t>(queryCount, 20);
+    const double linearScale = static_cast<double>( queryCount ) / static_cast<double>( linearQueries );
+
+    // Mostly small props with the occasional large one, spread over a 2 km square
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> spread(-1000.0f, 1000.0f);
+    std::uniform_real_distribution<float> height(0.0f, 50.0f);
+    std::uniform_real_distribution<float> size(0.25f, 2.0f);
+    std::vector<core::Aabb> bounds(objectCount);
+    for(core::Aabb& box : bounds)
+    {
+        const glm::vec3 center(spread(random), height(random), spread(random));
+        const glm::vec3 extents = glm::vec3(size(random), size(random), size(random)) * (random() % 100 == 0 ? 10.0f : 1.0f);
+        box = { center - extents, center + extents };
+    }
+
+    auto start = Clock::now();
+    core::Bvh bvh(bounds);
+    const double bvhBuildMs = elapsedMs(start);
+
+    start = Clock::now();
+    core::LooseOctree octree({ .worldBounds = { glm::vec3(-1000.0f, -1000.0f, -1000.0f), glm::vec3(1000.0f) }, .maxDepth = 10 });
+    for(const core::Aabb& box : bounds)
+        octree.insert(box);
+    const double octreeBuildMs = elapsedMs(start);
+
+    std::cout << objectCount << " objects, " << queryCount << " sphere and ray queries" << '\n';
+    std::cout << "BVH build " << std::fixed << std::setprecision(1) << bvhBuildMs << " ms, " << bvh.getNodes().size() << " nodes" << '\n';
+    std::cout << "Octree build " << octreeBuildMs << " ms, " << octree.getNodeCount() << " nodes" << '\n';
+    std::cout << "query             linear ms     bvh ms  octree ms        hits" << '\n';
+
+    std::vector<std::uint32_t> hits;
+    std::size_t linearHits = 0;
+
+    // One camera frustum, as culling a frame would
+    const glm::mat4 viewProjection = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 400.0f) *
+                                     glm::lookAt(glm::vec3(0.0f, 30.0f, 0.0f), glm::vec3(100.0f, 0.0f, 100.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    const core::Frustum frustum = core::Frustum::fromMatrix(viewProjection);
+    start = Clock::now();
+    for(const core::Aabb& box : bounds)
+        linearHits += frustum.intersects(box) ? 1u : 0u;
+    const double linearFrustumMs = elapsedMs(start);
+    g_Sink = linearHits;
+    start = Clock::now();
+    bvh.queryFrustum(frustum, hits);
+    const double bvhFrustumMs = elapsedMs(start);
+    start = Clock::now();
+    octree.queryFrustum(frustum, hits);
+    report("frustum", linearFrustumMs, bvhFrustumMs, elapsedMs(start), hits.size());
+
+    // Light volumes, e.g. assigning point lights to objects
+    std::vector<core::Sphere> spheres(queryCount);
+    for(core::Sphere& sphere : spheres)
+        sphere = { glm::vec3(spread(random), height(random), spread(random)), 15.0f };
+    start = Clock::now();
+    linearHits = 0;
+    for(std::size_t query = 0; query < linearQueries; query++)
+    {
+        for(const core::Aabb& box : bounds)
+            linearHits += core::intersects(box, spheres[query]) ? 1u : 0u;
+    }
+    const double linearSphereMs = elapsedMs(start) * linearScale;
+    g_Sink = linearHits;
+    std::size_t bvhHits = 0, octreeHits = 0;
+    start = Clock::now();
+    for(const core::Sphere& sphere : spheres)
+    {
+        bvh.querySphere(sphere, hits);
+        bvhHits += hits.size();
+    }
+    const double bvhSphereMs = elapsedMs(start);
+    start = Clock::now();
+    for(const core::Sphere& sphere : spheres)
+    {
+        octree.querySphere(sphere, hits);
+        octreeHits += hits.size();
+    }
+    report("spheres", linearSphereMs, bvhSphereMs, elapsedMs(start), octreeHits);
+
+    // Picking rays cast down into the scene
+    std::vector<core::Ray> rays(queryCount);
+    for(core::Ray& ray : rays)
+        ray = { glm::vec3(spread(random), 100.0f, spread(random)), glm::normalize(glm::vec3(spread(random), -1000.0f, spread(random))), 500.0f };
+    start = Clock::now();
+    for(std::size_t query = 0; query < linearQueries; query++)
+    {
+        const glm::vec3 inverseDirection = 1.0f / rays[query].direction;
+        for(const core::Aabb& box : bounds)
+            linearHits += core::intersectRay(box, rays[query], inverseDirection) >= 0.0f ? 1u : 0u;
+    }
+    const double linearRayMs = elapsedMs(start) * linearScale;
+    g_Sink = linearHits;
+    start = Clock::now();
+    for(const core::Ray& ray : rays)
+    {
+        bvh.queryRay(ray, hits);
+        bvhHits += hits.size();
+    }
+    const double bvhRayMs = elapsedMs(start);
+    octreeHits = 0;
+    start = Clock::now();
+    for(const core::Ray& ray : rays)
+    {
+        octree.queryRay(ray, hits);
+        octreeHits += hits.size();
+    }
+    report("rays", linearRayMs, bvhRayMs, elapsedMs(start), octreeHits);
+
+    // A tenth of the scene moves a little, the BVH refits and the octree updates those objects
+    std::uniform_real_distribution<float> step(-1.0f, 1.0f);
+    std::vector<std::uint32_t> moved;
+    for(std::uint32_t i = 0; i < objectCount; i += 10)
+    {
+        const glm::vec3 offset(step(random), 0.0f, step(random));
+        bounds[i].min += offset;
+        bounds[i].max += offset;
+        moved.push_back(i);
+    }
+    start = Clock::now();
+    bvh.refit(bounds);
+    const double refitMs = elapsedMs(start);
+    start = Clock::now();
+    for(const std::uint32_t i : moved)
+        octree.update(i, bounds[i]);
+    const double updateMs = elapsedMs(start);
+    std::cout << "Moved " << moved.size() << " objects: BVH refit " << std::setprecision(2) << refitMs << " ms, octree update "
+            << updateMs << " ms (" << octree.getReinsertCount() << " changed node)" << '\n';
+    return 0;
+}
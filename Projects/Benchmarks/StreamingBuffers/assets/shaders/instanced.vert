@@ -0,0 +1,27 @@
+#version 460 core
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+
+// Both written every frame, from a core::StreamBuffer or re-uploaded
+layout (std140, binding = 0) uniform Frame
+{
+    mat4 viewProjection;
+};
+
+layout (std430, binding = 0) readonly buffer Instances
+{
+    mat4 models[];
+};
+
+out vec3 Normal;
+out vec3 Colour;
+
+void main()
+{
+    mat4 model = models[gl_InstanceID];
+    // Rotations and uniform scales only, so mat3(model) keeps the normals' directions
+    Normal = mat3(model) * aNormal;
+    uint hash = uint(gl_InstanceID) * 2654435761u;
+    Colour = 0.4 + 0.6 * vec3(hash & 255u, (hash >> 8) & 255u, (hash >> 16) & 255u) / 255.0;
+    gl_Position = viewProjection * model * vec4(aPos, 1.0);
+}
@@ -0,0 +1,244 @@
+#include <glad/gl.h>
+#include  <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <imgui.h>
+#include <Camera.h>
+#include <Window.h>
+#include <FPSCounter.h>
+#include <glfwHelpers.h>
+#include <Shader.h>
+#include <Mesh.h>
+#include <JobSystem.h>
+#include <StreamBuffer.h>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <optional>
+#include <random>
+#include <span>
+#include <vector>
+
+/* A hundred thousand spinning cubes whose matrices are rewritten every frame and drawn with
+ * one instanced call. SubData overwrites a single buffer the GPU is still reading, Orphan
+ * re-specifies it with glNamedBufferData each frame, Stream writes the matrices straight into
+ * a persistently mapped core::StreamBuffer region from the job system. Compare the upload
+ * times, and drop the frames in flight to 1 to see the stream buffer wait on the GPU. */
+
+enum class UploadMode : int { SubData, Orphan, Stream };
+
+struct Vertex
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+};
+
+using VertexFormat = core::VertexLayoutOf<&Vertex::position, &Vertex::normal>;
+
+void pushVertex(std::vector<float>& vertices, const glm::vec3& position, const glm::vec3& normal)
+{
+    vertices.insert(vertices.end(), { position.x, position.y, position.z, normal.x, normal.y, normal.z });
+}
+
+// Cube from -1 to 1, flat normals
+std::vector<float> makeCube()
+{
+    std::vector<float> vertices;
+    for(int axis = 0; axis < 3; axis++)
+    {
+        for(const float side : { -1.0f, 1.0f })
+        {
+            glm::vec3 normal(0.0f);
+            normal[axis] = side;
+            const int u = (axis + 1) % 3, v = (axis + 2) % 3;
+            std::array<glm::vec3, 4> quad;
+            for(int corner = 0; corner < 4; corner++)
+            {
+                quad[static_cast<std::size_t>( corner )][axis] = side;
+                quad[static_cast<std::size_t>( corner )][u] = corner == 1 || corner == 2 ? 1.0f : -1.0f;
+                quad[static_cast<std::size_t>( corner )][v] = corner >= 2 ? 1.0f : -1.0f;
+            }
+            // Counter-clockwise seen from outside
+            if(side < 0.0f) std::swap(quad[1], quad[3]);
+            for(const int corner : { 0, 1, 2, 0, 2, 3 })
+                pushVertex(vertices, quad[static_cast<std::size_t>( corner )], normal);
+        }
+    }
+    return vertices;
+}
+
+struct Object
+{
+    glm::vec3 position;
+    glm::vec3 axis;
+    float size;
+    float spin;
+};
+
+// Spreads the matrices over the job system. Written in order, which suits write-combined mapped memory
+void writeModels(const std::span<glm::mat4> models, const std::vector<Object>& objects, const float time, core::JobSystem& jobs)
+{
+    jobs.parallelFor(models.size(), 0, [&](const std::size_t first, const std::size_t last)
+    {
+        for(std::size_t i = first; i < last; i++)
+        {
+            const Object& object = objects[i];
+            glm::mat4 model = glm::translate(glm::mat4(1.0f), object.position);
+            model = glm::rotate(model, time * object.spin, object.axis);
+            models[i] = glm::scale(model, glm::vec3(object.size));
+        }
+    });
+}
+
+int main()
+{
+    core::Window window({ .name = "StreamingBuffers", .vSync = false });
+    glfwSetInputMode(window.getGLFWWindow(), GLFW_CURSOR, GLFW_CURSOR_DISABLED);
+    glfwSetFramebufferSizeCallback(window.getGLFWWindow(), framebuffer_size_callback);
+
+    WindowState state{};
+    state.lastX = static_cast<float>( window.getFramebufferWidth() ) / 2.0f;
+    state.lastY = static_cast<float>( window.getFramebufferHeight() ) / 2.0f;
+    glfwSetWindowUserPointer(window.getGLFWWindow(), &state);
+
+    glfwSetKeyCallback(window.getGLFWWindow(), key_callback);
+    glfwSetCursorPosCallback(window.getGLFWWindow(), mouse_callback);
+    glfwSetScrollCallback(window.getGLFWWindow(), scroll_callback);
+
+    const core::Shader sceneShader{ "assets/shaders/instanced.vert", "assets/shaders/instanced.frag" };
+
+    core::MeshBuilder cubeBuilder(VertexFormat::desc());
+    cubeBuilder.addTriangleList(makeCube());
+    core::VertexArrayCache vertexArrays;
+    const core::Mesh cubeMesh(cubeBuilder.build({ .logStats = false }), vertexArrays);
+
+    constexpr std::size_t ObjectCount = 100000;
+    constexpr float Extent = 400.0f;
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::vector<Object> objects;
+    objects.reserve(ObjectCount);
+    for(std::size_t i = 0; i < ObjectCount; i++)
+    {
+        Object object{};
+        object.size = 0.3f + 0.7f * unit(random);
+        object.position = glm::vec3(unit(random) * Extent, object.size + unit(random) * 10.0f, unit(random) * Extent);
+        object.axis = glm::normalize(glm::vec3(unit(random) - 0.5f, 1.0f, unit(random) - 0.5f));
+        object.spin = 0.5f + 2.0f * unit(random);
+        objects.push_back(object);
+    }
+
+    // The naive paths: one instance buffer and one frame block, rewritten in place or re-specified
+    constexpr std::size_t InstanceBytes = ObjectCount * sizeof(glm::mat4);
+    std::vector<glm::mat4> models(ObjectCount);
+    unsigned int instanceBuffer = 0;
+    unsigned int frameBuffer = 0;
+    glCreateBuffers(1, &instanceBuffer);
+    glNamedBufferData(instanceBuffer, InstanceBytes, nullptr, GL_DYNAMIC_DRAW);
+    glCreateBuffers(1, &frameBuffer);
+    glNamedBufferData(frameBuffer, sizeof(glm::mat4), nullptr, GL_DYNAMIC_DRAW);
+
+    // Room for the matrices plus the frame block and its alignment
+    constexpr std::size_t StreamBytesPerFrame = InstanceBytes + 64 * 1024;
+    int framesInFlight = 3;
+    std::optional<core::StreamBuffer> stream;
+    stream.emplace(core::StreamBufferOptions{ .bytesPerFrame = StreamBytesPerFrame, .framesInFlight = 3 });
+    core::StreamBuffer::setMain(&*stream);
+
+    core::Camera camera({ .Pos = glm::vec3(-10.0f, 25.0f, -10.0f), .zFar = 1000.0f, .Yaw = 45.0f, .Pitch = -15.0f,
+                          .Speed = 30.0f, .MouseSens = 0.1f });
+    state.pCamera = &camera;
+
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+
+    core::FPSCounter fps;
+    window.setClearColour(glm::vec4(0.55f, 0.7f, 0.85f, 1.0f));
+
+    core::JobSystem jobs;
+    int mode = static_cast<int>( UploadMode::Stream );
+    double uploadMs = 0.0;
+
+    while(!window.shouldClose())
+    {
+        window.updateTime();
+        fps.update(window.getDeltaTime());
+        processInput(window.getGLFWWindow(), camera, window.getDeltaTime());
+
+        window.clear();
+        window.beginImgui();
+        fps.drawUI();
+
+        const glm::mat4 viewProjection = camera.getProjectionMatrix(window.getFramebufferWidth(), window.getFramebufferHeight(),
+                                                                    0.1f, 1000.0f) * camera.getViewMatrix();
+        const auto time = static_cast<float>( glfwGetTime() );
+
+        // Includes writing the matrices and the stream buffer's wait, everything it takes to get the data to the GPU
+        const auto start = std::chrono::steady_clock::now();
+        if(static_cast<UploadMode>( mode ) == UploadMode::Stream)
+        {
+            stream->beginFrame();
+            core::StreamAllocation instances;
+            const std::span<glm::mat4> mapped = stream->allocateArray<glm::mat4>(ObjectCount, core::StreamUsage::Storage, &instances);
+            writeModels(mapped, objects, time, jobs);
+            const core::StreamAllocation frame = stream->upload(&viewProjection, sizeof(viewProjection), core::StreamUsage::Uniform);
+            core::StreamBuffer::bind(GL_SHADER_STORAGE_BUFFER, 0, instances);
+            core::StreamBuffer::bind(GL_UNIFORM_BUFFER, 0, frame);
+        }
+        else
+        {
+            writeModels(models, objects, time, jobs);
+            if(static_cast<UploadMode>( mode ) == UploadMode::SubData)
+            {
+                glNamedBufferSubData(instanceBuffer, 0, InstanceBytes, models.data());
+                glNamedBufferSubData(frameBuffer, 0, sizeof(viewProjection), &viewProjection);
+            }
+            else
+            {
+                glNamedBufferData(instanceBuffer, InstanceBytes, models.data(), GL_DYNAMIC_DRAW);
+                glNamedBufferData(frameBuffer, sizeof(viewProjection), &viewProjection, GL_DYNAMIC_DRAW);
+            }
+            glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, instanceBuffer);
+            glBindBufferBase(GL_UNIFORM_BUFFER, 0, frameBuffer);
+        }
+        uploadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        sceneShader.use();
+        cubeMesh.drawInstanced(static_cast<int>( ObjectCount ));
+        if(static_cast<UploadMode>( mode ) == UploadMode::Stream) stream->endFrame();
+
+        ImGui::SetNextWindowPos(ImVec2(10, 160), ImGuiCond_FirstUseEver);
+        ImGui::Begin("Streaming Buffers");
+        ImGui::Text("%zu instances, %.1f MiB a frame", objects.size(), static_cast<double>( InstanceBytes ) / (1024.0 * 1024.0));
+        ImGui::RadioButton("SubData", &mode, static_cast<int>( UploadMode::SubData ));
+        ImGui::SameLine();
+        ImGui::RadioButton("Orphan", &mode, static_cast<int>( UploadMode::Orphan ));
+        ImGui::SameLine();
+        ImGui::RadioButton("Stream", &mode, static_cast<int>( UploadMode::Stream ));
+        if(ImGui::SliderInt("Frames in flight", &framesInFlight, 1, 4))
+        {
+            // Recreating deletes the old buffer, which must not be in use
+            glFinish();
+            stream.reset();
+            stream.emplace(core::StreamBufferOptions{ .bytesPerFrame = StreamBytesPerFrame,
+                                                      .framesInFlight = static_cast<unsigned int>( framesInFlight ) });
+            core::StreamBuffer::setMain(&*stream);
+        }
+        ImGui::Text("Upload %.3f ms", uploadMs);
+        if(static_cast<UploadMode>( mode ) == UploadMode::Stream)
+        {
+            const core::StreamBufferStats& stats = stream->getStats();
+            ImGui::Text("Stalled %.3f ms last frame, %zu frames so far", stats.stallMs, stats.stalledFrames);
+        }
+        ImGui::End();
+
+        window.endImgui();
+        window.swapBuffers();
+        window.pollEvents();
+    }
+    stream.reset();
+    glDeleteBuffers(1, &instanceBuffer);
+    glDeleteBuffers(1, &frameBuffer);
+    glfwTerminate();
+    return 0;
+}
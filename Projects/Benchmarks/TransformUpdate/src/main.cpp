@@ -0,0 +1,194 @@
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <Components.h>
+#include <JobSystem.h>
+#include <TransformHierarchy.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <vector>
+
+/* Times core::TransformHierarchy's breadth-first update against the recursive walk over
+ * heap allocated nodes it replaces, which recomputes every world matrix each frame. The
+ * scene is a forest of three level trees (a root, 10 children, 100 grandchildren), frames
+ * move every root, one root in a hundred or none. Exits with 1 when the two disagree.
+ * Usage: TransformUpdate [nodes] [runs] */
+
+// Relative to the element's magnitude, float rounding alone stays well below it
+constexpr float Tolerance = 1e-4f;
+constexpr float Step = 0.01f;
+
+// The layout before TransformHierarchy, each node its own allocation pointing at its children
+struct SceneNode
+{
+    core::Transform local;
+    glm::mat4 world = glm::mat4(1.0f);
+    std::vector<SceneNode*> children;
+};
+
+void updateRecursive(SceneNode& node, const glm::mat4& parentWorld)
+{
+    node.world = parentWorld * node.local.getMatrix();
+    for(SceneNode* child : node.children)
+        updateRecursive(*child, node.world);
+}
+
+template <typename Function>
+double medianMs(const int runs, const Function& function)
+{
+    std::vector<double> times;
+    for(int run = 0; run < runs + 2; run++)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        function();
+        const auto end = std::chrono::steady_clock::now();
+        // The first runs only warm caches
+        if(run >= 2) times.push_back(std::chrono::duration<double, std::milli>(end - start).count());
+    }
+    std::sort(times.begin(), times.end());
+    return times[times.size() / 2];
+}
+
+void report(const char* name, const double recursiveMs, const double hierarchyMs, const std::size_t updated)
+{
+    std::cout << std::left << std::setw(18) << name << std::right << std::fixed << std::setprecision(3)
+            << std::setw(14) << recursiveMs << std::setw(14) << hierarchyMs << std::setprecision(2)
+            << std::setw(11) << recursiveMs / hierarchyMs << "x" << std::setw(11) << updated << '\n';
+}
+
+int main(int argc, char** argv)
+{
+    const std::size_t nodeCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    const int runs = std::max(1, argc > 2 ? std::atoi(argv[2]) : 15);
+    constexpr std::size_t Fanout = 10;
+    const std::size_t rootCount = std::max<std::size_t>(1, nodeCount / (1 + Fanout + Fanout * Fanout));
+
+    std::mt19937 random(1234);
+    std::uniform_real_distribution<float> spread(-500.0f, 500.0f);
+    std::uniform_real_distribution<float> offset(-5.0f, 5.0f);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    const auto randomLocal = [&](const bool root)
+    {
+        core::Transform local;
+        local.position = root ? glm::vec3(spread(random), spread(random), spread(random))
+                                  : glm::vec3(offset(random), offset(random), offset(random));
+        local.rotation = glm::normalize(glm::quat(unit(random), unit(random), unit(random), unit(random)));
+        local.scale = glm::vec3(1.0f + 0.2f * unit(random));
+        return local;
+    };
+
+    // Created depth first, so the hierarchy has to sort its nodes into levels on the first update
+    core::TransformHierarchy hierarchy;
+    std::vector<std::unique_ptr<SceneNode>> sceneNodes;
+    std::vector<core::TransformHierarchy::Node> handles;
+    std::vector<std::size_t> roots;
+    const auto addNode = [&](const core::Transform& local, const std::size_t parent)
+    {
+        auto node = std::make_unique<SceneNode>();
+        node->local = local;
+        core::TransformHierarchy::Node parentHandle = core::TransformHierarchy::NoNode;
+        if(parent != std::numeric_limits<std::size_t>::max())
+        {
+            sceneNodes[parent]->children.push_back(node.get());
+            parentHandle = handles[parent];
+        }
+        handles.push_back(hierarchy.create(local, parentHandle));
+        sceneNodes.push_back(std::move(node));
+        return sceneNodes.size() - 1;
+    };
+    for(std::size_t tree = 0; tree < rootCount; tree++)
+    {
+        const std::size_t root = addNode(randomLocal(true), std::numeric_limits<std::size_t>::max());
+        roots.push_back(root);
+        for(std::size_t i = 0; i < Fanout; i++)
+        {
+            const std::size_t child = addNode(randomLocal(false), root);
+            for(std::size_t j = 0; j < Fanout; j++)
+                addNode(randomLocal(false), child);
+        }
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    hierarchy.update();
+    const double firstMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    // Both sides move the same roots by the same step, so their locals stay identical
+    const auto recursiveFrame = [&](const std::size_t every)
+    {
+        for(std::size_t i = 0; i < roots.size(); i += every)
+            sceneNodes[roots[i]]->local.position.x += Step;
+        for(const std::size_t root : roots)
+            updateRecursive(*sceneNodes[root], glm::mat4(1.0f));
+    };
+    const auto hierarchyFrame = [&](const std::size_t every, core::JobSystem* jobs)
+    {
+        for(std::size_t i = 0; i < roots.size(); i += every)
+        {
+            const core::TransformHierarchy::Node root = handles[roots[i]];
+            glm::vec3 position = hierarchy.getLocal(root).position;
+            position.x += Step;
+            hierarchy.setPosition(root, position);
+        }
+        hierarchy.update(jobs);
+    };
+
+    const double recursiveAllMs = medianMs(runs, [&] { recursiveFrame(1); });
+    const double hierarchyAllMs = medianMs(runs, [&] { hierarchyFrame(1, nullptr); });
+    const std::size_t allUpdated = hierarchy.getUpdatedCount();
+
+    core::JobSystem jobs;
+    const double recursiveParallelMs = medianMs(runs, [&] { recursiveFrame(1); });
+    const double hierarchyParallelMs = medianMs(runs, [&] { hierarchyFrame(1, &jobs); });
+    const std::size_t parallelUpdated = hierarchy.getUpdatedCount();
+
+    const double recursiveFewMs = medianMs(runs, [&] { recursiveFrame(100); });
+    const double hierarchyFewMs = medianMs(runs, [&] { hierarchyFrame(100, nullptr); });
+    const std::size_t fewUpdated = hierarchy.getUpdatedCount();
+
+    const double recursiveStillMs = medianMs(runs, [&]
+    {
+        for(const std::size_t root : roots)
+            updateRecursive(*sceneNodes[root], glm::mat4(1.0f));
+    });
+    const double hierarchyStillMs = medianMs(runs, [&] { hierarchy.update(); });
+    const std::size_t stillUpdated = hierarchy.getUpdatedCount();
+
+    std::cout << sceneNodes.size() << " nodes in " << rootCount << " trees, " << hierarchy.getDepthCount() << " levels, median of "
+            << runs << " runs, " << jobs.getThreadCount() << " threads" << '\n';
+    std::cout << "First update, sorting into levels: " << std::fixed << std::setprecision(1) << firstMs << " ms" << '\n';
+    std::cout << "frame             recursive ms  hierarchy ms    speedup    updated" << '\n';
+    report("all roots", recursiveAllMs, hierarchyAllMs, allUpdated);
+    report("all roots, jobs", recursiveParallelMs, hierarchyParallelMs, parallelUpdated);
+    report("1% of roots", recursiveFewMs, hierarchyFewMs, fewUpdated);
+    report("nothing moved", recursiveStillMs, hierarchyStillMs, stillUpdated);
+
+    // Elements below 1 are compared absolutely, larger ones relative to the recursive value
+    float difference = 0.0f;
+    for(std::size_t i = 0; i < sceneNodes.size(); i++)
+    {
+        const glm::mat4& expected = sceneNodes[i]->world;
+        const glm::mat4& actual = hierarchy.getWorld(handles[i]);
+        for(int column = 0; column < 4; column++)
+        {
+            for(int row = 0; row < 4; row++)
+            {
+                const float scale = std::max(1.0f, std::abs(expected[column][row]));
+                const float element = std::abs(expected[column][row] - actual[column][row]) / scale;
+                // std::max would drop a NaN
+                difference = std::isnan(element) ? std::numeric_limits<float>::infinity() : std::max(difference, element);
+            }
+        }
+    }
+    if(difference > Tolerance)
+    {
+        std::cout << "FAIL: world matrices differ from the recursive walk by " << std::scientific << difference << '\n';
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,12 @@
+#version 460 core
+out vec4 FragColour;
+in vec3 Normal;
+in vec2 TexCoord;
+
+void main()
+{
+    // Cheap shading keeps the benchmark bound by vertex fetch rather than fragments
+    float diffuse = max(dot(normalize(Normal), normalize(vec3(0.4, 1.0, 0.6))), 0.0);
+    vec3 checker = mix(vec3(0.2), vec3(0.9), mod(floor(TexCoord.x * 32.0) + floor(TexCoord.y * 16.0), 2.0));
+    FragColour = vec4(checker * (0.1 + diffuse), 1.0);
+}
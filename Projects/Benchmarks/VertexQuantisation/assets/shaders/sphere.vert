@@ -0,0 +1,25 @@
+#version 460 core
+/* The same shader reads both vertex formats. Normalized attributes arrive as floats,
+ * so only the VAO changes between the float and packed meshes. */
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;// the packed format stores a 4th (unused) component
+layout (location = 2) in vec2 aTexCoord;
+
+uniform mat4 dequant;// identity for float positions
+uniform mat4 viewProjection;
+uniform int gridSize;
+uniform float spacing;
+
+out vec3 Normal;
+out vec2 TexCoord;
+
+void main()
+{
+    // Lays the instances out on a gridSize x gridSize x gridSize lattice
+    ivec3 cell = ivec3(gl_InstanceID % gridSize, (gl_InstanceID / gridSize) % gridSize, gl_InstanceID / (gridSize * gridSize));
+    vec3 offset = (vec3(cell) - vec3(gridSize - 1) * 0.5) * spacing;
+
+    Normal = aNormal;
+    TexCoord = aTexCoord;
+    gl_Position = viewProjection * vec4((dequant * vec4(aPos, 1.0)).xyz + offset, 1.0);
+}
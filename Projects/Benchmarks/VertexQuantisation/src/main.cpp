@@ -0,0 +1,255 @@
+#include <glad/gl.h>
+#include  <GLFW/glfw3.h>
+#include <glm/glm.hpp>
+#include <glm/gtc/constants.hpp>
+#include <imgui.h>
+#include <Camera.h>
+#include <Window.h>
+#include <FPSCounter.h>
+#include <glfwHelpers.h>
+#include <Shader.h>
+#include <Mesh.h>
+#include <VertexPacking.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <iostream>
+
+/* Draws the same dense sphere grid from a 32 byte float vertex and a 16 byte packed vertex
+ * (SNORM16 position, 10:10:10:2 normal, UNORM16 uv), alternating every few hundred frames.
+ * GPU time is measured with GL_TIME_ELAPSED queries, so the difference is the cost of the
+ * extra vertex fetch bandwidth. Small triangles and cheap shading keep it vertex bound. */
+
+struct Vertex
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 texCoord;
+};
+
+using FloatVertexLayout = core::VertexLayoutOf<&Vertex::position, &Vertex::normal, &Vertex::texCoord>;
+static_assert(core::PackedVertexLayout::Stride == 16, "Packed vertex should be half the float one");
+
+// UV sphere as a triangle soup, MeshBuilder welds the shared vertices again
+std::vector<float> makeSphere(const int rings, const int segments)
+{
+    auto vertexAt = [rings, segments](const int ring, const int segment)
+    {
+        const float v = static_cast<float>( ring ) / static_cast<float>( rings );
+        const float u = static_cast<float>( segment ) / static_cast<float>( segments );
+        const float theta = v * glm::pi<float>();
+        const float phi = u * glm::two_pi<float>();
+        const glm::vec3 normal(std::sin(theta) * std::cos(phi), std::cos(theta), std::sin(theta) * std::sin(phi));
+        return Vertex{ normal * 0.5f, normal, glm::vec2(u, v) };
+    };
+
+    std::vector<float> vertices;
+    vertices.reserve(static_cast<std::size_t>( rings * segments ) * 6 * 8);
+    auto push = [&vertices](const Vertex& vertex)
+    {
+        vertices.insert(vertices.end(), { vertex.position.x, vertex.position.y, vertex.position.z,
+                                          vertex.normal.x, vertex.normal.y, vertex.normal.z,
+                                          vertex.texCoord.x, vertex.texCoord.y });
+    };
+
+    for(int ring = 0; ring < rings; ring++)
+    {
+        for(int segment = 0; segment < segments; segment++)
+        {
+            const Vertex a = vertexAt(ring, segment);
+            const Vertex b = vertexAt(ring + 1, segment);
+            const Vertex c = vertexAt(ring + 1, segment + 1);
+            const Vertex d = vertexAt(ring, segment + 1);
+            push(a); push(b); push(c);
+            push(a); push(c); push(d);
+        }
+    }
+    return vertices;
+}
+
+// Keeps a few queries in flight so reading a result never stalls on the current frame
+class GpuTimer
+{
+private:
+    static constexpr int QueryCount = 3;
+    std::array<unsigned int, QueryCount> m_Queries{};
+    std::array<int, QueryCount> m_Tags{};
+    int m_Frame = 0;
+
+public:
+    GpuTimer() { glCreateQueries(GL_TIME_ELAPSED, QueryCount, m_Queries.data()); }
+
+    GpuTimer(const GpuTimer&) = delete;
+
+    GpuTimer& operator=(const GpuTimer&) = delete;
+
+    ~GpuTimer() { glDeleteQueries(QueryCount, m_Queries.data()); }
+
+    void begin(const int tag)
+    {
+        const int slot = m_Frame % QueryCount;
+        m_Tags[slot] = tag;
+        glBeginQuery(GL_TIME_ELAPSED, m_Queries[slot]);
+    }
+
+    void end()
+    {
+        glEndQuery(GL_TIME_ELAPSED);
+        m_Frame++;
+    }
+
+    // The oldest query in the ring, returns false while it is still pending
+    bool oldestResult(int& tag, double& milliseconds) const
+    {
+        if(m_Frame < QueryCount) return false;
+        const int slot = m_Frame % QueryCount;
+
+        int available = GL_FALSE;
+        glGetQueryObjectiv(m_Queries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+        if(available == GL_FALSE) return false;
+
+        GLuint64 nanoseconds = 0;
+        glGetQueryObjectui64v(m_Queries[slot], GL_QUERY_RESULT, &nanoseconds);
+        tag = m_Tags[slot];
+        milliseconds = static_cast<double>( nanoseconds ) / 1.0e6;
+        return true;
+    }
+};
+
+struct FormatStats
+{
+    const char* name;
+    std::size_t vertexBytes;
+    double averageMs = 0.0;
+    int samples = 0;
+};
+
+int main()
+{
+    core::Window window({ .name = "VertexQuantisation", .vSync = false });
+    // The cursor stays free for the benchmark controls, WASD still moves the camera
+    glfwSetFramebufferSizeCallback(window.getGLFWWindow(), framebuffer_size_callback);
+
+    WindowState state{};
+    state.lastX = static_cast<float>( window.getFramebufferWidth() ) / 2.0f;
+    state.lastY = static_cast<float>( window.getFramebufferHeight() ) / 2.0f;
+    glfwSetWindowUserPointer(window.getGLFWWindow(), &state);
+
+    glfwSetKeyCallback(window.getGLFWWindow(), key_callback);
+    glfwSetScrollCallback(window.getGLFWWindow(), scroll_callback);
+
+    const core::Shader shader{ "assets/shaders/sphere.vert", "assets/shaders/sphere.frag" };
+
+    // ~130k vertices, both meshes share the index buffer layout so only the vertex size differs
+    core::MeshBuilder builder(FloatVertexLayout::desc());
+    builder.addTriangleList(makeSphere(256, 512));
+    core::MeshData floatData = builder.build();
+    // A coarse level that is never drawn here, it only checks that packing keeps the LOD chain
+    core::MeshBuilder lodBuilder(FloatVertexLayout::desc());
+    lodBuilder.addTriangleList(makeSphere(16, 32));
+    core::MeshBuilder::appendLod(floatData, lodBuilder.build({ .logStats = false }), 0.05f);
+    const core::MeshData packedData = core::packVertices(floatData);
+    if(packedData.lods.size() != floatData.lods.size())
+    {
+        std::cerr << "[VertexQuantisation] Error: packing kept " << packedData.lods.size() << " of "
+                  << floatData.lods.size() << " LODs" << '\n';
+        return 1;
+    }
+
+    core::VertexArrayCache vertexArrays;
+    const core::Mesh floatMesh(floatData, vertexArrays);
+    const core::Mesh packedMesh(packedData, vertexArrays);
+
+    std::array<FormatStats, 2> formats = {
+        FormatStats{ "Float", floatData.vertices.size() },
+        FormatStats{ "Packed", packedData.vertices.size() }
+    };
+
+    core::Camera camera({ .Pos = glm::vec3(0.0f, 0.0f, 14.0f), .Speed = 7.5f, .MouseSens = 0.1f });
+    state.pCamera = &camera;
+
+    glEnable(GL_DEPTH_TEST);
+    glEnable(GL_CULL_FACE);
+
+    core::FPSCounter fps;
+    window.setClearColour(glm::vec4(0.05f, 0.05f, 0.08f, 1.0f));
+
+    GpuTimer timer;
+    int gridSize = 6;
+    int framesPerSwitch = 240;
+    bool alternate = true;
+    int current = 0;
+    int frame = 0;
+
+    while(!window.shouldClose())
+    {
+        window.updateTime();
+        fps.update(window.getDeltaTime());
+        processInput(window.getGLFWWindow(), camera, window.getDeltaTime());
+
+        // Collects finished timings into a running average for the format they measured
+        int tag = 0;
+        double milliseconds = 0.0;
+        if(timer.oldestResult(tag, milliseconds))
+        {
+            FormatStats& stats = formats[static_cast<std::size_t>( tag )];
+            stats.samples++;
+            stats.averageMs += (milliseconds - stats.averageMs) / static_cast<double>( std::min(stats.samples, 120) );
+        }
+
+        if(alternate && ++frame % framesPerSwitch == 0)
+        {
+            current = 1 - current;
+            std::cerr << "[VertexQuantisation]: Float " << formats[0].averageMs << " ms, Packed "
+                    << formats[1].averageMs << " ms" << '\n';
+        }
+
+        window.clear();
+        window.beginImgui();
+        fps.drawUI();
+
+        const core::Mesh& mesh = current == 0 ? floatMesh : packedMesh;
+        const glm::mat4 viewProjection = camera.getProjectionMatrix(window.getFramebufferWidth(),
+                                                                    window.getFramebufferHeight()) *
+                                         camera.getViewMatrix();
+        shader.use();
+        shader.setUniform("viewProjection", viewProjection);
+        shader.setUniform("dequant", mesh.getDequantMatrix());
+        shader.setUniform("gridSize", gridSize);
+        shader.setUniform("spacing", 1.25f);
+
+        timer.begin(current);
+        mesh.drawInstanced(gridSize * gridSize * gridSize);
+        timer.end();
+
+        ImGui::SetNextWindowPos(ImVec2(10, 60), ImGuiCond_FirstUseEver);
+        ImGui::Begin("Vertex Quantisation");
+        ImGui::Text("%zu vertices, %zu triangles x %d instances", floatMesh.getVertexCount(),
+                    floatMesh.getIndexCount() / 3, gridSize * gridSize * gridSize);
+        for(std::size_t i = 0; i < formats.size(); i++)
+        {
+            const FormatStats& stats = formats[i];
+            ImGui::TextColored(static_cast<int>( i ) == current ? ImVec4(1.0f, 1.0f, 0.0f, 1.0f) : ImVec4(0.7f, 0.7f, 0.7f, 1.0f),
+                               "%-6s %5.1f MB  %6.3f ms", stats.name,
+                               static_cast<double>( stats.vertexBytes ) / (1024.0 * 1024.0), stats.averageMs);
+        }
+        if(formats[1].averageMs > 0.0)
+            ImGui::Text("Packed speedup: %.2fx", formats[0].averageMs / formats[1].averageMs);
+        ImGui::Checkbox("Alternate formats", &alternate);
+        ImGui::SliderInt("Frames per switch", &framesPerSwitch, 30, 1000);
+        ImGui::SliderInt("Grid size", &gridSize, 1, 12);
+        if(!alternate)
+        {
+            ImGui::RadioButton("Float", &current, 0);
+            ImGui::SameLine();
+            ImGui::RadioButton("Packed", &current, 1);
+        }
+        ImGui::End();
+
+        window.endImgui();
+        window.swapBuffers();
+        window.pollEvents();
+    }
+    glfwTerminate();
+    return 0;
+}
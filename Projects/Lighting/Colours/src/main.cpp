@@ -10,6 +10,7 @@
 #include <FPSCounter.h>
 #include <glfwHelpers.h>
 #include <Shader.h>
+#include <ShaderLibrary.h>
 #include <Texture.h>
 
 
@@ -28,9 +29,13 @@ int main()
     glfwSetCursorPosCallback(window.getGLFWWindow(), mouse_callback);
     glfwSetScrollCallback(window.getGLFWWindow(), scroll_callback);
 
-    // Sets up shaders for the cube and light source
-    core::Shader cubeShader{ "assets/shaders/shader.vert", "assets/shaders/cubeShader.frag" };
-    core::Shader lightingShader{ "assets/shaders/shader.vert", "assets/shaders/lightingShader.frag" };
+    // Sets up shaders for the cube and light source, compiled together in one batch
+    core::ShaderLibrary shaders;
+    shaders.add("cube", "assets/shaders/shader.vert", "assets/shaders/cubeShader.frag");
+    shaders.add("light", "assets/shaders/shader.vert", "assets/shaders/lightingShader.frag");
+    shaders.compileAll();
+    const core::Shader& cubeShader = shaders.get("cube");
+    const core::Shader& lightingShader = shaders.get("light");
 
     const std::vector<float> vertices = {
         -0.5f, -0.5f, -0.5f,
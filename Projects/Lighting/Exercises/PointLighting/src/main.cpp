@@ -9,10 +9,25 @@
 #include <FPSCounter.h>
 #include <glfwHelpers.h>
 #include <Shader.h>
+#include <ShaderLibrary.h>
 #include <Texture.h>
+#include <Mesh.h>
+#include <Ecs.h>
+#include <Components.h>
+#include <array>
+#include <vector>
 
 /*See glsl files for diffuse lighting math*/
 
+// Position + normal, the layout takes the offsets and stride from these members
+struct Vertex
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+};
+
+using VertexFormat = core::VertexLayoutOf<&Vertex::position, &Vertex::normal>;
+
 int main()
 {
     core::Window window({ .name = "PointLighting", .vSync = false });
@@ -28,9 +43,13 @@ int main()
     glfwSetCursorPosCallback(window.getGLFWWindow(), mouse_callback);
     glfwSetScrollCallback(window.getGLFWWindow(), scroll_callback);
 
-    // Sets up shaders for the cube and light source
-    const core::Shader cubeShader{ "assets/shaders/cubeShader.vert", "assets/shaders/cubeShader.frag" };
-    const core::Shader lightingShader{ "assets/shaders/lightShader.vert", "assets/shaders/lightShader.frag" };
+    // Sets up shaders for the cube and light source, compiled together in one batch
+    core::ShaderLibrary shaders;
+    shaders.add("cube", "assets/shaders/cubeShader.vert", "assets/shaders/cubeShader.frag");
+    shaders.add("light", "assets/shaders/lightShader.vert", "assets/shaders/lightShader.frag");
+    shaders.compileAll();
+    const core::Shader& cubeShader = shaders.get("cube");
+    const core::Shader& lightingShader = shaders.get("light");
 
     const std::vector<float> vertices = {
         -0.5f, -0.5f, -0.5f, 0.0f, 0.0f, -1.0f,
@@ -76,36 +95,13 @@ int main()
         -0.5f, 0.5f, -0.5f, 0.0f, 1.0f, 0.0f
     };
 
-    unsigned int VBO;
-    unsigned int cubeVAO;
-    unsigned int lightVAO;
-    glGenVertexArrays(1, &cubeVAO);
-    glGenVertexArrays(1, &lightVAO);
-    glGenBuffers(1, &VBO);
-
-    // VBO setup
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
-
-    // Set up for cubeVAO
-    glBindVertexArray(cubeVAO);
-
-    // position attribute
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), nullptr);
-    glEnableVertexAttribArray(0);
-
-    // normal vector attribute
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), ( void * )(3 * sizeof(float)));
-    glEnableVertexAttribArray(1);
-
-    glBindBuffer(GL_ARRAY_BUFFER, 0);
-    glBindVertexArray(0);
-
-    // Sets up light VAO
-    glBindVertexArray(lightVAO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(float), nullptr);
-    glEnableVertexAttribArray(0);
+    /* Welds the 36 cube vertices down to the 24 unique ones and uploads an indexed mesh.
+     * The cube and the lamps use the same vertex format, so they share one VAO.
+     * The light shader simply ignores the normal attribute. */
+    core::VertexArrayCache vertexArrays;
+    core::MeshBuilder cubeBuilder(VertexFormat::desc());
+    cubeBuilder.addTriangleList(vertices);
+    const core::Mesh cubeMesh(cubeBuilder.build(), vertexArrays);
 
 
     /* Defines our Camera class to automatically change our view and perspective
@@ -122,12 +118,21 @@ int main()
     core::FPSCounter fps;
     window.setClearColour(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
 
-    std::vector lightPositions = {
+    /* The scene lives in an ECS world: the cube is a Transform + MeshRef + Material entity,
+     * every lamp a Transform + Light entity. */
+    core::ecs::World scene;
+    scene.create(core::Transform{}, core::MeshRef{ &cubeMesh },
+                 core::Material{ .shader = &cubeShader, .colour = glm::vec4(0.75f, 0.0f, 0.0f, 1.0f), .shininess = 64.0f });
+    const std::array lamps = {
         glm::vec3(3.0f, 1.5f, 2.0f), // KeyLight
         glm::vec3(-6.0f, 1.5f, 2.0f),// FillLight
         glm::vec3(0.0f, 1.5f, -8.0f) // Backlight
     };
-    float rotationAngle = 0.0f;
+    for(const glm::vec3& position : lamps)
+        scene.create(core::Transform{ .position = position, .scale = glm::vec3(0.2f) }, core::Light{});
+
+    std::vector<glm::vec3> lightPositions;
+    lightPositions.reserve(lamps.size());
     constexpr float rotationSpeed = 0.5f;
 
     while(!window.shouldClose())
@@ -140,52 +145,51 @@ int main()
         window.beginImgui();
         fps.drawUI();
 
-        cubeShader.use();
-        glm::mat4 view = camera.getViewMatrix();
-        glm::mat4 projection = camera.getProjectionMatrix(window.getFramebufferWidth(), window.getFramebufferHeight());
-        cubeShader.setUniform("view", view);
-        cubeShader.setUniform("projection", projection);
-        cubeShader.setUniform("objectColour", glm::vec3(0.75, 0.0f, 0.0f));
-        cubeShader.setUniform("lightColour", glm::vec3(1.0f, 1.0f, 1.0f));
-        cubeShader.setUniform("lightPositions", lightPositions);
-        cubeShader.setUniform("viewPos", camera.getCamPos());
-        cubeShader.setUniform("shineLevel", 64);
-
-        float dt = window.getDeltaTime();
-        rotationAngle += rotationSpeed * dt;
-        if(rotationAngle > 360.0f) rotationAngle -= 360.0f;
-
-        auto model = glm::mat4(1.0f);
-        model = glm::translate(model, glm::vec3(0.0f, 0.0f, 0.0f));
-        model = glm::rotate(model, rotationAngle, glm::vec3(0.0f, 1.0f, 0.0f));
-        cubeShader.setUniform("model", model);
-
-        glBindVertexArray(cubeVAO);// Use the CUBE VAO
-        glDrawArrays(GL_TRIANGLES, 0, 36);
+        // Spins everything that has a mesh around the y axis
+        const glm::quat spin = glm::angleAxis(rotationSpeed * window.getDeltaTime(), glm::vec3(0.0f, 1.0f, 0.0f));
+        scene.each<core::Transform, const core::MeshRef>([&spin](core::Transform& transform, const core::MeshRef&)
+        {
+            transform.rotation = glm::normalize(spin * transform.rotation);
+        });
 
+        lightPositions.clear();
+        scene.each<const core::Transform, const core::Light>([&lightPositions](const core::Transform& transform, const core::Light&)
+        {
+            lightPositions.push_back(transform.position);
+        });
+
+        const glm::mat4 view = camera.getViewMatrix();
+        const glm::mat4 projection = camera.getProjectionMatrix(window.getFramebufferWidth(), window.getFramebufferHeight());
+
+        scene.each<const core::Transform, const core::MeshRef, const core::Material>(
+            [&](const core::Transform& transform, const core::MeshRef& mesh, const core::Material& material)
+            {
+                material.shader->use();
+                material.shader->setUniform("view", view);
+                material.shader->setUniform("projection", projection);
+                material.shader->setUniform("objectColour", glm::vec3(material.colour));
+                material.shader->setUniform("lightColour", glm::vec3(1.0f, 1.0f, 1.0f));
+                material.shader->setUniform("lightPositions", lightPositions);
+                material.shader->setUniform("viewPos", camera.getCamPos());
+                material.shader->setUniform("shineLevel", static_cast<int>( material.shininess ));
+                material.shader->setUniform("model", transform.getMatrix());
+                mesh.mesh->draw();
+            });
+
+        // The lamps are drawn as small unlit cubes
         lightingShader.use();
-        float lightIntensity = 1.0f;
-
-        for(auto& i : lightPositions)
+        lightingShader.setUniform("view", view);
+        lightingShader.setUniform("projection", projection);
+        scene.each<const core::Transform, const core::Light>([&](const core::Transform& transform, const core::Light&)
         {
-            lightingShader.setUniform("view", view);
-            lightingShader.setUniform("projection", projection);
-            model = glm::mat4(1.0f);
-            model = glm::translate(model, i);
-            model = glm::scale(model, glm::vec3(0.2f));// Make the lamp smaller
-            lightingShader.setUniform("model", model);
-            glBindVertexArray(lightVAO);
-            glDrawArrays(GL_TRIANGLES, 0, 36);
-            lightIntensity *= 0.2f;
-        }
+            lightingShader.setUniform("model", transform.getMatrix());
+            cubeMesh.draw();
+        });
 
         window.endImgui();
         window.swapBuffers();
         window.pollEvents();
     }
-    glDeleteVertexArrays(1, &cubeVAO);
-    glDeleteVertexArrays(1, &lightVAO);
-    glDeleteBuffers(1, &VBO);
     glfwTerminate();
     return 0;
 }
@@ -0,0 +1,67 @@
+// Frustum and Hi-Z tests shared by cull.comp and cluster.comp, included after #version
+layout (binding = 0) uniform sampler2D hiZ;
+
+uniform mat4 viewProjection;
+uniform vec4 frustumPlanes[6];
+uniform ivec2 hiZSize;
+uniform int hiZLevels;
+
+// Boxes, tested with the corner farthest along each plane's normal
+bool inFrustum(vec3 boundsMin, vec3 boundsMax)
+{
+    vec3 center = (boundsMin + boundsMax) * 0.5;
+    vec3 extents = (boundsMax - boundsMin) * 0.5;
+    for(int i = 0; i < 6; i++)
+    {
+        vec3 normal = frustumPlanes[i].xyz;
+        if(dot(normal, center) + frustumPlanes[i].w < -dot(abs(normal), extents)) return false;
+    }
+    return true;
+}
+
+// Spheres
+bool inFrustum(vec3 center, float radius)
+{
+    for(int i = 0; i < 6; i++)
+    {
+        if(dot(frustumPlanes[i].xyz, center) + frustumPlanes[i].w < -radius) return false;
+    }
+    return true;
+}
+
+bool notOccluded(vec3 boundsMin, vec3 boundsMax)
+{
+    vec2 uvMin = vec2(1.0);
+    vec2 uvMax = vec2(0.0);
+    float nearest = 1.0;
+    for(int i = 0; i < 8; i++)
+    {
+        vec3 corner = vec3((i & 1) != 0 ? boundsMax.x : boundsMin.x, (i & 2) != 0 ? boundsMax.y : boundsMin.y,
+                           (i & 4) != 0 ? boundsMax.z : boundsMin.z);
+        vec4 clip = viewProjection * vec4(corner, 1.0);
+        // Crossing the near plane, the box can't be tested on screen
+        if(clip.w <= 0.0 || clip.z < -clip.w) return true;
+
+        vec3 ndc = clip.xyz / clip.w;
+        uvMin = min(uvMin, ndc.xy * 0.5 + 0.5);
+        uvMax = max(uvMax, ndc.xy * 0.5 + 0.5);
+        nearest = min(nearest, ndc.z * 0.5 + 0.5);
+    }
+
+    // The frustum test let it through, so the rectangle overlaps the screen
+    ivec2 p0 = clamp(ivec2(floor(clamp(uvMin, 0.0, 1.0) * vec2(hiZSize))), ivec2(0), hiZSize - 1);
+    ivec2 p1 = clamp(ivec2(floor(clamp(uvMax, 0.0, 1.0) * vec2(hiZSize))), ivec2(0), hiZSize - 1);
+
+    // The level where the rectangle spans at most 2x2 texels
+    int extent = max(p1.x - p0.x, p1.y - p0.y);
+    int level = extent <= 1 ? 0 : int(ceil(log2(float(extent))));
+    level = min(level, hiZLevels - 1);
+
+    // Odd sizes fold their last row and column into the last texel, clamping lands there
+    ivec2 levelMax = max(hiZSize >> level, ivec2(1)) - 1;
+    ivec2 t0 = min(p0 >> level, levelMax);
+    ivec2 t1 = min(p1 >> level, levelMax);
+    float farthest = max(max(texelFetch(hiZ, t0, level).r, texelFetch(hiZ, ivec2(t1.x, t0.y), level).r),
+                         max(texelFetch(hiZ, ivec2(t0.x, t1.y), level).r, texelFetch(hiZ, t1, level).r));
+    return nearest <= farthest;
+}
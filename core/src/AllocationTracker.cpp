@@ -0,0 +1,294 @@
+#include <AllocationTracker.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+namespace core
+{
+    namespace
+    {
+        // Cumulative counters, relaxed atomics as each thread mostly touches its own slot
+        struct alignas(64) Counters
+        {
+            std::atomic<std::uint64_t> allocations{ 0 };
+            std::atomic<std::uint64_t> frees{ 0 };
+            std::atomic<std::uint64_t> bytes{ 0 };
+        };
+
+        struct TagSlot
+        {
+            std::atomic<const char*> tag{ nullptr };
+            Counters counters;
+        };
+
+        Counters s_Threads[AllocationFrameStats::MaxThreads];
+        std::atomic<std::size_t> s_ThreadCount{ 0 };
+        TagSlot s_Tags[AllocationFrameStats::MaxTags];
+        std::atomic<std::uint64_t> s_Violations{ 0 };
+
+#if defined(NDEBUG)
+        std::atomic<bool> s_FailOnViolation{ false };
+#else
+        std::atomic<bool> s_FailOnViolation{ true };
+#endif
+
+        // Plain pointers and ints, so touching them from operator new never allocates
+        thread_local Counters* t_Counters = nullptr;
+        thread_local const char* t_Tag = nullptr;
+        thread_local const char* t_NoAllocRegion = nullptr;
+
+        // Last frame's snapshot and the cumulative values it was taken against
+        AllocationFrameStats s_FrameStats;
+        AllocationCounts s_LastThreads[AllocationFrameStats::MaxThreads];
+        AllocationCounts s_LastTags[AllocationFrameStats::MaxTags];
+        std::uint64_t s_LastViolations = 0;
+
+        AllocationCounts load(const Counters& counters)
+        {
+            return { counters.allocations.load(std::memory_order_relaxed), counters.frees.load(std::memory_order_relaxed),
+                     counters.bytes.load(std::memory_order_relaxed) };
+        }
+
+        AllocationCounts difference(const AllocationCounts& now, const AllocationCounts& before)
+        {
+            return { now.allocations - before.allocations, now.frees - before.frees, now.bytes - before.bytes };
+        }
+
+        [[maybe_unused]] Counters& threadCounters()
+        {
+            if(t_Counters == nullptr)
+            {
+                // Threads past the limit share the last slot, the totals stay right
+                const std::size_t index = s_ThreadCount.fetch_add(1, std::memory_order_relaxed);
+                t_Counters = &s_Threads[index < AllocationFrameStats::MaxThreads ? index : AllocationFrameStats::MaxThreads - 1];
+            }
+            return *t_Counters;
+        }
+
+        [[maybe_unused]] Counters& tagCounters()
+        {
+            // Slot 0 is the untagged bucket, tags are string literals so pointers identify them
+            if(t_Tag == nullptr) return s_Tags[0].counters;
+            for(std::size_t i = 1; i < AllocationFrameStats::MaxTags; i++)
+            {
+                const char* current = s_Tags[i].tag.load(std::memory_order_acquire);
+                if(current == t_Tag) return s_Tags[i].counters;
+                if(current == nullptr)
+                {
+                    if(s_Tags[i].tag.compare_exchange_strong(current, t_Tag, std::memory_order_acq_rel) || current == t_Tag)
+                        return s_Tags[i].counters;
+                }
+            }
+            return s_Tags[AllocationFrameStats::MaxTags - 1].counters;
+        }
+
+        [[maybe_unused]] void recordAllocation(const std::size_t bytes)
+        {
+            Counters& thread = threadCounters();
+            thread.allocations.fetch_add(1, std::memory_order_relaxed);
+            thread.bytes.fetch_add(bytes, std::memory_order_relaxed);
+            Counters& tag = tagCounters();
+            tag.allocations.fetch_add(1, std::memory_order_relaxed);
+            tag.bytes.fetch_add(bytes, std::memory_order_relaxed);
+
+            if(t_NoAllocRegion != nullptr)
+            {
+                s_Violations.fetch_add(1, std::memory_order_relaxed);
+                if(s_FailOnViolation.load(std::memory_order_relaxed))
+                {
+                    // stdio on stderr is unbuffered and doesn't allocate, std::cerr might
+                    std::fprintf(stderr, "[AllocationTracker] Error: %zu byte allocation inside no-alloc region '%s' (tag '%s')\n",
+                                 bytes, t_NoAllocRegion, t_Tag != nullptr ? t_Tag : "untagged");
+                    std::abort();
+                }
+            }
+        }
+
+        [[maybe_unused]] void recordFree()
+        {
+            threadCounters().frees.fetch_add(1, std::memory_order_relaxed);
+            tagCounters().frees.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    bool AllocationTracker::isEnabled()
+    {
+#if defined(CORE_TRACK_ALLOCATIONS)
+        return true;
+#else
+        return false;
+#endif
+    }
+
+    void AllocationTracker::nextFrame()
+    {
+        if(!isEnabled()) return;
+
+        AllocationFrameStats& stats = s_FrameStats;
+        stats.total = {};
+        stats.threadCount = std::min(s_ThreadCount.load(std::memory_order_relaxed), AllocationFrameStats::MaxThreads);
+        for(std::size_t i = 0; i < stats.threadCount; i++)
+        {
+            const AllocationCounts now = load(s_Threads[i]);
+            stats.threads[i] = difference(now, s_LastThreads[i]);
+            s_LastThreads[i] = now;
+            stats.total.allocations += stats.threads[i].allocations;
+            stats.total.frees += stats.threads[i].frees;
+            stats.total.bytes += stats.threads[i].bytes;
+        }
+
+        stats.tagCount = 0;
+        for(std::size_t i = 0; i < AllocationFrameStats::MaxTags; i++)
+        {
+            const char* tag = i == 0 ? "untagged" : s_Tags[i].tag.load(std::memory_order_acquire);
+            if(tag == nullptr) break;
+            const AllocationCounts now = load(s_Tags[i].counters);
+            stats.tags[stats.tagCount++] = { tag, difference(now, s_LastTags[i]) };
+            s_LastTags[i] = now;
+        }
+
+        const std::uint64_t violations = s_Violations.load(std::memory_order_relaxed);
+        stats.noAllocViolations = violations - s_LastViolations;
+        s_LastViolations = violations;
+    }
+
+    const AllocationFrameStats& AllocationTracker::getFrameStats() { return s_FrameStats; }
+
+    AllocationCounts AllocationTracker::getLifetimeCounts()
+    {
+        AllocationCounts total;
+        const std::size_t threads = std::min(s_ThreadCount.load(std::memory_order_relaxed), AllocationFrameStats::MaxThreads);
+        for(std::size_t i = 0; i < threads; i++)
+        {
+            const AllocationCounts counts = load(s_Threads[i]);
+            total.allocations += counts.allocations;
+            total.frees += counts.frees;
+            total.bytes += counts.bytes;
+        }
+        return total;
+    }
+
+    void AllocationTracker::setFailOnViolation(const bool fail) { s_FailOnViolation.store(fail); }
+    bool AllocationTracker::getFailOnViolation() { return s_FailOnViolation.load(); }
+
+    AllocationTag::AllocationTag(const char* tag)
+        : m_Previous(t_Tag)
+    {
+        t_Tag = tag;
+    }
+
+    AllocationTag::~AllocationTag() { t_Tag = m_Previous; }
+
+    NoAllocScope::NoAllocScope(const char* name)
+        : m_Previous(t_NoAllocRegion)
+    {
+        t_NoAllocRegion = name;
+    }
+
+    NoAllocScope::~NoAllocScope() { t_NoAllocRegion = m_Previous; }
+}
+
+#if defined(CORE_TRACK_ALLOCATIONS)
+/* Replacement global allocation functions. They live in this translation unit so they are
+ * linked in together with the tracker the FPS overlay and Window call into. */
+namespace
+{
+    void* trackedAllocate(std::size_t size, const std::size_t alignment)
+    {
+        if(size == 0) size = 1;
+        void* pointer = nullptr;
+        if(alignment <= __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+            pointer = std::malloc(size);
+        else
+        {
+#if defined(_WIN32)
+            pointer = _aligned_malloc(size, alignment);
+#else
+            // aligned_alloc wants a size that is a multiple of the alignment
+            pointer = std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+        }
+        if(pointer != nullptr) core::recordAllocation(size);
+        return pointer;
+    }
+
+    void trackedFree(void* pointer, const std::size_t alignment)
+    {
+        if(pointer == nullptr) return;
+        core::recordFree();
+#if defined(_WIN32)
+        if(alignment > __STDCPP_DEFAULT_NEW_ALIGNMENT__)
+        {
+            _aligned_free(pointer);
+            return;
+        }
+#else
+        static_cast<void>( alignment );
+#endif
+        std::free(pointer);
+    }
+
+    void* trackedNew(const std::size_t size, const std::size_t alignment)
+    {
+        void* pointer = trackedAllocate(size, alignment);
+        if(pointer == nullptr) throw std::bad_alloc();
+        return pointer;
+    }
+}
+
+void* operator new(const std::size_t size) { return trackedNew(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new[](const std::size_t size) { return trackedNew(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void* operator new(const std::size_t size, const std::align_val_t alignment) { return trackedNew(size, static_cast<std::size_t>( alignment )); }
+void* operator new[](const std::size_t size, const std::align_val_t alignment) { return trackedNew(size, static_cast<std::size_t>( alignment )); }
+
+void* operator new(const std::size_t size, const std::nothrow_t&) noexcept
+{
+    return trackedAllocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new[](const std::size_t size, const std::nothrow_t&) noexcept
+{
+    return trackedAllocate(size, __STDCPP_DEFAULT_NEW_ALIGNMENT__);
+}
+
+void* operator new(const std::size_t size, const std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return trackedAllocate(size, static_cast<std::size_t>( alignment ));
+}
+
+void* operator new[](const std::size_t size, const std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    return trackedAllocate(size, static_cast<std::size_t>( alignment ));
+}
+
+void operator delete(void* pointer) noexcept { trackedFree(pointer, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void operator delete[](void* pointer) noexcept { trackedFree(pointer, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void operator delete(void* pointer, std::size_t) noexcept { trackedFree(pointer, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void operator delete[](void* pointer, std::size_t) noexcept { trackedFree(pointer, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void operator delete(void* pointer, const std::nothrow_t&) noexcept { trackedFree(pointer, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept { trackedFree(pointer, __STDCPP_DEFAULT_NEW_ALIGNMENT__); }
+void operator delete(void* pointer, const std::align_val_t alignment) noexcept { trackedFree(pointer, static_cast<std::size_t>( alignment )); }
+void operator delete[](void* pointer, const std::align_val_t alignment) noexcept { trackedFree(pointer, static_cast<std::size_t>( alignment )); }
+
+void operator delete(void* pointer, std::size_t, const std::align_val_t alignment) noexcept
+{
+    trackedFree(pointer, static_cast<std::size_t>( alignment ));
+}
+
+void operator delete[](void* pointer, std::size_t, const std::align_val_t alignment) noexcept
+{
+    trackedFree(pointer, static_cast<std::size_t>( alignment ));
+}
+
+void operator delete(void* pointer, const std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    trackedFree(pointer, static_cast<std::size_t>( alignment ));
+}
+
+void operator delete[](void* pointer, const std::align_val_t alignment, const std::nothrow_t&) noexcept
+{
+    trackedFree(pointer, static_cast<std::size_t>( alignment ));
+}
+#endif
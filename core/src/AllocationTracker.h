@@ -0,0 +1,93 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace core
+{
+    struct AllocationCounts
+    {
+        std::uint64_t allocations = 0;
+        std::uint64_t frees = 0;
+        std::uint64_t bytes = 0;// requested by the allocations, frees aren't sized
+    };
+
+    struct AllocationSiteStats
+    {
+        const char* tag = nullptr;
+        AllocationCounts counts;
+    };
+
+    /* One frame of heap traffic. Threads are numbered in the order they first allocated, so
+     * thread 0 is normally the main thread. Everything lives in fixed arrays because taking
+     * a snapshot must not allocate itself. */
+    struct AllocationFrameStats
+    {
+        static constexpr std::size_t MaxThreads = 64;
+        static constexpr std::size_t MaxTags = 32;
+
+        AllocationCounts total;
+        std::array<AllocationCounts, MaxThreads> threads{};
+        std::size_t threadCount = 0;
+        std::array<AllocationSiteStats, MaxTags> tags{};// tags[0] collects untagged allocations
+        std::size_t tagCount = 0;
+        std::uint64_t noAllocViolations = 0;
+    };
+
+    /* Counts every operator new / delete in the process when core is built with
+     * TRACK_ALLOCATIONS (CORE_TRACK_ALLOCATIONS), per frame, per thread and per call-site tag.
+     * Without it the hooks aren't compiled in, isEnabled() is false and the scopes below cost
+     * a thread_local write. Window::swapBuffers() closes each frame. */
+    class AllocationTracker
+    {
+    public:
+        [[nodiscard]] static bool isEnabled();
+
+        // Snapshots the counters into getFrameStats() and starts the next frame
+        static void nextFrame();
+
+        [[nodiscard]] static const AllocationFrameStats& getFrameStats();
+
+        // Totals since the process started
+        [[nodiscard]] static AllocationCounts getLifetimeCounts();
+
+        /* When set, an allocation inside a NoAllocScope prints what and where, then aborts.
+         * Otherwise it is only counted. On by default in debug builds. */
+        static void setFailOnViolation(bool fail);
+
+        [[nodiscard]] static bool getFailOnViolation();
+    };
+
+    // Attributes allocations made by this thread to a tag until the scope ends, tags nest
+    class AllocationTag
+    {
+    private:
+        const char* m_Previous;
+
+    public:
+        // tag has to outlive the program, use a string literal
+        explicit AllocationTag(const char* tag);
+
+        AllocationTag(const AllocationTag&) = delete;
+
+        AllocationTag& operator=(const AllocationTag&) = delete;
+
+        ~AllocationTag();
+    };
+
+    // Marks code that must not touch the heap in steady state, e.g. the body of a frame
+    class NoAllocScope
+    {
+    private:
+        const char* m_Previous;
+
+    public:
+        explicit NoAllocScope(const char* name);
+
+        NoAllocScope(const NoAllocScope&) = delete;
+
+        NoAllocScope& operator=(const NoAllocScope&) = delete;
+
+        ~NoAllocScope();
+    };
+}
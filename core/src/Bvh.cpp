@@ -0,0 +1,280 @@
+#include <Bvh.h>
+#include <algorithm>
+#include <array>
+#include <limits>
+
+namespace core
+{
+    namespace
+    {
+        struct Bin
+        {
+            Aabb bounds;
+            std::uint32_t count = 0;
+        };
+
+        // Top bit of a stack entry marks subtrees already known to be fully inside the query
+        constexpr std::uint32_t InsideFlag = 0x80000000u;
+
+        // Reused between queries so a steady stream of them doesn't allocate
+        thread_local std::vector<std::uint32_t> t_Stack;
+    }
+
+    Bvh::Bvh(const std::span<const Aabb> bounds, const BvhOptions& options)
+    {
+        build(bounds, options);
+    }
+
+    void Bvh::build(const std::span<const Aabb> bounds, const BvhOptions& options)
+    {
+        m_Options = options;
+        m_Options.maxLeafSize = std::max(1u, m_Options.maxLeafSize);
+        m_Options.binCount = std::clamp(m_Options.binCount, 2u, 64u);
+
+        m_Nodes.clear();
+        m_Indices.clear();
+        m_Bounds.clear();
+        if(bounds.empty()) return;
+
+        // Objects are partitioned in place with their boxes and centres, so every pass reads memory in order
+        std::vector<BuildItem> items(bounds.size());
+        Aabb total;
+        for(std::size_t i = 0; i < bounds.size(); i++)
+        {
+            items[i] = { bounds[i], bounds[i].getCenter(), static_cast<std::uint32_t>( i ) };
+            total.grow(bounds[i]);
+        }
+
+        // A binary tree with at least one object per leaf never needs more than 2n - 1 nodes
+        m_Nodes.reserve(bounds.size() * 2);
+        m_Nodes.push_back({ total.min, 0, total.max, static_cast<std::uint32_t>( bounds.size() ) });
+
+        std::vector<std::uint32_t> pending = { 0 };
+        while(!pending.empty())
+        {
+            const std::uint32_t node = pending.back();
+            pending.pop_back();
+            if(split(node, items))
+            {
+                pending.push_back(m_Nodes[node].leftOrFirst);
+                pending.push_back(m_Nodes[node].leftOrFirst + 1);
+            }
+        }
+
+        m_Indices.resize(items.size());
+        m_Bounds.resize(items.size());
+        for(std::size_t i = 0; i < items.size(); i++)
+        {
+            m_Indices[i] = items[i].index;
+            m_Bounds[i] = items[i].bounds;
+        }
+    }
+
+    bool Bvh::split(const std::uint32_t node, std::vector<BuildItem>& items)
+    {
+        const std::uint32_t first = m_Nodes[node].leftOrFirst;
+        const std::uint32_t count = m_Nodes[node].count;
+        if(count <= m_Options.maxLeafSize) return false;
+
+        Aabb centroids;
+        for(std::uint32_t i = first; i < first + count; i++)
+            centroids.grow(items[i].center);
+
+        // Sweeps the bins from both sides and keeps the split with the lowest SAH cost
+        const std::uint32_t binCount = m_Options.binCount;
+        std::array<Bin, 64> bins;
+        std::array<float, 64> rightCost{};
+        int bestAxis = -1;
+        std::uint32_t bestSplit = 0;
+        float bestCost = std::numeric_limits<float>::max();
+        Aabb bestLeft, bestRight;
+
+        for(int axis = 0; axis < 3; axis++)
+        {
+            const float extent = centroids.max[axis] - centroids.min[axis];
+            if(extent <= 0.0f) continue;
+
+            std::fill(bins.begin(), bins.begin() + binCount, Bin{});
+            const float scale = static_cast<float>( binCount ) / extent;
+            for(std::uint32_t i = first; i < first + count; i++)
+            {
+                const auto bin = std::min(binCount - 1, static_cast<std::uint32_t>( (items[i].center[axis] - centroids.min[axis]) * scale ));
+                bins[bin].bounds.grow(items[i].bounds);
+                bins[bin].count++;
+            }
+
+            Aabb right;
+            std::uint32_t rightCount = 0;
+            for(std::uint32_t bin = binCount - 1; bin > 0; bin--)
+            {
+                right.grow(bins[bin].bounds);
+                rightCount += bins[bin].count;
+                rightCost[bin] = rightCount == 0 ? -1.0f : right.getHalfArea() * static_cast<float>( rightCount );
+            }
+
+            Aabb left;
+            std::uint32_t leftCount = 0;
+            for(std::uint32_t bin = 0; bin + 1 < binCount; bin++)
+            {
+                left.grow(bins[bin].bounds);
+                leftCount += bins[bin].count;
+                // Split between bin and bin + 1, both halves must get something
+                if(leftCount == 0 || rightCost[bin + 1] < 0.0f) continue;
+                const float cost = left.getHalfArea() * static_cast<float>( leftCount ) + rightCost[bin + 1];
+                if(cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestAxis = axis;
+                    bestSplit = bin;
+                    bestLeft = left;
+                }
+            }
+        }
+
+        // Every centre in the same spot, nothing to split on
+        if(bestAxis < 0) return false;
+
+        const float scale = static_cast<float>( binCount ) / (centroids.max[bestAxis] - centroids.min[bestAxis]);
+        const auto middle = std::partition(items.begin() + first, items.begin() + first + count, [&](const BuildItem& item)
+        {
+            const auto bin = std::min(binCount - 1, static_cast<std::uint32_t>( (item.center[bestAxis] - centroids.min[bestAxis]) * scale ));
+            return bin <= bestSplit;
+        });
+        const auto leftCount = static_cast<std::uint32_t>( middle - (items.begin() + first) );
+        for(std::uint32_t i = first + leftCount; i < first + count; i++)
+            bestRight.grow(items[i].bounds);
+
+        const auto left = static_cast<std::uint32_t>( m_Nodes.size() );
+        m_Nodes.push_back({ bestLeft.min, first, bestLeft.max, leftCount });
+        m_Nodes.push_back({ bestRight.min, first + leftCount, bestRight.max, count - leftCount });
+        m_Nodes[node].leftOrFirst = left;
+        m_Nodes[node].count = 0;
+        return true;
+    }
+
+    void Bvh::refit(const std::span<const Aabb> bounds)
+    {
+        for(std::size_t i = 0; i < m_Indices.size(); i++)
+            m_Bounds[i] = bounds[m_Indices[i]];
+
+        // Children always come after their parent, so walking backwards sees them first
+        for(std::size_t i = m_Nodes.size(); i-- > 0;)
+        {
+            BvhNode& node = m_Nodes[i];
+            Aabb box;
+            if(node.isLeaf())
+            {
+                for(std::uint32_t object = node.leftOrFirst; object < node.leftOrFirst + node.count; object++)
+                    box.grow(m_Bounds[object]);
+            }
+            else
+            {
+                box = m_Nodes[node.leftOrFirst].getBounds();
+                box.grow(m_Nodes[node.leftOrFirst + 1].getBounds());
+            }
+            node.min = box.min;
+            node.max = box.max;
+        }
+    }
+
+    template <typename NodeTest, typename ObjectTest>
+    void Bvh::query(const NodeTest& nodeTest, const ObjectTest& objectTest, std::vector<std::uint32_t>& out) const
+    {
+        out.clear();
+        if(m_Nodes.empty()) return;
+
+        std::vector<std::uint32_t>& stack = t_Stack;
+        stack.clear();
+        stack.push_back(0);
+        while(!stack.empty())
+        {
+            const std::uint32_t entry = stack.back();
+            stack.pop_back();
+            const BvhNode& node = m_Nodes[entry & ~InsideFlag];
+
+            Containment containment = Containment::Inside;
+            if(!(entry & InsideFlag))
+            {
+                containment = nodeTest(node.getBounds());
+                if(containment == Containment::Outside) continue;
+            }
+
+            if(node.isLeaf())
+            {
+                for(std::uint32_t i = node.leftOrFirst; i < node.leftOrFirst + node.count; i++)
+                {
+                    if(containment == Containment::Inside || objectTest(m_Bounds[i])) out.push_back(m_Indices[i]);
+                }
+                continue;
+            }
+
+            const std::uint32_t flag = containment == Containment::Inside ? InsideFlag : 0;
+            stack.push_back((node.leftOrFirst + 1) | flag);
+            stack.push_back(node.leftOrFirst | flag);
+        }
+    }
+
+    void Bvh::queryFrustum(const Frustum& frustum, std::vector<std::uint32_t>& out) const
+    {
+        query([&frustum](const Aabb& box) { return frustum.classify(box); },
+              [&frustum](const Aabb& box) { return frustum.intersects(box); }, out);
+    }
+
+    void Bvh::querySphere(const Sphere& sphere, std::vector<std::uint32_t>& out) const
+    {
+        query([&sphere](const Aabb& box)
+              {
+                  return intersects(box, sphere) ? Containment::Intersects : Containment::Outside;
+              },
+              [&sphere](const Aabb& box) { return intersects(box, sphere); }, out);
+    }
+
+    void Bvh::queryAabb(const Aabb& box, std::vector<std::uint32_t>& out) const
+    {
+        query([&box](const Aabb& node)
+              {
+                  if(!intersects(node, box)) return Containment::Outside;
+                  return box.contains(node) ? Containment::Inside : Containment::Intersects;
+              },
+              [&box](const Aabb& object) { return intersects(object, box); }, out);
+    }
+
+    void Bvh::queryRay(const Ray& ray, std::vector<std::uint32_t>& out) const
+    {
+        out.clear();
+        const glm::vec3 inverseDirection = 1.0f / ray.direction;
+        if(m_Nodes.empty() || intersectRay(m_Nodes[0].getBounds(), ray, inverseDirection) < 0.0f) return;
+
+        std::vector<std::uint32_t>& stack = t_Stack;
+        stack.clear();
+        stack.push_back(0);
+        while(!stack.empty())
+        {
+            const BvhNode& node = m_Nodes[stack.back()];
+            stack.pop_back();
+            if(node.isLeaf())
+            {
+                for(std::uint32_t i = node.leftOrFirst; i < node.leftOrFirst + node.count; i++)
+                {
+                    if(intersectRay(m_Bounds[i], ray, inverseDirection) >= 0.0f) out.push_back(m_Indices[i]);
+                }
+                continue;
+            }
+
+            // Children are tested before they are pushed, the nearer one goes on top
+            const std::uint32_t left = node.leftOrFirst;
+            const float leftDistance = intersectRay(m_Nodes[left].getBounds(), ray, inverseDirection);
+            const float rightDistance = intersectRay(m_Nodes[left + 1].getBounds(), ray, inverseDirection);
+            if(leftDistance >= 0.0f && rightDistance >= 0.0f)
+            {
+                const bool leftFirst = leftDistance <= rightDistance;
+                stack.push_back(leftFirst ? left + 1 : left);
+                stack.push_back(leftFirst ? left : left + 1);
+            }
+            else if(leftDistance >= 0.0f)
+                stack.push_back(left);
+            else if(rightDistance >= 0.0f)
+                stack.push_back(left + 1);
+        }
+    }
+}
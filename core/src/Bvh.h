@@ -0,0 +1,84 @@
+#pragma once
+#include <Geometry.h>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace core
+{
+    // 32 bytes, two nodes per cache line
+    struct alignas(32) BvhNode
+    {
+        glm::vec3 min;
+        std::uint32_t leftOrFirst;// interior: left child, the right one follows it. leaf: first entry in the index list
+        glm::vec3 max;
+        std::uint32_t count;      // objects in a leaf, 0 for interior nodes
+
+        [[nodiscard]] bool isLeaf() const { return count != 0; }
+
+        [[nodiscard]] Aabb getBounds() const { return { min, max }; }
+    };
+
+    static_assert(sizeof(BvhNode) == 32, "BvhNode should stay 32 bytes");
+
+    struct BvhOptions
+    {
+        std::uint32_t maxLeafSize = 4;
+        // Centroid bins per axis the SAH evaluates splits between
+        std::uint32_t binCount = 16;
+    };
+
+    /* Bounding volume hierarchy over a fixed set of boxes, for static geometry. Built top-down
+     * with binned SAH into one flat array, parents before children and siblings next to each
+     * other. Objects that move a little can refit() the same tree, once they have wandered
+     * far the tree gets loose and a rebuild is due. Queries write the indices (into the span
+     * the tree was built from) of the boxes they hit into out, which is cleared first so
+     * callers can reuse one vector. Queries are const and can run on several threads at once. */
+    class Bvh
+    {
+    private:
+        std::vector<BvhNode> m_Nodes;
+        std::vector<std::uint32_t> m_Indices;// leaves point at runs of this
+        std::vector<Aabb> m_Bounds;          // object boxes in m_Indices order, so leaves read them sequentially
+        BvhOptions m_Options;
+
+        struct BuildItem
+        {
+            Aabb bounds;
+            glm::vec3 center;
+            std::uint32_t index;
+        };
+
+        // Splits a node with more than maxLeafSize objects at the cheapest SAH bin boundary, false keeps it a leaf
+        bool split(std::uint32_t node, std::vector<BuildItem>& items);
+
+        template <typename NodeTest, typename ObjectTest>
+        void query(const NodeTest& nodeTest, const ObjectTest& objectTest, std::vector<std::uint32_t>& out) const;
+
+    public:
+        Bvh() = default;
+
+        explicit Bvh(std::span<const Aabb> bounds, const BvhOptions& options = {});
+
+        void build(std::span<const Aabb> bounds, const BvhOptions& options = {});
+
+        // Recomputes every node's box bottom-up from bounds, same objects in the same order as the build
+        void refit(std::span<const Aabb> bounds);
+
+        void queryFrustum(const Frustum& frustum, std::vector<std::uint32_t>& out) const;
+
+        void querySphere(const Sphere& sphere, std::vector<std::uint32_t>& out) const;
+
+        void queryAabb(const Aabb& box, std::vector<std::uint32_t>& out) const;
+
+        // Every box the ray passes through, nearer subtrees visited first
+        void queryRay(const Ray& ray, std::vector<std::uint32_t>& out) const;
+
+        [[nodiscard]] const std::vector<BvhNode>& getNodes() const { return m_Nodes; }
+
+        [[nodiscard]] std::size_t getObjectCount() const { return m_Indices.size(); }
+
+        [[nodiscard]] Aabb getBounds() const { return m_Nodes.empty() ? Aabb{} : m_Nodes[0].getBounds(); }
+    };
+}
@@ -0,0 +1,169 @@
+#include <ClusterCuller.h>
+#include <Geometry.h>
+#include <GpuBuffers.h>
+#include <algorithm>
+#include <iostream>
+#include <vector>
+
+namespace core
+{
+    using detail::clearBuffer;
+    using detail::createBuffer;
+    using detail::deleteBuffer;
+
+    namespace
+    {
+        constexpr std::uint32_t GroupSize = 64;// matches local_size_x in cluster.comp
+
+        // Shader storage bindings, the same numbers as in cluster.comp
+        enum Binding : GLuint { Instances = 0, Meshlets = 1, Commands = 2, Counters = 3, Visibility = 4, Clusters = 5 };
+    }
+
+    ClusterCuller::ClusterCuller(const char* shaderPath)
+        : m_Shader(GL_COMPUTE_SHADER, shaderPath)
+    {
+        m_CounterBuffer = createBuffer(CounterCount * sizeof(std::uint32_t));
+        clearBuffer(m_CounterBuffer, 0, CounterCount * sizeof(std::uint32_t));
+        for(unsigned int& buffer : m_StatsBuffers)
+        {
+            buffer = createBuffer(CounterCount * sizeof(std::uint32_t));
+            clearBuffer(buffer, 0, CounterCount * sizeof(std::uint32_t));
+        }
+    }
+
+    ClusterCuller::~ClusterCuller()
+    {
+        for(unsigned int* buffer : { &m_MeshletBuffer, &m_InstanceBuffer, &m_ClusterBuffer, &m_CommandBuffer, &m_CounterBuffer, &m_VisibilityBuffer })
+            deleteBuffer(*buffer);
+        glDeleteBuffers(static_cast<GLsizei>( m_StatsBuffers.size() ), m_StatsBuffers.data());
+    }
+
+    void ClusterCuller::setMeshlets(const std::span<const Meshlet> meshlets)
+    {
+        deleteBuffer(m_MeshletBuffer);
+        m_MeshletBuffer = createBuffer(meshlets.size_bytes(), meshlets.data());
+        m_MeshletCount = meshlets.size();
+    }
+
+    void ClusterCuller::setInstances(const std::span<const GpuClusterInstance> instances)
+    {
+        std::vector<glm::uvec2> clusters;
+        for(std::size_t i = 0; i < instances.size(); i++)
+        {
+            const GpuClusterInstance& instance = instances[i];
+            if(static_cast<std::size_t>( instance.firstMeshlet ) + instance.meshletCount > m_MeshletCount)
+            {
+                std::cerr << "[ClusterCuller] Warning: Instance " << i << " uses meshlets past the " << m_MeshletCount << " set, skipping it" << '\n';
+                continue;
+            }
+            for(std::uint32_t meshlet = 0; meshlet < instance.meshletCount; meshlet++)
+                clusters.emplace_back(static_cast<std::uint32_t>( i ), instance.firstMeshlet + meshlet);
+        }
+
+        for(unsigned int* buffer : { &m_InstanceBuffer, &m_ClusterBuffer, &m_CommandBuffer, &m_VisibilityBuffer })
+            deleteBuffer(*buffer);
+
+        m_InstanceCount = instances.size();
+        m_ClusterCount = clusters.size();
+        m_InstanceBuffer = createBuffer(instances.size_bytes(), instances.data());
+        m_ClusterBuffer = createBuffer(clusters.size() * sizeof(glm::uvec2), clusters.data());
+        m_CommandBuffer = createBuffer(2 * m_ClusterCount * sizeof(DrawElementsIndirectCommand));
+        // Nothing was visible, the first Late pass finds everything
+        m_VisibilityBuffer = createBuffer(m_ClusterCount * sizeof(std::uint32_t));
+        clearBuffer(m_VisibilityBuffer, 0, std::max<std::size_t>(m_ClusterCount, 1) * sizeof(std::uint32_t));
+    }
+
+    void ClusterCuller::updateInstances(const std::size_t first, const std::span<const GpuClusterInstance> instances)
+    {
+        if(instances.empty() || first + instances.size() > m_InstanceCount) return;
+        glNamedBufferSubData(m_InstanceBuffer, static_cast<GLintptr>( first * sizeof(GpuClusterInstance) ),
+                             static_cast<GLsizeiptr>( instances.size_bytes() ), instances.data());
+    }
+
+    void ClusterCuller::cull(const CullPhase phase, const glm::mat4& viewProjection, const glm::vec3& cameraPos, const HiZPyramid* hiZ,
+                             const bool testCones)
+    {
+        // A frame starts with All or Early, which resets every counter. Late only resets its draw count
+        const std::uint32_t target = region(phase);
+        if(phase == CullPhase::Late)
+            clearBuffer(m_CounterBuffer, target * sizeof(std::uint32_t), sizeof(std::uint32_t));
+        else
+            clearBuffer(m_CounterBuffer, 0, CounterCount * sizeof(std::uint32_t));
+        if(m_ClusterCount == 0) return;
+
+        const Frustum frustum = Frustum::fromMatrix(viewProjection);
+        const bool occlusion = hiZ != nullptr && hiZ->getTexture() != 0 && phase != CullPhase::Early;
+
+        const unsigned int program = m_Shader.getProgramID();
+        glUseProgram(program);
+        m_Shader.setUniform("viewProjection", viewProjection);
+        glProgramUniform4fv(program, m_Shader.getUniformLocation("frustumPlanes"), 6, &frustum.planes[0].x);
+        m_Shader.setUniform("cameraPos", cameraPos);
+        m_Shader.setUniform("clusterCount", static_cast<unsigned int>( m_ClusterCount ));
+        m_Shader.setUniform("phase", static_cast<unsigned int>( phase ));
+        m_Shader.setUniform("commandOffset", static_cast<unsigned int>( target * m_ClusterCount ));
+        m_Shader.setUniform("countSlot", target);
+        m_Shader.setUniform("testCones", testCones);
+        m_Shader.setUniform("testOcclusion", occlusion);
+        if(occlusion)
+        {
+            glBindTextureUnit(0, hiZ->getTexture());
+            m_Shader.setUniform("hiZSize", glm::ivec2(hiZ->getWidth(), hiZ->getHeight()));
+            m_Shader.setUniform("hiZLevels", hiZ->getLevels());
+        }
+
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, Instances, m_InstanceBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, Meshlets, m_MeshletBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, Commands, m_CommandBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, Counters, m_CounterBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, Visibility, m_VisibilityBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, Clusters, m_ClusterBuffer);
+
+        const auto groups = static_cast<GLuint>( (m_ClusterCount + GroupSize - 1) / GroupSize );
+        glDispatchCompute(groups, 1, 1);
+
+        // The commands and counts are read by the indirect draw, the visibility by the next pass
+        glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+        glUseProgram(0);
+    }
+
+    void ClusterCuller::draw(const CullPhase phase, const unsigned int indexType) const
+    {
+        if(m_ClusterCount == 0) return;
+
+        const std::uint32_t source = region(phase);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, Clusters, m_ClusterBuffer);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_CommandBuffer);
+        glBindBuffer(GL_PARAMETER_BUFFER, m_CounterBuffer);
+        glMultiDrawElementsIndirectCount(GL_TRIANGLES, indexType,
+                                         reinterpret_cast<const void *>( source * m_ClusterCount * sizeof(DrawElementsIndirectCommand) ),
+                                         static_cast<GLintptr>( source * sizeof(std::uint32_t) ),
+                                         static_cast<GLsizei>( m_ClusterCount ), sizeof(DrawElementsIndirectCommand));
+        glBindBuffer(GL_PARAMETER_BUFFER, 0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+
+    void ClusterCuller::endFrame()
+    {
+        glCopyNamedBufferSubData(m_CounterBuffer, m_StatsBuffers[m_Frame % StatsFrames], 0, 0, CounterCount * sizeof(std::uint32_t));
+        m_Frame++;
+    }
+
+    ClusterCullStats ClusterCuller::getStats() const
+    {
+        ClusterCullStats stats;
+        stats.clusters = static_cast<std::uint32_t>( m_ClusterCount );
+        if(m_Frame < StatsFrames) return stats;
+
+        // The oldest snapshot, written StatsFrames - 1 frames ago
+        std::array<std::uint32_t, CounterCount> counters{};
+        glGetNamedBufferSubData(m_StatsBuffers[m_Frame % StatsFrames], 0, sizeof(counters), counters.data());
+        stats.earlyDraws = counters[0];
+        stats.lateDraws = counters[1];
+        stats.frustumCulled = counters[2];
+        stats.backfaceCulled = counters[3];
+        stats.occlusionCulled = counters[4];
+        stats.triangles = counters[5];
+        return stats;
+    }
+}
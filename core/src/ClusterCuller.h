@@ -0,0 +1,108 @@
+#pragma once
+#include <glad/gl.h>
+#include <GpuCuller.h>
+#include <HiZPyramid.h>
+#include <Meshlets.h>
+#include <ShaderStage.h>
+#include <glm/glm.hpp>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace core
+{
+    /* One object made of meshlets [firstMeshlet, firstMeshlet + meshletCount), std430 layout.
+     * model may rotate, translate and scale uniformly by scale (cones and spheres stay valid). */
+    struct GpuClusterInstance
+    {
+        glm::mat4 model = glm::mat4(1.0f);
+        std::uint32_t firstMeshlet = 0;
+        std::uint32_t meshletCount = 0;
+        float scale = 1.0f;
+        std::uint32_t padding = 0;
+    };
+
+    static_assert(sizeof(GpuClusterInstance) == 80, "GpuClusterInstance must match the std430 struct in cluster.comp");
+
+    // One frame of cluster culling, every count is in clusters except triangles
+    struct ClusterCullStats
+    {
+        std::uint32_t clusters = 0;      // tested, every meshlet of every instance
+        std::uint32_t earlyDraws = 0;    // All or Early
+        std::uint32_t lateDraws = 0;
+        std::uint32_t frustumCulled = 0;
+        std::uint32_t backfaceCulled = 0;// by the normal cone
+        std::uint32_t occlusionCulled = 0;
+        std::uint32_t triangles = 0;     // in the clusters drawn
+
+        [[nodiscard]] std::uint32_t getCulled() const { return frustumCulled + backfaceCulled + occlusionCulled; }
+    };
+
+    /* The GpuCuller pass at meshlet granularity: a compute pass tests every meshlet of every
+     * instance against the frustum, its normal cone against the camera and its bounds against
+     * a HiZPyramid, and appends one DrawElementsIndirectCommand per surviving meshlet, drawn
+     * with glMultiDrawElementsIndirectCount. Big meshes only pay for the parts on screen and
+     * facing the camera, where object culling has to draw all of them.
+     * Commands carry the cluster's index as baseInstance, and draw() binds the cluster list
+     * (uvec2 instance, meshlet per cluster) at storage binding 5, so the vertex shader finds
+     * its instance and meshlet through gl_BaseInstance. Phases work as in GpuCuller, with
+     * visibility kept per cluster. Every meshlet indexes the bound VAO's index buffer,
+     * Meshlet::firstIndex and baseVertex say where. */
+    class ClusterCuller
+    {
+    private:
+        static constexpr std::size_t StatsFrames = 3;
+        static constexpr std::size_t CounterCount = 6;// draw counts of both regions, then culled per test and triangles
+
+        ShaderStage m_Shader;
+        unsigned int m_MeshletBuffer = 0;
+        unsigned int m_InstanceBuffer = 0;
+        unsigned int m_ClusterBuffer = 0;   // (instance, meshlet) per cluster, what one invocation tests
+        unsigned int m_CommandBuffer = 0;   // two regions of m_ClusterCount commands, All/Early and Late
+        unsigned int m_CounterBuffer = 0;
+        unsigned int m_VisibilityBuffer = 0;// last frame's result per cluster, for Early
+        std::array<unsigned int, StatsFrames> m_StatsBuffers{};
+        std::size_t m_MeshletCount = 0;
+        std::size_t m_InstanceCount = 0;
+        std::size_t m_ClusterCount = 0;
+        std::size_t m_Frame = 0;
+
+        static std::uint32_t region(CullPhase phase) { return phase == CullPhase::Late ? 1 : 0; }
+
+    public:
+        // shaderPath is the culling compute shader, see core/shaders/cluster.comp
+        explicit ClusterCuller(const char* shaderPath);
+
+        ClusterCuller(const ClusterCuller&) = delete;
+
+        ClusterCuller& operator=(const ClusterCuller&) = delete;
+
+        ~ClusterCuller();
+
+        void setMeshlets(std::span<const Meshlet> meshlets);
+
+        // Replaces every instance and rebuilds the cluster list, which forgets last frame's visibility
+        void setInstances(std::span<const GpuClusterInstance> instances);
+
+        // Overwrites instances [first, first + instances.size()), for objects that moved. Their meshlet ranges must not change
+        void updateInstances(std::size_t first, std::span<const GpuClusterInstance> instances);
+
+        // hiZ nullptr skips the occlusion test, Early never reads it. testCones false keeps back facing clusters
+        void cull(CullPhase phase, const glm::mat4& viewProjection, const glm::vec3& cameraPos, const HiZPyramid* hiZ,
+                  bool testCones = true);
+
+        // Draws what the last cull() of this phase kept, with the caller's VAO and program bound. Rebinds storage binding 5
+        void draw(CullPhase phase, unsigned int indexType) const;
+
+        // Snapshots this frame's counters for getStats(), call once after the last draw
+        void endFrame();
+
+        // Counters from a few frames back, so reading them doesn't wait on the GPU
+        [[nodiscard]] ClusterCullStats getStats() const;
+
+        [[nodiscard]] std::size_t getClusterCount() const { return m_ClusterCount; }
+
+        [[nodiscard]] std::size_t getInstanceCount() const { return m_InstanceCount; }
+    };
+}
@@ -0,0 +1,316 @@
+#include <CommandBuffer.h>
+#include <FrameArena.h>
+#include <Mesh.h>
+#include <ProgramPipeline.h>
+#include <Shader.h>
+#include <new>
+
+namespace core
+{
+    namespace
+    {
+        // Every command starts with its type, replay peeks at it and copies the rest out
+        struct ProgramCommand
+        {
+            CommandType type;
+            unsigned int program;
+        };
+
+        struct BindCommand
+        {
+            CommandType type;
+            unsigned int slot;// texture unit or storage binding
+            unsigned int name;
+        };
+
+        template <typename T>
+        struct UniformCommand
+        {
+            CommandType type;
+            int location;
+            T value;
+        };
+
+        struct StateCommand
+        {
+            CommandType type;
+            unsigned int value;// capability, or the depth write flag
+        };
+
+        struct DrawMeshCommand
+        {
+            CommandType type;
+            std::uint32_t lod;
+            const Mesh* mesh;
+        };
+
+        struct DrawElementsCommand
+        {
+            CommandType type;
+            unsigned int mode;
+            std::uint32_t count;
+            unsigned int indexType;
+            std::uint32_t firstIndex;
+            std::uint32_t instanceCount;
+            std::int32_t baseVertex;
+            std::uint32_t baseInstance;
+        };
+
+        template <typename T>
+        T read(const std::byte*& cursor)
+        {
+            T command;
+            std::memcpy(&command, cursor, sizeof(T));
+            cursor += sizeof(T);
+            return command;
+        }
+
+        std::size_t indexSize(const unsigned int indexType)
+        {
+            if(indexType == GL_UNSIGNED_BYTE) return 1;
+            return indexType == GL_UNSIGNED_SHORT ? 2 : 4;
+        }
+    }
+
+    CommandBuffer::CommandBuffer(FrameArena& arena)
+        : m_Arena(&arena) {}
+
+    void CommandBuffer::reset()
+    {
+        m_First = nullptr;
+        m_Last = nullptr;
+        m_CommandCount = 0;
+        m_Bytes = 0;
+    }
+
+    std::byte* CommandBuffer::reserve(const std::size_t size)
+    {
+        if(m_Last == nullptr || m_Last->used + size > PageCapacity)
+        {
+            auto* page = new(m_Arena->allocate(PageSize, alignof(Page))) Page{ nullptr, 0 };
+            if(m_Last != nullptr) m_Last->next = page;
+            else m_First = page;
+            m_Last = page;
+        }
+
+        std::byte* target = reinterpret_cast<std::byte *>( m_Last + 1 ) + m_Last->used;
+        m_Last->used += size;
+        m_Bytes += size;
+        m_CommandCount++;
+        return target;
+    }
+
+    void CommandBuffer::bindProgram(const unsigned int program) { write(ProgramCommand{ CommandType::BindProgram, program }); }
+    void CommandBuffer::useShader(const Shader& shader) { bindProgram(shader.getProgramID()); }
+
+    void CommandBuffer::bindTexture(const unsigned int unit, const unsigned int texture)
+    {
+        write(BindCommand{ CommandType::BindTexture, unit, texture });
+    }
+
+    void CommandBuffer::bindStorageBuffer(const unsigned int binding, const unsigned int buffer)
+    {
+        write(BindCommand{ CommandType::BindStorageBuffer, binding, buffer });
+    }
+
+    void CommandBuffer::setUniform(const int location, const bool value) { setUniform(location, static_cast<int>( value )); }
+    void CommandBuffer::setUniform(const int location, const int value) { write(UniformCommand<int>{ CommandType::UniformInt, location, value }); }
+
+    void CommandBuffer::setUniform(const int location, const unsigned int value)
+    {
+        write(UniformCommand<unsigned int>{ CommandType::UniformUint, location, value });
+    }
+
+    void CommandBuffer::setUniform(const int location, const float value) { write(UniformCommand<float>{ CommandType::UniformFloat, location, value }); }
+
+    void CommandBuffer::setUniform(const int location, const glm::vec2& value)
+    {
+        write(UniformCommand<glm::vec2>{ CommandType::UniformVec2, location, value });
+    }
+
+    void CommandBuffer::setUniform(const int location, const glm::vec3& value)
+    {
+        write(UniformCommand<glm::vec3>{ CommandType::UniformVec3, location, value });
+    }
+
+    void CommandBuffer::setUniform(const int location, const glm::vec4& value)
+    {
+        write(UniformCommand<glm::vec4>{ CommandType::UniformVec4, location, value });
+    }
+
+    void CommandBuffer::setUniform(const int location, const glm::mat4& value)
+    {
+        write(UniformCommand<glm::mat4>{ CommandType::UniformMat4, location, value });
+    }
+
+    void CommandBuffer::enable(const unsigned int capability) { write(StateCommand{ CommandType::Enable, capability }); }
+    void CommandBuffer::disable(const unsigned int capability) { write(StateCommand{ CommandType::Disable, capability }); }
+    void CommandBuffer::depthMask(const bool write) { this->write(StateCommand{ CommandType::DepthMask, write ? 1u : 0u }); }
+
+    void CommandBuffer::drawMesh(const Mesh& mesh, const std::size_t lod)
+    {
+        write(DrawMeshCommand{ CommandType::DrawMesh, static_cast<std::uint32_t>( lod ), &mesh });
+    }
+
+    void CommandBuffer::drawElements(const unsigned int mode, const std::uint32_t count, const unsigned int indexType, const std::uint32_t firstIndex,
+                                     const std::uint32_t instanceCount, const std::int32_t baseVertex, const std::uint32_t baseInstance)
+    {
+        write(DrawElementsCommand{ CommandType::DrawElements, mode, count, indexType, firstIndex, instanceCount, baseVertex, baseInstance });
+    }
+
+    void CommandBuffer::execute(CommandReplayState& state) const
+    {
+        for(const Page* page = m_First; page != nullptr; page = page->next)
+        {
+            const std::byte* cursor = reinterpret_cast<const std::byte *>( page + 1 );
+            const std::byte* end = cursor + page->used;
+            while(cursor < end)
+            {
+                CommandType type;
+                std::memcpy(&type, cursor, sizeof(type));
+                switch(type)
+                {
+                    case CommandType::BindProgram:
+                    {
+                        const auto command = read<ProgramCommand>(cursor);
+                        if(command.program == state.program)
+                        {
+                            state.skipped++;
+                            break;
+                        }
+                        glUseProgram(command.program);
+                        ProgramPipeline::invalidateBinding();
+                        state.program = command.program;
+                        break;
+                    }
+                    case CommandType::BindTexture:
+                    {
+                        const auto command = read<BindCommand>(cursor);
+                        if(command.slot < state.textures.size())
+                        {
+                            if(state.textures[command.slot] == command.name)
+                            {
+                                state.skipped++;
+                                break;
+                            }
+                            state.textures[command.slot] = command.name;
+                        }
+                        glBindTextureUnit(command.slot, command.name);
+                        break;
+                    }
+                    case CommandType::BindStorageBuffer:
+                    {
+                        const auto command = read<BindCommand>(cursor);
+                        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, command.slot, command.name);
+                        break;
+                    }
+                    case CommandType::UniformInt:
+                    {
+                        const auto command = read<UniformCommand<int>>(cursor);
+                        glUniform1i(command.location, command.value);
+                        break;
+                    }
+                    case CommandType::UniformUint:
+                    {
+                        const auto command = read<UniformCommand<unsigned int>>(cursor);
+                        glUniform1ui(command.location, command.value);
+                        break;
+                    }
+                    case CommandType::UniformFloat:
+                    {
+                        const auto command = read<UniformCommand<float>>(cursor);
+                        glUniform1f(command.location, command.value);
+                        break;
+                    }
+                    case CommandType::UniformVec2:
+                    {
+                        const auto command = read<UniformCommand<glm::vec2>>(cursor);
+                        glUniform2fv(command.location, 1, &command.value.x);
+                        break;
+                    }
+                    case CommandType::UniformVec3:
+                    {
+                        const auto command = read<UniformCommand<glm::vec3>>(cursor);
+                        glUniform3fv(command.location, 1, &command.value.x);
+                        break;
+                    }
+                    case CommandType::UniformVec4:
+                    {
+                        const auto command = read<UniformCommand<glm::vec4>>(cursor);
+                        glUniform4fv(command.location, 1, &command.value.x);
+                        break;
+                    }
+                    case CommandType::UniformMat4:
+                    {
+                        const auto command = read<UniformCommand<glm::mat4>>(cursor);
+                        glUniformMatrix4fv(command.location, 1, GL_FALSE, &command.value[0].x);
+                        break;
+                    }
+                    case CommandType::Enable:
+                        glEnable(read<StateCommand>(cursor).value);
+                        break;
+                    case CommandType::Disable:
+                        glDisable(read<StateCommand>(cursor).value);
+                        break;
+                    case CommandType::DepthMask:
+                        glDepthMask(read<StateCommand>(cursor).value != 0 ? GL_TRUE : GL_FALSE);
+                        break;
+                    case CommandType::DrawMesh:
+                    {
+                        const auto command = read<DrawMeshCommand>(cursor);
+                        if(command.mesh != state.mesh)
+                        {
+                            command.mesh->bind();
+                            state.mesh = command.mesh;
+                        }
+                        command.mesh->drawBound(command.lod);
+                        break;
+                    }
+                    case CommandType::DrawElements:
+                    {
+                        const auto command = read<DrawElementsCommand>(cursor);
+                        glDrawElementsInstancedBaseVertexBaseInstance(command.mode, static_cast<GLsizei>( command.count ), command.indexType,
+                                                                      reinterpret_cast<const void *>( command.firstIndex * indexSize(command.indexType) ),
+                                                                      static_cast<GLsizei>( command.instanceCount ), command.baseVertex,
+                                                                      command.baseInstance);
+                        break;
+                    }
+                }
+                state.commands++;
+            }
+        }
+    }
+
+    CommandRecorder::CommandRecorder(FrameArena& arena)
+        : m_Arena(arena) {}
+
+    CommandRecorder::~CommandRecorder() = default;
+
+    void CommandRecorder::reset()
+    {
+        m_Stats = m_Frame;
+        m_Frame = {};
+        for(std::size_t i = 0; i < m_Used; i++)
+            m_Buffers[i].reset();
+        m_Used = 0;
+    }
+
+    void CommandRecorder::execute()
+    {
+        const auto start = std::chrono::steady_clock::now();
+        CommandReplayState state;
+        std::size_t bytes = 0;
+        for(std::size_t i = 0; i < m_Used; i++)
+        {
+            m_Buffers[i].execute(state);
+            bytes += m_Buffers[i].getBytes();
+        }
+        m_Frame.buffers = m_Used;
+        m_Frame.bytes = bytes;
+        m_Frame.commands = state.commands;
+        m_Frame.skipped = state.skipped;
+        m_Frame.replayMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    const CommandStats& CommandRecorder::getStats() const { return m_Stats; }
+}
@@ -0,0 +1,231 @@
+#pragma once
+#include <glad/gl.h>
+#include <JobSystem.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+#include <vector>
+
+namespace core
+{
+    class FrameArena;
+    class Mesh;
+    class Shader;
+
+    enum class CommandType : std::uint32_t
+    {
+        BindProgram,
+        BindTexture,
+        BindStorageBuffer,
+        UniformInt,
+        UniformUint,
+        UniformFloat,
+        UniformVec2,
+        UniformVec3,
+        UniformVec4,
+        UniformMat4,
+        Enable,
+        Disable,
+        DepthMask,
+        DrawMesh,
+        DrawElements
+    };
+
+    // GL state a replay has set, binds that match it are skipped. It carries over between buffers
+    struct CommandReplayState
+    {
+        static constexpr unsigned int Unknown = ~0u;
+        static constexpr std::size_t TextureUnits = 16;
+
+        unsigned int program = Unknown;
+        const Mesh* mesh = nullptr;
+        std::array<unsigned int, TextureUnits> textures = makeUnknown();
+        std::size_t commands = 0;
+        std::size_t skipped = 0;// binds that matched the state
+
+        static std::array<unsigned int, TextureUnits> makeUnknown()
+        {
+            std::array<unsigned int, TextureUnits> textures{};
+            textures.fill(Unknown);
+            return textures;
+        }
+    };
+
+    /* GL calls recorded as compact POD commands, to be replayed later on the context thread.
+     * Recording touches no GL, so any thread can fill a buffer (one thread per buffer).
+     * Commands go into PageSize pages taken from a FrameArena, which hands every thread its
+     * own block: recording takes no lock and allocates nothing on the heap, and the pages
+     * are only valid for the arena's frame, so a buffer is reset, recorded and executed
+     * within one frame. Uniforms go to the program the stream bound last, by location: look
+     * locations up on the GL thread beforehand (Shader::getUniformLocation). */
+    class CommandBuffer
+    {
+    public:
+        static constexpr std::size_t PageSize = 16 * 1024;
+
+    private:
+        struct Page
+        {
+            Page* next;
+            std::size_t used;
+        };
+
+        static constexpr std::size_t PageCapacity = PageSize - sizeof(Page);
+
+        FrameArena* m_Arena;
+        Page* m_First = nullptr;
+        Page* m_Last = nullptr;
+        std::size_t m_CommandCount = 0;
+        std::size_t m_Bytes = 0;
+
+        std::byte* reserve(std::size_t size);
+
+        template <typename T>
+        void write(const T& command)
+        {
+            static_assert(std::is_trivially_copyable_v<T> && sizeof(T) <= PageCapacity, "Commands are small PODs");
+            std::memcpy(reserve(sizeof(T)), &command, sizeof(T));
+        }
+
+    public:
+        explicit CommandBuffer(FrameArena& arena);
+
+        CommandBuffer(const CommandBuffer&) = delete;
+
+        CommandBuffer& operator=(const CommandBuffer&) = delete;
+
+        CommandBuffer(CommandBuffer&& other) noexcept = default;
+
+        CommandBuffer& operator=(CommandBuffer&& other) noexcept = default;
+
+        ~CommandBuffer() = default;
+
+        // Forgets every command, the pages go back to the arena with its frame
+        void reset();
+
+        void bindProgram(unsigned int program);
+
+        void useShader(const Shader& shader);
+
+        void bindTexture(unsigned int unit, unsigned int texture);
+
+        void bindStorageBuffer(unsigned int binding, unsigned int buffer);
+
+        void setUniform(int location, bool value);
+
+        void setUniform(int location, int value);
+
+        void setUniform(int location, unsigned int value);
+
+        void setUniform(int location, float value);
+
+        void setUniform(int location, const glm::vec2& value);
+
+        void setUniform(int location, const glm::vec3& value);
+
+        void setUniform(int location, const glm::vec4& value);
+
+        void setUniform(int location, const glm::mat4& value);
+
+        void enable(unsigned int capability);
+
+        void disable(unsigned int capability);
+
+        void depthMask(bool write);
+
+        // Binds mesh unless the replay already has it bound, then draws one level of detail
+        void drawMesh(const Mesh& mesh, std::size_t lod = 0);
+
+        // With the caller's VAO bound, firstIndex counts indices not bytes
+        void drawElements(unsigned int mode, std::uint32_t count, unsigned int indexType, std::uint32_t firstIndex,
+                          std::uint32_t instanceCount = 1, std::int32_t baseVertex = 0, std::uint32_t baseInstance = 0);
+
+        // GL thread only. Replays every command in order
+        void execute(CommandReplayState& state) const;
+
+        [[nodiscard]] std::size_t getCommandCount() const { return m_CommandCount; }
+
+        [[nodiscard]] std::size_t getBytes() const { return m_Bytes; }
+    };
+
+    // One frame of recording and replay
+    struct CommandStats
+    {
+        std::size_t buffers = 0;
+        std::size_t commands = 0;
+        std::size_t bytes = 0;
+        std::size_t skipped = 0;// binds the replay dropped because the state already matched
+        double recordMs = 0.0;
+        double replayMs = 0.0;
+    };
+
+    /* Records a frame's draws on a JobSystem and replays them on the GL thread. record()
+     * splits a range into chunks and each chunk records into a buffer of its own, execute()
+     * replays the buffers in chunk order (and in record() call order), so the GL stream is
+     * the same one a single thread would have recorded, whatever the thread count. */
+    class CommandRecorder
+    {
+    private:
+        FrameArena& m_Arena;
+        std::vector<CommandBuffer> m_Buffers;// reused across frames
+        std::size_t m_Used = 0;
+        CommandStats m_Frame;
+        CommandStats m_Stats;
+
+    public:
+        explicit CommandRecorder(FrameArena& arena);
+
+        CommandRecorder(const CommandRecorder&) = delete;
+
+        CommandRecorder& operator=(const CommandRecorder&) = delete;
+
+        ~CommandRecorder();
+
+        // Publishes the last frame's stats and drops its commands, call once per frame before recording
+        void reset();
+
+        /* Calls function(buffer, first, last) over [0, count) in chunks of grainSize, on jobs'
+         * threads when jobs isn't nullptr. grainSize 0 picks a few chunks per thread. */
+        template <typename Function>
+        void record(JobSystem* jobs, std::size_t count, const Function& function, std::size_t grainSize = 0);
+
+        // GL thread only, replays everything recorded since reset(). The stats keep the last call
+        void execute();
+
+        // The last finished frame
+        [[nodiscard]] const CommandStats& getStats() const;
+    };
+
+    template <typename Function>
+    void CommandRecorder::record(JobSystem* jobs, const std::size_t count, const Function& function, std::size_t grainSize)
+    {
+        if(count == 0) return;
+        const auto start = std::chrono::steady_clock::now();
+
+        if(grainSize == 0)
+            grainSize = jobs != nullptr ? std::max<std::size_t>(1, count / (static_cast<std::size_t>( jobs->getThreadCount() ) * 4)) : count;
+        const std::size_t chunks = (count + grainSize - 1) / grainSize;
+        const std::size_t base = m_Used;
+        m_Used += chunks;
+        while(m_Buffers.size() < m_Used)
+            m_Buffers.emplace_back(m_Arena);
+
+        CommandBuffer* buffers = m_Buffers.data() + base;
+        const auto recordChunks = [buffers, grainSize, count, &function](const std::size_t first, const std::size_t last)
+        {
+            for(std::size_t chunk = first; chunk < last; chunk++)
+                function(buffers[chunk], chunk * grainSize, std::min(count, (chunk + 1) * grainSize));
+        };
+        if(jobs != nullptr)
+            jobs->parallelFor(chunks, 1, recordChunks);
+        else
+            recordChunks(0, chunks);
+
+        m_Frame.recordMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
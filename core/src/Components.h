@@ -0,0 +1,71 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <cstdint>
+
+namespace core
+{
+    class Mesh;
+    class Shader;
+    class Texture;
+
+    /* The standard components scenes are built from. They are plain data for the ECS chunks,
+     * GPU resources are referenced by pointer and stay owned by whoever loaded them. */
+
+    // Local translation, rotation and scale, 40 bytes so a chunk holds a few hundred
+    struct Transform
+    {
+        glm::vec3 position = glm::vec3(0.0f);
+        glm::quat rotation = glm::quat(1.0f, 0.0f, 0.0f, 0.0f);
+        glm::vec3 scale = glm::vec3(1.0f);
+
+        [[nodiscard]] glm::mat4 getMatrix() const
+        {
+            glm::mat4 matrix = glm::mat4_cast(rotation);
+            matrix[0] *= scale.x;
+            matrix[1] *= scale.y;
+            matrix[2] *= scale.z;
+            matrix[3] = glm::vec4(position, 1.0f);
+            return matrix;
+        }
+    };
+
+    struct MeshRef
+    {
+        const Mesh* mesh = nullptr;
+    };
+
+    struct Material
+    {
+        const Shader* shader = nullptr;
+        const Texture* diffuse = nullptr;// nullptr draws with colour alone
+        glm::vec4 colour = glm::vec4(1.0f);
+        float shininess = 32.0f;
+    };
+
+    enum class LightType : std::uint8_t
+    {
+        Directional,
+        Point,
+        Spot
+    };
+
+    // Positioned by the entity's Transform, directional and spot lights shine down its local -Z
+    struct Light
+    {
+        glm::vec3 colour = glm::vec3(1.0f);
+        float intensity = 1.0f;
+        float range = 10.0f;     // point and spot
+        float innerCone = 0.91f; // spot, cosine of the half angle
+        float outerCone = 0.82f;
+        LightType type = LightType::Point;
+    };
+
+    // Model space bounding box and the sphere around it, for culling
+    struct Bounds
+    {
+        glm::vec3 center = glm::vec3(0.0f);
+        float radius = 0.0f;
+        glm::vec3 extents = glm::vec3(0.0f);// half size
+    };
+}
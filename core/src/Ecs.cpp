@@ -0,0 +1,260 @@
+#include <Ecs.h>
+#include <mutex>
+#include <stdexcept>
+
+namespace core::ecs
+{
+    namespace
+    {
+        std::mutex s_RegistryMutex;
+        std::array<ComponentInfo, MaxComponents> s_Components;
+        std::size_t s_ComponentCount = 0;
+
+        constexpr std::uint32_t alignUp(const std::uint32_t value, const std::uint32_t alignment)
+        {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+    }
+
+    ComponentId detail::registerComponent(const ComponentInfo& info)
+    {
+        std::lock_guard lock(s_RegistryMutex);
+        if(s_ComponentCount == MaxComponents)
+            throw std::runtime_error("[ECS]: More than " + std::to_string(MaxComponents) + " component types registered");
+        s_Components[s_ComponentCount] = info;
+        return static_cast<ComponentId>( s_ComponentCount++ );
+    }
+
+    const ComponentInfo& getComponentInfo(const ComponentId id)
+    {
+        std::lock_guard lock(s_RegistryMutex);
+        return s_Components[id];
+    }
+
+    Archetype::Archetype(const Signature& signature)
+        : m_Signature(signature)
+    {
+        m_Columns.fill(NoColumn);
+        std::uint32_t bytesPerEntity = sizeof(Entity);
+        for(ComponentId id = 0; id < MaxComponents; id++)
+        {
+            if(!signature.test(id)) continue;
+            m_Columns[id] = static_cast<std::uint16_t>( m_Components.size() );
+            m_Components.push_back(id);
+            m_Sizes.push_back(static_cast<std::uint32_t>( getComponentInfo(id).size ));
+            bytesPerEntity += m_Sizes.back();
+        }
+
+        // Every column starts on a cache line, leave room for the padding that costs
+        const std::uint32_t padding = static_cast<std::uint32_t>( m_Components.size() + 1 ) * 64;
+        m_Capacity = static_cast<std::uint32_t>( (ChunkBytes - padding) / bytesPerEntity );
+        if(m_Capacity == 0)
+            throw std::runtime_error("[ECS]: Archetype components don't fit a single entity into a chunk");
+
+        std::uint32_t offset = alignUp(m_Capacity * static_cast<std::uint32_t>( sizeof(Entity) ), 64);
+        for(const std::uint32_t size : m_Sizes)
+        {
+            m_Offsets.push_back(offset);
+            offset = alignUp(offset + m_Capacity * size, 64);
+        }
+    }
+
+    std::uint32_t Archetype::allocateRow()
+    {
+        if(m_Count == m_Chunks.size() * m_Capacity)
+            m_Chunks.push_back(std::make_unique_for_overwrite<Chunk>());// rows are written before they are read, no need to zero 16 KiB
+        return m_Count++;
+    }
+
+    Entity Archetype::removeRow(const std::uint32_t row)
+    {
+        const std::uint32_t last = --m_Count;
+        Entity moved;
+        if(row != last)
+        {
+            moved = getEntity(last);
+            getEntity(row) = moved;
+            for(std::size_t column = 0; column < m_Components.size(); column++)
+                std::memcpy(getComponent(row, m_Components[column]), getComponent(last, m_Components[column]), m_Sizes[column]);
+        }
+
+        // Keep one empty chunk around so an entity hopping back and forth doesn't reallocate
+        while(m_Chunks.size() * m_Capacity >= m_Count + 2 * static_cast<std::size_t>( m_Capacity ))
+            m_Chunks.pop_back();
+        return moved;
+    }
+
+    void Archetype::copyRow(const std::uint32_t row, const Archetype& source, const std::uint32_t sourceRow)
+    {
+        for(std::size_t column = 0; column < m_Components.size(); column++)
+        {
+            const ComponentId id = m_Components[column];
+            if(source.hasComponent(id))
+                std::memcpy(getComponent(row, id), source.getComponent(sourceRow, id), m_Sizes[column]);
+        }
+    }
+
+    void* Archetype::getComponent(const std::uint32_t row, const ComponentId id) const
+    {
+        const std::uint16_t column = m_Columns[id];
+        return m_Chunks[row / m_Capacity]->data + m_Offsets[column] + static_cast<std::size_t>( row % m_Capacity ) * m_Sizes[column];
+    }
+
+    Entity& Archetype::getEntity(const std::uint32_t row) const
+    {
+        return getEntities(row / m_Capacity)[row % m_Capacity];
+    }
+
+    Archetype& World::findArchetype(const Signature& signature)
+    {
+        if(const auto it = m_ArchetypeLookup.find(signature); it != m_ArchetypeLookup.end())
+            return *it->second;
+
+        Archetype* archetype = m_Archetypes.emplace_back(std::make_unique<Archetype>(signature)).get();
+        m_ArchetypeLookup.emplace(signature, archetype);
+
+        // Queries only read their lists, so they are brought up to date here rather than lazily
+        std::unique_lock lock(m_QueryMutex);
+        for(auto& [query, archetypes] : m_Queries)
+        {
+            if((signature & query) == query) archetypes.push_back(archetype);
+        }
+        return *archetype;
+    }
+
+    Entity World::allocateEntity(Archetype& archetype)
+    {
+        Entity entity;
+        if(!m_FreeIndices.empty())
+        {
+            entity.index = m_FreeIndices.back();
+            m_FreeIndices.pop_back();
+        }
+        else
+        {
+            entity.index = static_cast<std::uint32_t>( m_Records.size() );
+            m_Records.emplace_back();
+        }
+
+        Record& record = m_Records[entity.index];
+        entity.generation = record.generation;
+        record.archetype = &archetype;
+        record.row = archetype.allocateRow();
+        archetype.getEntity(record.row) = entity;
+        m_EntityCount++;
+        return entity;
+    }
+
+    void World::changeArchetype(const Entity entity, const Signature& signature)
+    {
+        Record& record = m_Records[entity.index];
+        Archetype& source = *record.archetype;
+        Archetype& target = findArchetype(signature);
+
+        const std::uint32_t row = target.allocateRow();
+        target.getEntity(row) = entity;
+        target.copyRow(row, source, record.row);
+
+        const Entity moved = source.removeRow(record.row);
+        if(moved.isValid()) m_Records[moved.index].row = record.row;
+        record.archetype = &target;
+        record.row = row;
+    }
+
+    const World::Record* World::findRecord(const Entity entity) const
+    {
+        if(entity.index >= m_Records.size()) return nullptr;
+        const Record& record = m_Records[entity.index];
+        if(record.archetype == nullptr || record.generation != entity.generation) return nullptr;
+        return &record;
+    }
+
+    const std::vector<Archetype*>& World::matchArchetypes(const Signature& signature)
+    {
+        {
+            std::shared_lock lock(m_QueryMutex);
+            if(const auto it = m_Queries.find(signature); it != m_Queries.end())
+                return it->second;
+        }
+
+        std::unique_lock lock(m_QueryMutex);
+        const auto [it, inserted] = m_Queries.try_emplace(signature);
+        if(inserted)
+        {
+            for(const auto& archetype : m_Archetypes)
+            {
+                if((archetype->getSignature() & signature) == signature) it->second.push_back(archetype.get());
+            }
+        }
+        return it->second;
+    }
+
+    void World::destroy(const Entity entity)
+    {
+        if(findRecord(entity) == nullptr) return;
+        Record& record = m_Records[entity.index];
+
+        const Entity moved = record.archetype->removeRow(record.row);
+        if(moved.isValid()) m_Records[moved.index].row = record.row;
+        record.archetype = nullptr;
+        record.generation++;
+        m_FreeIndices.push_back(entity.index);
+        m_EntityCount--;
+    }
+
+    void World::clear()
+    {
+        for(std::uint32_t index = 0; index < m_Records.size(); index++)
+        {
+            Record& record = m_Records[index];
+            if(record.archetype == nullptr) continue;
+            record.archetype->removeRow(record.archetype->getEntityCount() - 1);
+            record.archetype = nullptr;
+            record.generation++;
+            m_FreeIndices.push_back(index);
+        }
+        m_EntityCount = 0;
+    }
+
+    bool World::isAlive(const Entity entity) const
+    {
+        return findRecord(entity) != nullptr;
+    }
+
+    void Schedule::addSystem(std::string name, const SystemAccess& access, SystemFunction function)
+    {
+        std::size_t stage = 0;
+        for(const System& system : m_Systems)
+        {
+            if(system.access.conflictsWith(access)) stage = std::max(stage, system.stage + 1);
+        }
+        m_StageCount = std::max(m_StageCount, stage + 1);
+        m_Systems.push_back({ std::move(name), access, std::move(function), stage });
+    }
+
+    void Schedule::run(World& world, JobSystem& jobs) const
+    {
+        for(std::size_t stage = 0; stage < m_StageCount; stage++)
+        {
+            JobCounter counter;
+            for(const System& system : m_Systems)
+            {
+                if(system.stage != stage) continue;
+                const System* target = &system;
+                World* targetWorld = &world;
+                JobSystem* targetJobs = &jobs;
+                jobs.run([target, targetWorld, targetJobs] { target->function(*targetWorld, *targetJobs); }, counter);
+            }
+            jobs.wait(counter);
+        }
+    }
+
+    std::size_t Schedule::getStage(const std::string& name) const
+    {
+        for(const System& system : m_Systems)
+        {
+            if(system.name == name) return system.stage;
+        }
+        throw std::runtime_error("[Schedule]: No system named " + name);
+    }
+}
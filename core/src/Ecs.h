@@ -0,0 +1,455 @@
+#pragma once
+#include <JobSystem.h>
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace core::ecs
+{
+    using ComponentId = std::uint32_t;
+
+    constexpr std::size_t MaxComponents = 64;
+    constexpr std::size_t ChunkBytes = 16 * 1024;
+
+    // Which component types an archetype holds, or a query or system touches
+    using Signature = std::bitset<MaxComponents>;
+
+    // Index into the world's entity table plus a generation, so handles to destroyed entities go stale
+    struct Entity
+    {
+        static constexpr std::uint32_t InvalidIndex = 0xFFFFFFFF;
+
+        std::uint32_t index = InvalidIndex;
+        std::uint32_t generation = 0;
+
+        [[nodiscard]] bool isValid() const { return index != InvalidIndex; }
+
+        bool operator==(const Entity&) const = default;
+    };
+
+    struct ComponentInfo
+    {
+        std::size_t size = 0;
+        std::size_t alignment = 0;
+    };
+
+    namespace detail
+    {
+        // Hands out ids in registration order, throws past MaxComponents
+        ComponentId registerComponent(const ComponentInfo& info);
+    }
+
+    [[nodiscard]] const ComponentInfo& getComponentInfo(ComponentId id);
+
+    /* Components are plain data: chunks move them around with memcpy and never run
+     * constructors or destructors, so anything owning memory belongs outside the world. */
+    template <typename T>
+    ComponentId componentId()
+    {
+        using Component = std::remove_cvref_t<T>;
+        static_assert(std::is_trivially_copyable_v<Component> && std::is_trivially_destructible_v<Component>,
+                      "ECS components must be trivially copyable and destructible");
+        static_assert(alignof(Component) <= 64, "ECS components can't be aligned past a cache line");
+        // const T shares T's id
+        if constexpr(!std::is_same_v<T, Component>)
+            return componentId<Component>();
+        else
+        {
+            static const ComponentId id = detail::registerComponent({ sizeof(Component), alignof(Component) });
+            return id;
+        }
+    }
+
+    template <typename... Ts>
+    Signature signatureOf()
+    {
+        Signature signature;
+        (signature.set(componentId<Ts>()), ...);
+        return signature;
+    }
+
+    // 16 KiB of SoA columns: the entity handles first, then one array per component, each cache line aligned
+    struct Chunk
+    {
+        alignas(64) std::byte data[ChunkBytes];
+    };
+
+    /* All entities with exactly the same set of components. They are packed densely into
+     * chunks, every chunk but the last one is full, and removing an entity moves the last one
+     * into its place. Iterating a component therefore streams through contiguous arrays. */
+    class Archetype
+    {
+    private:
+        static constexpr std::uint16_t NoColumn = 0xFFFF;
+
+        Signature m_Signature;
+        std::vector<ComponentId> m_Components;// ascending
+        std::vector<std::uint32_t> m_Offsets; // byte offset of each component's column in a chunk
+        std::vector<std::uint32_t> m_Sizes;
+        std::array<std::uint16_t, MaxComponents> m_Columns{};// component id -> index into the above
+        std::uint32_t m_Capacity = 0;
+        std::uint32_t m_Count = 0;
+        std::vector<std::unique_ptr<Chunk>> m_Chunks;
+
+    public:
+        explicit Archetype(const Signature& signature);
+
+        Archetype(const Archetype&) = delete;
+
+        Archetype& operator=(const Archetype&) = delete;
+
+        // Appends an uninitialised row, the caller fills in the entity and its components
+        std::uint32_t allocateRow();
+
+        // Moves the last row into row, returns the entity that moved (invalid if row was the last)
+        Entity removeRow(std::uint32_t row);
+
+        // Copies the components both archetypes have from source's row into this archetype's row
+        void copyRow(std::uint32_t row, const Archetype& source, std::uint32_t sourceRow);
+
+        [[nodiscard]] void* getComponent(std::uint32_t row, ComponentId id) const;
+
+        [[nodiscard]] Entity& getEntity(std::uint32_t row) const;
+
+        [[nodiscard]] bool hasComponent(const ComponentId id) const { return m_Signature.test(id); }
+
+        [[nodiscard]] const Signature& getSignature() const { return m_Signature; }
+
+        [[nodiscard]] std::uint32_t getCapacity() const { return m_Capacity; }
+
+        [[nodiscard]] std::uint32_t getEntityCount() const { return m_Count; }
+
+        [[nodiscard]] std::size_t getChunkCount() const { return (m_Count + m_Capacity - 1) / m_Capacity; }
+
+        [[nodiscard]] std::uint32_t getChunkEntityCount(const std::size_t chunk) const
+        {
+            return std::min(m_Capacity, m_Count - static_cast<std::uint32_t>( chunk ) * m_Capacity);
+        }
+
+        [[nodiscard]] Entity* getEntities(const std::size_t chunk) const
+        {
+            return reinterpret_cast<Entity *>( m_Chunks[chunk]->data );
+        }
+
+        // Start of T's array in a chunk, T must be part of the archetype
+        template <typename T>
+        [[nodiscard]] T* getColumn(const std::size_t chunk) const
+        {
+            return reinterpret_cast<T *>( m_Chunks[chunk]->data + m_Offsets[m_Columns[componentId<T>()]] );
+        }
+    };
+
+    // One chunk's worth of a query: count entities and a pointer to each requested column
+    template <typename... Ts>
+    struct ChunkView
+    {
+        std::size_t count = 0;
+        const Entity* entities = nullptr;
+        std::tuple<Ts*...> columns;
+
+        template <typename T>
+        [[nodiscard]] std::span<T> get() const { return { std::get<T *>(columns), count }; }
+    };
+
+    /* Owns entities and their components. Structural changes (create, destroy, add, remove)
+     * must not overlap with queries, component reads and writes through queries may run on
+     * any number of threads as long as no two touch the same component type of the same entity. */
+    class World
+    {
+    private:
+        struct Record
+        {
+            Archetype* archetype = nullptr;
+            std::uint32_t row = 0;
+            std::uint32_t generation = 0;
+        };
+
+        std::vector<Record> m_Records;
+        std::vector<std::uint32_t> m_FreeIndices;
+        std::size_t m_EntityCount = 0;
+        std::vector<std::unique_ptr<Archetype>> m_Archetypes;
+        std::unordered_map<Signature, Archetype*> m_ArchetypeLookup;
+        // Matching archetypes per query signature, filled in as archetypes appear
+        std::unordered_map<Signature, std::vector<Archetype*>> m_Queries;
+        mutable std::shared_mutex m_QueryMutex;
+
+        Archetype& findArchetype(const Signature& signature);
+
+        Entity allocateEntity(Archetype& archetype);
+
+        // Moves the entity to the archetype with signature, keeping the components both have
+        void changeArchetype(Entity entity, const Signature& signature);
+
+        [[nodiscard]] const Record* findRecord(Entity entity) const;
+
+        [[nodiscard]] const std::vector<Archetype*>& matchArchetypes(const Signature& signature);
+
+    public:
+        World() = default;
+
+        World(const World&) = delete;
+
+        World& operator=(const World&) = delete;
+
+        template <typename... Ts>
+        Entity create(const Ts&... components);
+
+        // Stale handles are ignored
+        void destroy(Entity entity);
+
+        // Destroys every entity, archetypes and their chunks stay allocated
+        void clear();
+
+        [[nodiscard]] bool isAlive(Entity entity) const;
+
+        // Adds the component or overwrites it if the entity already has one
+        template <typename T>
+        void add(Entity entity, const T& component);
+
+        template <typename T>
+        void remove(Entity entity);
+
+        template <typename T>
+        [[nodiscard]] bool has(Entity entity) const;
+
+        // nullptr when the entity is dead or has no T, valid until the next structural change
+        template <typename T>
+        [[nodiscard]] T* get(Entity entity) const;
+
+        /* Calls function(Ts&...) or function(Entity, Ts&...) for every entity that has all of
+         * Ts. Mark components the function only reads as const. */
+        template <typename... Ts, typename Function>
+        void each(Function&& function);
+
+        // Calls function(ChunkView<Ts...>) per chunk, for loops the compiler can vectorise
+        template <typename... Ts, typename Function>
+        void eachChunk(Function&& function);
+
+        // each() with chunks spread over the job system's threads, returns once all are done
+        template <typename... Ts, typename Function>
+        void parallelEach(JobSystem& jobs, const Function& function);
+
+        // eachChunk() spread over the job system's threads
+        template <typename... Ts, typename Function>
+        void parallelEachChunk(JobSystem& jobs, const Function& function);
+
+        // Entities that have all of Ts
+        template <typename... Ts>
+        [[nodiscard]] std::size_t count();
+
+        [[nodiscard]] std::size_t getEntityCount() const { return m_EntityCount; }
+
+        [[nodiscard]] std::size_t getArchetypeCount() const { return m_Archetypes.size(); }
+    };
+
+    template <typename... Ts>
+    Entity World::create(const Ts&... components)
+    {
+        Archetype& archetype = findArchetype(signatureOf<Ts...>());
+        const Entity entity = allocateEntity(archetype);
+        const std::uint32_t row = m_Records[entity.index].row;
+        (std::memcpy(archetype.getComponent(row, componentId<Ts>()), &components, sizeof(Ts)), ...);
+        return entity;
+    }
+
+    template <typename T>
+    void World::add(const Entity entity, const T& component)
+    {
+        const Record* record = findRecord(entity);
+        if(record == nullptr) return;
+        const ComponentId id = componentId<T>();
+        if(!record->archetype->hasComponent(id))
+        {
+            changeArchetype(entity, Signature(record->archetype->getSignature()).set(id));
+            record = findRecord(entity);
+        }
+        std::memcpy(record->archetype->getComponent(record->row, id), &component, sizeof(T));
+    }
+
+    template <typename T>
+    void World::remove(const Entity entity)
+    {
+        const Record* record = findRecord(entity);
+        const ComponentId id = componentId<T>();
+        if(record == nullptr || !record->archetype->hasComponent(id)) return;
+        changeArchetype(entity, Signature(record->archetype->getSignature()).reset(id));
+    }
+
+    template <typename T>
+    bool World::has(const Entity entity) const
+    {
+        const Record* record = findRecord(entity);
+        return record != nullptr && record->archetype->hasComponent(componentId<T>());
+    }
+
+    template <typename T>
+    T* World::get(const Entity entity) const
+    {
+        const Record* record = findRecord(entity);
+        const ComponentId id = componentId<T>();
+        if(record == nullptr || !record->archetype->hasComponent(id)) return nullptr;
+        return static_cast<T *>( record->archetype->getComponent(record->row, id) );
+    }
+
+    template <typename... Ts, typename Function>
+    void World::eachChunk(Function&& function)
+    {
+        for(const Archetype* archetype : matchArchetypes(signatureOf<Ts...>()))
+        {
+            for(std::size_t chunk = 0; chunk < archetype->getChunkCount(); chunk++)
+            {
+                function(ChunkView<Ts...>{ archetype->getChunkEntityCount(chunk), archetype->getEntities(chunk),
+                                           { archetype->template getColumn<Ts>(chunk)... } });
+            }
+        }
+    }
+
+    template <typename... Ts, typename Function>
+    void World::each(Function&& function)
+    {
+        eachChunk<Ts...>([&function](const ChunkView<Ts...>& view)
+        {
+            // Unpacked once per chunk, the inner loop only indexes flat arrays
+            std::apply([&](Ts*... columns)
+            {
+                for(std::size_t i = 0; i < view.count; i++)
+                {
+                    if constexpr(std::is_invocable_v<Function&, Entity, Ts&...>)
+                        function(view.entities[i], columns[i]...);
+                    else
+                        function(columns[i]...);
+                }
+            }, view.columns);
+        });
+    }
+
+    template <typename... Ts, typename Function>
+    void World::parallelEachChunk(JobSystem& jobs, const Function& function)
+    {
+        const std::vector<Archetype*>& archetypes = matchArchetypes(signatureOf<Ts...>());
+        std::size_t chunkCount = 0;
+        for(const Archetype* archetype : archetypes)
+            chunkCount += archetype->getChunkCount();
+        if(chunkCount == 0) return;
+
+        // A few jobs per thread, each a run of chunks from one archetype
+        const std::size_t grain = std::max<std::size_t>(1, chunkCount / (static_cast<std::size_t>( jobs.getThreadCount() ) * 4));
+        JobCounter counter;
+        const Function* target = &function;
+        for(const Archetype* archetype : archetypes)
+        {
+            for(std::size_t begin = 0; begin < archetype->getChunkCount(); begin += grain)
+            {
+                const std::size_t end = std::min(archetype->getChunkCount(), begin + grain);
+                jobs.run([target, archetype, begin, end]
+                {
+                    for(std::size_t chunk = begin; chunk < end; chunk++)
+                    {
+                        (*target)(ChunkView<Ts...>{ archetype->getChunkEntityCount(chunk), archetype->getEntities(chunk),
+                                                    { archetype->template getColumn<Ts>(chunk)... } });
+                    }
+                }, counter);
+            }
+        }
+        jobs.wait(counter);
+    }
+
+    template <typename... Ts, typename Function>
+    void World::parallelEach(JobSystem& jobs, const Function& function)
+    {
+        parallelEachChunk<Ts...>(jobs, [&function](const ChunkView<Ts...>& view)
+        {
+            std::apply([&](Ts*... columns)
+            {
+                for(std::size_t i = 0; i < view.count; i++)
+                {
+                    if constexpr(std::is_invocable_v<const Function&, Entity, Ts&...>)
+                        function(view.entities[i], columns[i]...);
+                    else
+                        function(columns[i]...);
+                }
+            }, view.columns);
+        });
+    }
+
+    template <typename... Ts>
+    std::size_t World::count()
+    {
+        std::size_t total = 0;
+        for(const Archetype* archetype : matchArchetypes(signatureOf<Ts...>()))
+            total += archetype->getEntityCount();
+        return total;
+    }
+
+    // Component types a system reads and writes, const Ts count as reads
+    struct SystemAccess
+    {
+        Signature reads;
+        Signature writes;
+
+        [[nodiscard]] bool conflictsWith(const SystemAccess& other) const
+        {
+            return (writes & (other.reads | other.writes)).any() || (other.writes & reads).any();
+        }
+    };
+
+    template <typename... Ts>
+    SystemAccess accessOf()
+    {
+        SystemAccess access;
+        ((std::is_const_v<Ts> ? access.reads : access.writes).set(componentId<Ts>()), ...);
+        return access;
+    }
+
+    /* Runs systems once per frame. Systems are grouped into stages in the order they were
+     * added: a system joins the first stage after every earlier system it conflicts with, and
+     * the systems of a stage run at the same time on the job system. Within a system,
+     * World::parallelEach() spreads the work further. */
+    class Schedule
+    {
+    public:
+        using SystemFunction = std::function<void(World&, JobSystem&)>;
+
+    private:
+        struct System
+        {
+            std::string name;
+            SystemAccess access;
+            SystemFunction function;
+            std::size_t stage = 0;
+        };
+
+        std::vector<System> m_Systems;
+        std::size_t m_StageCount = 0;
+
+    public:
+        // Ts are the components the system touches, e.g. add<const Velocity, Transform>("move", ...)
+        template <typename... Ts>
+        void add(std::string name, SystemFunction function)
+        {
+            addSystem(std::move(name), accessOf<Ts...>(), std::move(function));
+        }
+
+        void addSystem(std::string name, const SystemAccess& access, SystemFunction function);
+
+        // Runs every stage in order, the systems inside a stage in parallel
+        void run(World& world, JobSystem& jobs) const;
+
+        [[nodiscard]] std::size_t getStageCount() const { return m_StageCount; }
+
+        // Stage the named system ended up in, for debugging the order
+        [[nodiscard]] std::size_t getStage(const std::string& name) const;
+    };
+}
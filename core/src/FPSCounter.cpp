@@ -1,4 +1,9 @@
 #include <FPSCounter.h>
+#include <AllocationTracker.h>
+#include <FrameArena.h>
+#include <LodSelector.h>
+#include <RenderQueue.h>
+#include <StreamBuffer.h>
 #include <imgui.h>
 
 
@@ -39,6 +44,70 @@ namespace core
         // Pro addition: show the raw frame time in ms
         ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "Frametime %.2f ms", m_FrameTime);
 
+        // Transient memory of the last frame against the most any frame has needed
+        if(const FrameArena* arena = FrameArena::getMain(); arena != nullptr)
+        {
+            const FrameArenaStats& stats = arena->getStats();
+            constexpr double toKiB = 1.0 / 1024.0;
+            ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "Frame arena %.1f KiB (high %.1f KiB)",
+                               static_cast<double>( stats.usedBytes ) * toKiB,
+                               static_cast<double>( stats.highWaterBytes ) * toKiB);
+            if(stats.overflowBytes > 0)
+                ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "Arena overflow %.1f KiB",
+                                   static_cast<double>( stats.overflowBytes ) * toKiB);
+        }
+
+        // Triangles submitted per level of detail last frame
+        if(const LodSelector* selector = LodSelector::getMain(); selector != nullptr)
+        {
+            const LodStats& stats = selector->getStats();
+            ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "LOD triangles %zu (%zu switches)", stats.getTotalTriangles(),
+                               stats.switches);
+            for(std::size_t level = 0; level < stats.levelCount; level++)
+            {
+                ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "  LOD%zu: %zu objects, %zu triangles", level,
+                                   stats.objects[level], stats.triangles[level]);
+            }
+        }
+
+        // State changes of the last submitted frame, and what drawing in push order would have cost
+        if(const RenderQueue* queue = RenderQueue::getMain(); queue != nullptr)
+        {
+            const RenderQueueStats& stats = queue->getStats();
+            ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "Draws %zu, state changes %zu (unsorted %zu)", stats.packets,
+                               stats.submitted.getTotal(), stats.insertionOrder.getTotal());
+        }
+
+        // Dynamic data streamed last frame, and how long the CPU waited for the GPU to free a region
+        if(const StreamBuffer* stream = StreamBuffer::getMain(); stream != nullptr)
+        {
+            const StreamBufferStats& stats = stream->getStats();
+            constexpr double toKiB = 1.0 / 1024.0;
+            ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "Stream buffer %.1f / %.1f KiB", static_cast<double>( stats.usedBytes ) * toKiB,
+                               static_cast<double>( stats.capacityBytes ) * toKiB);
+            if(stats.stallMs > 0.0)
+                ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "Stream buffer stall %.2f ms", stats.stallMs);
+        }
+
+        // Heap traffic of the last frame, only with the TRACK_ALLOCATIONS build option
+        if(AllocationTracker::isEnabled())
+        {
+            const AllocationFrameStats& allocations = AllocationTracker::getFrameStats();
+            ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "Allocs %llu (%.1f KiB) on %zu threads",
+                               static_cast<unsigned long long>( allocations.total.allocations ),
+                               static_cast<double>( allocations.total.bytes ) / 1024.0, allocations.threadCount);
+            for(std::size_t i = 0; i < allocations.tagCount; i++)
+            {
+                const AllocationSiteStats& site = allocations.tags[i];
+                if(site.counts.allocations == 0) continue;
+                ImGui::TextColored(ImVec4(0.7f, 0.7f, 0.7f, 1.0f), "  %s: %llu", site.tag,
+                                   static_cast<unsigned long long>( site.counts.allocations ));
+            }
+            if(allocations.noAllocViolations > 0)
+                ImGui::TextColored(ImVec4(1.0f, 0.3f, 0.3f, 1.0f), "No-alloc violations %llu",
+                                   static_cast<unsigned long long>( allocations.noAllocViolations ));
+        }
+
         ImGui::End();
     }
 
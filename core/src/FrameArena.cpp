@@ -0,0 +1,147 @@
+#include <FrameArena.h>
+#include <algorithm>
+#include <new>
+#include <stdexcept>
+
+namespace core
+{
+    namespace
+    {
+        // Arenas are numbered so a thread's cached slot can't leak into a newer arena at the same address
+        std::atomic<std::uint64_t> s_NextArenaId{ 1 };
+
+        struct ThreadSlot
+        {
+            std::uint64_t arena = 0;
+            unsigned int index = 0;
+        };
+
+        // Usually one entry, a thread only allocates from a handful of arenas
+        thread_local std::vector<ThreadSlot> t_Slots;
+
+        FrameArena* s_MainArena = nullptr;
+    }
+
+    FrameArenaResource::FrameArenaResource(FrameArena& arena)
+        : m_Arena(arena)
+    {
+    }
+
+    void* FrameArenaResource::do_allocate(const std::size_t bytes, const std::size_t alignment)
+    {
+        return m_Arena.allocate(bytes, alignment);
+    }
+
+    void FrameArenaResource::do_deallocate(void*, std::size_t, std::size_t)
+    {
+    }
+
+    bool FrameArenaResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+    {
+        return this == &other;
+    }
+
+    FrameArena::FrameArena(const FrameArenaOptions& options)
+        : m_Options(options),
+          m_Id(s_NextArenaId.fetch_add(1)),
+          m_Resource(*this)
+    {
+        m_Options.framesInFlight = std::max(1u, m_Options.framesInFlight);
+        m_Options.maxThreads = std::max(1u, m_Options.maxThreads);
+        m_Blocks = std::vector<Block>(static_cast<std::size_t>( m_Options.framesInFlight ) * m_Options.maxThreads);
+    }
+
+    FrameArena::~FrameArena()
+    {
+        if(s_MainArena == this) s_MainArena = nullptr;
+        for(Block& block : m_Blocks)
+            releaseOverflow(block);
+    }
+
+    unsigned int FrameArena::threadIndex()
+    {
+        for(const ThreadSlot& slot : t_Slots)
+        {
+            if(slot.arena == m_Id) return slot.index;
+        }
+
+        const unsigned int index = m_ThreadCount.fetch_add(1);
+        if(index >= m_Options.maxThreads)
+            throw std::runtime_error("[FrameArena]: More threads allocate than FrameArenaOptions::maxThreads");
+        t_Slots.push_back({ m_Id, index });
+        return index;
+    }
+
+    void* FrameArena::allocate(const std::size_t bytes, const std::size_t alignment)
+    {
+        const std::size_t row = m_Frame.load(std::memory_order_relaxed);
+        Block& block = m_Blocks[row * m_Options.maxThreads + threadIndex()];
+
+        // Blocks are made the first time a thread allocates in that frame slot and kept after
+        if(!block.memory && m_Options.bytesPerThread > 0)
+            block.memory.reset(new std::byte[m_Options.bytesPerThread]);
+
+        if(block.memory)
+        {
+            const auto base = reinterpret_cast<std::uintptr_t>( block.memory.get() );
+            const std::uintptr_t aligned = (base + block.offset + alignment - 1) & ~static_cast<std::uintptr_t>( alignment - 1 );
+            if(aligned + bytes <= base + m_Options.bytesPerThread)
+            {
+                block.offset = aligned + bytes - base;
+                return reinterpret_cast<void *>( aligned );
+            }
+        }
+
+        // The block is full, the heap keeps the frame going and the stats say how much was missing
+        void* pointer = ::operator new(bytes, std::align_val_t(alignment));
+        block.overflow.emplace_back(pointer, alignment);
+        block.overflowBytes += bytes;
+        return pointer;
+    }
+
+    void FrameArena::nextFrame()
+    {
+        const unsigned int threads = std::min(m_ThreadCount.load(), m_Options.maxThreads);
+        const std::size_t row = m_Frame.load(std::memory_order_relaxed);
+
+        FrameArenaStats stats;
+        stats.threads = threads;
+        stats.capacityBytes = static_cast<std::size_t>( threads ) * m_Options.bytesPerThread;
+        for(unsigned int thread = 0; thread < threads; thread++)
+        {
+            const Block& block = m_Blocks[row * m_Options.maxThreads + thread];
+            const std::size_t used = block.offset + block.overflowBytes;
+            stats.usedBytes += used;
+            stats.overflowBytes += block.overflowBytes;
+            stats.peakThreadBytes = std::max(stats.peakThreadBytes, used);
+        }
+        stats.highWaterBytes = std::max(m_Stats.highWaterBytes, stats.usedBytes);
+        m_Stats = stats;
+
+        const unsigned int next = (m_Frame.load(std::memory_order_relaxed) + 1) % m_Options.framesInFlight;
+        for(unsigned int thread = 0; thread < threads; thread++)
+        {
+            Block& block = m_Blocks[static_cast<std::size_t>( next ) * m_Options.maxThreads + thread];
+            block.offset = 0;
+            releaseOverflow(block);
+        }
+        m_Frame.store(next, std::memory_order_relaxed);
+        m_FrameNumber++;
+    }
+
+    void FrameArena::releaseOverflow(Block& block)
+    {
+        for(const auto& [pointer, alignment] : block.overflow)
+            ::operator delete(pointer, std::align_val_t(alignment));
+        block.overflow.clear();
+        block.overflowBytes = 0;
+    }
+
+    FrameArena* FrameArena::getMain() { return s_MainArena; }
+    void FrameArena::setMain(FrameArena* arena) { s_MainArena = arena; }
+
+    std::pmr::memory_resource* FrameArena::getResource() { return &m_Resource; }
+    const FrameArenaStats& FrameArena::getStats() const { return m_Stats; }
+    std::uint64_t FrameArena::getFrameNumber() const { return m_FrameNumber; }
+    const FrameArenaOptions& FrameArena::getOptions() const { return m_Options; }
+}
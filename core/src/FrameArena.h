@@ -0,0 +1,120 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace core
+{
+    class FrameArena;
+
+    // Lets std::pmr containers allocate from a FrameArena, deallocation is a no-op
+    class FrameArenaResource final : public std::pmr::memory_resource
+    {
+    private:
+        FrameArena& m_Arena;
+
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+
+        void do_deallocate(void* pointer, std::size_t bytes, std::size_t alignment) override;
+
+        [[nodiscard]] bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    public:
+        explicit FrameArenaResource(FrameArena& arena);
+    };
+
+    struct FrameArenaOptions
+    {
+        // Bump block each thread gets per frame, anything past it falls back to the heap
+        std::size_t bytesPerThread = 4 * 1024 * 1024;
+        // 2 = double buffered, 3 = triple buffered
+        unsigned int framesInFlight = 2;
+        unsigned int maxThreads = 64;
+    };
+
+    struct FrameArenaStats
+    {
+        std::size_t usedBytes = 0;      // the last finished frame, all threads together
+        std::size_t peakThreadBytes = 0;// the busiest thread of that frame
+        std::size_t overflowBytes = 0;  // what had to go to the heap because a block was full
+        std::size_t highWaterBytes = 0; // the most any frame has used so far
+        std::size_t capacityBytes = 0;  // per frame, for the threads that have allocated so far
+        unsigned int threads = 0;
+    };
+
+    /* Linear allocator for data that only lives for a frame: visible lists, sort keys,
+     * uniform staging. Each thread bumps a pointer in its own block, so allocating takes no
+     * lock, and nothing is freed individually. nextFrame() moves on to the next set of blocks
+     * and rewinds it, so memory handed out in frame N stays untouched until frame
+     * N + framesInFlight and the GPU can still be reading it.
+     * Allocation is thread safe, nextFrame() must only run once every job of the frame is done. */
+    class FrameArena
+    {
+    private:
+        struct alignas(64) Block
+        {
+            std::unique_ptr<std::byte[]> memory;
+            std::size_t offset = 0;
+            std::size_t overflowBytes = 0;
+            std::vector<std::pair<void*, std::size_t>> overflow;// pointer, alignment
+        };
+
+        FrameArenaOptions m_Options;
+        std::vector<Block> m_Blocks;// framesInFlight rows of maxThreads blocks
+        std::uint64_t m_Id = 0;
+        std::atomic<unsigned int> m_ThreadCount{ 0 };
+        std::atomic<unsigned int> m_Frame{ 0 };
+        std::uint64_t m_FrameNumber = 0;
+        FrameArenaStats m_Stats;
+        FrameArenaResource m_Resource;
+
+        [[nodiscard]] unsigned int threadIndex();
+
+        static void releaseOverflow(Block& block);
+
+    public:
+        explicit FrameArena(const FrameArenaOptions& options = {});
+
+        FrameArena(const FrameArena&) = delete;
+
+        FrameArena& operator=(const FrameArena&) = delete;
+
+        ~FrameArena();
+
+        // Valid until the same frame slot comes around again, framesInFlight frames from now
+        void* allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t));
+
+        // Uninitialised storage for count Ts, they are never destroyed
+        template <typename T>
+        std::span<T> allocateArray(std::size_t count);
+
+        // Records the finished frame's stats, then switches to and rewinds the next frame's blocks
+        void nextFrame();
+
+        [[nodiscard]] std::pmr::memory_resource* getResource();
+
+        [[nodiscard]] const FrameArenaStats& getStats() const;
+
+        [[nodiscard]] std::uint64_t getFrameNumber() const;
+
+        [[nodiscard]] const FrameArenaOptions& getOptions() const;
+
+        // The arena the Window rewinds every swap, what the FPS overlay reports. nullptr without a window
+        [[nodiscard]] static FrameArena* getMain();
+
+        static void setMain(FrameArena* arena);
+    };
+
+    template <typename T>
+    std::span<T> FrameArena::allocateArray(const std::size_t count)
+    {
+        static_assert(std::is_trivially_destructible_v<T>, "FrameArena never runs destructors");
+        return { static_cast<T *>( allocate(sizeof(T) * count, alignof(T)) ), count };
+    }
+}
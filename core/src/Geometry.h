@@ -0,0 +1,148 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <array>
+#include <limits>
+
+namespace core
+{
+    // Axis aligned box, an empty one has min > max so growing it by anything gives that thing
+    struct Aabb
+    {
+        glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+        glm::vec3 max = glm::vec3(-std::numeric_limits<float>::max());
+
+        [[nodiscard]] glm::vec3 getCenter() const { return (min + max) * 0.5f; }
+
+        [[nodiscard]] glm::vec3 getExtents() const { return (max - min) * 0.5f; }
+
+        [[nodiscard]] bool isEmpty() const { return min.x > max.x; }
+
+        // Half the surface area, all the SAH needs is the ratio between boxes
+        [[nodiscard]] float getHalfArea() const
+        {
+            if(isEmpty()) return 0.0f;
+            const glm::vec3 size = max - min;
+            return size.x * size.y + size.y * size.z + size.z * size.x;
+        }
+
+        void grow(const glm::vec3& point)
+        {
+            min = glm::min(min, point);
+            max = glm::max(max, point);
+        }
+
+        void grow(const Aabb& other)
+        {
+            min = glm::min(min, other.min);
+            max = glm::max(max, other.max);
+        }
+
+        [[nodiscard]] bool contains(const Aabb& other) const
+        {
+            return other.min.x >= min.x && other.min.y >= min.y && other.min.z >= min.z &&
+                   other.max.x <= max.x && other.max.y <= max.y && other.max.z <= max.z;
+        }
+    };
+
+    struct Sphere
+    {
+        glm::vec3 center = glm::vec3(0.0f);
+        float radius = 0.0f;
+    };
+
+    struct Ray
+    {
+        glm::vec3 origin = glm::vec3(0.0f);
+        glm::vec3 direction = glm::vec3(0.0f, 0.0f, -1.0f);// doesn't have to be normalised, distances are in its units
+        float maxDistance = std::numeric_limits<float>::max();
+    };
+
+    enum class Containment { Outside, Intersects, Inside };
+
+    // Six planes (xyz normal pointing inwards, w distance): left, right, bottom, top, near, far
+    struct Frustum
+    {
+        std::array<glm::vec4, 6> planes{};
+
+        // Gribb-Hartmann extraction, pass projection * view for world space planes
+        static Frustum fromMatrix(const glm::mat4& viewProjection)
+        {
+            auto row = [&viewProjection](const int i)
+            {
+                return glm::vec4(viewProjection[0][i], viewProjection[1][i], viewProjection[2][i], viewProjection[3][i]);
+            };
+
+            Frustum frustum;
+            frustum.planes = { row(3) + row(0), row(3) - row(0), row(3) + row(1), row(3) - row(1), row(3) + row(2), row(3) - row(2) };
+            for(glm::vec4& plane : frustum.planes)
+                plane /= glm::length(glm::vec3(plane));
+            return frustum;
+        }
+
+        [[nodiscard]] bool intersects(const Sphere& sphere) const
+        {
+            for(const glm::vec4& plane : planes)
+            {
+                if(glm::dot(glm::vec3(plane), sphere.center) + plane.w < -sphere.radius) return false;
+            }
+            return true;
+        }
+
+        [[nodiscard]] bool intersects(const Aabb& box) const
+        {
+            const glm::vec3 center = box.getCenter();
+            const glm::vec3 extents = box.getExtents();
+            for(const glm::vec4& plane : planes)
+            {
+                // Signed distance of the box's centre against its projected radius on the normal
+                const glm::vec3 normal(plane);
+                if(glm::dot(normal, center) + plane.w < -glm::dot(glm::abs(normal), extents)) return false;
+            }
+            return true;
+        }
+
+        // Tells whole subtrees that are fully inside apart, so queries can skip testing below them
+        [[nodiscard]] Containment classify(const Aabb& box) const
+        {
+            const glm::vec3 center = box.getCenter();
+            const glm::vec3 extents = box.getExtents();
+            Containment result = Containment::Inside;
+            for(const glm::vec4& plane : planes)
+            {
+                const glm::vec3 normal(plane);
+                const float distance = glm::dot(normal, center) + plane.w;
+                const float radius = glm::dot(glm::abs(normal), extents);
+                if(distance < -radius) return Containment::Outside;
+                if(distance < radius) result = Containment::Intersects;
+            }
+            return result;
+        }
+    };
+
+    inline bool intersects(const Aabb& a, const Aabb& b)
+    {
+        return a.min.x <= b.max.x && a.max.x >= b.min.x && a.min.y <= b.max.y && a.max.y >= b.min.y &&
+               a.min.z <= b.max.z && a.max.z >= b.min.z;
+    }
+
+    inline bool intersects(const Aabb& box, const Sphere& sphere)
+    {
+        const glm::vec3 closest = glm::clamp(sphere.center, box.min, box.max);
+        const glm::vec3 offset = closest - sphere.center;
+        return glm::dot(offset, offset) <= sphere.radius * sphere.radius;
+    }
+
+    /* Slab test, inverseDirection = 1 / ray.direction computed once per ray. Returns the
+     * entry distance, or a negative value when the ray misses or the box is past maxDistance. */
+    inline float intersectRay(const Aabb& box, const Ray& ray, const glm::vec3& inverseDirection)
+    {
+        const glm::vec3 t0 = (box.min - ray.origin) * inverseDirection;
+        const glm::vec3 t1 = (box.max - ray.origin) * inverseDirection;
+        const glm::vec3 closer = glm::min(t0, t1);
+        const glm::vec3 further = glm::max(t0, t1);
+        const float enter = std::max(std::max(closer.x, closer.y), std::max(closer.z, 0.0f));
+        const float exit = std::min(std::min(further.x, further.y), std::min(further.z, ray.maxDistance));
+        return enter <= exit ? enter : -1.0f;
+    }
+}
@@ -0,0 +1,704 @@
+#include <GltfLoader.h>
+#include <Json.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <unordered_map>
+
+namespace core
+{
+    namespace
+    {
+        using Clock = std::chrono::steady_clock;
+
+        constexpr std::uint32_t GlbMagic = 0x46546C67;// "glTF"
+        constexpr std::uint32_t ChunkJson = 0x4E4F534A;
+        constexpr std::uint32_t ChunkBin = 0x004E4942;
+
+        // glTF component types are the GL enums
+        constexpr unsigned int ComponentUnsignedByte = 5121;
+        constexpr unsigned int ComponentUnsignedShort = 5123;
+
+        double millisecondsSince(const Clock::time_point start)
+        {
+            return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        }
+
+        [[noreturn]] void fail(const std::string& path, const std::string& message)
+        {
+            throw std::runtime_error("[GltfLoader]: " + path + ": " + message);
+        }
+
+        std::uint32_t readU32(const std::byte* data)
+        {
+            std::uint32_t value = 0;
+            std::memcpy(&value, data, sizeof(value));
+            return value;
+        }
+
+        std::size_t componentSize(const unsigned int componentType)
+        {
+            switch(componentType)
+            {
+                case 5120: case 5121: return 1;
+                case 5122: case 5123: return 2;
+                case 5125: case 5126: return 4;
+                default: return 0;
+            }
+        }
+
+        int componentCount(const std::string_view type)
+        {
+            if(type == "SCALAR") return 1;
+            if(type == "VEC2") return 2;
+            if(type == "VEC3") return 3;
+            if(type == "VEC4") return 4;
+            if(type == "MAT2") return 4;
+            if(type == "MAT3") return 9;
+            if(type == "MAT4") return 16;
+            return 0;
+        }
+
+        // Shader locations used by the lessons (and packVertices)
+        int attributeLocation(const std::string_view name)
+        {
+            if(name == "POSITION") return 0;
+            if(name == "NORMAL") return 1;
+            if(name == "TEXCOORD_0") return 2;
+            if(name == "TANGENT") return 3;
+            if(name == "COLOR_0") return 4;
+            return -1;
+        }
+
+        // Casting a negative, non-finite or too large double to size_t is undefined, a fraction would be cut off
+        bool isSize(const double number)
+        {
+            return std::isfinite(number) && number >= 0.0 && number < static_cast<double>( std::numeric_limits<std::size_t>::max() ) &&
+                   std::trunc(number) == number;
+        }
+
+        float toFloat(const JsonValue& array, const std::size_t index)
+        {
+            return static_cast<float>( array[index].asNumber() );
+        }
+
+        // Where an accessor's bytes live once the asset is uploaded
+        struct ResolvedAccessor
+        {
+            std::size_t range = 0;
+            std::size_t offset = 0;
+            unsigned int stride = 0;
+            unsigned int componentType = 0;
+            int components = 0;
+            bool normalized = false;
+            std::size_t count = 0;
+        };
+
+        // An accessor the GPU can't read directly, written into its decoded buffer by a worker
+        struct DecodeTask
+        {
+            const JsonValue* accessor = nullptr;
+            std::byte* destination = nullptr;
+            std::size_t elementSize = 0;
+            bool widenIndices = false;
+        };
+
+        class GlbParser
+        {
+        private:
+            const std::string& m_Path;
+            GltfAsset& m_Asset;
+            const JsonValue& m_Json;
+            std::span<const std::byte> m_Bin;
+
+            std::unordered_map<std::size_t, std::size_t> m_ViewRanges;
+            std::unordered_map<std::size_t, ResolvedAccessor> m_Accessors;
+            std::vector<std::vector<std::size_t>> m_MeshPrimitives;
+
+        public:
+            std::vector<DecodeTask> decodeTasks;
+
+            GlbParser(const std::string& path, GltfAsset& asset, const JsonValue& json,
+                      const std::span<const std::byte> bin)
+                : m_Path(path), m_Asset(asset), m_Json(json), m_Bin(bin) {}
+
+            const JsonValue& element(const std::string_view array, const std::size_t index) const
+            {
+                const JsonValue* values = m_Json.find(array);
+                if(values == nullptr || index >= values->size())
+                {
+                    fail(m_Path, std::string(array) + "[" + std::to_string(index) + "] does not exist");
+                }
+                return (*values)[index];
+            }
+
+            // Counts, offsets and indices must be whole non-negative numbers, anything else fails the load
+            std::size_t checkedSize(const JsonValue& number, const std::string_view what) const
+            {
+                // Not a number at all comes back as NaN
+                const double value = number.asNumber(std::numeric_limits<double>::quiet_NaN());
+                if(!isSize(value)) fail(m_Path, "invalid " + std::string(what) + " " + std::to_string(value));
+                return static_cast<std::size_t>( value );
+            }
+
+            // An optional member, fallback when it is missing
+            std::size_t toSize(const JsonValue& value, const std::string_view key, const std::size_t fallback) const
+            {
+                const JsonValue* number = value.find(key);
+                return number != nullptr ? checkedSize(*number, key) : fallback;
+            }
+
+            std::size_t toSize(const JsonValue& value, const std::string_view key) const { return toSize(value, key, 0); }
+
+            std::size_t toIndex(const JsonValue& number) const { return checkedSize(number, "index"); }
+
+            // Bytes of a bufferView inside the BIN chunk
+            std::span<const std::byte> viewBytes(const std::size_t viewIndex) const
+            {
+                const JsonValue& view = element("bufferViews", viewIndex);
+                if(toSize(view, "buffer") != 0)
+                {
+                    fail(m_Path, "only the embedded BIN buffer is supported");
+                }
+                const std::size_t offset = toSize(view, "byteOffset");
+                const std::size_t length = toSize(view, "byteLength");
+                if(offset > m_Bin.size() || length > m_Bin.size() - offset)
+                {
+                    fail(m_Path, "bufferView " + std::to_string(viewIndex) + " is outside the BIN chunk");
+                }
+                return m_Bin.subspan(offset, length);
+            }
+
+            std::size_t viewRange(const std::size_t viewIndex)
+            {
+                const auto it = m_ViewRanges.find(viewIndex);
+                if(it != m_ViewRanges.end()) return it->second;
+
+                m_Asset.ranges.push_back(viewBytes(viewIndex));
+                m_ViewRanges.emplace(viewIndex, m_Asset.ranges.size() - 1);
+                return m_Asset.ranges.size() - 1;
+            }
+
+            ResolvedAccessor resolveAccessor(const std::size_t accessorIndex, const bool isIndices)
+            {
+                const auto cached = m_Accessors.find(accessorIndex);
+                if(cached != m_Accessors.end()) return cached->second;
+
+                const JsonValue& accessor = element("accessors", accessorIndex);
+                ResolvedAccessor resolved;
+                resolved.componentType = static_cast<unsigned int>( accessor.getNumber("componentType") );
+                resolved.components = componentCount(accessor.getString("type"));
+                resolved.normalized = accessor.find("normalized") != nullptr && accessor.find("normalized")->asBool();
+                resolved.count = toSize(accessor, "count");
+
+                const std::size_t elementSize = componentSize(resolved.componentType) * static_cast<std::size_t>( resolved.components );
+                if(elementSize == 0)
+                {
+                    fail(m_Path, "accessor " + std::to_string(accessorIndex) + " has an unknown type");
+                }
+
+                const JsonValue* viewIndex = accessor.find("bufferView");
+                const bool widen = isIndices && resolved.componentType == ComponentUnsignedByte;
+                if(viewIndex == nullptr || accessor.find("sparse") != nullptr || widen)
+                {
+                    // Needs decoding: dense copy of sparse data, zero filled accessors or byte indices
+                    const std::size_t outputElement = widen ? sizeof(std::uint16_t) : elementSize;
+                    auto& storage = m_Asset.decoded.emplace_back(outputElement * resolved.count);
+                    m_Asset.ranges.emplace_back(storage.data(), storage.size());
+                    decodeTasks.push_back({ &accessor, storage.data(), elementSize, widen });
+
+                    resolved.range = m_Asset.ranges.size() - 1;
+                    resolved.offset = 0;
+                    resolved.stride = static_cast<unsigned int>( outputElement );
+                    if(widen) resolved.componentType = ComponentUnsignedShort;
+                } else
+                {
+                    const auto view = toIndex(*viewIndex);
+                    const JsonValue& viewJson = element("bufferViews", view);
+                    resolved.range = viewRange(view);
+                    resolved.offset = toSize(accessor, "byteOffset");
+                    resolved.stride = static_cast<unsigned int>( toSize(viewJson, "byteStride", elementSize) );
+
+                    const std::size_t rangeSize = m_Asset.ranges[resolved.range].size();
+                    const std::size_t lastElement = resolved.count == 0 ? 0 : (resolved.count - 1) * resolved.stride + elementSize;
+                    if(resolved.offset > rangeSize || lastElement > rangeSize - resolved.offset)
+                    {
+                        fail(m_Path, "accessor " + std::to_string(accessorIndex) + " overruns its bufferView");
+                    }
+                }
+
+                m_Accessors.emplace(accessorIndex, resolved);
+                return resolved;
+            }
+
+            void parsePrimitive(const JsonValue& primitiveJson)
+            {
+                GltfPrimitive primitive;
+                primitive.mode = static_cast<unsigned int>( primitiveJson.getNumber("mode", GL_TRIANGLES) );
+
+                const JsonValue* attributes = primitiveJson.find("attributes");
+                if(attributes == nullptr) fail(m_Path, "primitive without attributes");
+
+                for(const auto& [name, accessorIndex] : attributes->getObject())
+                {
+                    const int location = attributeLocation(name);
+                    if(location < 0) continue;
+
+                    const auto index = toIndex(accessorIndex);
+                    const ResolvedAccessor resolved = resolveAccessor(index, false);
+                    primitive.attributes.push_back({
+                        static_cast<unsigned int>( location ), resolved.components, resolved.componentType,
+                        resolved.normalized, resolved.range, resolved.offset, resolved.stride
+                    });
+
+                    if(location == 0)
+                    {
+                        primitive.vertexCount = resolved.count;
+                        // POSITION has to carry min/max, so the bounds come for free
+                        const JsonValue& accessor = element("accessors", index);
+                        const JsonValue* min = accessor.find("min");
+                        const JsonValue* max = accessor.find("max");
+                        if(min != nullptr && max != nullptr && min->size() == 3 && max->size() == 3)
+                        {
+                            primitive.boundsMin = glm::vec3(toFloat(*min, 0), toFloat(*min, 1), toFloat(*min, 2));
+                            primitive.boundsMax = glm::vec3(toFloat(*max, 0), toFloat(*max, 1), toFloat(*max, 2));
+                        }
+                    }
+                }
+                if(primitive.vertexCount == 0) fail(m_Path, "primitive without POSITION");
+
+                if(const JsonValue* indices = primitiveJson.find("indices"))
+                {
+                    const ResolvedAccessor resolved = resolveAccessor(toIndex(*indices), true);
+                    primitive.indexed = true;
+                    primitive.indexType = resolved.componentType;
+                    primitive.indexCount = resolved.count;
+                    primitive.indexRange = resolved.range;
+                    primitive.indexOffset = resolved.offset;
+                }
+
+                m_Asset.primitives.push_back(std::move(primitive));
+            }
+
+            void parseMeshes()
+            {
+                const JsonValue* meshes = m_Json.find("meshes");
+                if(meshes == nullptr) return;
+
+                for(const JsonValue& mesh : meshes->getArray())
+                {
+                    std::vector<std::size_t> primitives;
+                    if(const JsonValue* list = mesh.find("primitives"))
+                    {
+                        for(const JsonValue& primitive : list->getArray())
+                        {
+                            parsePrimitive(primitive);
+                            primitives.push_back(m_Asset.primitives.size() - 1);
+                        }
+                    }
+                    m_MeshPrimitives.push_back(std::move(primitives));
+                }
+            }
+
+            static glm::mat4 nodeTransform(const JsonValue& node)
+            {
+                glm::mat4 transform(1.0f);
+                if(const JsonValue* matrix = node.find("matrix"); matrix != nullptr && matrix->size() == 16)
+                {
+                    // Column major, like glm
+                    for(std::size_t i = 0; i < 16; i++)
+                        transform[static_cast<int>( i / 4 )][static_cast<int>( i % 4 )] = toFloat(*matrix, i);
+                    return transform;
+                }
+
+                glm::vec3 translation(0.0f);
+                glm::vec4 rotation(0.0f, 0.0f, 0.0f, 1.0f);// x y z w
+                glm::vec3 scale(1.0f);
+                if(const JsonValue* t = node.find("translation"); t != nullptr && t->size() == 3)
+                    translation = glm::vec3(toFloat(*t, 0), toFloat(*t, 1), toFloat(*t, 2));
+                if(const JsonValue* r = node.find("rotation"); r != nullptr && r->size() == 4)
+                    rotation = glm::vec4(toFloat(*r, 0), toFloat(*r, 1), toFloat(*r, 2), toFloat(*r, 3));
+                if(const JsonValue* s = node.find("scale"); s != nullptr && s->size() == 3)
+                    scale = glm::vec3(toFloat(*s, 0), toFloat(*s, 1), toFloat(*s, 2));
+
+                // T * R * S with the unit quaternion expanded into the rotation columns
+                const float x = rotation.x, y = rotation.y, z = rotation.z, w = rotation.w;
+                transform[0] = glm::vec4(1.0f - 2.0f * (y * y + z * z), 2.0f * (x * y + z * w), 2.0f * (x * z - y * w), 0.0f) * scale.x;
+                transform[1] = glm::vec4(2.0f * (x * y - z * w), 1.0f - 2.0f * (x * x + z * z), 2.0f * (y * z + x * w), 0.0f) * scale.y;
+                transform[2] = glm::vec4(2.0f * (x * z + y * w), 2.0f * (y * z - x * w), 1.0f - 2.0f * (x * x + y * y), 0.0f) * scale.z;
+                transform[3] = glm::vec4(translation, 1.0f);
+                return transform;
+            }
+
+            // Walks the default scene and emits a draw item for every primitive of every mesh node
+            void parseScene()
+            {
+                const JsonValue* nodes = m_Json.find("nodes");
+                if(nodes == nullptr) return;
+
+                std::vector<std::size_t> roots;
+                const JsonValue* scenes = m_Json.find("scenes");
+                if(scenes != nullptr && scenes->size() > 0)
+                {
+                    const std::size_t sceneIndex = toSize(m_Json, "scene");
+                    if(sceneIndex >= scenes->size()) fail(m_Path, "scene " + std::to_string(sceneIndex) + " does not exist");
+                    const JsonValue& scene = (*scenes)[sceneIndex];
+                    if(const JsonValue* sceneNodes = scene.find("nodes"))
+                    {
+                        for(const JsonValue& node : sceneNodes->getArray())
+                            roots.push_back(toIndex(node));
+                    }
+                } else
+                {
+                    // No scene: every node that isn't somebody's child is a root
+                    std::vector<bool> isChild(nodes->size(), false);
+                    for(const JsonValue& node : nodes->getArray())
+                    {
+                        if(const JsonValue* children = node.find("children"))
+                        {
+                            for(const JsonValue& child : children->getArray())
+                            {
+                                const auto index = toIndex(child);
+                                if(index < isChild.size()) isChild[index] = true;
+                            }
+                        }
+                    }
+                    for(std::size_t i = 0; i < isChild.size(); i++)
+                        if(!isChild[i]) roots.push_back(i);
+                }
+
+                struct Pending
+                {
+                    std::size_t node;
+                    glm::mat4 parent;
+                    std::size_t depth;
+                };
+                std::vector<Pending> stack;
+                for(const std::size_t root : roots)
+                    stack.push_back({ root, glm::mat4(1.0f), 0 });
+
+                while(!stack.empty())
+                {
+                    const Pending pending = stack.back();
+                    stack.pop_back();
+                    // glTF forbids cycles, the depth limit only protects against broken files
+                    if(pending.depth > nodes->size()) fail(m_Path, "node hierarchy contains a cycle");
+
+                    const JsonValue& node = element("nodes", pending.node);
+                    const glm::mat4 world = pending.parent * nodeTransform(node);
+
+                    if(const JsonValue* mesh = node.find("mesh"))
+                    {
+                        const auto meshIndex = toIndex(*mesh);
+                        if(meshIndex >= m_MeshPrimitives.size()) fail(m_Path, "node references a missing mesh");
+                        for(const std::size_t primitive : m_MeshPrimitives[meshIndex])
+                            m_Asset.drawItems.push_back({ primitive, world });
+                    }
+                    if(const JsonValue* children = node.find("children"))
+                    {
+                        for(const JsonValue& child : children->getArray())
+                            stack.push_back({ toIndex(child), world, pending.depth + 1 });
+                    }
+                }
+            }
+
+            // Writes one accessor into its dense output, applying sparse substitutions
+            void decode(const DecodeTask& task) const
+            {
+                const JsonValue& accessor = *task.accessor;
+                const std::size_t count = toSize(accessor, "count");
+
+                // Byte indices are written as shorts, base values and sparse substitutions alike
+                auto* widened = reinterpret_cast<std::uint16_t *>( task.destination );
+
+                // Base values, accessors without a bufferView start out as zeros
+                const JsonValue* viewIndex = accessor.find("bufferView");
+                if(task.widenIndices && viewIndex != nullptr)
+                {
+                    const std::span<const std::byte> view = viewBytes(toIndex(*viewIndex));
+                    const std::size_t offset = toSize(accessor, "byteOffset");
+                    if(offset > view.size() || count > view.size() - offset)
+                    {
+                        fail(m_Path, "index accessor overruns its bufferView");
+                    }
+                    for(std::size_t i = 0; i < count; i++)
+                        widened[i] = static_cast<std::uint16_t>( view[offset + i] );
+                } else if(task.widenIndices)
+                {
+                    std::fill_n(widened, count, std::uint16_t{ 0 });
+                } else if(viewIndex != nullptr)
+                {
+                    const auto view = toIndex(*viewIndex);
+                    const std::span<const std::byte> bytes = viewBytes(view);
+                    const std::size_t offset = toSize(accessor, "byteOffset");
+                    const std::size_t stride = toSize(element("bufferViews", view), "byteStride", task.elementSize);
+                    if(count > 0 && (offset > bytes.size() || (count - 1) * stride + task.elementSize > bytes.size() - offset))
+                    {
+                        fail(m_Path, "sparse accessor base overruns its bufferView");
+                    }
+                    for(std::size_t i = 0; i < count; i++)
+                        std::memcpy(task.destination + i * task.elementSize, bytes.data() + offset + i * stride, task.elementSize);
+                } else
+                {
+                    std::fill_n(task.destination, count * task.elementSize, std::byte{ 0 });
+                }
+
+                const JsonValue* sparse = accessor.find("sparse");
+                if(sparse == nullptr) return;
+
+                const std::size_t sparseCount = toSize(*sparse, "count");
+                const JsonValue* indices = sparse->find("indices");
+                const JsonValue* values = sparse->find("values");
+                if(indices == nullptr || values == nullptr) fail(m_Path, "sparse accessor without indices/values");
+
+                const auto indexType = static_cast<unsigned int>( indices->getNumber("componentType") );
+                const std::size_t indexSize = componentSize(indexType);
+                const std::span<const std::byte> indexBytes = viewBytes(toSize(*indices, "bufferView"));
+                const std::span<const std::byte> valueBytes = viewBytes(toSize(*values, "bufferView"));
+                const std::size_t indexOffset = toSize(*indices, "byteOffset");
+                const std::size_t valueOffset = toSize(*values, "byteOffset");
+                if(indexSize == 0 || indexOffset > indexBytes.size() || sparseCount * indexSize > indexBytes.size() - indexOffset ||
+                   valueOffset > valueBytes.size() || sparseCount * task.elementSize > valueBytes.size() - valueOffset)
+                {
+                    fail(m_Path, "sparse accessor overruns its bufferViews");
+                }
+
+                for(std::size_t i = 0; i < sparseCount; i++)
+                {
+                    const std::byte* source = indexBytes.data() + indexOffset + i * indexSize;
+                    std::size_t target = 0;
+                    if(indexType == ComponentUnsignedByte)
+                    {
+                        target = static_cast<std::size_t>( *source );
+                    } else if(indexType == ComponentUnsignedShort)
+                    {
+                        std::uint16_t value = 0;
+                        std::memcpy(&value, source, sizeof(value));
+                        target = value;
+                    } else
+                    {
+                        target = readU32(source);
+                    }
+                    if(target >= count) fail(m_Path, "sparse index out of range");
+                    const std::byte* value = valueBytes.data() + valueOffset + i * task.elementSize;
+                    if(task.widenIndices) widened[target] = static_cast<std::uint16_t>( *value );
+                    else std::memcpy(task.destination + target * task.elementSize, value, task.elementSize);
+                }
+            }
+        };
+
+        // Spreads the decode tasks over worker threads, the calling thread works too
+        unsigned int runDecodeTasks(const GlbParser& parser, const std::vector<DecodeTask>& tasks,
+                                    const unsigned int requestedThreads)
+        {
+            if(tasks.empty()) return 0;
+
+            const unsigned int hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+            const unsigned int threads = std::min<unsigned int>(requestedThreads == 0 ? hardwareThreads : requestedThreads,
+                                                                static_cast<unsigned int>( std::min<std::size_t>(tasks.size(), hardwareThreads) ));
+
+            std::atomic<std::size_t> nextTask{ 0 };
+            std::exception_ptr error;
+            std::atomic<bool> failed{ false };
+            auto decodeTasks = [&]()
+            {
+                for(std::size_t i = nextTask++; i < tasks.size() && !failed; i = nextTask++)
+                {
+                    try
+                    {
+                        parser.decode(tasks[i]);
+                    } catch(...)
+                    {
+                        // Only the first error is kept, the rest of the batch is abandoned
+                        if(!failed.exchange(true)) error = std::current_exception();
+                    }
+                }
+            };
+
+            std::vector<std::thread> workers;
+            for(unsigned int i = 1; i < threads; i++)
+                workers.emplace_back(decodeTasks);
+            decodeTasks();
+            for(auto& worker : workers)
+                worker.join();
+
+            if(error) std::rethrow_exception(error);
+            return threads;
+        }
+    }
+
+    GltfAsset loadGlb(const std::string& path, const GltfLoadOptions& options)
+    {
+        const auto parseStart = Clock::now();
+
+        GltfAsset asset;
+        asset.logStats = options.logStats;
+        if(!asset.file.open(path)) fail(path, "could not be opened");
+
+        const std::span<const std::byte> data = asset.file.getData();
+        asset.stats.fileBytes = data.size();
+        if(data.size() < 20 || readU32(data.data()) != GlbMagic) fail(path, "not a binary glTF file");
+        if(readU32(data.data() + 4) != 2) fail(path, "only glTF 2.0 is supported");
+        const std::size_t length = std::min<std::size_t>(readU32(data.data() + 8), data.size());
+        if(length < 20) fail(path, "header length is too small");
+
+        // Chunk 0 is always JSON, the optional chunk 1 is the BIN buffer
+        const std::size_t jsonLength = readU32(data.data() + 12);
+        if(readU32(data.data() + 16) != ChunkJson || jsonLength > length - 20) fail(path, "missing JSON chunk");
+        const std::string_view jsonText(reinterpret_cast<const char *>( data.data() + 20 ), jsonLength);
+
+        std::span<const std::byte> bin;
+        const std::size_t binHeader = 20 + jsonLength;
+        if(binHeader + 8 <= length && readU32(data.data() + binHeader + 4) == ChunkBin)
+        {
+            const std::size_t binLength = readU32(data.data() + binHeader);
+            if(binLength > length - binHeader - 8) fail(path, "BIN chunk is truncated");
+            bin = data.subspan(binHeader + 8, binLength);
+        }
+
+        const JsonValue json = JsonValue::parse(jsonText);
+        GlbParser parser(path, asset, json, bin);
+        parser.parseMeshes();
+        parser.parseScene();
+        asset.stats.parseMs = millisecondsSince(parseStart);
+
+        const auto decodeStart = Clock::now();
+        asset.stats.convertedAccessors = parser.decodeTasks.size();
+        asset.stats.decodeThreads = runDecodeTasks(parser, parser.decodeTasks, options.workerThreads);
+        asset.stats.decodeMs = millisecondsSince(decodeStart);
+
+        for(const auto& range : asset.ranges)
+            asset.stats.uploadBytes += range.size();
+
+        if(options.logStats)
+        {
+            std::cerr << "[GltfLoader]: " << path << ": " << asset.primitives.size() << " primitives, "
+                    << asset.drawItems.size() << " draws, parsed in " << asset.stats.parseMs << " ms, "
+                    << asset.stats.convertedAccessors << " accessors decoded in " << asset.stats.decodeMs
+                    << " ms on " << asset.stats.decodeThreads << " threads" << '\n';
+        }
+        return asset;
+    }
+
+    GltfModel::GltfModel(const GltfAsset& asset)
+        : m_DrawItems(asset.drawItems),
+          m_Stats(asset.stats)
+    {
+        const auto uploadStart = Clock::now();
+
+        // Ranges are packed into one buffer, 16 byte alignment satisfies every attribute and index type
+        std::vector<std::size_t> rangeOffsets(asset.ranges.size());
+        std::size_t total = 0;
+        for(std::size_t i = 0; i < asset.ranges.size(); i++)
+        {
+            rangeOffsets[i] = total;
+            total += (asset.ranges[i].size() + 15) & ~static_cast<std::size_t>( 15 );
+        }
+
+        glCreateBuffers(1, &m_Buffer);
+        glNamedBufferStorage(m_Buffer, static_cast<GLsizeiptr>( std::max<std::size_t>(total, 1) ), nullptr,
+                             GL_DYNAMIC_STORAGE_BIT);
+        // The driver copies straight out of the mapped file, pages fault in as it reads
+        for(std::size_t i = 0; i < asset.ranges.size(); i++)
+        {
+            if(asset.ranges[i].empty()) continue;
+            glNamedBufferSubData(m_Buffer, static_cast<GLintptr>( rangeOffsets[i] ),
+                                 static_cast<GLsizeiptr>( asset.ranges[i].size() ), asset.ranges[i].data());
+        }
+
+        m_Primitives.reserve(asset.primitives.size());
+        for(const GltfPrimitive& primitive : asset.primitives)
+        {
+            DrawPrimitive draw;
+            draw.mode = primitive.mode;
+            draw.indexed = primitive.indexed;
+            draw.indexType = primitive.indexType;
+            draw.count = static_cast<int>( primitive.indexed ? primitive.indexCount : primitive.vertexCount );
+            draw.indexOffset = primitive.indexed ? rangeOffsets[primitive.indexRange] + primitive.indexOffset : 0;
+
+            glCreateVertexArrays(1, &draw.vertexArray);
+            // Every attribute gets its own binding, glTF attributes rarely share a bufferView stride
+            for(std::size_t i = 0; i < primitive.attributes.size(); i++)
+            {
+                const GltfAttribute& attr = primitive.attributes[i];
+                const auto binding = static_cast<unsigned int>( i );
+                glVertexArrayVertexBuffer(draw.vertexArray, binding, m_Buffer,
+                                          static_cast<GLintptr>( rangeOffsets[attr.range] + attr.offset ),
+                                          static_cast<GLsizei>( attr.stride ));
+                glEnableVertexArrayAttrib(draw.vertexArray, attr.location);
+                glVertexArrayAttribFormat(draw.vertexArray, attr.location, attr.components, attr.type,
+                                          attr.normalized ? GL_TRUE : GL_FALSE, 0);
+                glVertexArrayAttribBinding(draw.vertexArray, attr.location, binding);
+            }
+            if(primitive.indexed) glVertexArrayElementBuffer(draw.vertexArray, m_Buffer);
+
+            m_Primitives.push_back(draw);
+        }
+
+        // Scene bounds from the transformed corners of each placed primitive
+        bool first = true;
+        for(const GltfDrawItem& item : m_DrawItems)
+        {
+            const GltfPrimitive& primitive = asset.primitives[item.primitive];
+            for(int corner = 0; corner < 8; corner++)
+            {
+                const glm::vec3 local((corner & 1) ? primitive.boundsMax.x : primitive.boundsMin.x,
+                                      (corner & 2) ? primitive.boundsMax.y : primitive.boundsMin.y,
+                                      (corner & 4) ? primitive.boundsMax.z : primitive.boundsMin.z);
+                const glm::vec3 world = glm::vec3(item.transform * glm::vec4(local, 1.0f));
+                m_BoundsMin = first ? world : glm::min(m_BoundsMin, world);
+                m_BoundsMax = first ? world : glm::max(m_BoundsMax, world);
+                first = false;
+            }
+        }
+
+        m_Stats.uploadMs = millisecondsSince(uploadStart);
+        if(asset.logStats)
+        {
+            std::cerr << "[GltfLoader]: Uploaded " << static_cast<double>( total ) / (1024.0 * 1024.0) << " MB in "
+                    << m_Stats.uploadMs << " ms" << '\n';
+        }
+    }
+
+    GltfModel::GltfModel(const std::string& path, const GltfLoadOptions& options)
+        : GltfModel(loadGlb(path, options)) {}
+
+    GltfModel::~GltfModel()
+    {
+        for(const DrawPrimitive& primitive : m_Primitives)
+            glDeleteVertexArrays(1, &primitive.vertexArray);
+        glDeleteBuffers(1, &m_Buffer);
+    }
+
+    void GltfModel::draw(const Shader& shader, const glm::mat4& model, const std::string_view modelUniform) const
+    {
+        const int location = shader.getUniformLocation(modelUniform);
+        for(const GltfDrawItem& item : m_DrawItems)
+        {
+            const DrawPrimitive& primitive = m_Primitives[item.primitive];
+            shader.setUniform(location, model * item.transform);
+            glBindVertexArray(primitive.vertexArray);
+            if(primitive.indexed)
+            {
+                glDrawElements(primitive.mode, primitive.count, primitive.indexType,
+                               reinterpret_cast<const void *>( primitive.indexOffset ));
+            } else
+            {
+                glDrawArrays(primitive.mode, 0, primitive.count);
+            }
+        }
+    }
+
+    std::size_t GltfModel::getPrimitiveCount() const { return m_Primitives.size(); }
+    std::size_t GltfModel::getDrawCount() const { return m_DrawItems.size(); }
+    glm::vec3 GltfModel::getBoundsMin() const { return m_BoundsMin; }
+    glm::vec3 GltfModel::getBoundsMax() const { return m_BoundsMax; }
+    const GltfLoadStats& GltfModel::getStats() const { return m_Stats; }
+}
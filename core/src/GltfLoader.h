@@ -0,0 +1,135 @@
+#pragma once
+#include <glad/gl.h>
+#include <MappedFile.h>
+#include <Shader.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace core
+{
+    struct GltfLoadOptions
+    {
+        // Threads used to decode accessors that can't be uploaded as they are (0 = hardware threads)
+        unsigned int workerThreads = 0;
+        bool logStats = true;
+    };
+
+    struct GltfLoadStats
+    {
+        std::size_t fileBytes = 0;
+        std::size_t uploadBytes = 0;     // bytes handed to the GPU, straight from the mapping where possible
+        std::size_t convertedAccessors = 0;// sparse / byte index accessors that had to be decoded
+        unsigned int decodeThreads = 0;
+        double parseMs = 0.0;
+        double decodeMs = 0.0;
+        double uploadMs = 0.0;
+    };
+
+    // One vertex attribute read from a range of the upload buffer
+    struct GltfAttribute
+    {
+        unsigned int location = 0;// POSITION 0, NORMAL 1, TEXCOORD_0 2, TANGENT 3, COLOR_0 4
+        int components = 0;
+        unsigned int type = GL_FLOAT;
+        bool normalized = false;
+        std::size_t range = 0;    // index into GltfAsset::ranges
+        std::size_t offset = 0;   // byte offset inside that range
+        unsigned int stride = 0;
+    };
+
+    struct GltfPrimitive
+    {
+        std::vector<GltfAttribute> attributes;
+        unsigned int mode = GL_TRIANGLES;
+        std::size_t vertexCount = 0;
+        bool indexed = false;
+        unsigned int indexType = GL_UNSIGNED_INT;
+        std::size_t indexCount = 0;
+        std::size_t indexRange = 0;
+        std::size_t indexOffset = 0;
+        glm::vec3 boundsMin = glm::vec3(0.0f);
+        glm::vec3 boundsMax = glm::vec3(0.0f);
+    };
+
+    // A primitive placed in the scene, nodes that reuse a mesh share its primitives
+    struct GltfDrawItem
+    {
+        std::size_t primitive = 0;
+        glm::mat4 transform = glm::mat4(1.0f);
+    };
+
+    /* CPU side of a .glb file, safe to build on any thread.
+     * ranges point either into the mapped BIN chunk or into decoded, so data the GPU
+     * can read as it is never gets copied on the way to the buffer. */
+    struct GltfAsset
+    {
+        MappedFile file;
+        std::vector<std::span<const std::byte>> ranges;
+        std::vector<std::vector<std::byte>> decoded;
+        std::vector<GltfPrimitive> primitives;
+        std::vector<GltfDrawItem> drawItems;
+        GltfLoadStats stats;
+        bool logStats = true;
+    };
+
+    /* Memory-maps a binary glTF 2.0 file and parses its JSON chunk.
+     * Only bufferViews used by mesh accessors end up in ranges. Sparse accessors and
+     * unsigned byte indices are decoded in parallel, everything else stays in the mapping.
+     * Throws std::runtime_error for anything that isn't a valid .glb. */
+    GltfAsset loadGlb(const std::string& path, const GltfLoadOptions& options = {});
+
+    /* GPU copy of a GltfAsset: one immutable buffer filled range by range from the mapping
+     * and a vertex array per primitive, with one binding per attribute as glTF stores
+     * attributes in separate (or interleaved) bufferViews. Has to be made on the GL thread. */
+    class GltfModel
+    {
+    private:
+        struct DrawPrimitive
+        {
+            unsigned int vertexArray = 0;
+            unsigned int mode = GL_TRIANGLES;
+            bool indexed = false;
+            unsigned int indexType = GL_UNSIGNED_INT;
+            int count = 0;
+            std::size_t indexOffset = 0;
+        };
+
+        unsigned int m_Buffer = 0;
+        std::vector<DrawPrimitive> m_Primitives;
+        std::vector<GltfDrawItem> m_DrawItems;
+        glm::vec3 m_BoundsMin = glm::vec3(0.0f);
+        glm::vec3 m_BoundsMax = glm::vec3(0.0f);
+        GltfLoadStats m_Stats;
+
+    public:
+        explicit GltfModel(const GltfAsset& asset);
+
+        // Loads and uploads in one go
+        explicit GltfModel(const std::string& path, const GltfLoadOptions& options = {});
+
+        GltfModel(const GltfModel&) = delete;
+
+        GltfModel& operator=(const GltfModel&) = delete;
+
+        ~GltfModel();
+
+        // Draws every primitive, setting modelUniform to model * node transform for each one
+        void draw(const Shader& shader, const glm::mat4& model = glm::mat4(1.0f),
+                  std::string_view modelUniform = "model") const;
+
+        [[nodiscard]] std::size_t getPrimitiveCount() const;
+
+        [[nodiscard]] std::size_t getDrawCount() const;
+
+        // Scene bounds in model space, with node transforms applied
+        [[nodiscard]] glm::vec3 getBoundsMin() const;
+
+        [[nodiscard]] glm::vec3 getBoundsMax() const;
+
+        [[nodiscard]] const GltfLoadStats& getStats() const;
+    };
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <glad/gl.h>
+#include <algorithm>
+#include <cstddef>
+
+namespace core::detail
+{
+    /* Buffer helpers shared by the compute culling classes (GpuCuller, ClusterCuller), not
+     * part of the engine's interface. */
+
+    // Immutable storage the CPU can update with glNamedBufferSubData. glNamedBufferStorage rejects
+    // a size of 0, so tiny buffers get 4 bytes and data is uploaded separately to not read past it
+    inline unsigned int createBuffer(const std::size_t size, const void* data = nullptr)
+    {
+        unsigned int buffer = 0;
+        glCreateBuffers(1, &buffer);
+        const std::size_t storage = std::max<std::size_t>(size, 4);
+        glNamedBufferStorage(buffer, static_cast<GLsizeiptr>( storage ), storage == size ? data : nullptr, GL_DYNAMIC_STORAGE_BIT);
+        if(storage != size && size > 0 && data != nullptr) glNamedBufferSubData(buffer, 0, static_cast<GLsizeiptr>( size ), data);
+        return buffer;
+    }
+
+    // Zeroes a range of 32 bit counters
+    inline void clearBuffer(const unsigned int buffer, const std::size_t offset, const std::size_t size)
+    {
+        glClearNamedBufferSubData(buffer, GL_R32UI, static_cast<GLintptr>( offset ), static_cast<GLsizeiptr>( size ),
+                                  GL_RED_INTEGER, GL_UNSIGNED_INT, nullptr);
+    }
+
+    inline void deleteBuffer(unsigned int& buffer)
+    {
+        if(buffer != 0) glDeleteBuffers(1, &buffer);
+        buffer = 0;
+    }
+}
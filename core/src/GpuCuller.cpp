@@ -0,0 +1,142 @@
+#include <GpuCuller.h>
+#include <Geometry.h>
+#include <GpuBuffers.h>
+#include <algorithm>
+
+namespace core
+{
+    using detail::clearBuffer;
+    using detail::createBuffer;
+    using detail::deleteBuffer;
+
+    namespace
+    {
+        constexpr std::uint32_t GroupSize = 64;// matches local_size_x in cull.comp
+
+        // Shader storage bindings, the same numbers as in cull.comp
+        enum Binding : GLuint { Instances = 0, Meshes = 1, Commands = 2, Counts = 3, Visibility = 4 };
+    }
+
+    GpuCuller::GpuCuller(const char* shaderPath)
+        : m_Shader(GL_COMPUTE_SHADER, shaderPath)
+    {
+        m_CountBuffer = createBuffer(2 * sizeof(std::uint32_t));
+        clearBuffer(m_CountBuffer, 0, 2 * sizeof(std::uint32_t));
+        for(unsigned int& buffer : m_StatsBuffers)
+        {
+            buffer = createBuffer(2 * sizeof(std::uint32_t));
+            clearBuffer(buffer, 0, 2 * sizeof(std::uint32_t));
+        }
+    }
+
+    GpuCuller::~GpuCuller()
+    {
+        for(unsigned int* buffer : { &m_InstanceBuffer, &m_MeshBuffer, &m_CommandBuffer, &m_CountBuffer, &m_VisibilityBuffer })
+            deleteBuffer(*buffer);
+        glDeleteBuffers(static_cast<GLsizei>( m_StatsBuffers.size() ), m_StatsBuffers.data());
+    }
+
+    void GpuCuller::setMeshes(const std::span<const GpuMeshRange> meshes)
+    {
+        deleteBuffer(m_MeshBuffer);
+        m_MeshBuffer = createBuffer(meshes.size_bytes(), meshes.data());
+        m_MeshCount = meshes.size();
+    }
+
+    void GpuCuller::setInstances(const std::span<const GpuInstance> instances)
+    {
+        if(instances.size() > m_Capacity)
+        {
+            for(unsigned int* buffer : { &m_InstanceBuffer, &m_CommandBuffer, &m_VisibilityBuffer })
+                deleteBuffer(*buffer);
+
+            m_Capacity = std::max(instances.size(), m_Capacity * 2);
+            m_InstanceBuffer = createBuffer(m_Capacity * sizeof(GpuInstance));
+            m_CommandBuffer = createBuffer(2 * m_Capacity * sizeof(DrawElementsIndirectCommand));
+            // Nothing was visible, the first Late pass finds everything
+            m_VisibilityBuffer = createBuffer(m_Capacity * sizeof(std::uint32_t));
+            clearBuffer(m_VisibilityBuffer, 0, m_Capacity * sizeof(std::uint32_t));
+        }
+
+        m_InstanceCount = instances.size();
+        if(!instances.empty()) glNamedBufferSubData(m_InstanceBuffer, 0, static_cast<GLsizeiptr>( instances.size_bytes() ), instances.data());
+    }
+
+    void GpuCuller::updateInstances(const std::size_t first, const std::span<const GpuInstance> instances)
+    {
+        if(instances.empty() || first + instances.size() > m_InstanceCount) return;
+        glNamedBufferSubData(m_InstanceBuffer, static_cast<GLintptr>( first * sizeof(GpuInstance) ),
+                             static_cast<GLsizeiptr>( instances.size_bytes() ), instances.data());
+    }
+
+    void GpuCuller::cull(const CullPhase phase, const glm::mat4& viewProjection, const HiZPyramid* hiZ)
+    {
+        const std::uint32_t target = region(phase);
+        clearBuffer(m_CountBuffer, target * sizeof(std::uint32_t), sizeof(std::uint32_t));
+        if(m_InstanceCount == 0 || m_MeshCount == 0) return;
+
+        const Frustum frustum = Frustum::fromMatrix(viewProjection);
+        const bool occlusion = hiZ != nullptr && hiZ->getTexture() != 0 && phase != CullPhase::Early;
+
+        const unsigned int program = m_Shader.getProgramID();
+        glUseProgram(program);
+        m_Shader.setUniform("viewProjection", viewProjection);
+        glProgramUniform4fv(program, m_Shader.getUniformLocation("frustumPlanes"), 6, &frustum.planes[0].x);
+        m_Shader.setUniform("instanceCount", static_cast<unsigned int>( m_InstanceCount ));
+        m_Shader.setUniform("phase", static_cast<unsigned int>( phase ));
+        m_Shader.setUniform("commandOffset", static_cast<unsigned int>( target * m_Capacity ));
+        m_Shader.setUniform("countSlot", target);
+        m_Shader.setUniform("testOcclusion", occlusion);
+        if(occlusion)
+        {
+            glBindTextureUnit(0, hiZ->getTexture());
+            m_Shader.setUniform("hiZSize", glm::ivec2(hiZ->getWidth(), hiZ->getHeight()));
+            m_Shader.setUniform("hiZLevels", hiZ->getLevels());
+        }
+
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, Instances, m_InstanceBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, Meshes, m_MeshBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, Commands, m_CommandBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, Counts, m_CountBuffer);
+        glBindBufferBase(GL_SHADER_STORAGE_BUFFER, Visibility, m_VisibilityBuffer);
+
+        const auto groups = static_cast<GLuint>( (m_InstanceCount + GroupSize - 1) / GroupSize );
+        glDispatchCompute(groups, 1, 1);
+
+        // The commands and counts are read by the indirect draw, the visibility by the next pass
+        glMemoryBarrier(GL_COMMAND_BARRIER_BIT | GL_SHADER_STORAGE_BARRIER_BIT);
+        glUseProgram(0);
+    }
+
+    void GpuCuller::draw(const CullPhase phase, const unsigned int indexType) const
+    {
+        if(m_InstanceCount == 0) return;
+
+        const std::uint32_t source = region(phase);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_CommandBuffer);
+        glBindBuffer(GL_PARAMETER_BUFFER, m_CountBuffer);
+        // The GPU stops at the count the cull wrote, the CPU only knows the upper bound
+        glMultiDrawElementsIndirectCount(GL_TRIANGLES, indexType,
+                                         reinterpret_cast<const void *>( source * m_Capacity * sizeof(DrawElementsIndirectCommand) ),
+                                         static_cast<GLintptr>( source * sizeof(std::uint32_t) ),
+                                         static_cast<GLsizei>( m_InstanceCount ), sizeof(DrawElementsIndirectCommand));
+        glBindBuffer(GL_PARAMETER_BUFFER, 0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    }
+
+    void GpuCuller::endFrame()
+    {
+        glCopyNamedBufferSubData(m_CountBuffer, m_StatsBuffers[m_Frame % StatsFrames], 0, 0, 2 * sizeof(std::uint32_t));
+        m_Frame++;
+    }
+
+    std::array<std::uint32_t, 2> GpuCuller::getDrawCounts() const
+    {
+        std::array<std::uint32_t, 2> counts{};
+        if(m_Frame < StatsFrames) return counts;
+
+        // The oldest snapshot, written StatsFrames - 1 frames ago
+        glGetNamedBufferSubData(m_StatsBuffers[m_Frame % StatsFrames], 0, sizeof(counts), counts.data());
+        return counts;
+    }
+}
@@ -0,0 +1,109 @@
+#pragma once
+#include <glad/gl.h>
+#include <HiZPyramid.h>
+#include <ShaderStage.h>
+#include <glm/glm.hpp>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace core
+{
+    // GL's indirect indexed draw, tightly packed (20 bytes)
+    struct DrawElementsIndirectCommand
+    {
+        std::uint32_t count;
+        std::uint32_t instanceCount;
+        std::uint32_t firstIndex;
+        std::int32_t baseVertex;
+        std::uint32_t baseInstance;
+    };
+
+    // Where a mesh sits in the shared vertex and index buffers, std430 layout
+    struct GpuMeshRange
+    {
+        std::uint32_t indexCount = 0;
+        std::uint32_t firstIndex = 0;
+        std::int32_t baseVertex = 0;
+        std::uint32_t padding = 0;
+    };
+
+    // World space bounds and mesh of one instance, std430 layout (vec3 + uint twice)
+    struct GpuInstance
+    {
+        glm::vec3 boundsMin;
+        std::uint32_t mesh;
+        glm::vec3 boundsMax;
+        std::uint32_t padding = 0;
+    };
+
+    static_assert(sizeof(DrawElementsIndirectCommand) == 20, "DrawElementsIndirectCommand must match GL's layout");
+    static_assert(sizeof(GpuInstance) == 32, "GpuInstance must match the std430 struct in cull.comp");
+
+    /* All: every instance in one pass. Early and Late are the two halves of a two-phase frame:
+     * Early draws what was visible last frame (frustum test only), then the caller builds the
+     * Hi-Z from that depth, and Late tests everything against it, drawing only what Early
+     * missed and remembering the result for the next frame's Early. */
+    enum class CullPhase : std::uint32_t { All, Early, Late };
+
+    /* GPU-driven culling: a compute pass tests every instance's bounds against the frustum and
+     * optionally a HiZPyramid, and appends a DrawElementsIndirectCommand for each survivor with
+     * an atomic counter, which draw() hands to glMultiDrawElementsIndirectCount. The CPU cost
+     * per frame is a few calls, whatever the instance count.
+     * Commands carry the instance's index as baseInstance, the vertex shader fetches its own
+     * per-instance data with gl_BaseInstance. All meshes share one vertex and index buffer
+     * (the bound VAO), GpuMeshRange says where each one is. */
+    class GpuCuller
+    {
+    private:
+        static constexpr std::size_t StatsFrames = 3;
+
+        ShaderStage m_Shader;
+        unsigned int m_InstanceBuffer = 0;
+        unsigned int m_MeshBuffer = 0;
+        unsigned int m_CommandBuffer = 0;   // two regions of m_Capacity commands, All/Early and Late
+        unsigned int m_CountBuffer = 0;     // one draw count per region
+        unsigned int m_VisibilityBuffer = 0;// last frame's result per instance, for Early
+        std::array<unsigned int, StatsFrames> m_StatsBuffers{};
+        std::size_t m_Capacity = 0;
+        std::size_t m_InstanceCount = 0;
+        std::size_t m_MeshCount = 0;
+        std::size_t m_Frame = 0;
+
+        static std::uint32_t region(CullPhase phase) { return phase == CullPhase::Late ? 1 : 0; }
+
+    public:
+        // shaderPath is the culling compute shader, see core/shaders/cull.comp
+        explicit GpuCuller(const char* shaderPath);
+
+        GpuCuller(const GpuCuller&) = delete;
+
+        GpuCuller& operator=(const GpuCuller&) = delete;
+
+        ~GpuCuller();
+
+        void setMeshes(std::span<const GpuMeshRange> meshes);
+
+        // Replaces every instance, the buffers grow as needed. Growing forgets last frame's visibility
+        void setInstances(std::span<const GpuInstance> instances);
+
+        // Overwrites instances [first, first + instances.size()), for objects that moved
+        void updateInstances(std::size_t first, std::span<const GpuInstance> instances);
+
+        // hiZ nullptr tests the frustum only. Early never reads it
+        void cull(CullPhase phase, const glm::mat4& viewProjection, const HiZPyramid* hiZ);
+
+        // Draws what the last cull() of this phase kept, with the caller's VAO and program bound
+        void draw(CullPhase phase, unsigned int indexType) const;
+
+        // Snapshots this frame's draw counts for getDrawCounts(), call once after the last draw
+        void endFrame();
+
+        /* Draw counts of the two regions (All or Early, then Late) from a few frames back, so
+         * reading them doesn't wait on the GPU. */
+        [[nodiscard]] std::array<std::uint32_t, 2> getDrawCounts() const;
+
+        [[nodiscard]] std::size_t getInstanceCount() const { return m_InstanceCount; }
+    };
+}
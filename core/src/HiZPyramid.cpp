@@ -0,0 +1,71 @@
+#include <HiZPyramid.h>
+#include <glm/glm.hpp>
+#include <algorithm>
+#include <bit>
+
+namespace core
+{
+    namespace
+    {
+        constexpr int GroupSize = 8;// matches local_size_x/y in hiz.comp
+
+        int groupCount(const int size)
+        {
+            return (size + GroupSize - 1) / GroupSize;
+        }
+    }
+
+    HiZPyramid::HiZPyramid(const char* shaderPath)
+        : m_Shader(GL_COMPUTE_SHADER, shaderPath) {}
+
+    HiZPyramid::~HiZPyramid()
+    {
+        if(m_Texture != 0) glDeleteTextures(1, &m_Texture);
+    }
+
+    void HiZPyramid::allocate(const int width, const int height)
+    {
+        if(m_Texture != 0) glDeleteTextures(1, &m_Texture);
+
+        m_Width = width;
+        m_Height = height;
+        // Down to 1x1, so any rectangle fits in 2x2 texels of some level
+        m_Levels = std::bit_width(static_cast<unsigned int>( std::max(width, height) ));
+
+        glCreateTextures(GL_TEXTURE_2D, 1, &m_Texture);
+        glTextureStorage2D(m_Texture, m_Levels, GL_R32F, width, height);
+        glTextureParameteri(m_Texture, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+        glTextureParameteri(m_Texture, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+        glTextureParameteri(m_Texture, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTextureParameteri(m_Texture, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    }
+
+    void HiZPyramid::build(const unsigned int depthTexture, const int width, const int height)
+    {
+        if(width <= 0 || height <= 0) return;
+        if(width != m_Width || height != m_Height) allocate(width, height);
+
+        glUseProgram(m_Shader.getProgramID());
+        glBindTextureUnit(0, depthTexture);
+
+        glm::ivec2 sourceSize(width, height);
+        for(int level = 0; level < m_Levels; level++)
+        {
+            const glm::ivec2 size(std::max(1, width >> level), std::max(1, height >> level));
+            m_Shader.setUniform("level", level);
+            m_Shader.setUniform("sourceSize", sourceSize);
+            m_Shader.setUniform("destinationSize", size);
+
+            // Level 0 reads the depth texture, every other level the one below it
+            if(level > 0) glBindImageTexture(0, m_Texture, level - 1, GL_FALSE, 0, GL_READ_ONLY, GL_R32F);
+            glBindImageTexture(1, m_Texture, level, GL_FALSE, 0, GL_WRITE_ONLY, GL_R32F);
+            glDispatchCompute(static_cast<GLuint>( groupCount(size.x) ), static_cast<GLuint>( groupCount(size.y) ), 1);
+            glMemoryBarrier(GL_SHADER_IMAGE_ACCESS_BARRIER_BIT);
+            sourceSize = size;
+        }
+
+        // The culling pass reads the chain with texelFetch
+        glMemoryBarrier(GL_TEXTURE_FETCH_BARRIER_BIT);
+        glUseProgram(0);
+    }
+}
@@ -0,0 +1,45 @@
+#pragma once
+#include <glad/gl.h>
+#include <ShaderStage.h>
+
+namespace core
+{
+    /* Hierarchical depth: an R32F mip chain where every texel holds the farthest depth of the
+     * texels under it. Level 0 is a copy of the depth buffer, each level after that is built
+     * from the one before by a compute pass (the shader at shaderPath, see core/shaders/hiz.comp).
+     * Odd sizes fold the leftover row or column into the last texel, so every level covers the
+     * whole depth buffer.
+     * A box whose nearest depth is farther than the chain's value over its screen rectangle is
+     * hidden, and the right level makes that at most four texel reads. */
+    class HiZPyramid
+    {
+    private:
+        ShaderStage m_Shader;
+        unsigned int m_Texture = 0;
+        int m_Width = 0;
+        int m_Height = 0;
+        int m_Levels = 0;
+
+        void allocate(int width, int height);
+
+    public:
+        explicit HiZPyramid(const char* shaderPath);
+
+        HiZPyramid(const HiZPyramid&) = delete;
+
+        HiZPyramid& operator=(const HiZPyramid&) = delete;
+
+        ~HiZPyramid();
+
+        // Rebuilds every level from a depth texture (not a renderbuffer) of this size, reallocating when it changed
+        void build(unsigned int depthTexture, int width, int height);
+
+        [[nodiscard]] unsigned int getTexture() const { return m_Texture; }
+
+        [[nodiscard]] int getWidth() const { return m_Width; }
+
+        [[nodiscard]] int getHeight() const { return m_Height; }
+
+        [[nodiscard]] int getLevels() const { return m_Levels; }
+    };
+}
@@ -1,13 +1,11 @@
 #include <ImageLoader.h>
-#include <filesystem>
+#include <VirtualFileSystem.h>
 #include <iostream>
 #include <string>
 #include <stb_image.h>
 
 namespace core
 {
-    namespace fs = std::filesystem;
-
 
     ImageLoader::ImageLoader(const std::string& filepath)
     {
@@ -24,15 +22,18 @@ namespace core
     {
         unloadImage();
 
-        if(!fs::exists(filepath) || !fs::is_regular_file(filepath))
+        const vfs::FileView file = vfs::get().read(filepath);
+        if(!file)
         {
             std::cerr << "(ERROR) ImageLoader: File does not exist : " << filepath << std::endl;
             return false;
         }
         m_filepath = filepath;
 
+        // Decoded straight from the mapped bytes, wherever the mounts found them
         stbi_set_flip_vertically_on_load(true);
-        m_data = stbi_load(m_filepath.c_str(), & m_width, & m_height, & m_nrChannels, 0);
+        m_data = stbi_load_from_memory(reinterpret_cast<const stbi_uc *>( file.getData().data() ),
+                                       static_cast<int>( file.getSize() ), & m_width, & m_height, & m_nrChannels, 0);
 
         if(m_data == nullptr)
         {
@@ -0,0 +1,256 @@
+#include <JobSystem.h>
+#include <bit>
+#include <iostream>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace core
+{
+    namespace
+    {
+        // Which system the current thread works for, a thread can belong to one at a time
+        thread_local const JobSystem* t_System = nullptr;
+        thread_local int t_Worker = -1;
+
+        // Spins before a worker goes to sleep, cheap jobs arrive in bursts
+        constexpr int IdleSpins = 64;
+    }
+
+    WorkStealingQueue::WorkStealingQueue(const std::size_t capacity)
+    {
+        const std::size_t size = std::bit_ceil(std::max<std::size_t>(capacity, 2));
+        m_Jobs = std::make_unique<std::atomic<Job*>[]>(size);
+        m_Mask = static_cast<std::int64_t>( size ) - 1;
+    }
+
+    bool WorkStealingQueue::push(Job* job)
+    {
+        const std::int64_t bottom = m_Bottom.load(std::memory_order_relaxed);
+        const std::int64_t top = m_Top.load(std::memory_order_acquire);
+        if(bottom - top > m_Mask) return false;
+
+        slot(bottom).store(job, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    Job* WorkStealingQueue::pop()
+    {
+        const std::int64_t bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+        m_Bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t top = m_Top.load(std::memory_order_relaxed);
+
+        if(top > bottom)
+        {
+            m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        Job* job = slot(bottom).load(std::memory_order_relaxed);
+        if(top == bottom)
+        {
+            // Last job, a thief may be taking it at the same time
+            if(!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+                job = nullptr;
+            m_Bottom.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return job;
+    }
+
+    Job* WorkStealingQueue::steal()
+    {
+        std::int64_t top = m_Top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const std::int64_t bottom = m_Bottom.load(std::memory_order_acquire);
+        if(top >= bottom) return nullptr;
+
+        Job* job = slot(top).load(std::memory_order_relaxed);
+        if(!m_Top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            return nullptr;
+        return job;
+    }
+
+    JobSystem::JobSystem(const JobSystemOptions& options)
+    {
+        const unsigned int hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+        const unsigned int threads = (options.threadCount == 0 ? hardwareThreads : options.threadCount) - 1;
+
+        for(unsigned int i = 0; i <= threads; i++)
+        {
+            m_Workers.push_back(std::make_unique<Worker>(options.queueCapacity));
+            m_Workers.back()->random = 0x9E3779B9u * (i + 1);
+        }
+
+        if(t_System != nullptr)
+            std::cerr << "[JobSystem]: This thread already belonged to another job system, it now works for this one" << '\n';
+        t_System = this;
+        t_Worker = 0;
+
+        m_Threads.reserve(threads);
+        for(unsigned int i = 1; i <= threads; i++)
+        {
+            m_Threads.emplace_back(&JobSystem::workerLoop, this, static_cast<int>( i ));
+            if(options.pinThreads) pinThread(m_Threads.back(), i % hardwareThreads);
+        }
+    }
+
+    JobSystem::~JobSystem()
+    {
+        m_Running.store(false);
+        m_Signal.fetch_add(1);
+        m_Signal.notify_all();
+        for(std::thread& thread : m_Threads)
+            thread.join();
+
+        if(t_System == this)
+        {
+            t_System = nullptr;
+            t_Worker = -1;
+        }
+    }
+
+    int JobSystem::currentWorker() const
+    {
+        return t_System == this ? t_Worker : -1;
+    }
+
+    Job* JobSystem::allocateJob(const int worker)
+    {
+        /* A ring twice the deque size. Slots free up out of order (the oldest job can sit at the
+         * top of the deque while newer ones come and go at the bottom), so busy ones are skipped. */
+        Worker& owner = *m_Workers[static_cast<std::size_t>( worker )];
+        for(std::size_t probe = 0; probe < owner.jobCount; probe++)
+        {
+            Job& job = owner.jobs[owner.nextJob];
+            owner.nextJob = (owner.nextJob + 1) % owner.jobCount;
+            if(!job.busy.load(std::memory_order_acquire))
+            {
+                job.busy.store(true, std::memory_order_relaxed);
+                return &job;
+            }
+        }
+        return nullptr;
+    }
+
+    void JobSystem::submit(const int worker, Job* job)
+    {
+        if(!m_Workers[static_cast<std::size_t>( worker )]->queue.push(job))
+        {
+            // The deque is full, running it here is the cheapest kind of back-pressure
+            execute(*job);
+            return;
+        }
+
+        // Sleepers only get a futex wake when there are any, the common case stays a plain store
+        m_Signal.fetch_add(1);
+        if(m_Sleeping.load() > 0) m_Signal.notify_one();
+    }
+
+    Job* JobSystem::findJob(const int worker)
+    {
+        Worker& self = *m_Workers[static_cast<std::size_t>( worker )];
+        if(Job* job = self.queue.pop()) return job;
+
+        // xorshift picks where to start, so thieves don't all hammer the same victim
+        const std::size_t count = m_Workers.size();
+        self.random ^= self.random << 13;
+        self.random ^= self.random >> 17;
+        self.random ^= self.random << 5;
+        const std::size_t start = self.random % count;
+        for(std::size_t i = 0; i < count; i++)
+        {
+            const std::size_t victim = (start + i) % count;
+            if(victim == static_cast<std::size_t>( worker )) continue;
+            if(Job* job = m_Workers[victim]->queue.steal()) return job;
+        }
+        return nullptr;
+    }
+
+    void JobSystem::execute(Job& job)
+    {
+        JobCounter* counter = job.counter;
+        job.function(job);
+        job.busy.store(false, std::memory_order_release);
+        counter->m_Pending.fetch_sub(1, std::memory_order_release);
+    }
+
+    void JobSystem::workerLoop(const int worker)
+    {
+        t_System = this;
+        t_Worker = worker;
+
+        int idle = 0;
+        while(m_Running.load(std::memory_order_relaxed))
+        {
+            if(Job* job = findJob(worker))
+            {
+                execute(*job);
+                idle = 0;
+                continue;
+            }
+
+            if(++idle < IdleSpins)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+
+            // Announce the sleep first, then look once more, so a job pushed in between is never missed
+            m_Sleeping.fetch_add(1);
+            const std::uint32_t signal = m_Signal.load();
+            if(Job* job = findJob(worker))
+            {
+                m_Sleeping.fetch_sub(1);
+                execute(*job);
+                idle = 0;
+                continue;
+            }
+            if(m_Running.load()) m_Signal.wait(signal);
+            m_Sleeping.fetch_sub(1);
+            idle = 0;
+        }
+    }
+
+    void JobSystem::wait(const JobCounter& counter)
+    {
+        const int worker = currentWorker();
+        while(!counter.isDone())
+        {
+            Job* job = worker >= 0 ? findJob(worker) : nullptr;
+            if(job != nullptr) execute(*job);
+            else std::this_thread::yield();
+        }
+    }
+
+    unsigned int JobSystem::getThreadCount() const
+    {
+        return static_cast<unsigned int>( m_Workers.size() );
+    }
+
+    void JobSystem::pinThread(std::thread& thread, const unsigned int core)
+    {
+#if defined(_WIN32)
+        if(SetThreadAffinityMask(thread.native_handle(), DWORD_PTR(1) << core) == 0)
+            std::cerr << "[JobSystem]: Could not pin a worker to core " << core << '\n';
+#elif defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(core, &set);
+        if(pthread_setaffinity_np(thread.native_handle(), sizeof(set), &set) != 0)
+            std::cerr << "[JobSystem]: Could not pin a worker to core " << core << '\n';
+#else
+        // macOS has no hard affinity, the scheduler only takes hints
+        static_cast<void>( thread );
+        static_cast<void>( core );
+#endif
+    }
+}
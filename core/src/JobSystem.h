@@ -0,0 +1,201 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace core
+{
+    class JobSystem;
+
+    // Counts unfinished jobs, JobSystem::wait() runs other jobs until it reaches zero
+    class JobCounter
+    {
+    private:
+        std::atomic<std::uint32_t> m_Pending{ 0 };
+
+        friend class JobSystem;
+
+    public:
+        JobCounter() = default;
+
+        JobCounter(const JobCounter&) = delete;
+
+        JobCounter& operator=(const JobCounter&) = delete;
+
+        [[nodiscard]] bool isDone() const { return m_Pending.load(std::memory_order_acquire) == 0; }
+    };
+
+    // One cache line, the callable is stored inline so submitting a job never allocates
+    struct alignas(64) Job
+    {
+        static constexpr std::size_t DataSize = 40;
+
+        void (*function)(Job&) = nullptr;
+        JobCounter* counter = nullptr;
+        std::atomic<bool> busy{ false };// set by the owning thread, cleared by whoever ran it
+        alignas(std::uint64_t) std::byte data[DataSize];
+    };
+
+    /* Chase-Lev work-stealing deque with a fixed capacity. The owning worker pushes and pops
+     * at the bottom (LIFO, cache warm), other workers steal from the top (FIFO, the oldest and
+     * usually biggest piece of work). Orderings follow Le et al., "Correct and Efficient
+     * Work-Stealing for Weak Memory Models". */
+    class WorkStealingQueue
+    {
+    private:
+        alignas(64) std::atomic<std::int64_t> m_Top{ 0 };
+        alignas(64) std::atomic<std::int64_t> m_Bottom{ 0 };
+        std::unique_ptr<std::atomic<Job*>[]> m_Jobs;
+        std::int64_t m_Mask = 0;
+
+        // top and bottom are signed so pop() can go one below top, masked they are never negative
+        std::atomic<Job*>& slot(const std::int64_t index) const { return m_Jobs[static_cast<std::size_t>( index & m_Mask )]; }
+
+    public:
+        // capacity is rounded up to a power of two
+        explicit WorkStealingQueue(std::size_t capacity);
+
+        WorkStealingQueue(const WorkStealingQueue&) = delete;
+
+        WorkStealingQueue& operator=(const WorkStealingQueue&) = delete;
+
+        // Owner only, false when the deque is full
+        bool push(Job* job);
+
+        // Owner only
+        Job* pop();
+
+        // Any thread, nullptr when empty or when another thief won the race
+        Job* steal();
+    };
+
+    struct JobSystemOptions
+    {
+        // Threads that run jobs, the creating one included (0 = hardware threads, 1 = no workers)
+        unsigned int threadCount = 0;
+        // Pins worker i to logical core i, the creating thread is left where it is
+        bool pinThreads = false;
+        // Jobs each thread can have queued, past that new jobs run inline
+        std::size_t queueCapacity = 4096;
+    };
+
+    /* Work-stealing job system. Every thread, including the one that created the system,
+     * owns a deque and a ring of job slots. Idle workers steal from random victims and sleep
+     * on an atomic once there is nothing left, waiting threads run jobs instead of blocking.
+     * Jobs may be submitted from the creating thread or from inside other jobs, any other
+     * thread runs them inline. */
+    class JobSystem
+    {
+    private:
+        struct alignas(64) Worker
+        {
+            explicit Worker(const std::size_t capacity)
+                : queue(capacity), jobs(std::make_unique<Job[]>(capacity * 2)), jobCount(capacity * 2) {}
+
+            WorkStealingQueue queue;
+            std::unique_ptr<Job[]> jobs;
+            std::size_t jobCount = 0;
+            std::size_t nextJob = 0;
+            std::uint32_t random = 0;
+        };
+
+        std::vector<std::unique_ptr<Worker>> m_Workers;
+        std::vector<std::thread> m_Threads;
+        std::atomic<bool> m_Running{ true };
+        std::atomic<std::uint32_t> m_Signal{ 0 };
+        std::atomic<std::uint32_t> m_Sleeping{ 0 };
+
+        // Index of the calling thread in m_Workers, -1 when it doesn't belong to this system
+        [[nodiscard]] int currentWorker() const;
+
+        // nullptr when every slot of the thread's ring is still queued or running
+        Job* allocateJob(int worker);
+
+        void submit(int worker, Job* job);
+
+        Job* findJob(int worker);
+
+        static void execute(Job& job);
+
+        void workerLoop(int worker);
+
+        static void pinThread(std::thread& thread, unsigned int core);
+
+    public:
+        explicit JobSystem(const JobSystemOptions& options = {});
+
+        JobSystem(const JobSystem&) = delete;
+
+        JobSystem& operator=(const JobSystem&) = delete;
+
+        // Finishes nothing, wait on your counters before the system goes away
+        ~JobSystem();
+
+        // Queues function() to run on any thread, counter is decremented once it has finished
+        template <typename Function>
+        void run(Function&& function, JobCounter& counter);
+
+        // Runs jobs on the calling thread until the counter reaches zero
+        void wait(const JobCounter& counter);
+
+        /* Calls function(begin, end) over [0, count) in chunks of grainSize and waits for all
+         * of them. grainSize 0 splits the range into a few chunks per thread. */
+        template <typename Function>
+        void parallelFor(std::size_t count, std::size_t grainSize, const Function& function);
+
+        // Threads that run jobs, the creating thread included
+        [[nodiscard]] unsigned int getThreadCount() const;
+    };
+
+    template <typename Function>
+    void JobSystem::run(Function&& function, JobCounter& counter)
+    {
+        using Callable = std::decay_t<Function>;
+        static_assert(sizeof(Callable) <= Job::DataSize, "Job captures too much, capture a pointer to the data instead");
+        static_assert(alignof(Callable) <= alignof(std::uint64_t), "Job callable is over-aligned");
+
+        const int worker = currentWorker();
+        Job* job = worker >= 0 ? allocateJob(worker) : nullptr;
+        if(job == nullptr)
+        {
+            function();
+            return;
+        }
+
+        new(job->data) Callable(std::forward<Function>(function));
+        job->function = [](Job& self)
+        {
+            auto* callable = std::launder(reinterpret_cast<Callable *>( self.data ));
+            (*callable)();
+            callable->~Callable();
+        };
+        job->counter = &counter;
+        counter.m_Pending.fetch_add(1, std::memory_order_relaxed);
+        submit(worker, job);
+    }
+
+    template <typename Function>
+    void JobSystem::parallelFor(const std::size_t count, std::size_t grainSize, const Function& function)
+    {
+        if(count == 0) return;
+        if(grainSize == 0) grainSize = std::max<std::size_t>(1, count / (static_cast<std::size_t>( getThreadCount() ) * 4));
+
+        JobCounter counter;
+        const Function* target = &function;
+        // The calling thread keeps the first chunk, the rest can be stolen while it works
+        for(std::size_t begin = grainSize; begin < count; begin += grainSize)
+        {
+            const std::size_t end = std::min(count, begin + grainSize);
+            run([target, begin, end] { (*target)(begin, end); }, counter);
+        }
+        function(std::size_t(0), std::min(count, grainSize));
+        wait(counter);
+    }
+}
@@ -0,0 +1,293 @@
+#include <Json.h>
+#include <charconv>
+#include <stdexcept>
+
+namespace core
+{
+    // Recursive descent over the text, strings are unescaped into the DOM as they are read
+    class JsonParser
+    {
+    private:
+        static constexpr int MaxDepth = 256;
+
+        std::string_view m_Text;
+        std::size_t m_Pos = 0;
+        int m_Depth = 0;
+
+        [[noreturn]] void fail(const char* message) const
+        {
+            throw std::runtime_error("[Json]: " + std::string(message) + " at offset " + std::to_string(m_Pos));
+        }
+
+        void skipWhitespace()
+        {
+            while(m_Pos < m_Text.size())
+            {
+                const char c = m_Text[m_Pos];
+                if(c != ' ' && c != '\t' && c != '\n' && c != '\r') break;
+                m_Pos++;
+            }
+        }
+
+        char peek()
+        {
+            skipWhitespace();
+            if(m_Pos >= m_Text.size()) fail("Unexpected end of input");
+            return m_Text[m_Pos];
+        }
+
+        void expect(const char c)
+        {
+            if(peek() != c) fail("Unexpected character");
+            m_Pos++;
+        }
+
+        void expectLiteral(const std::string_view literal)
+        {
+            if(m_Text.substr(m_Pos, literal.size()) != literal) fail("Invalid literal");
+            m_Pos += literal.size();
+        }
+
+        unsigned int parseHex4()
+        {
+            if(m_Pos + 4 > m_Text.size()) fail("Truncated unicode escape");
+            unsigned int value = 0;
+            const auto [end, error] = std::from_chars(m_Text.data() + m_Pos, m_Text.data() + m_Pos + 4, value, 16);
+            if(error != std::errc{} || end != m_Text.data() + m_Pos + 4) fail("Invalid unicode escape");
+            m_Pos += 4;
+            return value;
+        }
+
+        static void appendUtf8(std::string& out, const unsigned int codePoint)
+        {
+            if(codePoint < 0x80)
+            {
+                out += static_cast<char>( codePoint );
+            } else if(codePoint < 0x800)
+            {
+                out += static_cast<char>( 0xC0 | codePoint >> 6 );
+                out += static_cast<char>( 0x80 | (codePoint & 0x3F) );
+            } else if(codePoint < 0x10000)
+            {
+                out += static_cast<char>( 0xE0 | codePoint >> 12 );
+                out += static_cast<char>( 0x80 | (codePoint >> 6 & 0x3F) );
+                out += static_cast<char>( 0x80 | (codePoint & 0x3F) );
+            } else
+            {
+                out += static_cast<char>( 0xF0 | codePoint >> 18 );
+                out += static_cast<char>( 0x80 | (codePoint >> 12 & 0x3F) );
+                out += static_cast<char>( 0x80 | (codePoint >> 6 & 0x3F) );
+                out += static_cast<char>( 0x80 | (codePoint & 0x3F) );
+            }
+        }
+
+        std::string parseString()
+        {
+            expect('"');
+            std::string out;
+            while(true)
+            {
+                // Copies runs without escapes in one go, which is nearly every glTF string
+                const std::size_t runEnd = m_Text.find_first_of("\"\\", m_Pos);
+                if(runEnd == std::string_view::npos) fail("Unterminated string");
+                out.append(m_Text.substr(m_Pos, runEnd - m_Pos));
+                m_Pos = runEnd + 1;
+                if(m_Text[runEnd] == '"') return out;
+
+                if(m_Pos >= m_Text.size()) fail("Unterminated escape");
+                switch(m_Text[m_Pos++])
+                {
+                    case '"': out += '"'; break;
+                    case '\\': out += '\\'; break;
+                    case '/': out += '/'; break;
+                    case 'b': out += '\b'; break;
+                    case 'f': out += '\f'; break;
+                    case 'n': out += '\n'; break;
+                    case 'r': out += '\r'; break;
+                    case 't': out += '\t'; break;
+                    case 'u':
+                    {
+                        unsigned int codePoint = parseHex4();
+                        // Characters outside the BMP come as a surrogate pair
+                        if(codePoint >= 0xD800 && codePoint < 0xDC00 && m_Text.substr(m_Pos, 2) == "\\u")
+                        {
+                            m_Pos += 2;
+                            const unsigned int low = parseHex4();
+                            if(low < 0xDC00 || low >= 0xE000) fail("Invalid surrogate pair");
+                            codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                        }
+                        appendUtf8(out, codePoint);
+                        break;
+                    }
+                    default: fail("Invalid escape");
+                }
+            }
+        }
+
+        double parseNumber()
+        {
+            double value = 0.0;
+            // from_chars doesn't take a leading '+', which JSON doesn't allow either
+            const auto [end, error] = std::from_chars(m_Text.data() + m_Pos, m_Text.data() + m_Text.size(), value);
+            if(error != std::errc{}) fail("Invalid number");
+            m_Pos = static_cast<std::size_t>( end - m_Text.data() );
+            return value;
+        }
+
+        JsonValue parseValue()
+        {
+            if(++m_Depth > MaxDepth) fail("Document nested too deeply");
+
+            JsonValue result;
+            const char c = peek();
+            if(c == '{')
+            {
+                m_Pos++;
+                JsonValue::Object object;
+                while(peek() != '}')
+                {
+                    std::string key = parseString();
+                    expect(':');
+                    object.emplace_back(std::move(key), parseValue());
+                    if(peek() != ',') break;
+                    m_Pos++;
+                    if(peek() == '}') fail("Trailing comma");
+                }
+                expect('}');
+                result.m_Value = std::move(object);
+            } else if(c == '[')
+            {
+                m_Pos++;
+                JsonValue::Array array;
+                while(peek() != ']')
+                {
+                    array.push_back(parseValue());
+                    if(peek() != ',') break;
+                    m_Pos++;
+                    if(peek() == ']') fail("Trailing comma");
+                }
+                expect(']');
+                result.m_Value = std::move(array);
+            } else if(c == '"')
+            {
+                result.m_Value = parseString();
+            } else if(c == 't')
+            {
+                expectLiteral("true");
+                result.m_Value = true;
+            } else if(c == 'f')
+            {
+                expectLiteral("false");
+                result.m_Value = false;
+            } else if(c == 'n')
+            {
+                expectLiteral("null");
+            } else
+            {
+                result.m_Value = parseNumber();
+            }
+
+            m_Depth--;
+            return result;
+        }
+
+    public:
+        explicit JsonParser(const std::string_view text) : m_Text(text) {}
+
+        JsonValue parseDocument()
+        {
+            JsonValue root = parseValue();
+            skipWhitespace();
+            if(m_Pos != m_Text.size()) fail("Trailing characters after document");
+            return root;
+        }
+    };
+
+    namespace
+    {
+        const JsonValue::Array EmptyArray;
+        const JsonValue::Object EmptyObject;
+    }
+
+    JsonValue JsonValue::parse(const std::string_view text)
+    {
+        return JsonParser(text).parseDocument();
+    }
+
+    JsonValue::Type JsonValue::getType() const { return static_cast<Type>( m_Value.index() ); }
+    bool JsonValue::isNull() const { return std::holds_alternative<std::nullptr_t>(m_Value); }
+    bool JsonValue::isNumber() const { return std::holds_alternative<double>(m_Value); }
+    bool JsonValue::isString() const { return std::holds_alternative<std::string>(m_Value); }
+    bool JsonValue::isArray() const { return std::holds_alternative<Array>(m_Value); }
+    bool JsonValue::isObject() const { return std::holds_alternative<Object>(m_Value); }
+
+    const JsonValue* JsonValue::find(const std::string_view key) const
+    {
+        const auto* object = std::get_if<Object>(&m_Value);
+        if(object == nullptr) return nullptr;
+        for(const auto& [name, value] : *object)
+        {
+            if(name == key) return &value;
+        }
+        return nullptr;
+    }
+
+    std::size_t JsonValue::size() const
+    {
+        if(const auto* array = std::get_if<Array>(&m_Value)) return array->size();
+        if(const auto* object = std::get_if<Object>(&m_Value)) return object->size();
+        return 0;
+    }
+
+    const JsonValue& JsonValue::operator[](const std::size_t index) const
+    {
+        const auto* array = std::get_if<Array>(&m_Value);
+        if(array == nullptr || index >= array->size())
+        {
+            throw std::runtime_error("[Json]: Array index " + std::to_string(index) + " out of range");
+        }
+        return (*array)[index];
+    }
+
+    bool JsonValue::asBool(const bool fallback) const
+    {
+        const auto* value = std::get_if<bool>(&m_Value);
+        return value != nullptr ? *value : fallback;
+    }
+
+    double JsonValue::asNumber(const double fallback) const
+    {
+        const auto* value = std::get_if<double>(&m_Value);
+        return value != nullptr ? *value : fallback;
+    }
+
+    std::string_view JsonValue::asString(const std::string_view fallback) const
+    {
+        const auto* value = std::get_if<std::string>(&m_Value);
+        return value != nullptr ? std::string_view(*value) : fallback;
+    }
+
+    double JsonValue::getNumber(const std::string_view key, const double fallback) const
+    {
+        const JsonValue* value = find(key);
+        return value != nullptr ? value->asNumber(fallback) : fallback;
+    }
+
+    std::string_view JsonValue::getString(const std::string_view key, const std::string_view fallback) const
+    {
+        const JsonValue* value = find(key);
+        return value != nullptr ? value->asString(fallback) : fallback;
+    }
+
+    const JsonValue::Array& JsonValue::getArray() const
+    {
+        const auto* array = std::get_if<Array>(&m_Value);
+        return array != nullptr ? *array : EmptyArray;
+    }
+
+    const JsonValue::Object& JsonValue::getObject() const
+    {
+        const auto* object = std::get_if<Object>(&m_Value);
+        return object != nullptr ? *object : EmptyObject;
+    }
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace core
+{
+    /* Small read-only JSON document, enough for asset manifests and glTF headers.
+     * Objects keep their members in file order and are searched linearly, which is
+     * faster than hashing for the handful of keys a glTF object has. */
+    class JsonValue
+    {
+    public:
+        enum class Type { Null, Bool, Number, String, Array, Object };
+
+        using Array = std::vector<JsonValue>;
+        using Object = std::vector<std::pair<std::string, JsonValue>>;
+
+    private:
+        std::variant<std::nullptr_t, bool, double, std::string, Array, Object> m_Value;
+
+        friend class JsonParser;
+
+    public:
+        JsonValue() = default;
+
+        // Parses a whole document, throws std::runtime_error with the offset of the first error
+        static JsonValue parse(std::string_view text);
+
+        [[nodiscard]] Type getType() const;
+
+        [[nodiscard]] bool isNull() const;
+
+        [[nodiscard]] bool isNumber() const;
+
+        [[nodiscard]] bool isString() const;
+
+        [[nodiscard]] bool isArray() const;
+
+        [[nodiscard]] bool isObject() const;
+
+        // Member lookup, nullptr when this isn't an object or the key is missing
+        [[nodiscard]] const JsonValue* find(std::string_view key) const;
+
+        // Array element or object member count, 0 for everything else
+        [[nodiscard]] std::size_t size() const;
+
+        // Array element, throws when out of range or not an array
+        [[nodiscard]] const JsonValue& operator[](std::size_t index) const;
+
+        [[nodiscard]] bool asBool(bool fallback = false) const;
+
+        [[nodiscard]] double asNumber(double fallback = 0.0) const;
+
+        [[nodiscard]] std::string_view asString(std::string_view fallback = {}) const;
+
+        // Shorthands for optional members, e.g. accessor.getNumber("byteOffset", 0)
+        [[nodiscard]] double getNumber(std::string_view key, double fallback = 0.0) const;
+
+        [[nodiscard]] std::string_view getString(std::string_view key, std::string_view fallback = {}) const;
+
+        // Empty when this isn't an array/object
+        [[nodiscard]] const Array& getArray() const;
+
+        [[nodiscard]] const Object& getObject() const;
+    };
+}
@@ -0,0 +1,88 @@
+#include <LodSelector.h>
+#include <algorithm>
+#include <cmath>
+
+namespace core
+{
+    namespace
+    {
+        LodSelector* s_MainSelector = nullptr;
+    }
+
+    std::size_t LodStats::getTotalTriangles() const
+    {
+        std::size_t total = 0;
+        for(std::size_t level = 0; level < levelCount; level++)
+            total += triangles[level];
+        return total;
+    }
+
+    LodSelector::LodSelector(const LodSelectorOptions& options)
+        : m_Options(options) {}
+
+    LodSelector::~LodSelector()
+    {
+        if(s_MainSelector == this) s_MainSelector = nullptr;
+    }
+
+    void LodSelector::beginFrame(const Camera& camera, const int framebufferHeight, const float zNear)
+    {
+        m_Stats = m_Frame;
+        m_Frame = {};
+
+        m_CamPos = camera.getCamPos();
+        m_MinDistance = zNear;
+        // The vertical FOV spans the framebuffer's height at every distance
+        const float halfFov = glm::radians(camera.getFOV()) * 0.5f;
+        m_PixelsPerUnit = static_cast<float>( framebufferHeight ) / (2.0f * std::tan(halfFov));
+    }
+
+    std::size_t LodSelector::select(const ObjectId id, const std::span<const MeshLod> lods, const Sphere& bounds, const float scale)
+    {
+        if(id >= m_Current.size()) m_Current.resize(static_cast<std::size_t>( id ) + 1, Unselected);
+
+        const std::size_t count = std::min(std::max<std::size_t>(lods.size(), 1), MaxLodLevels);
+        // Nearest point of the bounds, so large objects don't coarsen while the camera is beside them
+        const float distance = std::max(glm::length(bounds.center - m_CamPos) - bounds.radius, m_MinDistance);
+        auto screenError = [&](const std::size_t level)
+        {
+            return projectError(lods[level].error * scale, distance);
+        };
+
+        const bool first = m_Current[id] == Unselected;
+        std::size_t level = first ? 0 : std::min<std::size_t>(m_Current[id], count - 1);
+        const float coarsenBelow = first ? m_Options.pixelThreshold : m_Options.pixelThreshold * (1.0f - m_Options.hysteresis);
+        const float refineAbove = m_Options.pixelThreshold * (1.0f + m_Options.hysteresis);
+
+        // Errors grow with the level, so walking from the current level is enough
+        while(level + 1 < count && screenError(level + 1) <= coarsenBelow)
+            level++;
+        while(level > 0 && screenError(level) > refineAbove)
+            level--;
+
+        if(!first && level != m_Current[id]) m_Frame.switches++;
+        m_Current[id] = static_cast<std::uint8_t>( level );
+
+        m_Frame.objects[level]++;
+        if(!lods.empty()) m_Frame.triangles[level] += lods[level].indexCount / 3;
+        m_Frame.levelCount = std::max(m_Frame.levelCount, level + 1);
+        return level;
+    }
+
+    float LodSelector::projectError(const float error, const float distance) const
+    {
+        return error * m_PixelsPerUnit / distance;
+    }
+
+    void LodSelector::reset()
+    {
+        std::fill(m_Current.begin(), m_Current.end(), Unselected);
+    }
+
+    void LodSelector::setOptions(const LodSelectorOptions& options) { m_Options = options; }
+    const LodSelectorOptions& LodSelector::getOptions() const { return m_Options; }
+    const LodStats& LodSelector::getStats() const { return m_Stats; }
+
+    LodSelector* LodSelector::getMain() { return s_MainSelector; }
+    void LodSelector::setMain(LodSelector* selector) { s_MainSelector = selector; }
+}
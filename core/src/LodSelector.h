@@ -0,0 +1,88 @@
+#pragma once
+#include <Camera.h>
+#include <Geometry.h>
+#include <MeshBuilder.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace core
+{
+    struct LodSelectorOptions
+    {
+        // Largest projected geometric error allowed on screen, in pixels
+        float pixelThreshold = 1.0f;
+        /* Fraction of the threshold the error has to cross before the level changes: coarser
+         * below threshold * (1 - hysteresis), finer above threshold * (1 + hysteresis). Stops
+         * objects at the boundary from flickering between two levels. */
+        float hysteresis = 0.25f;
+    };
+
+    // One frame of selections, per level
+    struct LodStats
+    {
+        std::array<std::size_t, MaxLodLevels> objects{};
+        std::array<std::size_t, MaxLodLevels> triangles{};
+        std::size_t levelCount = 0;// one past the coarsest level selected
+        std::size_t switches = 0;  // objects that changed level this frame
+
+        [[nodiscard]] std::size_t getTotalTriangles() const;
+    };
+
+    /* Picks a level of detail per object from its MeshLod chain: each level's error is
+     * projected to pixels at the object's distance, the coarsest level under the threshold
+     * wins. Objects are identified by a caller chosen dense index, which keeps their current
+     * level for the hysteresis. */
+    class LodSelector
+    {
+    public:
+        using ObjectId = std::uint32_t;
+
+    private:
+        static constexpr std::uint8_t Unselected = 0xFF;
+
+        LodSelectorOptions m_Options;
+        glm::vec3 m_CamPos = glm::vec3(0.0f);
+        float m_PixelsPerUnit = 0.0f;// screen height in pixels of one unit at distance one
+        float m_MinDistance = 0.1f;
+        std::vector<std::uint8_t> m_Current;
+        LodStats m_Frame;
+        LodStats m_Stats;
+
+    public:
+        explicit LodSelector(const LodSelectorOptions& options = {});
+
+        LodSelector(const LodSelector&) = delete;
+
+        LodSelector& operator=(const LodSelector&) = delete;
+
+        ~LodSelector();
+
+        // Takes the camera for this frame and publishes the previous frame's stats
+        void beginFrame(const Camera& camera, int framebufferHeight, float zNear = 0.1f);
+
+        /* Level for an object with world space bounds, whose model matrix scales by at most
+         * scale (the lods' errors are in model units). */
+        std::size_t select(ObjectId id, std::span<const MeshLod> lods, const Sphere& bounds, float scale = 1.0f);
+
+        // Pixels a model space error covers at a distance
+        [[nodiscard]] float projectError(float error, float distance) const;
+
+        // Forgets every object's current level, the next selection skips the hysteresis
+        void reset();
+
+        void setOptions(const LodSelectorOptions& options);
+
+        [[nodiscard]] const LodSelectorOptions& getOptions() const;
+
+        // The last finished frame
+        [[nodiscard]] const LodStats& getStats() const;
+
+        // The selector the FPS overlay reports, nullptr if none. The selector unregisters itself when destroyed
+        [[nodiscard]] static LodSelector* getMain();
+
+        static void setMain(LodSelector* selector);
+    };
+}
@@ -0,0 +1,234 @@
+#include <LooseOctree.h>
+#include <algorithm>
+#include <cmath>
+
+namespace core
+{
+    namespace
+    {
+        constexpr std::uint32_t InsideFlag = 0x80000000u;
+
+        thread_local std::vector<std::uint32_t> t_Stack;
+
+        Aabb looseBounds(const LooseOctreeNode& node)
+        {
+            const glm::vec3 reach(node.halfSize * 2.0f);
+            return { node.center - reach, node.center + reach };
+        }
+    }
+
+    LooseOctree::LooseOctree(const LooseOctreeOptions& options)
+        : m_Options(options)
+    {
+        // The root is a cube around the world bounds
+        const glm::vec3 extents = options.worldBounds.getExtents();
+        LooseOctreeNode root{};
+        root.center = options.worldBounds.getCenter();
+        root.halfSize = std::max(std::max(extents.x, extents.y), extents.z);
+        root.parent = 0;
+        m_Nodes.push_back(root);
+        m_NodeObjects.emplace_back();
+    }
+
+    std::uint32_t LooseOctree::findNode(const Aabb& bounds)
+    {
+        const glm::vec3 center = bounds.getCenter();
+        const glm::vec3 extents = bounds.getExtents();
+        const float size = std::max(std::max(extents.x, extents.y), extents.z);
+
+        const glm::vec3 offset = glm::abs(center - m_Nodes[0].center);
+        if(std::max(std::max(offset.x, offset.y), offset.z) > m_Nodes[0].halfSize) return 0;
+
+        // A child's loose bounds reach a whole child cell past its own, enough for anything no bigger than that cell
+        std::uint32_t node = 0;
+        while(m_Nodes[node].depth < m_Options.maxDepth)
+        {
+            const float childHalf = m_Nodes[node].halfSize * 0.5f;
+            if(size > childHalf) break;
+
+            const glm::vec3 nodeCenter = m_Nodes[node].center;
+            const std::uint32_t octant = (center.x >= nodeCenter.x ? 1u : 0u) | (center.y >= nodeCenter.y ? 2u : 0u) |
+                                         (center.z >= nodeCenter.z ? 4u : 0u);
+            if(m_Nodes[node].children[octant] == LooseOctreeNode::NoChild)
+            {
+                LooseOctreeNode child{};
+                child.center = nodeCenter + glm::vec3(octant & 1u ? childHalf : -childHalf, octant & 2u ? childHalf : -childHalf,
+                                                      octant & 4u ? childHalf : -childHalf);
+                child.halfSize = childHalf;
+                child.parent = node;
+                child.depth = m_Nodes[node].depth + 1;
+                const auto index = static_cast<std::uint32_t>( m_Nodes.size() );
+                m_Nodes.push_back(child);
+                m_NodeObjects.emplace_back();
+                m_Nodes[node].children[octant] = index;
+            }
+            node = m_Nodes[node].children[octant];
+        }
+        return node;
+    }
+
+    void LooseOctree::link(const Handle handle, const std::uint32_t node)
+    {
+        Object& object = m_Objects[handle];
+        object.node = node;
+        object.slot = static_cast<std::uint32_t>( m_NodeObjects[node].size() );
+        m_NodeObjects[node].push_back(handle);
+        m_Nodes[node].objectCount++;
+        for(std::uint32_t current = node;; current = m_Nodes[current].parent)
+        {
+            m_Nodes[current].subtreeCount++;
+            if(current == 0) break;
+        }
+    }
+
+    void LooseOctree::unlink(const Handle handle)
+    {
+        const Object& object = m_Objects[handle];
+        std::vector<Handle>& objects = m_NodeObjects[object.node];
+        const Handle moved = objects.back();
+        objects[object.slot] = moved;
+        m_Objects[moved].slot = object.slot;
+        objects.pop_back();
+
+        m_Nodes[object.node].objectCount--;
+        for(std::uint32_t current = object.node;; current = m_Nodes[current].parent)
+        {
+            m_Nodes[current].subtreeCount--;
+            if(current == 0) break;
+        }
+    }
+
+    LooseOctree::Handle LooseOctree::insert(const Aabb& bounds)
+    {
+        Handle handle;
+        if(!m_FreeHandles.empty())
+        {
+            handle = m_FreeHandles.back();
+            m_FreeHandles.pop_back();
+        }
+        else
+        {
+            handle = static_cast<Handle>( m_Objects.size() );
+            m_Objects.emplace_back();
+            m_Alive.push_back(0);
+        }
+
+        m_Objects[handle].bounds = bounds;
+        m_Alive[handle] = 1;
+        link(handle, findNode(bounds));
+        m_ObjectCount++;
+        return handle;
+    }
+
+    void LooseOctree::update(const Handle handle, const Aabb& bounds)
+    {
+        if(!isAlive(handle)) return;
+        m_Objects[handle].bounds = bounds;
+        const std::uint32_t node = findNode(bounds);
+        if(node == m_Objects[handle].node) return;
+
+        unlink(handle);
+        link(handle, node);
+        m_ReinsertCount++;
+    }
+
+    void LooseOctree::remove(const Handle handle)
+    {
+        if(!isAlive(handle)) return;
+        unlink(handle);
+        m_Alive[handle] = 0;
+        m_FreeHandles.push_back(handle);
+        m_ObjectCount--;
+    }
+
+    void LooseOctree::clear()
+    {
+        for(std::size_t node = 0; node < m_Nodes.size(); node++)
+        {
+            m_Nodes[node].objectCount = 0;
+            m_Nodes[node].subtreeCount = 0;
+            m_NodeObjects[node].clear();
+        }
+        m_Objects.clear();
+        m_Alive.clear();
+        m_FreeHandles.clear();
+        m_ObjectCount = 0;
+    }
+
+    bool LooseOctree::isAlive(const Handle handle) const
+    {
+        return handle < m_Alive.size() && m_Alive[handle];
+    }
+
+    template <typename NodeTest, typename ObjectTest>
+    void LooseOctree::query(const NodeTest& nodeTest, const ObjectTest& objectTest, std::vector<Handle>& out) const
+    {
+        out.clear();
+        if(m_Nodes[0].subtreeCount == 0) return;
+
+        std::vector<std::uint32_t>& stack = t_Stack;
+        stack.clear();
+        stack.push_back(0);
+        while(!stack.empty())
+        {
+            const std::uint32_t entry = stack.back();
+            stack.pop_back();
+            const std::uint32_t index = entry & ~InsideFlag;
+            const LooseOctreeNode& node = m_Nodes[index];
+
+            // The root also holds whatever is outside the world bounds, so it is never culled
+            Containment containment = entry & InsideFlag ? Containment::Inside : Containment::Intersects;
+            if(index != 0 && containment != Containment::Inside)
+            {
+                containment = nodeTest(looseBounds(node));
+                if(containment == Containment::Outside) continue;
+            }
+
+            if(node.objectCount != 0)
+            {
+                for(const Handle handle : m_NodeObjects[index])
+                {
+                    if(containment == Containment::Inside || objectTest(m_Objects[handle].bounds)) out.push_back(handle);
+                }
+            }
+
+            const std::uint32_t flag = containment == Containment::Inside ? InsideFlag : 0;
+            for(const std::uint32_t child : node.children)
+            {
+                if(child != LooseOctreeNode::NoChild && m_Nodes[child].subtreeCount != 0) stack.push_back(child | flag);
+            }
+        }
+    }
+
+    void LooseOctree::queryFrustum(const Frustum& frustum, std::vector<Handle>& out) const
+    {
+        query([&frustum](const Aabb& box) { return frustum.classify(box); },
+              [&frustum](const Aabb& box) { return frustum.intersects(box); }, out);
+    }
+
+    void LooseOctree::querySphere(const Sphere& sphere, std::vector<Handle>& out) const
+    {
+        query([&sphere](const Aabb& box)
+              {
+                  return intersects(box, sphere) ? Containment::Intersects : Containment::Outside;
+              },
+              [&sphere](const Aabb& box) { return intersects(box, sphere); }, out);
+    }
+
+    void LooseOctree::queryAabb(const Aabb& box, std::vector<Handle>& out) const
+    {
+        query([&box](const Aabb& node)
+              {
+                  if(!intersects(node, box)) return Containment::Outside;
+                  return box.contains(node) ? Containment::Inside : Containment::Intersects;
+              },
+              [&box](const Aabb& object) { return intersects(object, box); }, out);
+    }
+
+    void LooseOctree::queryRay(const Ray& ray, std::vector<Handle>& out) const
+    {
+        const glm::vec3 inverseDirection = 1.0f / ray.direction;
+        auto hits = [&ray, &inverseDirection](const Aabb& box) { return intersectRay(box, ray, inverseDirection) >= 0.0f; };
+        query([&hits](const Aabb& box) { return hits(box) ? Containment::Intersects : Containment::Outside; }, hits, out);
+    }
+}
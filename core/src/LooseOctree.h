@@ -0,0 +1,107 @@
+#pragma once
+#include <Geometry.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace core
+{
+    // One cache line per node
+    struct alignas(64) LooseOctreeNode
+    {
+        static constexpr std::uint32_t NoChild = 0;// the root can't be anyone's child
+
+        glm::vec3 center;
+        float halfSize;                // of the cell, the loose bounds are twice that
+        std::uint32_t children[8];
+        std::uint32_t parent;
+        std::uint32_t depth;
+        std::uint32_t objectCount;     // stored in this node
+        std::uint32_t subtreeCount;    // stored in this node and below, empty branches are skipped
+    };
+
+    static_assert(sizeof(LooseOctreeNode) == 64, "LooseOctreeNode should stay one cache line");
+
+    struct LooseOctreeOptions
+    {
+        Aabb worldBounds = { glm::vec3(-1024.0f), glm::vec3(1024.0f) };
+        std::uint32_t maxDepth = 8;
+    };
+
+    /* Loose octree for objects that move. Every node's bounds are its cell grown by half a
+     * cell on each side, so an object fits the node whose cell holds its centre at the depth
+     * its size picks: inserting is a descent without any splitting or testing against
+     * neighbours, and an object that moves within its cell is updated in place. Objects
+     * outside the world bounds live in the root, which is always searched.
+     * Objects are identified by the handle insert() returns. Handles are reused after
+     * remove() and stay dense while objects are only added, so they can index a side array. */
+    class LooseOctree
+    {
+    public:
+        using Handle = std::uint32_t;
+
+        static constexpr Handle NoHandle = 0xFFFFFFFF;
+
+    private:
+        struct Object
+        {
+            Aabb bounds;
+            std::uint32_t node = 0;
+            std::uint32_t slot = 0;// index into the node's object list
+        };
+
+        LooseOctreeOptions m_Options;
+        std::vector<LooseOctreeNode> m_Nodes;
+        std::vector<std::vector<Handle>> m_NodeObjects;// parallel to m_Nodes
+        std::vector<Object> m_Objects;
+        std::vector<std::uint8_t> m_Alive;
+        std::vector<Handle> m_FreeHandles;
+        std::size_t m_ObjectCount = 0;
+        std::size_t m_ReinsertCount = 0;
+
+        // Node the box belongs to, creating the nodes on the way down
+        std::uint32_t findNode(const Aabb& bounds);
+
+        void link(Handle handle, std::uint32_t node);
+
+        void unlink(Handle handle);
+
+        template <typename NodeTest, typename ObjectTest>
+        void query(const NodeTest& nodeTest, const ObjectTest& objectTest, std::vector<Handle>& out) const;
+
+    public:
+        explicit LooseOctree(const LooseOctreeOptions& options = {});
+
+        Handle insert(const Aabb& bounds);
+
+        // Updates in place when the box still belongs to the same node, reinserts otherwise
+        void update(Handle handle, const Aabb& bounds);
+
+        void remove(Handle handle);
+
+        // Removes every object, the nodes stay allocated for the next fill
+        void clear();
+
+        [[nodiscard]] bool isAlive(Handle handle) const;
+
+        [[nodiscard]] const Aabb& getBounds(Handle handle) const { return m_Objects[handle].bounds; }
+
+        // Queries clear out and fill it with the handles of the objects they hit
+        void queryFrustum(const Frustum& frustum, std::vector<Handle>& out) const;
+
+        void querySphere(const Sphere& sphere, std::vector<Handle>& out) const;
+
+        void queryAabb(const Aabb& box, std::vector<Handle>& out) const;
+
+        void queryRay(const Ray& ray, std::vector<Handle>& out) const;
+
+        [[nodiscard]] std::size_t getObjectCount() const { return m_ObjectCount; }
+
+        [[nodiscard]] std::size_t getNodeCount() const { return m_Nodes.size(); }
+
+        // update() calls that had to move an object to another node since the last resetStats()
+        [[nodiscard]] std::size_t getReinsertCount() const { return m_ReinsertCount; }
+
+        void resetStats() { m_ReinsertCount = 0; }
+    };
+}
@@ -0,0 +1,147 @@
+#include <MappedFile.h>
+#include <iostream>
+#include <utility>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace core
+{
+    MappedFile::MappedFile(const std::string& filepath)
+    {
+        open(filepath);
+    }
+
+    MappedFile::~MappedFile()
+    {
+        unmap();
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+    {
+        *this = std::move(other);
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+    {
+        if(this != &other)
+        {
+            unmap();
+            m_Filepath = std::move(other.m_Filepath);
+            m_Data = std::exchange(other.m_Data, nullptr);
+            m_Size = std::exchange(other.m_Size, 0);
+            m_Open = std::exchange(other.m_Open, false);
+#if defined(_WIN32)
+            m_File = std::exchange(other.m_File, nullptr);
+            m_Mapping = std::exchange(other.m_Mapping, nullptr);
+#endif
+        }
+        return *this;
+    }
+
+    bool MappedFile::open(const std::string& filepath)
+    {
+        unmap();
+        m_Filepath = filepath;
+
+#if defined(_WIN32)
+        HANDLE file = CreateFileA(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                                  FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if(file == INVALID_HANDLE_VALUE)
+        {
+            std::cerr << "[MappedFile] Error: Could not open " << filepath << '\n';
+            return false;
+        }
+
+        LARGE_INTEGER size{};
+        GetFileSizeEx(file, &size);
+        if(size.QuadPart == 0)
+        {
+            // Zero sized files can't be mapped, they are simply open and empty
+            m_File = file;
+            m_Open = true;
+            return true;
+        }
+
+        HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        const void* view = mapping != nullptr ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+        if(view == nullptr)
+        {
+            std::cerr << "[MappedFile] Error: Could not map " << filepath << '\n';
+            if(mapping != nullptr) CloseHandle(mapping);
+            CloseHandle(file);
+            return false;
+        }
+
+        m_File = file;
+        m_Mapping = mapping;
+        m_Data = static_cast<const std::byte *>( view );
+        m_Size = static_cast<std::size_t>( size.QuadPart );
+        m_Open = true;
+#else
+        const int fd = ::open(filepath.c_str(), O_RDONLY | O_CLOEXEC);
+        if(fd < 0)
+        {
+            std::cerr << "[MappedFile] Error: Could not open " << filepath << '\n';
+            return false;
+        }
+
+        struct stat info{};
+        if(fstat(fd, &info) != 0)
+        {
+            std::cerr << "[MappedFile] Error: Could not stat " << filepath << '\n';
+            close(fd);
+            return false;
+        }
+
+        if(info.st_size > 0)
+        {
+            void* view = mmap(nullptr, static_cast<std::size_t>( info.st_size ), PROT_READ, MAP_PRIVATE, fd, 0);
+            if(view == MAP_FAILED)
+            {
+                std::cerr << "[MappedFile] Error: Could not map " << filepath << '\n';
+                close(fd);
+                return false;
+            }
+            // Loaders walk the file front to back, so start reading it in right away
+            madvise(view, static_cast<std::size_t>( info.st_size ), MADV_SEQUENTIAL);
+            madvise(view, static_cast<std::size_t>( info.st_size ), MADV_WILLNEED);
+            m_Data = static_cast<const std::byte *>( view );
+            m_Size = static_cast<std::size_t>( info.st_size );
+        }
+        // The mapping keeps its own reference to the file
+        close(fd);
+        m_Open = true;
+#endif
+        return true;
+    }
+
+    void MappedFile::unmap()
+    {
+#if defined(_WIN32)
+        if(m_Data != nullptr) UnmapViewOfFile(m_Data);
+        if(m_Mapping != nullptr) CloseHandle(m_Mapping);
+        if(m_File != nullptr) CloseHandle(m_File);
+        m_Mapping = nullptr;
+        m_File = nullptr;
+#else
+        if(m_Data != nullptr) munmap(const_cast<std::byte *>( m_Data ), m_Size);
+#endif
+        m_Data = nullptr;
+        m_Size = 0;
+        m_Open = false;
+    }
+
+    bool MappedFile::isOpen() const { return m_Open; }
+    std::span<const std::byte> MappedFile::getData() const { return { m_Data, m_Size }; }
+    std::size_t MappedFile::getSize() const { return m_Size; }
+    const std::string& MappedFile::getFilepath() const { return m_Filepath; }
+}
@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <span>
+#include <string>
+
+namespace core
+{
+    /* Read-only memory mapping of a whole file (mmap, or CreateFileMapping on Windows).
+     * Pages are only read from disk when they are touched, so large assets can be parsed
+     * and uploaded straight from the mapping without being copied into the heap first. */
+    class MappedFile
+    {
+    private:
+        std::string m_Filepath;
+        const std::byte* m_Data = nullptr;
+        std::size_t m_Size = 0;
+        bool m_Open = false;
+#if defined(_WIN32)
+        void* m_File = nullptr;
+        void* m_Mapping = nullptr;
+#endif
+
+        void unmap();
+
+    public:
+        MappedFile() = default;
+
+        // Maps the file, check isOpen() afterwards (errors are logged)
+        explicit MappedFile(const std::string& filepath);
+
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        MappedFile(MappedFile&& other) noexcept;
+
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        bool open(const std::string& filepath);
+
+        [[nodiscard]] bool isOpen() const;
+
+        [[nodiscard]] std::span<const std::byte> getData() const;
+
+        [[nodiscard]] std::size_t getSize() const;
+
+        [[nodiscard]] const std::string& getFilepath() const;
+    };
+}
@@ -0,0 +1,244 @@
+#include <MathSIMD.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace core::simd
+{
+    static_assert(sizeof(glm::mat4) == 16 * sizeof(float), "Batch kernels read glm::mat4 as 16 packed floats");
+    static_assert(sizeof(glm::mat3) == 9 * sizeof(float), "Batch kernels write glm::mat3 as 9 packed floats");
+
+    namespace
+    {
+#if defined(__AVX2__)
+        inline __m256 fmadd(const __m256 a, const __m256 b, const __m256 c)
+        {
+#if defined(__FMA__)
+            return _mm256_fmadd_ps(a, b, c);
+#else
+            return _mm256_add_ps(_mm256_mul_ps(a, b), c);
+#endif
+        }
+
+        inline __m256 fmsub(const __m256 a, const __m256 b, const __m256 c)
+        {
+#if defined(__FMA__)
+            return _mm256_fmsub_ps(a, b, c);
+#else
+            return _mm256_sub_ps(_mm256_mul_ps(a, b), c);
+#endif
+        }
+
+        // Row k of the input holds element k of 8 objects, afterwards row k holds object k's elements
+        inline void transpose8x8(__m256 (&rows)[8])
+        {
+            const __m256 t0 = _mm256_unpacklo_ps(rows[0], rows[1]);
+            const __m256 t1 = _mm256_unpackhi_ps(rows[0], rows[1]);
+            const __m256 t2 = _mm256_unpacklo_ps(rows[2], rows[3]);
+            const __m256 t3 = _mm256_unpackhi_ps(rows[2], rows[3]);
+            const __m256 t4 = _mm256_unpacklo_ps(rows[4], rows[5]);
+            const __m256 t5 = _mm256_unpackhi_ps(rows[4], rows[5]);
+            const __m256 t6 = _mm256_unpacklo_ps(rows[6], rows[7]);
+            const __m256 t7 = _mm256_unpackhi_ps(rows[6], rows[7]);
+
+            const __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+            const __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+            const __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+            const __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+            const __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+            const __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+            const __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+            const __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+
+            rows[0] = _mm256_permute2f128_ps(s0, s4, 0x20);
+            rows[1] = _mm256_permute2f128_ps(s1, s5, 0x20);
+            rows[2] = _mm256_permute2f128_ps(s2, s6, 0x20);
+            rows[3] = _mm256_permute2f128_ps(s3, s7, 0x20);
+            rows[4] = _mm256_permute2f128_ps(s0, s4, 0x31);
+            rows[5] = _mm256_permute2f128_ps(s1, s5, 0x31);
+            rows[6] = _mm256_permute2f128_ps(s2, s6, 0x31);
+            rows[7] = _mm256_permute2f128_ps(s3, s7, 0x31);
+        }
+#endif
+    }
+
+    void TransformArrays::resize(const std::size_t count)
+    {
+        for(std::vector<float>* stream : { &positionX, &positionY, &positionZ, &rotationX, &rotationY, &rotationZ })
+            stream->resize(count, 0.0f);
+        rotationW.resize(count, 1.0f);
+        for(std::vector<float>* stream : { &scaleX, &scaleY, &scaleZ })
+            stream->resize(count, 1.0f);
+    }
+
+    void TransformArrays::set(const std::size_t index, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale)
+    {
+        positionX[index] = position.x;
+        positionY[index] = position.y;
+        positionZ[index] = position.z;
+        rotationX[index] = rotation.x;
+        rotationY[index] = rotation.y;
+        rotationZ[index] = rotation.z;
+        rotationW[index] = rotation.w;
+        scaleX[index] = scale.x;
+        scaleY[index] = scale.y;
+        scaleZ[index] = scale.z;
+    }
+
+    TransformStreams TransformArrays::getStreams() const
+    {
+        return { positionX.data(), positionY.data(), positionZ.data(), rotationX.data(), rotationY.data(),
+                 rotationZ.data(), rotationW.data(), scaleX.data(), scaleY.data(), scaleZ.data() };
+    }
+
+    void composeTRS(const TransformStreams& transforms, const std::size_t count, glm::mat4* out)
+    {
+        std::size_t i = 0;
+#if defined(__AVX2__)
+        const __m256 one = _mm256_set1_ps(1.0f);
+        const __m256 two = _mm256_set1_ps(2.0f);
+        const __m256 zero = _mm256_setzero_ps();
+        for(; i + 8 <= count; i += 8)
+        {
+            const __m256 qx = _mm256_loadu_ps(transforms.rotationX + i);
+            const __m256 qy = _mm256_loadu_ps(transforms.rotationY + i);
+            const __m256 qz = _mm256_loadu_ps(transforms.rotationZ + i);
+            const __m256 qw = _mm256_loadu_ps(transforms.rotationW + i);
+            const __m256 sx = _mm256_loadu_ps(transforms.scaleX + i);
+            const __m256 sy = _mm256_loadu_ps(transforms.scaleY + i);
+            const __m256 sz = _mm256_loadu_ps(transforms.scaleZ + i);
+
+            // Doubled products, so every off-diagonal term is one add or subtract away
+            const __m256 x2 = _mm256_mul_ps(qx, two), y2 = _mm256_mul_ps(qy, two), z2 = _mm256_mul_ps(qz, two);
+            const __m256 xx = _mm256_mul_ps(qx, x2), yy = _mm256_mul_ps(qy, y2), zz = _mm256_mul_ps(qz, z2);
+            const __m256 xy = _mm256_mul_ps(qx, y2), xz = _mm256_mul_ps(qx, z2), yz = _mm256_mul_ps(qy, z2);
+            const __m256 wx = _mm256_mul_ps(qw, x2), wy = _mm256_mul_ps(qw, y2), wz = _mm256_mul_ps(qw, z2);
+
+            // Element k of all 8 matrices, column major
+            __m256 low[8] = {
+                _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(yy, zz)), sx),
+                _mm256_mul_ps(_mm256_add_ps(xy, wz), sx),
+                _mm256_mul_ps(_mm256_sub_ps(xz, wy), sx),
+                zero,
+                _mm256_mul_ps(_mm256_sub_ps(xy, wz), sy),
+                _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, zz)), sy),
+                _mm256_mul_ps(_mm256_add_ps(yz, wx), sy),
+                zero
+            };
+            __m256 high[8] = {
+                _mm256_mul_ps(_mm256_add_ps(xz, wy), sz),
+                _mm256_mul_ps(_mm256_sub_ps(yz, wx), sz),
+                _mm256_mul_ps(_mm256_sub_ps(one, _mm256_add_ps(xx, yy)), sz),
+                zero,
+                _mm256_loadu_ps(transforms.positionX + i),
+                _mm256_loadu_ps(transforms.positionY + i),
+                _mm256_loadu_ps(transforms.positionZ + i),
+                one
+            };
+
+            transpose8x8(low);
+            transpose8x8(high);
+            for(std::size_t k = 0; k < 8; k++)
+            {
+                float* matrix = &out[i + k][0][0];
+                _mm256_storeu_ps(matrix, low[k]);
+                _mm256_storeu_ps(matrix + 8, high[k]);
+            }
+        }
+#endif
+        for(; i < count; i++)
+        {
+            out[i] = composeTRS(glm::vec3(transforms.positionX[i], transforms.positionY[i], transforms.positionZ[i]),
+                                glm::quat(transforms.rotationW[i], transforms.rotationX[i], transforms.rotationY[i], transforms.rotationZ[i]),
+                                glm::vec3(transforms.scaleX[i], transforms.scaleY[i], transforms.scaleZ[i]));
+        }
+    }
+
+    void multiply(const glm::mat4& left, const glm::mat4* right, const std::size_t count, glm::mat4* out)
+    {
+        std::size_t i = 0;
+#if defined(__AVX2__)
+        // left's columns repeated in both halves, so two result columns are built at once
+        const __m256 l0 = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>( &left[0][0] ));
+        const __m256 l1 = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>( &left[1][0] ));
+        const __m256 l2 = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>( &left[2][0] ));
+        const __m256 l3 = _mm256_broadcast_ps(reinterpret_cast<const __m128 *>( &left[3][0] ));
+        for(; i < count; i++)
+        {
+            const float* source = &right[i][0][0];
+            const __m256 r01 = _mm256_loadu_ps(source);
+            const __m256 r23 = _mm256_loadu_ps(source + 8);
+
+            // In-lane shuffles broadcast element k of each of the two columns
+            __m256 c01 = _mm256_mul_ps(l0, _mm256_shuffle_ps(r01, r01, 0x00));
+            __m256 c23 = _mm256_mul_ps(l0, _mm256_shuffle_ps(r23, r23, 0x00));
+            c01 = fmadd(l1, _mm256_shuffle_ps(r01, r01, 0x55), c01);
+            c23 = fmadd(l1, _mm256_shuffle_ps(r23, r23, 0x55), c23);
+            c01 = fmadd(l2, _mm256_shuffle_ps(r01, r01, 0xAA), c01);
+            c23 = fmadd(l2, _mm256_shuffle_ps(r23, r23, 0xAA), c23);
+            c01 = fmadd(l3, _mm256_shuffle_ps(r01, r01, 0xFF), c01);
+            c23 = fmadd(l3, _mm256_shuffle_ps(r23, r23, 0xFF), c23);
+
+            float* target = &out[i][0][0];
+            _mm256_storeu_ps(target, c01);
+            _mm256_storeu_ps(target + 8, c23);
+        }
+#endif
+        for(; i < count; i++)
+            out[i] = multiply(left, right[i]);
+    }
+
+    void normalMatrices(const glm::mat4* models, const std::size_t count, glm::mat3* out)
+    {
+        std::size_t i = 0;
+#if defined(__AVX2__)
+        const __m256i stride = _mm256_setr_epi32(0, 16, 32, 48, 64, 80, 96, 112);
+        const __m256 one = _mm256_set1_ps(1.0f);
+        for(; i + 8 <= count; i += 8)
+        {
+            // Upper 3x3 of 8 matrices, one register per element
+            const float* base = &models[i][0][0];
+            const __m256 ax = _mm256_i32gather_ps(base + 0, stride, 4);
+            const __m256 ay = _mm256_i32gather_ps(base + 1, stride, 4);
+            const __m256 az = _mm256_i32gather_ps(base + 2, stride, 4);
+            const __m256 bx = _mm256_i32gather_ps(base + 4, stride, 4);
+            const __m256 by = _mm256_i32gather_ps(base + 5, stride, 4);
+            const __m256 bz = _mm256_i32gather_ps(base + 6, stride, 4);
+            const __m256 cx = _mm256_i32gather_ps(base + 8, stride, 4);
+            const __m256 cy = _mm256_i32gather_ps(base + 9, stride, 4);
+            const __m256 cz = _mm256_i32gather_ps(base + 10, stride, 4);
+
+            const __m256 bcx = fmsub(by, cz, _mm256_mul_ps(bz, cy));
+            const __m256 bcy = fmsub(bz, cx, _mm256_mul_ps(bx, cz));
+            const __m256 bcz = fmsub(bx, cy, _mm256_mul_ps(by, cx));
+            const __m256 determinant = fmadd(az, bcz, fmadd(ay, bcy, _mm256_mul_ps(ax, bcx)));
+            const __m256 inverse = _mm256_div_ps(one, determinant);
+
+            __m256 rows[8] = {
+                _mm256_mul_ps(bcx, inverse),
+                _mm256_mul_ps(bcy, inverse),
+                _mm256_mul_ps(bcz, inverse),
+                _mm256_mul_ps(fmsub(cy, az, _mm256_mul_ps(cz, ay)), inverse),
+                _mm256_mul_ps(fmsub(cz, ax, _mm256_mul_ps(cx, az)), inverse),
+                _mm256_mul_ps(fmsub(cx, ay, _mm256_mul_ps(cy, ax)), inverse),
+                _mm256_mul_ps(fmsub(ay, bz, _mm256_mul_ps(az, by)), inverse),
+                _mm256_mul_ps(fmsub(az, bx, _mm256_mul_ps(ax, bz)), inverse)
+            };
+            alignas(32) float last[8];
+            _mm256_store_ps(last, _mm256_mul_ps(fmsub(ax, by, _mm256_mul_ps(ay, bx)), inverse));
+
+            // 8 of the 9 elements go out as one store per matrix, the last one on its own
+            transpose8x8(rows);
+            for(std::size_t k = 0; k < 8; k++)
+            {
+                float* normal = &out[i + k][0][0];
+                _mm256_storeu_ps(normal, rows[k]);
+                normal[8] = last[k];
+            }
+        }
+#endif
+        for(; i < count; i++)
+            out[i] = normalMatrix(models[i]);
+    }
+}
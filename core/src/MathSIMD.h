@@ -0,0 +1,123 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+#include <cstddef>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#define CORE_SIMD_SSE 1
+#endif
+
+namespace core::simd
+{
+    /* Small-matrix helpers for the per-object hot loops (transform hierarchy, culling).
+     * glm's generic operators go through loops the compiler doesn't always unroll, these are
+     * written against SSE directly, with FMA when the build enables it, and fall back to glm
+     * on other targets. */
+
+    // a * b, both column major
+    inline glm::mat4 multiply(const glm::mat4& a, const glm::mat4& b)
+    {
+#if defined(CORE_SIMD_SSE)
+        const __m128 a0 = _mm_loadu_ps(&a[0][0]);
+        const __m128 a1 = _mm_loadu_ps(&a[1][0]);
+        const __m128 a2 = _mm_loadu_ps(&a[2][0]);
+        const __m128 a3 = _mm_loadu_ps(&a[3][0]);
+
+        glm::mat4 result;
+        for(int column = 0; column < 4; column++)
+        {
+            // Each result column is a's columns weighted by the matching column of b
+            const __m128 x = _mm_set1_ps(b[column][0]);
+            const __m128 y = _mm_set1_ps(b[column][1]);
+            const __m128 z = _mm_set1_ps(b[column][2]);
+            const __m128 w = _mm_set1_ps(b[column][3]);
+#if defined(__FMA__)
+            const __m128 sum = _mm_fmadd_ps(a3, w, _mm_fmadd_ps(a2, z, _mm_fmadd_ps(a1, y, _mm_mul_ps(a0, x))));
+#else
+            const __m128 sum = _mm_add_ps(_mm_add_ps(_mm_mul_ps(a0, x), _mm_mul_ps(a1, y)),
+                                          _mm_add_ps(_mm_mul_ps(a2, z), _mm_mul_ps(a3, w)));
+#endif
+            _mm_storeu_ps(&result[column][0], sum);
+        }
+        return result;
+#else
+        return a * b;
+#endif
+    }
+
+    // translate * rotate * scale without building and multiplying three matrices
+    inline glm::mat4 composeTRS(const glm::vec3& translation, const glm::quat& rotation, const glm::vec3& scale)
+    {
+        const float xx = rotation.x * rotation.x, yy = rotation.y * rotation.y, zz = rotation.z * rotation.z;
+        const float xy = rotation.x * rotation.y, xz = rotation.x * rotation.z, yz = rotation.y * rotation.z;
+        const float wx = rotation.w * rotation.x, wy = rotation.w * rotation.y, wz = rotation.w * rotation.z;
+
+        glm::mat4 matrix;
+        matrix[0] = glm::vec4(1.0f - 2.0f * (yy + zz), 2.0f * (xy + wz), 2.0f * (xz - wy), 0.0f) * scale.x;
+        matrix[1] = glm::vec4(2.0f * (xy - wz), 1.0f - 2.0f * (xx + zz), 2.0f * (yz + wx), 0.0f) * scale.y;
+        matrix[2] = glm::vec4(2.0f * (xz + wy), 2.0f * (yz - wx), 1.0f - 2.0f * (xx + yy), 0.0f) * scale.z;
+        matrix[3] = glm::vec4(translation, 1.0f);
+        return matrix;
+    }
+
+    /* transpose(inverse(mat3(model))). The inverse's rows are the cross products of the
+     * other two columns over the determinant, transposed they become the columns. */
+    inline glm::mat3 normalMatrix(const glm::mat4& model)
+    {
+        const glm::vec3 a(model[0]), b(model[1]), c(model[2]);
+        const glm::vec3 bc = glm::cross(b, c);
+        const float inverseDeterminant = 1.0f / glm::dot(a, bc);
+
+        glm::mat3 normal;
+        normal[0] = bc * inverseDeterminant;
+        normal[1] = glm::cross(c, a) * inverseDeterminant;
+        normal[2] = glm::cross(a, b) * inverseDeterminant;
+        return normal;
+    }
+
+    // Structure-of-arrays TRS input for the batch kernels, one float per object in each stream
+    struct TransformStreams
+    {
+        const float* positionX = nullptr;
+        const float* positionY = nullptr;
+        const float* positionZ = nullptr;
+        const float* rotationX = nullptr;
+        const float* rotationY = nullptr;
+        const float* rotationZ = nullptr;
+        const float* rotationW = nullptr;
+        const float* scaleX = nullptr;
+        const float* scaleY = nullptr;
+        const float* scaleZ = nullptr;
+    };
+
+    // Owns the streams, for callers that don't already keep transforms split by component
+    struct TransformArrays
+    {
+        std::vector<float> positionX, positionY, positionZ;
+        std::vector<float> rotationX, rotationY, rotationZ, rotationW;
+        std::vector<float> scaleX, scaleY, scaleZ;
+
+        void resize(std::size_t count);
+
+        void set(std::size_t index, const glm::vec3& position, const glm::quat& rotation, const glm::vec3& scale);
+
+        [[nodiscard]] std::size_t size() const { return positionX.size(); }
+
+        [[nodiscard]] TransformStreams getStreams() const;
+    };
+
+    /* Batch kernels over count objects. With AVX2, composeTRS and normalMatrices work on 8
+     * objects per iteration and multiply on two columns at a time; the remainder and non-AVX2
+     * builds go through the single-matrix functions above. Results match glm to float rounding. */
+
+    // out[i] = translate * rotate * scale of object i
+    void composeTRS(const TransformStreams& transforms, std::size_t count, glm::mat4* out);
+
+    // out[i] = left * right[i], e.g. the shared view-projection times each model matrix. out may alias right
+    void multiply(const glm::mat4& left, const glm::mat4* right, std::size_t count, glm::mat4* out);
+
+    // out[i] = transpose(inverse(mat3(models[i]))), what lighting shaders transform normals with
+    void normalMatrices(const glm::mat4* models, std::size_t count, glm::mat3* out);
+}
@@ -0,0 +1,95 @@
+#include <Mesh.h>
+#include <glm/gtc/matrix_transform.hpp>
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+
+namespace core
+{
+    namespace
+    {
+        // glNamedBufferStorage rejects a size of 0, an empty mesh still gets a small buffer
+        void storeBuffer(const unsigned int buffer, const std::size_t size, const void* data)
+        {
+            if(size == 0) glNamedBufferStorage(buffer, 4, nullptr, 0);
+            else glNamedBufferStorage(buffer, static_cast<GLsizeiptr>( size ), data, 0);
+        }
+    }
+
+    Mesh::Mesh(const MeshData& data, VertexArrayCache& vertexArrays)
+        : m_Stride(data.layout.stride),
+          m_IndexCount(data.indices.size()),
+          m_VertexCount(data.vertexCount()),
+          m_Lods(data.lods)
+    {
+        if(m_Lods.empty()) m_Lods.push_back({ 0, static_cast<std::uint32_t>( m_IndexCount ), 0.0f });
+
+        m_VertexArray = vertexArrays.get(data.layout);
+        m_DequantMatrix = glm::scale(glm::translate(glm::mat4(1.0f), data.positionOffset),
+                                     glm::vec3(data.positionScale));
+
+        glCreateBuffers(1, &m_VertexBuffer);
+        storeBuffer(m_VertexBuffer, data.vertices.size(), data.vertices.data());
+
+        glCreateBuffers(1, &m_IndexBuffer);
+        // Halves the index memory whenever the mesh is small enough
+        if(m_VertexCount <= std::numeric_limits<std::uint16_t>::max())
+        {
+            const std::vector<std::uint16_t> shortIndices(data.indices.begin(), data.indices.end());
+            m_IndexType = GL_UNSIGNED_SHORT;
+            storeBuffer(m_IndexBuffer, shortIndices.size() * sizeof(std::uint16_t), shortIndices.data());
+        } else
+        {
+            m_IndexType = GL_UNSIGNED_INT;
+            storeBuffer(m_IndexBuffer, data.indices.size() * sizeof(unsigned int), data.indices.data());
+        }
+    }
+
+    Mesh::~Mesh()
+    {
+        glDeleteBuffers(1, &m_VertexBuffer);
+        glDeleteBuffers(1, &m_IndexBuffer);
+    }
+
+    void Mesh::bind() const
+    {
+        VertexArrayCache::bind(m_VertexArray, m_VertexBuffer, m_Stride, m_IndexBuffer);
+    }
+
+    // Appended levels share the index buffer, so drawing all of it would overlay every level
+    void Mesh::draw() const { drawLod(0); }
+
+    // An empty mesh draws nothing
+    void Mesh::drawInstanced(const int instanceCount, const std::size_t lod) const
+    {
+        if(m_IndexCount == 0) return;
+        bind();
+        const MeshLod& level = m_Lods[std::min(lod, m_Lods.size() - 1)];
+        if(level.indexCount == 0) return;
+        glDrawElementsInstanced(GL_TRIANGLES, static_cast<GLsizei>( level.indexCount ), m_IndexType,
+                                reinterpret_cast<const void *>( level.firstIndex * indexSize() ), instanceCount);
+    }
+
+    void Mesh::drawLod(const std::size_t lod) const
+    {
+        if(m_IndexCount == 0) return;
+        bind();
+        drawBound(lod);
+    }
+
+    void Mesh::drawBound(const std::size_t lod) const
+    {
+        const MeshLod& level = m_Lods[std::min(lod, m_Lods.size() - 1)];
+        if(level.indexCount == 0) return;
+        glDrawElements(GL_TRIANGLES, static_cast<GLsizei>( level.indexCount ), m_IndexType,
+                       reinterpret_cast<const void *>( level.firstIndex * indexSize() ));
+    }
+
+    std::size_t Mesh::indexSize() const { return m_IndexType == GL_UNSIGNED_SHORT ? sizeof(std::uint16_t) : sizeof(unsigned int); }
+
+    std::size_t Mesh::getIndexCount() const { return m_IndexCount; }
+    std::size_t Mesh::getVertexCount() const { return m_VertexCount; }
+    unsigned int Mesh::getIndexType() const { return m_IndexType; }
+    const glm::mat4& Mesh::getDequantMatrix() const { return m_DequantMatrix; }
+    std::span<const MeshLod> Mesh::getLods() const { return m_Lods; }
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include <MeshBuilder.h>
+#include <VertexArrayCache.h>
+#include <span>
+#include <vector>
+
+namespace core
+{
+    /* GPU copy of a MeshData in immutable buffers (glNamedBufferStorage).
+     * The VAO comes from a VertexArrayCache, so meshes with the same layout share it.
+     * Every level of detail lives in the one index buffer, drawLod picks a range. */
+    class Mesh
+    {
+    private:
+        unsigned int m_VertexBuffer = 0;
+        unsigned int m_IndexBuffer = 0;
+        unsigned int m_VertexArray = 0;
+        unsigned int m_Stride = 0;
+        unsigned int m_IndexType = GL_UNSIGNED_INT;
+        std::size_t m_IndexCount = 0;
+        std::size_t m_VertexCount = 0;
+        glm::mat4 m_DequantMatrix = glm::mat4(1.0f);
+        std::vector<MeshLod> m_Lods;
+
+        // Bytes per index, for turning a level's firstIndex into a buffer offset
+        [[nodiscard]] std::size_t indexSize() const;
+
+    public:
+        Mesh(const MeshData& data, VertexArrayCache& vertexArrays);
+
+        Mesh(const Mesh&) = delete;
+
+        Mesh& operator=(const Mesh&) = delete;
+
+        ~Mesh();
+
+        // Points the shared VAO at this mesh's buffers and binds it
+        void bind() const;
+
+        // Binds and draws level 0, the full detail mesh. Coarser levels go through drawLod
+        void draw() const;
+
+        // One level drawn instanceCount times, shaders tell the copies apart with gl_InstanceID
+        void drawInstanced(int instanceCount, std::size_t lod = 0) const;
+
+        // Binds and draws one level of detail, 0 is the finest
+        void drawLod(std::size_t lod) const;
+
+        // drawLod without the bind, for callers that already bound this mesh (a sorted RenderQueue)
+        void drawBound(std::size_t lod) const;
+
+        // Never empty, a mesh without LODs has one level over the whole index buffer
+        [[nodiscard]] std::span<const MeshLod> getLods() const;
+
+        [[nodiscard]] std::size_t getIndexCount() const;
+
+        [[nodiscard]] std::size_t getVertexCount() const;
+
+        // GL_UNSIGNED_SHORT when every index fits in 16 bits, else GL_UNSIGNED_INT
+        [[nodiscard]] unsigned int getIndexType() const;
+
+        // Maps quantised positions back to model space, multiply it on the right of the model matrix
+        [[nodiscard]] const glm::mat4& getDequantMatrix() const;
+    };
+}
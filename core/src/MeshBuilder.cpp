@@ -0,0 +1,436 @@
+#include <MeshBuilder.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+namespace core
+{
+    namespace
+    {
+        constexpr std::size_t NoVertex = std::numeric_limits<std::size_t>::max();
+
+        struct Float3
+        {
+            float x, y, z;
+        };
+
+        Float3 operator-(const Float3& a, const Float3& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+
+        Float3 cross(const Float3& a, const Float3& b)
+        {
+            return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+        }
+
+        // Finds the vec3 float position attribute the overdraw pass sorts by
+        const VertexAttribute* findPositionAttribute(const VertexLayoutDesc& layout)
+        {
+            for(const auto& attr : layout.attributes)
+            {
+                if(attr.location == 0 && attr.type == GL_FLOAT && attr.components >= 3 && !attr.integer)
+                    return &attr;
+            }
+            return nullptr;
+        }
+
+        Float3 readPosition(const MeshData& mesh, const unsigned int offset, const unsigned int index)
+        {
+            Float3 position;
+            std::memcpy(&position, mesh.vertices.data() + static_cast<std::size_t>( index ) * mesh.layout.stride + offset,
+                        sizeof(Float3));
+            return position;
+        }
+
+        // Number of FIFO cache misses for each triangle, in draw order
+        std::vector<unsigned char> simulateTriangleMisses(const std::vector<unsigned int>& indices,
+                                                          const std::size_t vertexCount, const unsigned int cacheSize)
+        {
+            std::vector<unsigned int> cacheTime(vertexCount, 0);
+            unsigned int timestamp = cacheSize + 1;
+            std::vector<unsigned char> misses(indices.size() / 3, 0);
+
+            for(std::size_t i = 0; i < indices.size(); i++)
+            {
+                const unsigned int vertex = indices[i];
+                if(timestamp - cacheTime[vertex] > cacheSize)
+                {
+                    cacheTime[vertex] = timestamp++;
+                    misses[i / 3]++;
+                }
+            }
+            return misses;
+        }
+    }
+
+    std::size_t MeshData::vertexCount() const
+    {
+        return layout.stride == 0 ? 0 : vertices.size() / layout.stride;
+    }
+
+    std::size_t MeshBuilder::VertexHash::operator()(const unsigned int index) const noexcept
+    {
+        // FNV-1a over the raw vertex bytes
+        const std::byte* vertex = builder->vertexAt(index);
+        std::uint64_t hash = 14695981039346656037ull;
+        for(unsigned int i = 0; i < builder->m_Layout.stride; i++)
+        {
+            hash ^= static_cast<std::uint64_t>( vertex[i] );
+            hash *= 1099511628211ull;
+        }
+        return static_cast<std::size_t>( hash );
+    }
+
+    bool MeshBuilder::VertexEqual::operator()(const unsigned int a, const unsigned int b) const noexcept
+    {
+        return std::memcmp(builder->vertexAt(a), builder->vertexAt(b), builder->m_Layout.stride) == 0;
+    }
+
+    MeshBuilder::MeshBuilder(VertexLayoutDesc layout)
+        : m_Layout(std::move(layout)),
+          m_Welded(64, VertexHash{ this }, VertexEqual{ this })
+    {
+    }
+
+    const std::byte* MeshBuilder::vertexAt(const unsigned int index) const
+    {
+        return m_Vertices.data() + static_cast<std::size_t>( index ) * m_Layout.stride;
+    }
+
+    void MeshBuilder::addTriangleList(const void* vertices, const std::size_t vertexCount)
+    {
+        if(vertexCount % 3 != 0)
+            throw std::runtime_error("[MeshBuilder]: Triangle list of " + std::to_string(vertexCount) + " vertices isn't whole triangles");
+
+        const auto* source = static_cast<const std::byte*>( vertices );
+        const std::size_t stride = m_Layout.stride;
+        m_Indices.reserve(m_Indices.size() + vertexCount);
+
+        for(std::size_t i = 0; i < vertexCount; i++)
+        {
+            // The candidate is appended first so the set can hash it in place
+            const auto candidate = static_cast<unsigned int>( m_Vertices.size() / stride );
+            m_Vertices.insert(m_Vertices.end(), source + i * stride, source + (i + 1) * stride);
+
+            if(const auto it = m_Welded.find(candidate); it != m_Welded.end())
+            {
+                m_Vertices.resize(m_Vertices.size() - stride);
+                m_Indices.push_back(*it);
+            } else
+            {
+                m_Welded.insert(candidate);
+                m_Indices.push_back(candidate);
+            }
+        }
+    }
+
+    void MeshBuilder::addTriangleList(const std::vector<float>& vertices)
+    {
+        const std::size_t bytes = vertices.size() * sizeof(float);
+        if(bytes % m_Layout.stride != 0)
+            throw std::runtime_error("[MeshBuilder]: " + std::to_string(vertices.size()) + " floats aren't whole vertices of "
+                                     + std::to_string(m_Layout.stride) + " bytes");
+        addTriangleList(vertices.data(), bytes / m_Layout.stride);
+    }
+
+    MeshData MeshBuilder::build(const MeshBuildOptions& options) const
+    {
+        MeshData mesh{ m_Layout, m_Vertices, m_Indices };
+        const VertexCacheStats before = analyzeVertexCache(mesh.indices, mesh.vertexCount(), options.cacheSize);
+
+        if(options.optimizeVertexCache)
+            optimizeVertexCache(mesh.indices, mesh.vertexCount(), options.cacheSize);
+        if(options.optimizeOverdraw)
+            optimizeOverdraw(mesh, options.cacheSize, options.overdrawThreshold);
+        if(options.optimizeVertexFetch)
+            optimizeVertexFetch(mesh);
+
+        if(options.logStats)
+        {
+            const VertexCacheStats after = analyzeVertexCache(mesh.indices, mesh.vertexCount(), options.cacheSize);
+            std::cerr << "[MeshBuilder]: " << m_Indices.size() << " -> " << mesh.vertexCount() << " vertices, "
+                    << mesh.indices.size() / 3 << " triangles, ACMR " << before.acmr << " -> " << after.acmr
+                    << ", ATVR " << before.atvr << " -> " << after.atvr << '\n';
+        }
+        return mesh;
+    }
+
+    VertexCacheStats MeshBuilder::analyzeVertexCache(const std::vector<unsigned int>& indices,
+                                                     const std::size_t vertexCount, const unsigned int cacheSize)
+    {
+        VertexCacheStats stats{};
+        if(indices.empty()) return stats;
+
+        const std::vector<unsigned char> misses = simulateTriangleMisses(indices, vertexCount, cacheSize);
+        const std::size_t totalMisses = std::accumulate(misses.begin(), misses.end(), std::size_t{ 0 });
+
+        std::vector<bool> used(vertexCount, false);
+        std::size_t usedVertices = 0;
+        for(const unsigned int index : indices)
+        {
+            if(!used[index])
+            {
+                used[index] = true;
+                usedVertices++;
+            }
+        }
+
+        stats.acmr = static_cast<float>( totalMisses ) / static_cast<float>( misses.size() );
+        stats.atvr = static_cast<float>( totalMisses ) / static_cast<float>( usedVertices );
+        return stats;
+    }
+
+    void MeshBuilder::optimizeVertexCache(std::vector<unsigned int>& indices, const std::size_t vertexCount,
+                                          const unsigned int cacheSize)
+    {
+        const std::size_t triangleCount = indices.size() / 3;
+        if(triangleCount == 0) return;
+
+        // Vertex -> triangle adjacency stored as offsets into one flat array
+        std::vector<unsigned int> liveTriangles(vertexCount, 0);
+        for(const unsigned int index : indices) liveTriangles[index]++;
+
+        std::vector<std::size_t> adjacencyOffsets(vertexCount + 1, 0);
+        for(std::size_t v = 0; v < vertexCount; v++)
+            adjacencyOffsets[v + 1] = adjacencyOffsets[v] + liveTriangles[v];
+
+        std::vector<unsigned int> adjacency(indices.size());
+        std::vector<std::size_t> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for(std::size_t t = 0; t < triangleCount; t++)
+        {
+            for(std::size_t k = 0; k < 3; k++)
+                adjacency[fill[indices[t * 3 + k]]++] = static_cast<unsigned int>( t );
+        }
+
+        std::vector<unsigned int> cacheTime(vertexCount, 0);
+        std::vector<bool> emitted(triangleCount, false);
+        std::vector<unsigned int> deadEnd;
+        std::vector<unsigned int> candidates;
+        std::vector<unsigned int> result;
+        deadEnd.reserve(indices.size());
+        result.reserve(indices.size());
+
+        unsigned int timestamp = cacheSize + 1;
+        std::size_t cursor = 0;
+        std::size_t fanning = indices[0];
+
+        while(fanning != NoVertex)
+        {
+            // Emits every remaining triangle around the fanning vertex
+            candidates.clear();
+            for(std::size_t i = adjacencyOffsets[fanning]; i < adjacencyOffsets[fanning + 1]; i++)
+            {
+                const unsigned int triangle = adjacency[i];
+                if(emitted[triangle]) continue;
+
+                for(std::size_t k = 0; k < 3; k++)
+                {
+                    const unsigned int vertex = indices[triangle * 3 + k];
+                    result.push_back(vertex);
+                    deadEnd.push_back(vertex);
+                    candidates.push_back(vertex);
+                    liveTriangles[vertex]--;
+                    if(timestamp - cacheTime[vertex] > cacheSize)
+                        cacheTime[vertex] = timestamp++;
+                }
+                emitted[triangle] = true;
+            }
+
+            // Picks the candidate that will still be in the cache once its remaining triangles are emitted
+            fanning = NoVertex;
+            long long bestPriority = -1;
+            for(const unsigned int vertex : candidates)
+            {
+                if(liveTriangles[vertex] == 0) continue;
+
+                long long priority = 0;
+                const long long age = timestamp - cacheTime[vertex];
+                if(age + 2 * static_cast<long long>( liveTriangles[vertex] ) <= static_cast<long long>( cacheSize ))
+                    priority = age;
+
+                if(priority > bestPriority)
+                {
+                    bestPriority = priority;
+                    fanning = vertex;
+                }
+            }
+
+            // Dead end: fall back to recently used vertices, then to the next unprocessed one in order
+            if(fanning == NoVertex)
+            {
+                while(!deadEnd.empty())
+                {
+                    const unsigned int vertex = deadEnd.back();
+                    deadEnd.pop_back();
+                    if(liveTriangles[vertex] > 0)
+                    {
+                        fanning = vertex;
+                        break;
+                    }
+                }
+            }
+            while(fanning == NoVertex && cursor < vertexCount)
+            {
+                if(liveTriangles[cursor] > 0) fanning = cursor;
+                else cursor++;
+            }
+        }
+
+        indices.swap(result);
+    }
+
+    void MeshBuilder::optimizeOverdraw(MeshData& mesh, const unsigned int cacheSize, const float threshold)
+    {
+        const VertexAttribute* positionAttr = findPositionAttribute(mesh.layout);
+        const std::size_t triangleCount = mesh.indices.size() / 3;
+        if(positionAttr == nullptr)
+        {
+            std::cerr << "[MeshBuilder] Warning: No vec3 position at location 0, skipping overdraw pass" << '\n';
+            return;
+        }
+        if(triangleCount < 2) return;
+
+        /* Splits the cache optimised order into clusters. A triangle missing all three vertices
+         * starts a hard cluster, a cluster is also cut at a 2+ miss triangle once its own
+         * ACMR is within the threshold of the whole mesh, so the cache win is mostly kept. */
+        const std::vector<unsigned char> misses = simulateTriangleMisses(mesh.indices, mesh.vertexCount(), cacheSize);
+        const float meshAcmr = analyzeVertexCache(mesh.indices, mesh.vertexCount(), cacheSize).acmr;
+
+        std::vector<std::size_t> clusterStarts{ 0 };
+        std::size_t clusterMisses = misses[0];
+        for(std::size_t t = 1; t < triangleCount; t++)
+        {
+            const std::size_t clusterSize = t - clusterStarts.back();
+            const float clusterAcmr = static_cast<float>( clusterMisses ) / static_cast<float>( clusterSize );
+            const bool hardBoundary = misses[t] == 3;
+            const bool softBoundary = misses[t] >= 2 && clusterAcmr <= meshAcmr * threshold;
+
+            if(hardBoundary || softBoundary)
+            {
+                clusterStarts.push_back(t);
+                clusterMisses = 0;
+            }
+            clusterMisses += misses[t];
+        }
+        clusterStarts.push_back(triangleCount);
+
+        // Mesh centroid, triangles are weighted by area
+        Float3 meshCentroid{ 0.0f, 0.0f, 0.0f };
+        float meshArea = 0.0f;
+        struct Cluster
+        {
+            std::size_t begin, end;
+            float sortKey;
+        };
+        std::vector<Cluster> clusters;
+        std::vector<Float3> clusterCentroids;
+        std::vector<Float3> clusterNormals;
+
+        for(std::size_t c = 0; c + 1 < clusterStarts.size(); c++)
+        {
+            Float3 centroid{ 0.0f, 0.0f, 0.0f };
+            Float3 normal{ 0.0f, 0.0f, 0.0f };
+            float area = 0.0f;
+
+            for(std::size_t t = clusterStarts[c]; t < clusterStarts[c + 1]; t++)
+            {
+                const Float3 a = readPosition(mesh, positionAttr->offset, mesh.indices[t * 3 + 0]);
+                const Float3 b = readPosition(mesh, positionAttr->offset, mesh.indices[t * 3 + 1]);
+                const Float3 p = readPosition(mesh, positionAttr->offset, mesh.indices[t * 3 + 2]);
+                const Float3 n = cross(b - a, p - a);
+                const float triangleArea = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+
+                centroid.x += (a.x + b.x + p.x) / 3.0f * triangleArea;
+                centroid.y += (a.y + b.y + p.y) / 3.0f * triangleArea;
+                centroid.z += (a.z + b.z + p.z) / 3.0f * triangleArea;
+                normal.x += n.x;
+                normal.y += n.y;
+                normal.z += n.z;
+                area += triangleArea;
+            }
+
+            meshCentroid.x += centroid.x;
+            meshCentroid.y += centroid.y;
+            meshCentroid.z += centroid.z;
+            meshArea += area;
+
+            const float inverseArea = area > 0.0f ? 1.0f / area : 0.0f;
+            clusterCentroids.push_back({ centroid.x * inverseArea, centroid.y * inverseArea, centroid.z * inverseArea });
+            clusterNormals.push_back(normal);
+            clusters.push_back({ clusterStarts[c], clusterStarts[c + 1], 0.0f });
+        }
+
+        const float inverseMeshArea = meshArea > 0.0f ? 1.0f / meshArea : 0.0f;
+        meshCentroid = { meshCentroid.x * inverseMeshArea, meshCentroid.y * inverseMeshArea, meshCentroid.z * inverseMeshArea };
+
+        // Clusters facing away from the centre are likely occluders, so they are drawn first
+        for(std::size_t c = 0; c < clusters.size(); c++)
+        {
+            const Float3 n = clusterNormals[c];
+            const float length = std::sqrt(n.x * n.x + n.y * n.y + n.z * n.z);
+            const Float3 d = clusterCentroids[c] - meshCentroid;
+            clusters[c].sortKey = length > 0.0f ? (d.x * n.x + d.y * n.y + d.z * n.z) / length : 0.0f;
+        }
+        std::stable_sort(clusters.begin(), clusters.end(),
+                         [](const Cluster& a, const Cluster& b) { return a.sortKey > b.sortKey; });
+
+        std::vector<unsigned int> result;
+        result.reserve(mesh.indices.size());
+        for(const auto& cluster : clusters)
+        {
+            result.insert(result.end(), mesh.indices.begin() + static_cast<std::ptrdiff_t>( cluster.begin * 3 ),
+                          mesh.indices.begin() + static_cast<std::ptrdiff_t>( cluster.end * 3 ));
+        }
+        mesh.indices.swap(result);
+    }
+
+    void MeshBuilder::optimizeVertexFetch(MeshData& mesh)
+    {
+        const std::size_t stride = mesh.layout.stride;
+        constexpr unsigned int Unmapped = std::numeric_limits<unsigned int>::max();
+        std::vector<unsigned int> remap(mesh.vertexCount(), Unmapped);
+        std::vector<std::byte> vertices;
+        vertices.reserve(mesh.vertices.size());
+
+        // Vertices are stored in the order the index buffer first touches them
+        unsigned int next = 0;
+        for(unsigned int& index : mesh.indices)
+        {
+            if(remap[index] == Unmapped)
+            {
+                remap[index] = next++;
+                const auto* source = mesh.vertices.data() + static_cast<std::size_t>( index ) * stride;
+                vertices.insert(vertices.end(), source, source + stride);
+            }
+            index = remap[index];
+        }
+        mesh.vertices.swap(vertices);
+    }
+
+    bool MeshBuilder::appendLod(MeshData& mesh, const MeshData& lod, const float error)
+    {
+        if(lod.layout != mesh.layout || lod.positionOffset != mesh.positionOffset || lod.positionScale != mesh.positionScale)
+        {
+            std::cerr << "[MeshBuilder] Warning: LOD layout or quantisation differs from the mesh, not appended" << '\n';
+            return false;
+        }
+        if(mesh.lods.empty())
+            mesh.lods.push_back({ 0, static_cast<std::uint32_t>( mesh.indices.size() ), 0.0f });
+        if(error < mesh.lods.back().error)
+        {
+            std::cerr << "[MeshBuilder] Warning: LOD error " << error << " is below the previous level's, not appended" << '\n';
+            return false;
+        }
+
+        const auto baseVertex = static_cast<unsigned int>( mesh.vertexCount() );
+        mesh.lods.push_back({ static_cast<std::uint32_t>( mesh.indices.size() ), static_cast<std::uint32_t>( lod.indices.size() ), error });
+        mesh.vertices.insert(mesh.vertices.end(), lod.vertices.begin(), lod.vertices.end());
+        for(const unsigned int index : lod.indices)
+            mesh.indices.push_back(baseVertex + index);
+        return true;
+    }
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include <VertexLayout.h>
+#include <cstddef>
+#include <cstdint>
+#include <unordered_set>
+#include <vector>
+
+namespace core
+{
+    /* One level of detail: a range of the mesh's index buffer, and the geometric error of that
+     * range, the farthest (in model units) its surface strays from the full detail mesh. */
+    struct MeshLod
+    {
+        std::uint32_t firstIndex = 0;
+        std::uint32_t indexCount = 0;
+        float error = 0.0f;
+    };
+
+    constexpr std::size_t MaxLodLevels = 8;
+
+    // CPU side indexed mesh, the format Mesh uploads
+    struct MeshData
+    {
+        VertexLayoutDesc layout;
+        std::vector<std::byte> vertices;// interleaved, layout.stride bytes per vertex
+        std::vector<unsigned int> indices;// triangle list
+        // Quantised positions are stored as (p - positionOffset) / positionScale
+        glm::vec3 positionOffset = glm::vec3(0.0f);
+        float positionScale = 1.0f;
+        // Finest first with increasing error. Empty means a single level over every index
+        std::vector<MeshLod> lods{};
+
+        [[nodiscard]] std::size_t vertexCount() const;
+    };
+
+    // Post-transform vertex cache efficiency, simulated with a FIFO cache
+    struct VertexCacheStats
+    {
+        float acmr = 0.0f;// average cache miss ratio: vertex shader runs per triangle (0.5 - 3.0)
+        float atvr = 0.0f;// average transformed vertex ratio: vertex shader runs per vertex (1.0 is ideal)
+    };
+
+    struct MeshBuildOptions
+    {
+        bool optimizeVertexCache = true;
+        bool optimizeOverdraw = true;
+        bool optimizeVertexFetch = true;
+        unsigned int cacheSize = 16;
+        // How much worse than the cache optimised ACMR a cluster may get when splitting for overdraw
+        float overdrawThreshold = 1.05f;
+        bool logStats = true;
+    };
+
+    /* Welds duplicate vertices of triangle soups into an index buffer and reorders the result:
+     *   - triangles for post-transform cache locality (Tipsify, Sander et al. 2007)
+     *   - triangle clusters so outward facing ones draw first, reducing overdraw
+     *   - vertices in first-use order for pre-transform fetch locality
+     * The overdraw pass reads positions from the vec3 float attribute at location 0. */
+    class MeshBuilder
+    {
+    private:
+        // Hashes/compares welded vertices by their bytes inside m_Vertices
+        struct VertexHash
+        {
+            const MeshBuilder* builder;
+            std::size_t operator()(unsigned int index) const noexcept;
+        };
+
+        struct VertexEqual
+        {
+            const MeshBuilder* builder;
+            bool operator()(unsigned int a, unsigned int b) const noexcept;
+        };
+
+        VertexLayoutDesc m_Layout;
+        std::vector<std::byte> m_Vertices;
+        std::vector<unsigned int> m_Indices;
+        std::unordered_set<unsigned int, VertexHash, VertexEqual> m_Welded;
+
+        [[nodiscard]] const std::byte* vertexAt(unsigned int index) const;
+
+    public:
+        explicit MeshBuilder(VertexLayoutDesc layout);
+
+        MeshBuilder(const MeshBuilder&) = delete;
+
+        MeshBuilder& operator=(const MeshBuilder&) = delete;
+
+        // Adds a non-indexed triangle list, identical vertices are welded together. Throws if
+        // vertexCount isn't a multiple of 3
+        void addTriangleList(const void* vertices, std::size_t vertexCount);
+
+        // Throws as well if the floats don't split into whole vertices of the layout's stride
+        void addTriangleList(const std::vector<float>& vertices);
+
+        // Produces the optimised mesh, logging ACMR/ATVR before and after if requested
+        [[nodiscard]] MeshData build(const MeshBuildOptions& options = {}) const;
+
+        static VertexCacheStats analyzeVertexCache(const std::vector<unsigned int>& indices, std::size_t vertexCount,
+                                                   unsigned int cacheSize = 16);
+
+        static void optimizeVertexCache(std::vector<unsigned int>& indices, std::size_t vertexCount,
+                                        unsigned int cacheSize = 16);
+
+        static void optimizeOverdraw(MeshData& mesh, unsigned int cacheSize = 16, float threshold = 1.05f);
+
+        static void optimizeVertexFetch(MeshData& mesh);
+
+        /* Appends lod's vertices and indices to mesh as its next coarser level. Both must share
+         * the layout and quantisation, and the optimisations above must already have run, they
+         * reorder the whole index buffer and would mix the levels' ranges. */
+        static bool appendLod(MeshData& mesh, const MeshData& lod, float error);
+    };
+}
@@ -0,0 +1,586 @@
+#include <MeshSimplifier.h>
+#include <JobSystem.h>
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <numeric>
+
+namespace core
+{
+    namespace
+    {
+        constexpr std::uint32_t Invalid = std::numeric_limits<std::uint32_t>::max();
+        // Border planes are weighted by the edge's squared length times this, enough to keep the outline
+        constexpr float BorderWeight = 4.0f;
+        // A triangle whose normal turns further than acos(0.25) counts as flipped
+        constexpr float FlipThreshold = 0.25f;
+        // Collapses costing more than this multiple of the pass's goal cost wait for the next pass
+        constexpr float PassCostSlack = 1.5f;
+
+        template <typename Function>
+        void forEach(JobSystem* jobs, const std::size_t count, const Function& function)
+        {
+            if(jobs != nullptr) jobs->parallelFor(count, 0, function);
+            else function(std::size_t(0), count);
+        }
+
+        std::uint32_t hashPosition(const glm::vec3& position)
+        {
+            std::uint32_t hash = 2166136261u;
+            for(int axis = 0; axis < 3; axis++)
+            {
+                hash ^= std::bit_cast<std::uint32_t>(position[axis]);
+                hash *= 16777619u;
+                hash ^= hash >> 15;
+            }
+            return hash;
+        }
+    }
+
+    void MeshSimplifier::Quadric::addPlane(const glm::vec3& normal, const float distance, const float planeWeight)
+    {
+        a00 += planeWeight * normal.x * normal.x;
+        a11 += planeWeight * normal.y * normal.y;
+        a22 += planeWeight * normal.z * normal.z;
+        a01 += planeWeight * normal.x * normal.y;
+        a02 += planeWeight * normal.x * normal.z;
+        a12 += planeWeight * normal.y * normal.z;
+        b0 += planeWeight * normal.x * distance;
+        b1 += planeWeight * normal.y * distance;
+        b2 += planeWeight * normal.z * distance;
+        c += planeWeight * distance * distance;
+        weight += planeWeight;
+    }
+
+    void MeshSimplifier::Quadric::add(const Quadric& other)
+    {
+        a00 += other.a00;
+        a11 += other.a11;
+        a22 += other.a22;
+        a01 += other.a01;
+        a02 += other.a02;
+        a12 += other.a12;
+        b0 += other.b0;
+        b1 += other.b1;
+        b2 += other.b2;
+        c += other.c;
+        weight += other.weight;
+    }
+
+    float MeshSimplifier::Quadric::evaluate(const glm::vec3& point) const
+    {
+        const float x = point.x, y = point.y, z = point.z;
+        const float sum = a00 * x * x + a11 * y * y + a22 * z * z + 2.0f * (a01 * x * y + a02 * x * z + a12 * y * z) +
+                          2.0f * (b0 * x + b1 * y + b2 * z) + c;
+        // Rounding can take an exact fit slightly negative
+        return weight > 0.0f ? std::max(sum, 0.0f) / weight : 0.0f;
+    }
+
+    MeshSimplifier::MeshSimplifier(const MeshData& mesh, const std::span<const unsigned int> indices, const SimplifyOptions& options,
+                                   JobSystem* jobs)
+        : m_Options(options),
+          m_Jobs(jobs)
+    {
+        const VertexAttribute* positionAttr = nullptr;
+        for(const VertexAttribute& attr : mesh.layout.attributes)
+        {
+            if(attr.location == 0 && attr.type == GL_FLOAT && attr.components >= 3 && !attr.integer)
+                positionAttr = &attr;
+        }
+        if(positionAttr == nullptr)
+        {
+            std::cerr << "[MeshSimplifier] Warning: No float vec3 position at location 0, nothing to simplify" << '\n';
+            return;
+        }
+
+        const std::size_t vertexCount = mesh.vertexCount();
+        const std::size_t stride = mesh.layout.stride;
+        m_Positions.resize(vertexCount);
+        glm::vec3 boundsMin(std::numeric_limits<float>::max());
+        glm::vec3 boundsMax(-std::numeric_limits<float>::max());
+        for(std::size_t v = 0; v < vertexCount; v++)
+        {
+            std::memcpy(&m_Positions[v], mesh.vertices.data() + v * stride + positionAttr->offset, sizeof(glm::vec3));
+            boundsMin = glm::min(boundsMin, m_Positions[v]);
+            boundsMax = glm::max(boundsMax, m_Positions[v]);
+        }
+
+        // Costs are compared in the unit cube, so the attribute weight means the same for every mesh
+        const glm::vec3 extent = boundsMax - boundsMin;
+        m_Scale = std::max(std::max(extent.x, extent.y), extent.z);
+        if(!(m_Scale > 0.0f)) m_Scale = 1.0f;
+        for(glm::vec3& position : m_Positions)
+            position = (position - boundsMin) / m_Scale;
+
+        // Every other float attribute, up to MaxAttributes components
+        std::vector<std::pair<unsigned int, int>> attributeSources;
+        for(const VertexAttribute& attr : mesh.layout.attributes)
+        {
+            if(&attr == positionAttr || attr.type != GL_FLOAT || attr.integer) continue;
+            const int components = std::min(attr.components, static_cast<int>( MaxAttributes - m_AttributeCount ));
+            if(components <= 0) break;
+            attributeSources.emplace_back(attr.offset, components);
+            m_AttributeCount += static_cast<std::size_t>( components );
+        }
+        m_Attributes.resize(vertexCount * m_AttributeCount);
+        for(std::size_t v = 0; v < vertexCount; v++)
+        {
+            float* destination = m_Attributes.data() + v * m_AttributeCount;
+            for(const auto& [offset, components] : attributeSources)
+            {
+                std::memcpy(destination, mesh.vertices.data() + v * stride + offset, sizeof(float) * static_cast<std::size_t>( components ));
+                destination += components;
+            }
+        }
+
+        // Vertices that only differ in their attributes share a position id, open addressing on the position's bits
+        m_PositionOf.resize(vertexCount);
+        const std::size_t capacity = std::bit_ceil(std::max<std::size_t>(vertexCount * 2, 16));
+        std::vector<std::uint32_t> table(capacity, Invalid);
+        for(std::size_t v = 0; v < vertexCount; v++)
+        {
+            std::size_t slot = hashPosition(m_Positions[v]) & (capacity - 1);
+            while(true)
+            {
+                const std::uint32_t existing = table[slot];
+                if(existing == Invalid)
+                {
+                    table[slot] = static_cast<std::uint32_t>( v );
+                    m_PositionOf[v] = static_cast<std::uint32_t>( v );
+                    break;
+                }
+                if(std::memcmp(&m_Positions[existing], &m_Positions[v], sizeof(glm::vec3)) == 0)
+                {
+                    m_PositionOf[v] = existing;
+                    break;
+                }
+                slot = (slot + 1) & (capacity - 1);
+            }
+        }
+
+        // Triangles that are already degenerate at the position level would only get in the way
+        m_Indices.reserve(indices.size());
+        for(std::size_t t = 0; t + 2 < indices.size(); t += 3)
+        {
+            const unsigned int a = indices[t], b = indices[t + 1], c = indices[t + 2];
+            if(a >= vertexCount || b >= vertexCount || c >= vertexCount) continue;
+            if(m_PositionOf[a] == m_PositionOf[b] || m_PositionOf[b] == m_PositionOf[c] || m_PositionOf[a] == m_PositionOf[c]) continue;
+            m_Indices.insert(m_Indices.end(), { a, b, c });
+        }
+
+        m_Remap.resize(vertexCount);
+        std::iota(m_Remap.begin(), m_Remap.end(), 0u);
+        m_Flags.assign(vertexCount, 0);
+        m_Quadrics.assign(vertexCount, {});
+        buildAdjacency();
+        classifyVertices();
+        computeQuadrics();
+    }
+
+    void MeshSimplifier::buildAdjacency()
+    {
+        m_AdjacencyOffsets.assign(m_Positions.size() + 1, 0);
+        for(std::size_t corner = 0; corner < m_Indices.size(); corner++)
+            m_AdjacencyOffsets[positionAt(corner) + 1]++;
+        std::partial_sum(m_AdjacencyOffsets.begin(), m_AdjacencyOffsets.end(), m_AdjacencyOffsets.begin());
+
+        m_Adjacency.resize(m_Indices.size());
+        std::vector<std::uint32_t> cursor(m_AdjacencyOffsets.begin(), m_AdjacencyOffsets.end() - 1);
+        for(std::size_t corner = 0; corner < m_Indices.size(); corner++)
+            m_Adjacency[cursor[positionAt(corner)]++] = static_cast<std::uint32_t>( corner / 3 );
+    }
+
+    void MeshSimplifier::classifyVertices()
+    {
+        forEach(m_Jobs, m_Positions.size(), [this](const std::size_t first, const std::size_t last)
+        {
+            for(std::size_t p = first; p < last; p++)
+            {
+                const std::uint32_t begin = m_AdjacencyOffsets[p], end = m_AdjacencyOffsets[p + 1];
+                std::uint8_t flags = 0;
+                for(std::uint32_t i = begin; i < end; i++)
+                {
+                    const std::size_t t = m_Adjacency[i];
+                    const std::size_t k = positionAt(t * 3) == p ? 0 : positionAt(t * 3 + 1) == p ? 1 : 2;
+                    // Both edges through p, each counted over every triangle around p
+                    for(const std::uint32_t other : { positionAt(t * 3 + (k + 1) % 3), positionAt(t * 3 + (k + 2) % 3) })
+                    {
+                        std::size_t shared = 0, outgoing = 0, incoming = 0;
+                        for(std::uint32_t j = begin; j < end; j++)
+                        {
+                            const std::size_t u = m_Adjacency[j];
+                            for(std::size_t c = 0; c < 3; c++)
+                            {
+                                if(positionAt(u * 3 + c) != p) continue;
+                                const std::uint32_t next = positionAt(u * 3 + (c + 1) % 3);
+                                const std::uint32_t prev = positionAt(u * 3 + (c + 2) % 3);
+                                if(next == other) outgoing++;
+                                if(prev == other) incoming++;
+                                if(next == other || prev == other) shared++;
+                            }
+                        }
+                        if(shared == 1) flags |= BorderFlag;
+                        if(shared > 2 || outgoing > 1 || incoming > 1) flags |= LockedFlag;
+                    }
+                }
+                if((flags & BorderFlag) != 0 && m_Options.lockBorders) flags |= LockedFlag;
+                m_Flags[p] = flags;
+            }
+        });
+    }
+
+    void MeshSimplifier::computeQuadrics()
+    {
+        forEach(m_Jobs, m_Positions.size(), [this](const std::size_t first, const std::size_t last)
+        {
+            for(std::size_t p = first; p < last; p++)
+            {
+                Quadric quadric;
+                for(std::uint32_t i = m_AdjacencyOffsets[p]; i < m_AdjacencyOffsets[p + 1]; i++)
+                {
+                    const std::size_t t = m_Adjacency[i];
+                    const glm::vec3 corners[3] = { m_Positions[m_Indices[t * 3]], m_Positions[m_Indices[t * 3 + 1]], m_Positions[m_Indices[t * 3 + 2]] };
+                    const glm::vec3 cross = glm::cross(corners[1] - corners[0], corners[2] - corners[0]);
+                    const float length = glm::length(cross);
+                    if(length <= 0.0f) continue;
+
+                    // Area weighted, so the evaluated error is a mean squared distance
+                    const glm::vec3 normal = cross / length;
+                    quadric.addPlane(normal, -glm::dot(normal, corners[0]), length * 0.5f);
+
+                    // Borders that may move get a plane through the edge, perpendicular to the triangle
+                    if(m_Options.lockBorders || (m_Flags[p] & BorderFlag) == 0) continue;
+                    const std::size_t k = positionAt(t * 3) == p ? 0 : positionAt(t * 3 + 1) == p ? 1 : 2;
+                    for(const std::size_t other : { (k + 1) % 3, (k + 2) % 3 })
+                    {
+                        const std::uint32_t otherPosition = positionAt(t * 3 + other);
+                        std::size_t shared = 0;
+                        for(std::uint32_t j = m_AdjacencyOffsets[p]; j < m_AdjacencyOffsets[p + 1]; j++)
+                        {
+                            const std::size_t u = m_Adjacency[j];
+                            if(positionAt(u * 3) == otherPosition || positionAt(u * 3 + 1) == otherPosition || positionAt(u * 3 + 2) == otherPosition)
+                                shared++;
+                        }
+                        if(shared != 1) continue;
+
+                        const glm::vec3 edge = corners[other] - corners[k];
+                        const glm::vec3 borderNormal = glm::cross(edge, normal);
+                        const float borderLength = glm::length(borderNormal);
+                        if(borderLength <= 0.0f) continue;
+                        quadric.addPlane(borderNormal / borderLength, -glm::dot(borderNormal / borderLength, corners[k]),
+                                         glm::dot(edge, edge) * BorderWeight);
+                    }
+                }
+                m_Quadrics[p] = quadric;
+            }
+        });
+    }
+
+    bool MeshSimplifier::isCollapsed(const std::size_t triangle) const
+    {
+        const std::uint32_t a = positionAt(triangle * 3), b = positionAt(triangle * 3 + 1), c = positionAt(triangle * 3 + 2);
+        return a == b || b == c || a == c;
+    }
+
+    bool MeshSimplifier::mapWedges(const std::uint32_t source, const std::uint32_t target, WedgeMap& map) const
+    {
+        map.count = 0;
+        map.edgeTriangles = 0;
+        for(std::uint32_t i = m_AdjacencyOffsets[source]; i < m_AdjacencyOffsets[source + 1]; i++)
+        {
+            const std::size_t t = m_Adjacency[i];
+            if(isCollapsed(t)) continue;
+            std::uint32_t from = Invalid, to = Invalid;
+            for(std::size_t c = 0; c < 3; c++)
+            {
+                const std::uint32_t position = positionAt(t * 3 + c);
+                if(position == source) from = vertexAt(t * 3 + c);
+                else if(position == target) to = vertexAt(t * 3 + c);
+            }
+            if(to != Invalid) map.edgeTriangles++;
+
+            // Each of source's vertices has to land on exactly one of target's, found through a shared triangle
+            std::size_t slot = 0;
+            while(slot < map.count && map.from[slot] != from) slot++;
+            if(slot == map.count)
+            {
+                if(map.count == WedgeMap::MaxWedges) return false;
+                map.from[slot] = from;
+                map.to[slot] = to;
+                map.count++;
+            } else if(to != Invalid)
+            {
+                if(map.to[slot] == Invalid) map.to[slot] = to;
+                else if(map.to[slot] != to) return false;
+            }
+        }
+
+        for(std::size_t slot = 0; slot < map.count; slot++)
+        {
+            // A vertex without a triangle on the edge would take attributes from across a seam
+            if(map.to[slot] == Invalid) return false;
+        }
+        return map.edgeTriangles > 0;
+    }
+
+    bool MeshSimplifier::evaluateEdge(const std::uint32_t a, const std::uint32_t b, const bool border, Collapse& collapse) const
+    {
+        bool found = false;
+        for(const auto& [source, target] : { std::pair(a, b), std::pair(b, a) })
+        {
+            if((m_Flags[source] & LockedFlag) != 0) continue;
+            // Border vertices only slide along the border
+            if((m_Flags[source] & BorderFlag) != 0 && !border) continue;
+
+            WedgeMap map;
+            if(!mapWedges(source, target, map)) continue;
+
+            Quadric quadric = m_Quadrics[source];
+            quadric.add(m_Quadrics[target]);
+            const float error = quadric.evaluate(m_Positions[target]);
+
+            float attributeError = 0.0f;
+            for(std::size_t slot = 0; slot < map.count; slot++)
+            {
+                const float* from = m_Attributes.data() + static_cast<std::size_t>( map.from[slot] ) * m_AttributeCount;
+                const float* to = m_Attributes.data() + static_cast<std::size_t>( map.to[slot] ) * m_AttributeCount;
+                for(std::size_t i = 0; i < m_AttributeCount; i++)
+                    attributeError += (from[i] - to[i]) * (from[i] - to[i]);
+            }
+
+            const float cost = error + attributeError * m_Options.attributeWeight;
+            if(!found || cost < collapse.cost)
+            {
+                collapse = { source, target, cost, error };
+                found = true;
+            }
+        }
+        return found;
+    }
+
+    bool MeshSimplifier::flipsTriangles(const std::uint32_t source, const std::uint32_t target) const
+    {
+        for(std::uint32_t i = m_AdjacencyOffsets[source]; i < m_AdjacencyOffsets[source + 1]; i++)
+        {
+            const std::size_t t = m_Adjacency[i];
+            if(isCollapsed(t)) continue;
+            glm::vec3 before[3], after[3];
+            bool removed = false;
+            for(std::size_t c = 0; c < 3; c++)
+            {
+                const std::uint32_t position = positionAt(t * 3 + c);
+                removed = removed || position == target;
+                before[c] = m_Positions[position];
+                after[c] = position == source ? m_Positions[target] : before[c];
+            }
+            if(removed) continue;
+
+            const glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+            const glm::vec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+            const float lengths = glm::length(normalBefore) * glm::length(normalAfter);
+            if(glm::dot(normalBefore, normalBefore) > 0.0f && glm::dot(normalBefore, normalAfter) <= FlipThreshold * lengths)
+                return true;
+        }
+        return false;
+    }
+
+    void MeshSimplifier::collectRing(const std::uint32_t position, std::vector<std::uint32_t>& ring) const
+    {
+        ring.clear();
+        for(std::uint32_t i = m_AdjacencyOffsets[position]; i < m_AdjacencyOffsets[position + 1]; i++)
+        {
+            const std::size_t t = m_Adjacency[i];
+            if(isCollapsed(t)) continue;
+            for(std::size_t c = 0; c < 3; c++)
+            {
+                if(positionAt(t * 3 + c) != position) ring.push_back(positionAt(t * 3 + c));
+            }
+        }
+        std::sort(ring.begin(), ring.end());
+        ring.erase(std::unique(ring.begin(), ring.end()), ring.end());
+    }
+
+    bool MeshSimplifier::runPass(const std::size_t targetTriangles, float& maxError)
+    {
+        buildAdjacency();
+
+        // Every edge once: interior edges from the triangle where they run from the lower position id
+        const std::size_t triangleCount = m_Indices.size() / 3;
+        const float errorLimit = m_Options.maxError * m_Options.maxError;
+        std::vector<Collapse> candidates(triangleCount * 3, Collapse{ Invalid, Invalid, 0.0f, 0.0f });
+        forEach(m_Jobs, triangleCount, [&](const std::size_t first, const std::size_t last)
+        {
+            for(std::size_t t = first; t < last; t++)
+            {
+                for(std::size_t c = 0; c < 3; c++)
+                {
+                    const std::uint32_t a = positionAt(t * 3 + c);
+                    const std::uint32_t b = positionAt(t * 3 + (c + 1) % 3);
+                    std::size_t shared = 0;
+                    for(std::uint32_t i = m_AdjacencyOffsets[a]; i < m_AdjacencyOffsets[a + 1]; i++)
+                    {
+                        const std::size_t u = m_Adjacency[i];
+                        if(positionAt(u * 3) == b || positionAt(u * 3 + 1) == b || positionAt(u * 3 + 2) == b) shared++;
+                    }
+                    const bool border = shared == 1;
+                    if(a > b && !border) continue;
+
+                    Collapse collapse;
+                    if(evaluateEdge(a, b, border, collapse) && collapse.error <= errorLimit) candidates[t * 3 + c] = collapse;
+                }
+            }
+        });
+
+        // Cheapest first: non-negative floats sort like their bits
+        std::vector<std::uint64_t> order;
+        order.reserve(candidates.size() / 2);
+        for(std::size_t i = 0; i < candidates.size(); i++)
+        {
+            if(candidates[i].source != Invalid)
+                order.push_back(static_cast<std::uint64_t>( std::bit_cast<std::uint32_t>(candidates[i].cost) ) << 32 | i);
+        }
+        if(order.empty()) return false;
+        std::sort(order.begin(), order.end());
+
+        // Most collapses remove two triangles, the ones much dearer than the goal needs can wait a pass
+        const std::size_t removeGoal = triangleCount - targetTriangles;
+        const std::size_t goalIndex = std::min(order.size() - 1, removeGoal / 2);
+        const float costLimit = candidates[order[goalIndex] & 0xFFFFFFFFu].cost * PassCostSlack;
+
+        /* Collapses are checked against the triangles as earlier collapses of the pass left
+         * them (through m_Remap), only the two positions of a collapse are done for the pass:
+         * the target's quadric has changed and the source is gone. */
+        std::vector<std::uint8_t> touched(m_Positions.size(), 0);
+        std::size_t removed = 0, collapsed = 0;
+        for(const std::uint64_t key : order)
+        {
+            if(removed >= removeGoal) break;
+            const Collapse& collapse = candidates[key & 0xFFFFFFFFu];
+            if(collapse.cost > costLimit && collapsed > 0) break;
+            if(touched[collapse.source] != 0 || touched[collapse.target] != 0) continue;
+
+            WedgeMap map;
+            if(!mapWedges(collapse.source, collapse.target, map)) continue;
+
+            // Link condition: the two only share the neighbours across the edge, otherwise the surface pinches
+            collectRing(collapse.source, m_SourceRing);
+            collectRing(collapse.target, m_TargetRing);
+            std::size_t sharedNeighbours = 0;
+            for(auto a = m_SourceRing.begin(), b = m_TargetRing.begin(); a != m_SourceRing.end() && b != m_TargetRing.end();)
+            {
+                if(*a < *b) ++a;
+                else if(*b < *a) ++b;
+                else
+                {
+                    sharedNeighbours++;
+                    ++a;
+                    ++b;
+                }
+            }
+            if(sharedNeighbours != map.edgeTriangles) continue;
+            if(flipsTriangles(collapse.source, collapse.target)) continue;
+
+            m_Quadrics[collapse.target].add(m_Quadrics[collapse.source]);
+            for(std::size_t slot = 0; slot < map.count; slot++)
+                m_Remap[map.from[slot]] = map.to[slot];
+
+            touched[collapse.source] = touched[collapse.target] = 1;
+            removed += map.edgeTriangles;
+            collapsed++;
+            maxError = std::max(maxError, collapse.error);
+        }
+        if(collapsed == 0) return false;
+
+        // Moves the collapsed vertices and drops the triangles that lost an edge
+        std::size_t write = 0;
+        for(std::size_t t = 0; t < triangleCount; t++)
+        {
+            if(isCollapsed(t)) continue;
+            const unsigned int a = vertexAt(t * 3), b = vertexAt(t * 3 + 1), c = vertexAt(t * 3 + 2);
+            m_Indices[write++] = a;
+            m_Indices[write++] = b;
+            m_Indices[write++] = c;
+        }
+        m_Indices.resize(write);
+        std::iota(m_Remap.begin(), m_Remap.end(), 0u);
+        return true;
+    }
+
+    std::vector<SimplifiedLevel> MeshSimplifier::simplify(const std::span<const std::size_t> targetTriangles)
+    {
+        std::vector<SimplifiedLevel> levels;
+        float maxError = 0.0f;
+        for(const std::size_t target : targetTriangles)
+        {
+            const std::size_t previous = levels.empty() ? std::numeric_limits<std::size_t>::max() : levels.back().indices.size() / 3;
+            bool stuck = false;
+            while(getTriangleCount() > target && !stuck)
+                stuck = !runPass(target, maxError);
+
+            // A stuck run still keeps what it got, the caller decides if that is enough of a reduction
+            if(getTriangleCount() < previous && !m_Indices.empty())
+                levels.push_back({ m_Indices, std::sqrt(maxError) * m_Scale });
+            if(stuck) break;
+        }
+        return levels;
+    }
+
+    std::size_t MeshSimplifier::generateLods(MeshData& mesh, const LodChainOptions& options, JobSystem* jobs)
+    {
+        if(mesh.indices.empty()) return 0;
+
+        const MeshLod base = mesh.lods.empty() ? MeshLod{ 0, static_cast<std::uint32_t>( mesh.indices.size() ), 0.0f } : mesh.lods[0];
+        std::vector<unsigned int> baseIndices(mesh.indices.begin() + base.firstIndex,
+                                              mesh.indices.begin() + base.firstIndex + base.indexCount);
+
+        std::vector<std::size_t> targets;
+        std::size_t triangles = baseIndices.size() / 3;
+        for(std::size_t level = 0; level < std::min(options.maxLevels, MaxLodLevels - 1); level++)
+        {
+            triangles = static_cast<std::size_t>( static_cast<float>( triangles ) * options.reduction );
+            if(triangles < options.minTriangles) break;
+            targets.push_back(triangles);
+        }
+
+        std::vector<SimplifiedLevel> levels;
+        if(!targets.empty())
+        {
+            MeshSimplifier simplifier(mesh, baseIndices, options.simplify, jobs);
+            levels = simplifier.simplify(targets);
+        }
+
+        // Drops levels that barely differ from the one before
+        std::vector<SimplifiedLevel> kept;
+        std::size_t previous = baseIndices.size() / 3;
+        for(SimplifiedLevel& level : levels)
+        {
+            const std::size_t count = level.indices.size() / 3;
+            if(static_cast<float>( count ) > static_cast<float>( previous ) * options.minReduction) continue;
+            previous = count;
+            kept.push_back(std::move(level));
+        }
+
+        if(options.optimizeVertexCache)
+        {
+            const std::size_t vertexCount = mesh.vertexCount();
+            forEach(jobs, kept.size(), [&](const std::size_t first, const std::size_t last)
+            {
+                for(std::size_t i = first; i < last; i++)
+                    MeshBuilder::optimizeVertexCache(kept[i].indices, vertexCount);
+            });
+        }
+
+        mesh.indices = std::move(baseIndices);
+        mesh.lods = { MeshLod{ 0, static_cast<std::uint32_t>( mesh.indices.size() ), 0.0f } };
+        for(const SimplifiedLevel& level : kept)
+        {
+            mesh.lods.push_back({ static_cast<std::uint32_t>( mesh.indices.size() ), static_cast<std::uint32_t>( level.indices.size() ),
+                                  std::max(level.error, mesh.lods.back().error) });
+            mesh.indices.insert(mesh.indices.end(), level.indices.begin(), level.indices.end());
+        }
+        return kept.size();
+    }
+}
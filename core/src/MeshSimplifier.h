@@ -0,0 +1,163 @@
+#pragma once
+#include <MeshBuilder.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace core
+{
+    class JobSystem;
+
+    struct SimplifyOptions
+    {
+        // Cost of moving a vertex's attributes (normals, UVs, every float attribute besides the position) onto its target's
+        float attributeWeight = 0.01f;
+        // Keeps open edges where they are, so meshes that are split into parts don't open cracks between them
+        bool lockBorders = true;
+        // Largest geometric error a collapse may cause, as a fraction of the mesh's largest extent
+        float maxError = 0.1f;
+    };
+
+    struct LodChainOptions
+    {
+        // Coarser levels to generate after the full detail one, at most MaxLodLevels - 1 are kept
+        std::size_t maxLevels = 4;
+        // Each level aims for this fraction of the previous level's triangles
+        float reduction = 0.5f;
+        // No level is made below this many triangles
+        std::size_t minTriangles = 64;
+        // Levels that keep more than this fraction of the previous level's triangles aren't worth a switch
+        float minReduction = 0.85f;
+        // Reorders each level's triangles for the post-transform cache
+        bool optimizeVertexCache = true;
+        SimplifyOptions simplify{};
+    };
+
+    struct SimplifiedLevel
+    {
+        std::vector<unsigned int> indices;// into the source mesh's vertices
+        float error = 0.0f;                // in model units, see MeshLod::error
+    };
+
+    /* Quadric error metric simplification (Garland & Heckbert 1997) by half-edge collapses:
+     * a vertex moves onto a neighbour, so no vertex is ever created and every level indexes
+     * the source mesh's vertex buffer. A collapse costs the target's distance to the planes
+     * of every triangle the two vertices have absorbed (area weighted, so the error stays a
+     * distance), plus how far the moving vertex's attributes are from the target's.
+     * Seams, where one position has several vertices with different attributes, only
+     * collapse along themselves so both sides keep their attributes; non-manifold edges
+     * are locked, and so are borders unless lockBorders is off (then they only slide along
+     * themselves). Triangle normals may not flip.
+     * Collapses are made in passes: every edge's cost is evaluated (in parallel with a
+     * JobSystem), then the cheapest collapses are made in order, skipping any whose
+     * endpoints an earlier collapse of the pass already moved or grew. Positions are the
+     * float vec3 at location 0. */
+    class MeshSimplifier
+    {
+    private:
+        struct Quadric
+        {
+            float a00 = 0.0f, a11 = 0.0f, a22 = 0.0f, a01 = 0.0f, a02 = 0.0f, a12 = 0.0f;
+            float b0 = 0.0f, b1 = 0.0f, b2 = 0.0f;
+            float c = 0.0f;
+            float weight = 0.0f;
+
+            void addPlane(const glm::vec3& normal, float distance, float planeWeight);
+
+            void add(const Quadric& other);
+
+            // Weighted mean squared distance of a point to the planes
+            [[nodiscard]] float evaluate(const glm::vec3& point) const;
+        };
+
+        struct Collapse
+        {
+            std::uint32_t source = 0;// position ids
+            std::uint32_t target = 0;
+            float cost = 0.0f;
+            float error = 0.0f;
+        };
+
+        // Attribute vertices the moving position's triangles switch to, one pair per vertex it uses
+        struct WedgeMap
+        {
+            static constexpr std::size_t MaxWedges = 8;
+
+            std::uint32_t from[MaxWedges];
+            std::uint32_t to[MaxWedges];
+            std::size_t count = 0;
+            std::size_t edgeTriangles = 0;// triangles that contain both positions, removed by the collapse
+        };
+
+        static constexpr std::size_t MaxAttributes = 8;
+        static constexpr std::uint8_t BorderFlag = 1;
+        static constexpr std::uint8_t LockedFlag = 2;
+
+        SimplifyOptions m_Options;
+        JobSystem* m_Jobs = nullptr;
+        float m_Scale = 1.0f;                 // model units per normalised unit
+        std::vector<glm::vec3> m_Positions;   // per vertex, normalised to the unit cube
+        std::vector<float> m_Attributes;      // m_AttributeCount floats per vertex
+        std::size_t m_AttributeCount = 0;
+        std::vector<std::uint32_t> m_PositionOf;// vertex -> first vertex with the same position (its position id)
+        std::vector<std::uint8_t> m_Flags;    // per position id
+        std::vector<Quadric> m_Quadrics;      // per position id
+        std::vector<unsigned int> m_Indices;  // the current triangles
+        std::vector<unsigned int> m_Remap;    // vertex -> the vertex it collapsed into during this pass
+
+        // Triangles around each position id, rebuilt every pass
+        std::vector<std::uint32_t> m_AdjacencyOffsets;
+        std::vector<std::uint32_t> m_Adjacency;
+
+        // Scratch for the sequential part of a pass
+        std::vector<std::uint32_t> m_SourceRing;
+        std::vector<std::uint32_t> m_TargetRing;
+
+        void buildAdjacency();
+
+        void classifyVertices();
+
+        void computeQuadrics();
+
+        [[nodiscard]] unsigned int vertexAt(std::size_t corner) const { return m_Remap[m_Indices[corner]]; }
+
+        [[nodiscard]] std::uint32_t positionAt(std::size_t corner) const { return m_PositionOf[vertexAt(corner)]; }
+
+        // Lost an edge to a collapse earlier in this pass
+        [[nodiscard]] bool isCollapsed(std::size_t triangle) const;
+
+        [[nodiscard]] bool mapWedges(std::uint32_t source, std::uint32_t target, WedgeMap& map) const;
+
+        // Cheapest valid direction of the edge, false when neither may collapse
+        [[nodiscard]] bool evaluateEdge(std::uint32_t a, std::uint32_t b, bool border, Collapse& collapse) const;
+
+        [[nodiscard]] bool flipsTriangles(std::uint32_t source, std::uint32_t target) const;
+
+        void collectRing(std::uint32_t position, std::vector<std::uint32_t>& ring) const;
+
+        // One pass, false when no collapse was possible
+        bool runPass(std::size_t targetTriangles, float& maxError);
+
+    public:
+        // indices is the source triangle list, usually MeshLod 0 of mesh
+        MeshSimplifier(const MeshData& mesh, std::span<const unsigned int> indices, const SimplifyOptions& options = {},
+                       JobSystem* jobs = nullptr);
+
+        MeshSimplifier(const MeshSimplifier&) = delete;
+
+        MeshSimplifier& operator=(const MeshSimplifier&) = delete;
+
+        /* Simplifies down to each triangle count in turn (decreasing), continuing from the
+         * previous level so every error is measured against the source. Stops early when no
+         * collapse under maxError is left, the result then has fewer levels. */
+        [[nodiscard]] std::vector<SimplifiedLevel> simplify(std::span<const std::size_t> targetTriangles);
+
+        [[nodiscard]] std::size_t getTriangleCount() const { return m_Indices.size() / 3; }
+
+        /* Replaces mesh's coarser levels with a chain simplified from level 0, each one a new
+         * index range over the same vertices with its achieved error. Returns the levels added. */
+        static std::size_t generateLods(MeshData& mesh, const LodChainOptions& options = {}, JobSystem* jobs = nullptr);
+    };
+}
@@ -0,0 +1,205 @@
+#include <Meshlets.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+namespace core
+{
+    namespace
+    {
+        constexpr std::uint32_t Invalid = std::numeric_limits<std::uint32_t>::max();
+        // Cones wider than this (as the smallest normal-to-axis dot) would hardly ever pass the test
+        constexpr float MinConeDot = 0.1f;
+        // Cost of a candidate's distance from the cluster's centre, per average edge length. Keeps clusters round
+        constexpr float SpreadWeight = 0.25f;
+
+        // Bounding sphere around the vertices' box centre and the normal cone of the triangles
+        void computeBounds(Meshlet& meshlet, const std::vector<glm::vec3>& positions, const unsigned int* indices)
+        {
+            glm::vec3 boundsMin(std::numeric_limits<float>::max());
+            glm::vec3 boundsMax(-std::numeric_limits<float>::max());
+            glm::vec3 normalSum(0.0f);
+            for(std::uint32_t i = 0; i < meshlet.indexCount; i += 3)
+            {
+                const glm::vec3& a = positions[indices[i]];
+                const glm::vec3& b = positions[indices[i + 1]];
+                const glm::vec3& c = positions[indices[i + 2]];
+                boundsMin = glm::min(glm::min(boundsMin, a), glm::min(b, c));
+                boundsMax = glm::max(glm::max(boundsMax, a), glm::max(b, c));
+                // Area weighted, so slivers don't tilt the axis
+                normalSum += glm::cross(b - a, c - a);
+            }
+
+            meshlet.center = (boundsMin + boundsMax) * 0.5f;
+            float radiusSquared = 0.0f;
+            for(std::uint32_t i = 0; i < meshlet.indexCount; i++)
+            {
+                const glm::vec3 offset = positions[indices[i]] - meshlet.center;
+                radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+            }
+            meshlet.radius = std::sqrt(radiusSquared);
+
+            const float normalLength = glm::length(normalSum);
+            if(!(normalLength > 0.0f)) return;
+            meshlet.coneAxis = normalSum / normalLength;
+
+            float minDot = 1.0f;
+            for(std::uint32_t i = 0; i < meshlet.indexCount; i += 3)
+            {
+                const glm::vec3& a = positions[indices[i]];
+                const glm::vec3 normal = glm::cross(positions[indices[i + 1]] - a, positions[indices[i + 2]] - a);
+                const float length = glm::length(normal);
+                if(length > 0.0f) minDot = std::min(minDot, glm::dot(normal / length, meshlet.coneAxis));
+            }
+            meshlet.coneCutoff = minDot <= MinConeDot ? 1.0f : std::sqrt(1.0f - minDot * minDot);
+        }
+    }
+
+    std::vector<Meshlet> buildMeshlets(MeshData& mesh, const MeshletOptions& options)
+    {
+        std::vector<Meshlet> meshlets;
+
+        const VertexAttribute* positionAttr = nullptr;
+        for(const VertexAttribute& attr : mesh.layout.attributes)
+        {
+            if(attr.location == 0 && attr.type == GL_FLOAT && attr.components >= 3 && !attr.integer)
+                positionAttr = &attr;
+        }
+        if(positionAttr == nullptr)
+        {
+            std::cerr << "[Meshlets] Warning: No float vec3 position at location 0, no meshlets built" << '\n';
+            return meshlets;
+        }
+        if(options.maxVertices < 3 || options.maxTriangles == 0)
+        {
+            std::cerr << "[Meshlets] Warning: A meshlet needs room for at least one triangle" << '\n';
+            return meshlets;
+        }
+
+        const std::size_t vertexCount = mesh.vertexCount();
+        const std::size_t stride = mesh.layout.stride;
+        std::vector<glm::vec3> positions(vertexCount);
+        for(std::size_t v = 0; v < vertexCount; v++)
+            std::memcpy(&positions[v], mesh.vertices.data() + v * stride + positionAttr->offset, sizeof(glm::vec3));
+
+        const std::size_t first = mesh.lods.empty() ? 0 : mesh.lods[0].firstIndex;
+        const std::size_t triangleCount = (mesh.lods.empty() ? mesh.indices.size() : mesh.lods[0].indexCount) / 3;
+        const unsigned int* source = mesh.indices.data() + first;
+
+        // Triangles around each vertex
+        std::vector<std::uint32_t> offsets(vertexCount + 1, 0);
+        std::vector<std::uint32_t> adjacency(triangleCount * 3);
+        for(std::size_t i = 0; i < triangleCount * 3; i++)
+            offsets[source[i] + 1]++;
+        for(std::size_t v = 0; v < vertexCount; v++)
+            offsets[v + 1] += offsets[v];
+        std::vector<std::uint32_t> cursor(offsets.begin(), offsets.end() - 1);
+        for(std::size_t i = 0; i < triangleCount * 3; i++)
+            adjacency[cursor[source[i]]++] = static_cast<std::uint32_t>( i / 3 );
+
+        std::vector<glm::vec3> normals(triangleCount, glm::vec3(0.0f));
+        std::vector<glm::vec3> centroids(triangleCount);
+        float edgeSum = 0.0f;
+        for(std::size_t t = 0; t < triangleCount; t++)
+        {
+            const glm::vec3& a = positions[source[t * 3]];
+            const glm::vec3& b = positions[source[t * 3 + 1]];
+            const glm::vec3& c = positions[source[t * 3 + 2]];
+            const glm::vec3 normal = glm::cross(b - a, c - a);
+            const float length = glm::length(normal);
+            if(length > 0.0f) normals[t] = normal / length;
+            centroids[t] = (a + b + c) / 3.0f;
+            edgeSum += glm::length(b - a) + glm::length(c - b) + glm::length(a - c);
+        }
+        const float averageEdge = edgeSum > 0.0f ? edgeSum / static_cast<float>( triangleCount * 3 ) : 1.0f;
+
+        // Both hold the index of the meshlet that last took the vertex or listed the triangle, so nothing is cleared per meshlet
+        std::vector<std::uint32_t> vertexOwner(vertexCount, Invalid);
+        std::vector<std::uint32_t> candidateOwner(triangleCount, Invalid);
+        std::vector<std::uint8_t> emitted(triangleCount, 0);
+        std::vector<std::uint32_t> candidates;
+        std::vector<unsigned int> reordered;
+        reordered.reserve(triangleCount * 3);
+
+        std::uint32_t seed = 0;
+        while(true)
+        {
+            while(seed < triangleCount && emitted[seed] != 0)
+                seed++;
+            if(seed == triangleCount) break;
+
+            const auto meshletIndex = static_cast<std::uint32_t>( meshlets.size() );
+            Meshlet meshlet;
+            meshlet.firstIndex = static_cast<std::uint32_t>( first + reordered.size() );
+            glm::vec3 normalSum(0.0f);
+            glm::vec3 centroidSum(0.0f);
+            candidates.clear();
+
+            auto addTriangle = [&](const std::uint32_t triangle)
+            {
+                emitted[triangle] = 1;
+                normalSum += normals[triangle];
+                centroidSum += centroids[triangle];
+                meshlet.indexCount += 3;
+                for(std::size_t corner = 0; corner < 3; corner++)
+                {
+                    const unsigned int vertex = source[triangle * 3 + corner];
+                    reordered.push_back(vertex);
+                    if(vertexOwner[vertex] == meshletIndex) continue;
+
+                    vertexOwner[vertex] = meshletIndex;
+                    meshlet.vertexCount++;
+                    for(std::uint32_t i = offsets[vertex]; i < offsets[vertex + 1]; i++)
+                    {
+                        const std::uint32_t neighbour = adjacency[i];
+                        if(emitted[neighbour] != 0 || candidateOwner[neighbour] == meshletIndex) continue;
+                        candidateOwner[neighbour] = meshletIndex;
+                        candidates.push_back(neighbour);
+                    }
+                }
+            };
+
+            addTriangle(seed);
+            while(meshlet.indexCount / 3 < options.maxTriangles)
+            {
+                const float normalLength = glm::length(normalSum);
+                const glm::vec3 axis = normalLength > 0.0f ? normalSum / normalLength : glm::vec3(0.0f);
+                const glm::vec3 center = centroidSum / static_cast<float>( meshlet.indexCount / 3 );
+
+                // Candidates border the meshlet, so each adds at most two vertices
+                std::uint32_t best = Invalid;
+                float bestScore = std::numeric_limits<float>::max();
+                std::size_t write = 0;
+                for(const std::uint32_t triangle : candidates)
+                {
+                    if(emitted[triangle] != 0) continue;
+                    candidates[write++] = triangle;
+
+                    std::size_t newVertices = 0;
+                    for(std::size_t corner = 0; corner < 3; corner++)
+                        newVertices += vertexOwner[source[triangle * 3 + corner]] != meshletIndex ? 1 : 0;
+                    if(meshlet.vertexCount + newVertices > options.maxVertices) continue;
+
+                    const float score = static_cast<float>( newVertices ) + options.coneWeight * (1.0f - glm::dot(normals[triangle], axis)) +
+                                        SpreadWeight * glm::length(centroids[triangle] - center) / averageEdge;
+                    if(score < bestScore)
+                    {
+                        bestScore = score;
+                        best = triangle;
+                    }
+                }
+                candidates.resize(write);
+                if(best == Invalid) break;
+                addTriangle(best);
+            }
+
+            computeBounds(meshlet, positions, reordered.data() + (meshlet.firstIndex - first));
+            meshlets.push_back(meshlet);
+        }
+
+        std::copy(reordered.begin(), reordered.end(), mesh.indices.begin() + static_cast<std::ptrdiff_t>( first ));
+        return meshlets;
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include <MeshBuilder.h>
+#include <glm/glm.hpp>
+#include <cstdint>
+#include <vector>
+
+namespace core
+{
+    /* A cluster of at most MeshletOptions::maxVertices vertices and maxTriangles triangles,
+     * stored as a contiguous range of the mesh's index buffer so it draws with one
+     * glDrawElements range (or indirect command). std430 layout, the cluster culling shader
+     * reads it as is. */
+    struct Meshlet
+    {
+        glm::vec3 center = glm::vec3(0.0f);// bounding sphere, model space
+        float radius = 0.0f;
+        /* Normal cone: every triangle faces within acos(sqrt(1 - coneCutoff^2)) of coneAxis.
+         * Seen from p, the whole cluster faces away when
+         *   dot(center - p, coneAxis) >= coneCutoff * length(center - p) + radius
+         * A cutoff of 1 never culls (the normals spread too far for the test to be useful). */
+        glm::vec3 coneAxis = glm::vec3(0.0f, 0.0f, 1.0f);
+        float coneCutoff = 1.0f;
+        std::uint32_t firstIndex = 0;
+        std::uint32_t indexCount = 0;
+        std::int32_t baseVertex = 0;// for meshes sharing one vertex buffer, the builder leaves it 0
+        std::uint32_t vertexCount = 0;
+    };
+
+    static_assert(sizeof(Meshlet) == 48, "Meshlet must match the std430 struct in cluster.comp");
+
+    struct MeshletOptions
+    {
+        // 64 vertices and 124 triangles fit a mesh shader workgroup's output on every vendor
+        std::size_t maxVertices = 64;
+        std::size_t maxTriangles = 124;
+        // Weight of a candidate's normal against the cluster's when picking the next triangle, tighter cones cull more
+        float coneWeight = 0.5f;
+    };
+
+    /* Splits level 0 of mesh (the whole index buffer without LODs) into meshlets, reordering
+     * its triangles so every meshlet is one index range. Clusters grow greedily from a seed
+     * triangle, preferring neighbours that add the fewest new vertices, then the ones whose
+     * normal is closest to the cluster's and the ones nearest its centre. The seeds follow the
+     * existing triangle order, so a cache optimised mesh keeps its locality. Positions are the
+     * float vec3 at location 0. */
+    std::vector<Meshlet> buildMeshlets(MeshData& mesh, const MeshletOptions& options = {});
+}
@@ -0,0 +1,426 @@
+#include <OcclusionCuller.h>
+#include <MathSIMD.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <mutex>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace core
+{
+    namespace
+    {
+        using Clock = std::chrono::steady_clock;
+
+        /* Triangles are clipped against the near plane and a guard band twice the screen's
+         * size, past that the edge functions would lose too much precision. */
+        constexpr float GuardBand = 2.0f;
+        constexpr int ClipPlaneCount = 5;
+
+        // Buffers are padded so a row read 8 wide may run up to 7 floats past its end
+        constexpr std::size_t Padding = 8;
+
+        thread_local std::vector<glm::vec4> t_Clip;
+        thread_local std::vector<std::uint8_t> t_Outcodes;
+
+        // Signed distance to a clip plane, inside where >= 0
+        float planeDistance(const glm::vec4& v, const int plane)
+        {
+            switch(plane)
+            {
+                case 0: return v.z + v.w;
+                case 1: return GuardBand * v.w + v.x;
+                case 2: return GuardBand * v.w - v.x;
+                case 3: return GuardBand * v.w + v.y;
+                default: return GuardBand * v.w - v.y;
+            }
+        }
+
+        std::uint8_t outcode(const glm::vec4& v)
+        {
+            std::uint8_t code = 0;
+            for(int plane = 0; plane < ClipPlaneCount; plane++)
+            {
+                if(planeDistance(v, plane) < 0.0f) code |= static_cast<std::uint8_t>( 1u << plane );
+            }
+            return code;
+        }
+
+        // Edge from p to q as a * x + b * y + c, positive on the left
+        glm::vec3 edge(const glm::vec3& p, const glm::vec3& q)
+        {
+            return { p.y - q.y, q.x - p.x, p.x * q.y - q.x * p.y };
+        }
+
+        double elapsedMs(const Clock::time_point start)
+        {
+            return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        }
+    }
+
+    OcclusionCuller::OcclusionCuller(const OcclusionCullerOptions& options)
+        : m_Options(options)
+    {
+        m_TilesX = std::max(1u, (options.width + TileSize - 1) / TileSize);
+        m_TilesY = std::max(1u, (options.height + TileSize - 1) / TileSize);
+        m_Width = m_TilesX * TileSize;
+        m_Height = m_TilesY * TileSize;
+        m_Depth.assign(static_cast<std::size_t>( m_Width ) * m_Height + Padding, 0.0f);
+        m_TileDepth.assign(static_cast<std::size_t>( m_TilesX ) * m_TilesY + Padding, 0.0f);
+    }
+
+    void OcclusionCuller::beginFrame(const glm::mat4& viewProjection)
+    {
+        m_ViewProjection = viewProjection;
+        std::fill(m_Depth.begin(), m_Depth.end(), 0.0f);
+        std::fill(m_TileDepth.begin(), m_TileDepth.end(), 0.0f);
+        m_Occluders.clear();
+        m_Triangles.clear();
+        m_Stats = {};
+    }
+
+    void OcclusionCuller::addOccluder(const std::span<const glm::vec3> positions, const std::span<const unsigned int> indices,
+                                      const glm::mat4& model)
+    {
+        m_Occluders.push_back({ positions, indices, simd::multiply(m_ViewProjection, model) });
+        m_Stats.occluderTriangles += indices.size() / 3;
+    }
+
+    void OcclusionCuller::setupOccluder(const Occluder& occluder, std::vector<ScreenTriangle>& out) const
+    {
+        std::vector<glm::vec4>& clip = t_Clip;
+        std::vector<std::uint8_t>& outcodes = t_Outcodes;
+        clip.resize(occluder.positions.size());
+        outcodes.resize(occluder.positions.size());
+        for(std::size_t i = 0; i < occluder.positions.size(); i++)
+        {
+            clip[i] = occluder.modelViewProjection * glm::vec4(occluder.positions[i], 1.0f);
+            outcodes[i] = outcode(clip[i]);
+        }
+
+        const float width = static_cast<float>( m_Width );
+        const float height = static_cast<float>( m_Height );
+        auto emit = [&](const glm::vec4& c0, const glm::vec4& c1, const glm::vec4& c2)
+        {
+            if(c0.w <= 0.0f || c1.w <= 0.0f || c2.w <= 0.0f) return;
+
+            // Screen position in pixels and 1/w, which is linear across the screen
+            auto project = [width, height](const glm::vec4& c)
+            {
+                const float inverseW = 1.0f / c.w;
+                return glm::vec3((c.x * inverseW * 0.5f + 0.5f) * width, (c.y * inverseW * 0.5f + 0.5f) * height, inverseW);
+            };
+            glm::vec3 v0 = project(c0), v1 = project(c1), v2 = project(c2);
+
+            float area = (v1.x - v0.x) * (v2.y - v0.y) - (v2.x - v0.x) * (v1.y - v0.y);
+            if(area == 0.0f) return;
+            if(area < 0.0f)
+            {
+                if(m_Options.cullBackFaces) return;
+                std::swap(v1, v2);
+                area = -area;
+            }
+
+            // Pixels whose centre (x + 0.5) falls inside the triangle's box
+            ScreenTriangle triangle;
+            triangle.minX = std::max(0, static_cast<std::int32_t>( std::ceil(std::min({ v0.x, v1.x, v2.x }) - 0.5f) ));
+            triangle.minY = std::max(0, static_cast<std::int32_t>( std::ceil(std::min({ v0.y, v1.y, v2.y }) - 0.5f) ));
+            triangle.maxX = std::min(static_cast<std::int32_t>( m_Width ) - 1,
+                                     static_cast<std::int32_t>( std::floor(std::max({ v0.x, v1.x, v2.x }) - 0.5f) ));
+            triangle.maxY = std::min(static_cast<std::int32_t>( m_Height ) - 1,
+                                     static_cast<std::int32_t>( std::floor(std::max({ v0.y, v1.y, v2.y }) - 0.5f) ));
+            if(triangle.minX > triangle.maxX || triangle.minY > triangle.maxY) return;
+
+            triangle.edges[0] = edge(v1, v2);
+            triangle.edges[1] = edge(v2, v0);
+            triangle.edges[2] = edge(v0, v1);
+
+            const float dzdx = ((v1.z - v0.z) * (v2.y - v0.y) - (v2.z - v0.z) * (v1.y - v0.y)) / area;
+            const float dzdy = ((v2.z - v0.z) * (v1.x - v0.x) - (v1.z - v0.z) * (v2.x - v0.x)) / area;
+            triangle.depth = glm::vec3(v0.z - dzdx * v0.x - dzdy * v0.y, dzdx, dzdy);
+            out.push_back(triangle);
+        };
+
+        const std::span<const unsigned int> indices = occluder.indices;
+        for(std::size_t i = 0; i + 2 < indices.size(); i += 3)
+        {
+            const unsigned int a = indices[i], b = indices[i + 1], c = indices[i + 2];
+            // All three outside the same plane
+            if(outcodes[a] & outcodes[b] & outcodes[c]) continue;
+
+            const std::uint8_t crossed = outcodes[a] | outcodes[b] | outcodes[c];
+            if(crossed == 0)
+            {
+                emit(clip[a], clip[b], clip[c]);
+                continue;
+            }
+
+            // Sutherland-Hodgman against the planes the triangle crosses, each adds at most one vertex
+            std::array<glm::vec4, 3 + ClipPlaneCount> polygon{ clip[a], clip[b], clip[c] };
+            std::array<glm::vec4, 3 + ClipPlaneCount> clipped;
+            std::size_t count = 3;
+            for(int plane = 0; plane < ClipPlaneCount && count >= 3; plane++)
+            {
+                if(!(crossed & (1u << plane))) continue;
+
+                std::size_t clippedCount = 0;
+                for(std::size_t vertex = 0; vertex < count; vertex++)
+                {
+                    const glm::vec4& p = polygon[vertex];
+                    const glm::vec4& q = polygon[(vertex + 1) % count];
+                    const float dp = planeDistance(p, plane);
+                    const float dq = planeDistance(q, plane);
+                    if(dp >= 0.0f) clipped[clippedCount++] = p;
+                    if((dp >= 0.0f) != (dq >= 0.0f)) clipped[clippedCount++] = p + (q - p) * (dp / (dp - dq));
+                }
+                polygon = clipped;
+                count = clippedCount;
+            }
+
+            for(std::size_t vertex = 2; vertex < count; vertex++)
+                emit(polygon[0], polygon[vertex - 1], polygon[vertex]);
+        }
+    }
+
+    void OcclusionCuller::rasterise(JobSystem* jobs)
+    {
+        const Clock::time_point start = Clock::now();
+
+        if(jobs == nullptr)
+        {
+            for(const Occluder& occluder : m_Occluders)
+                setupOccluder(occluder, m_Triangles);
+        }
+        else
+        {
+            std::mutex mutex;
+            jobs->parallelFor(m_Occluders.size(), 1, [this, &mutex](const std::size_t first, const std::size_t last)
+            {
+                thread_local std::vector<ScreenTriangle> triangles;
+                triangles.clear();
+                for(std::size_t i = first; i < last; i++)
+                    setupOccluder(m_Occluders[i], triangles);
+
+                // Order doesn't matter, every pixel keeps the nearest value whoever writes first
+                const std::lock_guard lock(mutex);
+                m_Triangles.insert(m_Triangles.end(), triangles.begin(), triangles.end());
+            });
+        }
+        m_Stats.rasterisedTriangles = m_Triangles.size();
+
+        // Bins are whole tiles, so two jobs never touch the same pixel or tile
+        const std::uint32_t binsX = (m_Width + BinWidth - 1) / BinWidth;
+        const std::uint32_t binsY = (m_Height + BinHeight - 1) / BinHeight;
+        if(jobs == nullptr)
+        {
+            for(std::uint32_t bin = 0; bin < binsX * binsY; bin++)
+                rasteriseBin(bin);
+        }
+        else
+        {
+            jobs->parallelFor(binsX * binsY, 1, [this](const std::size_t first, const std::size_t last)
+            {
+                for(std::size_t bin = first; bin < last; bin++)
+                    rasteriseBin(static_cast<std::uint32_t>( bin ));
+            });
+        }
+
+        m_Stats.rasteriseMs += elapsedMs(start);
+    }
+
+    void OcclusionCuller::rasteriseBin(const std::uint32_t bin)
+    {
+        const std::uint32_t binsX = (m_Width + BinWidth - 1) / BinWidth;
+        const auto binMinX = static_cast<std::int32_t>( (bin % binsX) * BinWidth );
+        const auto binMinY = static_cast<std::int32_t>( (bin / binsX) * BinHeight );
+        const std::int32_t binMaxX = std::min(binMinX + static_cast<std::int32_t>( BinWidth ), static_cast<std::int32_t>( m_Width )) - 1;
+        const std::int32_t binMaxY = std::min(binMinY + static_cast<std::int32_t>( BinHeight ), static_cast<std::int32_t>( m_Height )) - 1;
+
+        for(const ScreenTriangle& triangle : m_Triangles)
+        {
+            const std::int32_t minX = std::max(triangle.minX, binMinX), maxX = std::min(triangle.maxX, binMaxX);
+            const std::int32_t minY = std::max(triangle.minY, binMinY), maxY = std::min(triangle.maxY, binMaxY);
+            if(minX > maxX || minY > maxY) continue;
+
+            for(std::int32_t y = minY; y <= maxY; y++)
+            {
+                const float pixelY = static_cast<float>( y ) + 0.5f;
+                float* row = m_Depth.data() + static_cast<std::size_t>( y ) * m_Width;
+#if defined(__AVX2__)
+                // Starts on a multiple of 8, the bin is a whole number of 8 pixel rows so this stays inside it
+                const __m256 a0 = _mm256_set1_ps(triangle.edges[0].x);
+                const __m256 a1 = _mm256_set1_ps(triangle.edges[1].x);
+                const __m256 a2 = _mm256_set1_ps(triangle.edges[2].x);
+                const __m256 rowE0 = _mm256_set1_ps(triangle.edges[0].y * pixelY + triangle.edges[0].z);
+                const __m256 rowE1 = _mm256_set1_ps(triangle.edges[1].y * pixelY + triangle.edges[1].z);
+                const __m256 rowE2 = _mm256_set1_ps(triangle.edges[2].y * pixelY + triangle.edges[2].z);
+                const __m256 dzdx = _mm256_set1_ps(triangle.depth.y);
+                const __m256 rowZ = _mm256_set1_ps(triangle.depth.z * pixelY + triangle.depth.x);
+                const __m256 centres = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+                for(std::int32_t x = minX & ~7; x <= maxX; x += 8)
+                {
+                    const __m256 pixelX = _mm256_add_ps(_mm256_set1_ps(static_cast<float>( x )), centres);
+                    const __m256 e0 = _mm256_add_ps(_mm256_mul_ps(a0, pixelX), rowE0);
+                    const __m256 e1 = _mm256_add_ps(_mm256_mul_ps(a1, pixelX), rowE1);
+                    const __m256 e2 = _mm256_add_ps(_mm256_mul_ps(a2, pixelX), rowE2);
+                    const __m256 inside = _mm256_cmp_ps(_mm256_min_ps(e0, _mm256_min_ps(e1, e2)), _mm256_setzero_ps(), _CMP_GE_OQ);
+                    if(_mm256_movemask_ps(inside) == 0) continue;
+
+                    const __m256 z = _mm256_add_ps(_mm256_mul_ps(dzdx, pixelX), rowZ);
+                    const __m256 old = _mm256_loadu_ps(row + x);
+                    _mm256_storeu_ps(row + x, _mm256_blendv_ps(old, _mm256_max_ps(old, z), inside));
+                }
+#else
+                for(std::int32_t x = minX; x <= maxX; x++)
+                {
+                    const glm::vec3 pixel(static_cast<float>( x ) + 0.5f, pixelY, 1.0f);
+                    if(glm::dot(triangle.edges[0], pixel) < 0.0f || glm::dot(triangle.edges[1], pixel) < 0.0f ||
+                       glm::dot(triangle.edges[2], pixel) < 0.0f) continue;
+                    row[x] = std::max(row[x], triangle.depth.x + triangle.depth.y * pixel.x + triangle.depth.z * pixel.y);
+                }
+#endif
+            }
+        }
+
+        // Farthest value of every tile in the bin
+        for(auto tileY = static_cast<std::uint32_t>( binMinY ) / TileSize; tileY <= static_cast<std::uint32_t>( binMaxY ) / TileSize; tileY++)
+        {
+            for(auto tileX = static_cast<std::uint32_t>( binMinX ) / TileSize; tileX <= static_cast<std::uint32_t>( binMaxX ) / TileSize; tileX++)
+            {
+                const float* tile = m_Depth.data() + static_cast<std::size_t>( tileY ) * TileSize * m_Width + tileX * TileSize;
+#if defined(__AVX2__)
+                __m256 farthest = _mm256_loadu_ps(tile);
+                for(std::uint32_t y = 1; y < TileSize; y++)
+                    farthest = _mm256_min_ps(farthest, _mm256_loadu_ps(tile + static_cast<std::size_t>( y ) * m_Width));
+                __m128 half = _mm_min_ps(_mm256_castps256_ps128(farthest), _mm256_extractf128_ps(farthest, 1));
+                half = _mm_min_ps(half, _mm_movehl_ps(half, half));
+                half = _mm_min_ss(half, _mm_shuffle_ps(half, half, 1));
+                m_TileDepth[static_cast<std::size_t>( tileY ) * m_TilesX + tileX] = _mm_cvtss_f32(half);
+#else
+                float farthest = tile[0];
+                for(std::uint32_t y = 0; y < TileSize; y++)
+                {
+                    for(std::uint32_t x = 0; x < TileSize; x++)
+                        farthest = std::min(farthest, tile[static_cast<std::size_t>( y ) * m_Width + x]);
+                }
+                m_TileDepth[static_cast<std::size_t>( tileY ) * m_TilesX + tileX] = farthest;
+#endif
+            }
+        }
+    }
+
+    bool OcclusionCuller::rowOccludes(const float* row, const std::uint32_t first, const std::uint32_t last, const float depth)
+    {
+#if defined(__AVX2__)
+        const __m256 limit = _mm256_set1_ps(depth);
+        const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        for(std::uint32_t x = first; x <= last; x += 8)
+        {
+            // Lanes past last read the padding or the next row and are masked off
+            const __m256i valid = _mm256_cmpgt_epi32(_mm256_set1_epi32(static_cast<int>( last - x + 1 )), lanes);
+            const __m256 nearer = _mm256_cmp_ps(_mm256_loadu_ps(row + x), limit, _CMP_GT_OQ);
+            if(_mm256_movemask_ps(_mm256_andnot_ps(nearer, _mm256_castsi256_ps(valid))) != 0) return false;
+        }
+        return true;
+#else
+        for(std::uint32_t x = first; x <= last; x++)
+        {
+            if(row[x] <= depth) return false;
+        }
+        return true;
+#endif
+    }
+
+    bool OcclusionCuller::isVisible(const Aabb& box) const
+    {
+        float minX = std::numeric_limits<float>::max(), minY = minX;
+        float maxX = -minX, maxY = -minX;
+        float nearest = 0.0f;
+        // Corners as the min corner plus the matrix's columns scaled by the box's size, no full transform each
+        const glm::vec3 size = box.max - box.min;
+        const glm::vec4 base = m_ViewProjection * glm::vec4(box.min, 1.0f);
+        const glm::vec4 stepX = m_ViewProjection[0] * size.x;
+        const glm::vec4 stepY = m_ViewProjection[1] * size.y;
+        const glm::vec4 stepZ = m_ViewProjection[2] * size.z;
+        for(int corner = 0; corner < 8; corner++)
+        {
+            glm::vec4 clip = base;
+            if(corner & 1) clip += stepX;
+            if(corner & 2) clip += stepY;
+            if(corner & 4) clip += stepZ;
+            // Reaches through the near plane, the camera may well be inside it
+            if(clip.w <= 0.0f || clip.z < -clip.w) return true;
+
+            const float inverseW = 1.0f / clip.w;
+            const float x = (clip.x * inverseW * 0.5f + 0.5f) * static_cast<float>( m_Width );
+            const float y = (clip.y * inverseW * 0.5f + 0.5f) * static_cast<float>( m_Height );
+            minX = std::min(minX, x);
+            maxX = std::max(maxX, x);
+            minY = std::min(minY, y);
+            maxY = std::max(maxY, y);
+            nearest = std::max(nearest, inverseW);
+        }
+
+        // Off screen is the frustum culler's call
+        if(maxX < 0.0f || maxY < 0.0f || minX >= static_cast<float>( m_Width ) || minY >= static_cast<float>( m_Height )) return true;
+
+        // Every pixel the box touches, not only the ones whose centre it covers
+        const auto firstX = static_cast<std::uint32_t>( std::max(0.0f, minX) );
+        const auto firstY = static_cast<std::uint32_t>( std::max(0.0f, minY) );
+        const auto lastX = static_cast<std::uint32_t>( std::min(maxX, static_cast<float>( m_Width - 1 )) );
+        const auto lastY = static_cast<std::uint32_t>( std::min(maxY, static_cast<float>( m_Height - 1 )) );
+
+        for(std::uint32_t tileY = firstY / TileSize; tileY <= lastY / TileSize; tileY++)
+        {
+            const float* tiles = m_TileDepth.data() + static_cast<std::size_t>( tileY ) * m_TilesX;
+            if(rowOccludes(tiles, firstX / TileSize, lastX / TileSize, nearest)) continue;
+
+            // Some tile in the row has pixels at least as far as the box, look at those pixels
+            const std::uint32_t rowFirst = std::max(firstY, tileY * TileSize);
+            const std::uint32_t rowLast = std::min(lastY, tileY * TileSize + TileSize - 1);
+            for(std::uint32_t tileX = firstX / TileSize; tileX <= lastX / TileSize; tileX++)
+            {
+                if(tiles[tileX] > nearest) continue;
+
+                const std::uint32_t columnFirst = std::max(firstX, tileX * TileSize);
+                const std::uint32_t columnLast = std::min(lastX, tileX * TileSize + TileSize - 1);
+                for(std::uint32_t y = rowFirst; y <= rowLast; y++)
+                {
+                    if(!rowOccludes(m_Depth.data() + static_cast<std::size_t>( y ) * m_Width, columnFirst, columnLast, nearest)) return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    void OcclusionCuller::test(const std::span<const Aabb> boxes, const std::span<std::uint8_t> visible, JobSystem* jobs)
+    {
+        const Clock::time_point start = Clock::now();
+        std::atomic<std::size_t> occluded{ 0 };
+        auto testRange = [this, boxes, visible, &occluded](const std::size_t first, const std::size_t last)
+        {
+            std::size_t hidden = 0;
+            for(std::size_t i = first; i < last; i++)
+            {
+                visible[i] = isVisible(boxes[i]) ? 1 : 0;
+                hidden += visible[i] ? 0 : 1;
+            }
+            occluded.fetch_add(hidden, std::memory_order_relaxed);
+        };
+
+        if(jobs == nullptr)
+            testRange(0, boxes.size());
+        else
+            jobs->parallelFor(boxes.size(), 256, testRange);
+
+        m_Stats.tested += boxes.size();
+        m_Stats.occluded += occluded.load(std::memory_order_relaxed);
+        m_Stats.testMs += elapsedMs(start);
+    }
+}
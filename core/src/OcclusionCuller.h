@@ -0,0 +1,117 @@
+#pragma once
+#include <Geometry.h>
+#include <JobSystem.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace core
+{
+    struct OcclusionCullerOptions
+    {
+        // Depth buffer size, rounded up to whole tiles. Low is fine, occluders are big
+        std::uint32_t width = 320;
+        std::uint32_t height = 192;
+        // Skips occluder triangles wound clockwise on screen, the GL default for back faces
+        bool cullBackFaces = true;
+    };
+
+    // Counters for the current frame, reset by beginFrame()
+    struct OcclusionStats
+    {
+        std::size_t occluderTriangles = 0;  // submitted with addOccluder()
+        std::size_t rasterisedTriangles = 0;// left after clipping and culling
+        std::size_t tested = 0;
+        std::size_t occluded = 0;
+        double rasteriseMs = 0.0;
+        double testMs = 0.0;
+
+        [[nodiscard]] float getOccludedPercent() const
+        {
+            return tested == 0 ? 0.0f : 100.0f * static_cast<float>( occluded ) / static_cast<float>( tested );
+        }
+    };
+
+    /* CPU occlusion culling for scenes where most things are hidden behind a few big ones.
+     * A frame adds the chosen occluder meshes, rasterise() draws them at low resolution into
+     * a depth buffer of 1/w values (bigger is nearer, so no near or far plane to pick) and
+     * keeps the farthest value of every 8x8 tile, then occludee boxes are tested against the
+     * tiles first and the pixels only where a tile can't decide. Rows of 8 pixels are one
+     * AVX2 vector, the screen is split into bins rasterised as separate jobs.
+     * Occluder edges are sampled at pixel centres, so something peeking out by less than half
+     * a pixel can still be culled. Pick the resolution with that in mind.
+     * Everything runs on the CPU, the GL context is never touched. */
+    class OcclusionCuller
+    {
+    public:
+        static constexpr std::uint32_t TileSize = 8;
+        static constexpr std::uint32_t BinWidth = 64;
+        static constexpr std::uint32_t BinHeight = 32;
+
+    private:
+        struct Occluder
+        {
+            std::span<const glm::vec3> positions;
+            std::span<const unsigned int> indices;
+            glm::mat4 modelViewProjection;
+        };
+
+        // Edge functions and the 1/w plane in screen space, all evaluated at pixel centres
+        struct ScreenTriangle
+        {
+            glm::vec3 edges[3];// a * x + b * y + c, inside where all three are >= 0
+            glm::vec3 depth;   // z0 + dzdx * x + dzdy * y
+            std::int32_t minX, minY, maxX, maxY;
+        };
+
+        OcclusionCullerOptions m_Options;
+        std::uint32_t m_Width = 0;
+        std::uint32_t m_Height = 0;
+        std::uint32_t m_TilesX = 0;
+        std::uint32_t m_TilesY = 0;
+        glm::mat4 m_ViewProjection = glm::mat4(1.0f);
+        std::vector<float> m_Depth;    // m_Width * m_Height, row 0 at the bottom
+        std::vector<float> m_TileDepth;// farthest 1/w of every tile
+        std::vector<Occluder> m_Occluders;
+        std::vector<ScreenTriangle> m_Triangles;
+        OcclusionStats m_Stats;
+
+        // Clips and sets up one occluder's triangles, appends to out
+        void setupOccluder(const Occluder& occluder, std::vector<ScreenTriangle>& out) const;
+
+        void rasteriseBin(std::uint32_t bin);
+
+        // True when every value in row[first, last] is nearer than depth
+        static bool rowOccludes(const float* row, std::uint32_t first, std::uint32_t last, float depth);
+
+    public:
+        explicit OcclusionCuller(const OcclusionCullerOptions& options = {});
+
+        // Clears the buffers and the stats, viewProjection is the camera's projection * view
+        void beginFrame(const glm::mat4& viewProjection);
+
+        /* Queues a triangle list to draw with model. The spans are only read by rasterise(),
+         * keep them alive until then. */
+        void addOccluder(std::span<const glm::vec3> positions, std::span<const unsigned int> indices, const glm::mat4& model);
+
+        // Draws the queued occluders, spread over jobs when given
+        void rasterise(JobSystem* jobs = nullptr);
+
+        // False only when the whole box is behind occluders. Boxes off screen or through the near plane are visible
+        [[nodiscard]] bool isVisible(const Aabb& box) const;
+
+        // isVisible() for every box into visible (1 or 0, same size as boxes), counted in the stats
+        void test(std::span<const Aabb> boxes, std::span<std::uint8_t> visible, JobSystem* jobs = nullptr);
+
+        [[nodiscard]] const OcclusionStats& getStats() const { return m_Stats; }
+
+        [[nodiscard]] std::uint32_t getWidth() const { return m_Width; }
+
+        [[nodiscard]] std::uint32_t getHeight() const { return m_Height; }
+
+        // 1/w per pixel after rasterise(), 0 where nothing was drawn. Handy to upload as a debug texture
+        [[nodiscard]] const std::vector<float>& getDepth() const { return m_Depth; }
+    };
+}
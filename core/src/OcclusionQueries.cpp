@@ -0,0 +1,172 @@
+#include <OcclusionQueries.h>
+#include <algorithm>
+#include <cstdint>
+
+namespace core
+{
+    OcclusionQueries::OcclusionQueries(const OcclusionQueryOptions& options)
+        : m_Options(options)
+    {
+        m_Options.recheckInterval = std::max(1u, m_Options.recheckInterval);
+        m_Options.hiddenFramesToCull = std::clamp(m_Options.hiddenFramesToCull, 1u, 255u);
+
+        // Unit cube, the instance's box stretches it
+        const std::array<float, 24> corners = {
+            0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 0.0f,
+            0.0f, 0.0f, 1.0f, 1.0f, 0.0f, 1.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f
+        };
+        const std::array<std::uint8_t, 36> indices = {
+            0, 2, 3, 0, 3, 1, 4, 5, 7, 4, 7, 6, 0, 4, 6, 0, 6, 2,
+            1, 3, 7, 1, 7, 5, 0, 1, 5, 0, 5, 4, 2, 6, 7, 2, 7, 3
+        };
+        glCreateBuffers(1, &m_CornerBuffer);
+        glNamedBufferStorage(m_CornerBuffer, sizeof(corners), corners.data(), 0);
+        glCreateBuffers(1, &m_IndexBuffer);
+        glNamedBufferStorage(m_IndexBuffer, sizeof(indices), indices.data(), 0);
+
+        glCreateVertexArrays(1, &m_BoxVertexArray);
+        glVertexArrayVertexBuffer(m_BoxVertexArray, 0, m_CornerBuffer, 0, 3 * sizeof(float));
+        glVertexArrayElementBuffer(m_BoxVertexArray, m_IndexBuffer);
+        glEnableVertexArrayAttrib(m_BoxVertexArray, 0);
+        glVertexArrayAttribFormat(m_BoxVertexArray, 0, 3, GL_FLOAT, GL_FALSE, 0);
+        glVertexArrayAttribBinding(m_BoxVertexArray, 0, 0);
+
+        // Binding 1 steps once per instance, the draws pick their box with the base instance
+        glEnableVertexArrayAttrib(m_BoxVertexArray, 1);
+        glVertexArrayAttribFormat(m_BoxVertexArray, 1, 3, GL_FLOAT, GL_FALSE, offsetof(Aabb, min));
+        glVertexArrayAttribBinding(m_BoxVertexArray, 1, 1);
+        glEnableVertexArrayAttrib(m_BoxVertexArray, 2);
+        glVertexArrayAttribFormat(m_BoxVertexArray, 2, 3, GL_FLOAT, GL_FALSE, offsetof(Aabb, max));
+        glVertexArrayAttribBinding(m_BoxVertexArray, 2, 1);
+        glVertexArrayBindingDivisor(m_BoxVertexArray, 1, 1);
+    }
+
+    OcclusionQueries::~OcclusionQueries()
+    {
+        glDeleteVertexArrays(1, &m_BoxVertexArray);
+        glDeleteBuffers(1, &m_CornerBuffer);
+        glDeleteBuffers(1, &m_IndexBuffer);
+        if(m_BoxBuffer != 0) glDeleteBuffers(1, &m_BoxBuffer);
+    }
+
+    unsigned int OcclusionQueries::issue(Object& object)
+    {
+        // A GPU this far behind won't miss one result, dropping the oldest keeps the ring bounded
+        if(object.count == MaxInFlight)
+        {
+            m_Pool.release(object.queries[object.first]);
+            object.first = static_cast<std::uint8_t>( (object.first + 1) % MaxInFlight );
+            object.count--;
+        }
+
+        const unsigned int query = m_Pool.acquire();
+        object.queries[(object.first + object.count) % MaxInFlight] = query;
+        object.count++;
+        m_Stats.queriesIssued++;
+        return query;
+    }
+
+    void OcclusionQueries::applyResult(Object& object, const bool passed)
+    {
+        if(passed)
+        {
+            object.visible = true;
+            object.hiddenResults = 0;
+            return;
+        }
+
+        object.hiddenResults = static_cast<std::uint8_t>( std::min(255, object.hiddenResults + 1) );
+        if(object.hiddenResults >= m_Options.hiddenFramesToCull) object.visible = false;
+    }
+
+    void OcclusionQueries::beginFrame(const std::size_t objectCount)
+    {
+        m_Frame++;
+        m_Stats = {};
+
+        for(std::size_t id = objectCount; id < m_Objects.size(); id++)
+        {
+            Object& object = m_Objects[id];
+            for(; object.count > 0; object.count--, object.first = static_cast<std::uint8_t>( (object.first + 1) % MaxInFlight ))
+                m_Pool.release(object.queries[object.first]);
+        }
+        m_Objects.resize(objectCount);
+
+        /* Queries finish in the order they were issued, so each object's ring is read oldest
+         * first and the first one still pending ends it. Nothing here waits on the GPU. */
+        for(Object& object : m_Objects)
+        {
+            while(object.count > 0)
+            {
+                const unsigned int query = object.queries[object.first];
+                GLuint available = GL_FALSE;
+                glGetQueryObjectuiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+                if(available == GL_FALSE) break;
+
+                GLuint passed = GL_FALSE;
+                glGetQueryObjectuiv(query, GL_QUERY_RESULT, &passed);
+                applyResult(object, passed != GL_FALSE);
+                m_Stats.resultsRead++;
+
+                m_Pool.release(query);
+                object.first = static_cast<std::uint8_t>( (object.first + 1) % MaxInFlight );
+                object.count--;
+            }
+        }
+    }
+
+    void OcclusionQueries::queryHidden(const std::span<const Aabb> bounds, const glm::vec3& cameraPosition)
+    {
+        m_Hidden.clear();
+        m_Boxes.clear();
+        const glm::vec3 margin(m_Options.boxMargin);
+        for(ObjectId id = 0; id < m_Objects.size(); id++)
+        {
+            Object& object = m_Objects[id];
+            if(object.visible) continue;
+
+            // Drawing a box the camera is inside tells nothing, the near plane cuts it away
+            const Aabb box = { bounds[id].min - margin, bounds[id].max + margin };
+            if(box.contains({ cameraPosition, cameraPosition }))
+            {
+                object.visible = true;
+                object.hiddenResults = 0;
+                m_Hidden.push_back({ id, 0 });
+                continue;
+            }
+            m_Hidden.push_back({ id, issue(object) });
+            m_Boxes.push_back(box);
+        }
+        if(m_Boxes.empty()) return;
+
+        if(m_Boxes.size() > m_BoxCapacity)
+        {
+            if(m_BoxBuffer != 0) glDeleteBuffers(1, &m_BoxBuffer);
+            m_BoxCapacity = std::max(m_Boxes.size(), m_BoxCapacity * 2);
+            glCreateBuffers(1, &m_BoxBuffer);
+            glNamedBufferStorage(m_BoxBuffer, static_cast<GLsizeiptr>( m_BoxCapacity * sizeof(Aabb) ), nullptr, GL_DYNAMIC_STORAGE_BIT);
+            glVertexArrayVertexBuffer(m_BoxVertexArray, 1, m_BoxBuffer, 0, sizeof(Aabb));
+        }
+        glNamedBufferSubData(m_BoxBuffer, 0, static_cast<GLsizeiptr>( m_Boxes.size() * sizeof(Aabb) ), m_Boxes.data());
+
+        // Depth test only, and both faces so a box stays testable whatever the cull state
+        const GLboolean culling = glIsEnabled(GL_CULL_FACE);
+        glDisable(GL_CULL_FACE);
+        glColorMask(GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE);
+        glDepthMask(GL_FALSE);
+        glBindVertexArray(m_BoxVertexArray);
+
+        GLuint instance = 0;
+        for(const HiddenEntry& entry : m_Hidden)
+        {
+            if(entry.query == 0) continue;
+            glBeginQuery(GL_ANY_SAMPLES_PASSED_CONSERVATIVE, entry.query);
+            glDrawElementsInstancedBaseInstance(GL_TRIANGLES, 36, GL_UNSIGNED_BYTE, nullptr, 1, instance++);
+            glEndQuery(GL_ANY_SAMPLES_PASSED_CONSERVATIVE);
+        }
+
+        glDepthMask(GL_TRUE);
+        glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+        if(culling) glEnable(GL_CULL_FACE);
+    }
+}
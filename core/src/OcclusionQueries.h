@@ -0,0 +1,172 @@
+#pragma once
+#include <glad/gl.h>
+#include <Geometry.h>
+#include <QueryPool.h>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace core
+{
+    struct OcclusionQueryOptions
+    {
+        // A visible object's own draw is wrapped in a query every this many frames, staggered by id
+        std::uint32_t recheckInterval = 8;
+        // Hidden results in a row before a visible object is treated as hidden, one is often a blip
+        std::uint32_t hiddenFramesToCull = 3;
+        /* Hidden objects are still submitted under glBeginConditionalRender, so one that comes
+         * into view is drawn the same frame. false skips them on the CPU instead, cheaper to
+         * submit but they pop in once the box query's result arrives. */
+        bool conditionalRender = true;
+        // Boxes are grown by this much, a camera inside one (near plane included) makes the object visible
+        float boxMargin = 0.1f;
+    };
+
+    // Counters for the current frame, reset by beginFrame()
+    struct OcclusionQueryStats
+    {
+        std::size_t visible = 0;    // drawn unconditionally
+        std::size_t conditional = 0;// hidden, submitted under conditional rendering
+        std::size_t skipped = 0;    // hidden, not submitted at all
+        std::size_t queriesIssued = 0;
+        std::size_t resultsRead = 0;
+    };
+
+    /* Hardware occlusion culling with GL_ANY_SAMPLES_PASSED_CONSERVATIVE queries, for scenes
+     * with heavy overdraw. Results are only ever read once the GPU reports them available, a
+     * frame or more later, so the CPU never waits. An object's visibility is what its last
+     * results said, with hysteresis so a single hidden result doesn't cull it.
+     * Objects are ids 0..count-1 that keep their meaning from frame to frame. A frame:
+     *   beginFrame(count);
+     *   drawVisible(draw);               // the previously visible objects, they fill the depth buffer
+     *   boxShader.use();                 // see queryHidden()
+     *   queryHidden(bounds, cameraPos);  // box of every hidden object against that depth
+     *   shader.use();
+     *   drawHidden(draw);                // the hidden objects, conditional on their box query
+     * draw(id) issues the object's draw calls. */
+    class OcclusionQueries
+    {
+    public:
+        using ObjectId = std::uint32_t;
+
+        // Queries one object may have in flight, past that the oldest is dropped unread
+        static constexpr std::size_t MaxInFlight = 4;
+
+    private:
+        struct Object
+        {
+            std::array<unsigned int, MaxInFlight> queries{};// ring, oldest at first
+            std::uint8_t first = 0;
+            std::uint8_t count = 0;
+            std::uint8_t hiddenResults = 0;// in a row
+            bool visible = true;
+        };
+
+        struct HiddenEntry
+        {
+            ObjectId id;
+            unsigned int query;// 0 draws the object unconditionally
+        };
+
+        OcclusionQueryOptions m_Options;
+        QueryPool m_Pool{ GL_ANY_SAMPLES_PASSED_CONSERVATIVE };
+        std::vector<Object> m_Objects;
+        std::vector<HiddenEntry> m_Hidden;
+        std::vector<Aabb> m_Boxes;
+        std::uint32_t m_Frame = 0;
+        OcclusionQueryStats m_Stats;
+
+        unsigned int m_BoxVertexArray = 0;
+        unsigned int m_CornerBuffer = 0;
+        unsigned int m_IndexBuffer = 0;
+        unsigned int m_BoxBuffer = 0;// per instance min and max
+        std::size_t m_BoxCapacity = 0;
+
+        unsigned int issue(Object& object);
+
+        void applyResult(Object& object, bool passed);
+
+    public:
+        explicit OcclusionQueries(const OcclusionQueryOptions& options = {});
+
+        OcclusionQueries(const OcclusionQueries&) = delete;
+
+        OcclusionQueries& operator=(const OcclusionQueries&) = delete;
+
+        ~OcclusionQueries();
+
+        // Reads every result that has arrived and sizes the object list, new objects start visible
+        void beginFrame(std::size_t objectCount);
+
+        template <typename Draw>
+        void drawVisible(const Draw& draw);
+
+        /* Draws the box of every hidden object under its own query, with colour and depth
+         * writes off (both are on again afterwards). The bound program gets the unit cube
+         * corner at location 0 and the box's min and max at locations 1 and 2 (per instance):
+         *   gl_Position = viewProjection * vec4(mix(boxMin, boxMax, corner), 1.0);
+         * bounds is indexed by ObjectId. */
+        void queryHidden(std::span<const Aabb> bounds, const glm::vec3& cameraPosition);
+
+        template <typename Draw>
+        void drawHidden(const Draw& draw);
+
+        [[nodiscard]] bool isVisible(const ObjectId id) const { return id < m_Objects.size() && m_Objects[id].visible; }
+
+        void setConditionalRender(const bool enabled) { m_Options.conditionalRender = enabled; }
+
+        [[nodiscard]] const OcclusionQueryStats& getStats() const { return m_Stats; }
+
+        [[nodiscard]] const QueryPool& getPool() const { return m_Pool; }
+    };
+
+    template <typename Draw>
+    void OcclusionQueries::drawVisible(const Draw& draw)
+    {
+        for(ObjectId id = 0; id < m_Objects.size(); id++)
+        {
+            Object& object = m_Objects[id];
+            if(!object.visible) continue;
+            m_Stats.visible++;
+
+            // Objects with a hidden result pending confirmation are asked again straight away
+            const bool recheck = object.count == 0 && (object.hiddenResults > 0 || (m_Frame + id) % m_Options.recheckInterval == 0);
+            if(!recheck)
+            {
+                draw(id);
+                continue;
+            }
+
+            glBeginQuery(GL_ANY_SAMPLES_PASSED_CONSERVATIVE, issue(object));
+            draw(id);
+            glEndQuery(GL_ANY_SAMPLES_PASSED_CONSERVATIVE);
+        }
+    }
+
+    template <typename Draw>
+    void OcclusionQueries::drawHidden(const Draw& draw)
+    {
+        for(const HiddenEntry& entry : m_Hidden)
+        {
+            if(entry.query == 0)
+            {
+                m_Stats.visible++;
+                draw(entry.id);
+                continue;
+            }
+            if(!m_Options.conditionalRender)
+            {
+                m_Stats.skipped++;
+                continue;
+            }
+
+            // NO_WAIT: if the result isn't there yet the GPU draws anyway rather than stalling
+            m_Stats.conditional++;
+            glBeginConditionalRender(entry.query, GL_QUERY_NO_WAIT);
+            draw(entry.id);
+            glEndConditionalRender();
+        }
+    }
+}
@@ -0,0 +1,205 @@
+#include <PackFile.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace core
+{
+    PackFile::PackFile(const std::string& filepath)
+    {
+        open(filepath);
+    }
+
+    bool PackFile::open(const std::string& filepath)
+    {
+        m_Entries = {};
+        m_Names = nullptr;
+        if(!m_File.open(filepath)) return false;
+
+        const std::span<const std::byte> data = m_File.getData();
+        PackHeader header;
+        if(data.size() < sizeof(header))
+        {
+            std::cerr << "[PackFile] Error: " << filepath << " is too small to be a pack" << '\n';
+            m_File = MappedFile();
+            return false;
+        }
+        std::memcpy(&header, data.data(), sizeof(header));
+
+        const std::size_t tocSize = static_cast<std::size_t>( header.entryCount ) * sizeof(PackEntry);
+        if(header.magic != PackMagic || header.version != PackVersion || header.tocOffset % alignof(PackEntry) != 0 ||
+           header.tocOffset > data.size() || tocSize > data.size() - header.tocOffset || header.namesOffset > data.size())
+        {
+            std::cerr << "[PackFile] Error: " << filepath << " is not a valid version " << PackVersion << " pack" << '\n';
+            m_File = MappedFile();
+            return false;
+        }
+
+        // The TOC is used in place, the mapping is page aligned and tocOffset is checked above
+        m_Entries = { reinterpret_cast<const PackEntry *>( data.data() + header.tocOffset ), header.entryCount };
+        m_Names = reinterpret_cast<const char *>( data.data() + header.namesOffset );
+        for(const PackEntry& entry : m_Entries)
+        {
+            if(entry.offset > data.size() || entry.size > data.size() - entry.offset ||
+               header.namesOffset + entry.nameOffset + entry.nameLength > data.size())
+            {
+                std::cerr << "[PackFile] Error: " << filepath << " has an entry outside the file" << '\n';
+                m_Entries = {};
+                m_Names = nullptr;
+                m_File = MappedFile();
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool PackFile::isOpen() const { return m_File.isOpen(); }
+
+    const PackEntry* PackFile::find(const std::string_view path) const
+    {
+        if(m_Entries.empty()) return nullptr;
+
+        const std::string normalized = normalizePath(path);
+        const std::uint64_t hash = fnv1a64(normalized);
+        auto it = std::lower_bound(m_Entries.begin(), m_Entries.end(), hash,
+                                   [](const PackEntry& entry, const std::uint64_t value) { return entry.pathHash < value; });
+        // Names are compared too, so a hash collision can't return the wrong asset
+        for(; it != m_Entries.end() && it->pathHash == hash; ++it)
+        {
+            if(getName(*it) == normalized) return &*it;
+        }
+        return nullptr;
+    }
+
+    std::span<const std::byte> PackFile::getData(const std::string_view path) const
+    {
+        const PackEntry* entry = find(path);
+        return entry != nullptr ? getData(*entry) : std::span<const std::byte>{};
+    }
+
+    std::span<const std::byte> PackFile::getData(const PackEntry& entry) const
+    {
+        return m_File.getData().subspan(entry.offset, entry.size);
+    }
+
+    std::string_view PackFile::getName(const PackEntry& entry) const
+    {
+        return { m_Names + entry.nameOffset, entry.nameLength };
+    }
+
+    std::span<const PackEntry> PackFile::getEntries() const { return m_Entries; }
+
+    bool PackFile::readTexture(const std::string_view path, CookedTexture& texture) const
+    {
+        const PackEntry* entry = find(path);
+        return entry != nullptr && readTexture(*entry, texture);
+    }
+
+    bool PackFile::readTexture(const PackEntry& entry, CookedTexture& texture) const
+    {
+        if(entry.type != PackEntryType::Texture) return false;
+
+        const std::span<const std::byte> data = getData(entry);
+        CookedTextureHeader header;
+        if(data.size() < sizeof(header)) return false;
+        std::memcpy(&header, data.data(), sizeof(header));
+
+        texture.width = static_cast<int>( header.width );
+        texture.height = static_cast<int>( header.height );
+        texture.channels = static_cast<int>( header.channels );
+        texture.levels.clear();
+
+        std::size_t offset = sizeof(header);
+        std::size_t width = header.width;
+        std::size_t height = header.height;
+        for(std::uint32_t level = 0; level < header.levels; level++)
+        {
+            const std::size_t size = width * height * header.channels;
+            if(size > data.size() - offset)
+            {
+                std::cerr << "[PackFile] Error: Truncated texture " << getName(entry) << '\n';
+                return false;
+            }
+            texture.levels.push_back(data.subspan(offset, size));
+            offset += size;
+            width = std::max<std::size_t>(1, width / 2);
+            height = std::max<std::size_t>(1, height / 2);
+        }
+        return !texture.levels.empty();
+    }
+
+    bool PackFile::readMesh(const std::string_view path, MeshData& mesh) const
+    {
+        const PackEntry* entry = find(path);
+        return entry != nullptr && readMesh(*entry, mesh);
+    }
+
+    bool PackFile::readMesh(const PackEntry& entry, MeshData& mesh) const
+    {
+        if(entry.type != PackEntryType::Mesh) return false;
+
+        const std::span<const std::byte> data = getData(entry);
+        CookedMeshHeader header;
+        if(data.size() < sizeof(header)) return false;
+        std::memcpy(&header, data.data(), sizeof(header));
+
+        const std::size_t attributesSize = header.attributeCount * sizeof(CookedMeshAttribute);
+        const std::size_t verticesSize = static_cast<std::size_t>( header.vertexCount ) * header.stride;
+        const std::size_t indicesSize = static_cast<std::size_t>( header.indexCount ) * sizeof(unsigned int);
+        const std::size_t lodsSize = header.lodCount * sizeof(CookedMeshLod);
+        if(sizeof(header) + attributesSize + verticesSize + indicesSize + lodsSize > data.size())
+        {
+            std::cerr << "[PackFile] Error: Truncated mesh " << getName(entry) << '\n';
+            return false;
+        }
+
+        // A bad level would draw past the index buffer, so they are checked before anything is read
+        std::vector<MeshLod> lods(header.lodCount);
+        const std::byte* lodCursor = data.data() + sizeof(header) + attributesSize + verticesSize + indicesSize;
+        std::uint64_t previousEnd = 0;
+        for(MeshLod& level : lods)
+        {
+            CookedMeshLod lod;
+            std::memcpy(&lod, lodCursor, sizeof(lod));
+            lodCursor += sizeof(lod);
+            const std::uint64_t end = static_cast<std::uint64_t>( lod.firstIndex ) + lod.indexCount;
+            if(lod.indexCount == 0 || lod.firstIndex < previousEnd || end > header.indexCount)
+            {
+                std::cerr << "[PackFile] Error: Invalid LOD range in mesh " << getName(entry) << '\n';
+                return false;
+            }
+            previousEnd = end;
+            level = { lod.firstIndex, lod.indexCount, lod.error };
+        }
+
+        const std::byte* cursor = data.data() + sizeof(header);
+        mesh.layout.attributes.clear();
+        mesh.layout.stride = header.stride;
+        for(std::uint32_t i = 0; i < header.attributeCount; i++)
+        {
+            CookedMeshAttribute attr;
+            std::memcpy(&attr, cursor, sizeof(attr));
+            cursor += sizeof(attr);
+            mesh.layout.attributes.push_back({ attr.location, attr.components, attr.type, (attr.flags & 1u) != 0,
+                                               (attr.flags & 2u) != 0, attr.offset });
+        }
+
+        mesh.vertices.assign(cursor, cursor + verticesSize);
+        cursor += verticesSize;
+        mesh.indices.resize(header.indexCount);
+        std::memcpy(mesh.indices.data(), cursor, indicesSize);
+        mesh.lods = std::move(lods);
+        mesh.positionOffset = glm::vec3(header.positionOffset[0], header.positionOffset[1], header.positionOffset[2]);
+        mesh.positionScale = header.positionScale;
+        return true;
+    }
+
+    std::string PackFile::normalizePath(const std::string_view path)
+    {
+        std::string normalized(path);
+        std::replace(normalized.begin(), normalized.end(), '\\', '/');
+        while(normalized.starts_with("./"))
+            normalized.erase(0, 2);
+        return normalized;
+    }
+}
@@ -0,0 +1,71 @@
+#pragma once
+#include <MappedFile.h>
+#include <MeshBuilder.h>
+#include <PackFormat.h>
+#include <cstddef>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace core
+{
+    // A cooked texture read in place from the pack, levels[0] is the full size image
+    struct CookedTexture
+    {
+        int width = 0;
+        int height = 0;
+        int channels = 0;
+        std::vector<std::span<const std::byte>> levels;
+    };
+
+    /* Runtime side of the asset_cooker archive. The whole pack is one read-only mapping,
+     * lookups hash the path and binary search the TOC, and payloads are handed out as
+     * spans into the mapping without being copied. */
+    class PackFile
+    {
+    private:
+        MappedFile m_File;
+        std::span<const PackEntry> m_Entries;
+        const char* m_Names = nullptr;
+
+    public:
+        PackFile() = default;
+
+        explicit PackFile(const std::string& filepath);
+
+        PackFile(const PackFile&) = delete;
+
+        PackFile& operator=(const PackFile&) = delete;
+
+        // Maps and validates the pack, errors are logged and leave it closed
+        bool open(const std::string& filepath);
+
+        [[nodiscard]] bool isOpen() const;
+
+        // nullptr when the path isn't in the pack
+        [[nodiscard]] const PackEntry* find(std::string_view path) const;
+
+        // Payload of an entry, empty when it is missing
+        [[nodiscard]] std::span<const std::byte> getData(std::string_view path) const;
+
+        [[nodiscard]] std::span<const std::byte> getData(const PackEntry& entry) const;
+
+        [[nodiscard]] std::string_view getName(const PackEntry& entry) const;
+
+        [[nodiscard]] std::span<const PackEntry> getEntries() const;
+
+        // Views the mip chain of a Texture entry, false when missing or of another type
+        bool readTexture(std::string_view path, CookedTexture& texture) const;
+
+        bool readTexture(const PackEntry& entry, CookedTexture& texture) const;
+
+        // Copies a Mesh entry into MeshData, false when missing or of another type
+        bool readMesh(std::string_view path, MeshData& mesh) const;
+
+        bool readMesh(const PackEntry& entry, MeshData& mesh) const;
+
+        // "./assets\\a.png" -> "assets/a.png", the form paths are hashed in
+        static std::string normalizePath(std::string_view path);
+    };
+}
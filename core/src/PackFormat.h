@@ -0,0 +1,110 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+/* On-disk layout of the packed asset archive (assets.pak), shared by asset_cooker and PackFile.
+ *
+ *   PackHeader
+ *   PackEntry[entryCount]      sorted by pathHash so lookups are a binary search
+ *   names                      entry paths, not null terminated
+ *   data                       each entry's payload, PackAlignment aligned
+ *
+ * Everything is little endian and read in place from the mapping. */
+namespace core
+{
+    constexpr std::uint32_t PackMagic = 0x4B415043;// "CPAK"
+    constexpr std::uint32_t PackVersion = 2;
+    constexpr std::size_t PackAlignment = 16;
+
+    enum class PackEntryType : std::uint32_t
+    {
+        Raw = 0,    // copied unchanged
+        Shader = 1, // GLSL with #includes resolved and comments stripped
+        Texture = 2,// CookedTextureHeader + every mip level, tightly packed
+        Mesh = 3    // CookedMeshHeader + attributes + vertices + indices + LODs
+    };
+
+    struct PackHeader
+    {
+        std::uint32_t magic = PackMagic;
+        std::uint32_t version = PackVersion;
+        std::uint32_t entryCount = 0;
+        std::uint32_t reserved = 0;
+        std::uint64_t tocOffset = 0;
+        std::uint64_t namesOffset = 0;
+    };
+
+    struct PackEntry
+    {
+        std::uint64_t pathHash = 0;   // fnv1a64 of the normalized path, e.g. "assets/shaders/cube.vert"
+        std::uint64_t contentHash = 0;// hash of the cooked payload, used for incremental cooking
+        std::uint64_t offset = 0;
+        std::uint64_t size = 0;
+        std::uint32_t nameOffset = 0; // into the names block
+        std::uint32_t nameLength = 0;
+        PackEntryType type = PackEntryType::Raw;
+        std::uint32_t reserved = 0;
+    };
+
+    // Pixels are stored bottom row first (already flipped for OpenGL), level 0 first
+    struct CookedTextureHeader
+    {
+        std::uint32_t width = 0;
+        std::uint32_t height = 0;
+        std::uint32_t channels = 0;
+        std::uint32_t levels = 0;
+    };
+
+    // Followed by attributeCount CookedMeshAttribute, the vertices, 32 bit indices and lodCount CookedMeshLod
+    struct CookedMeshHeader
+    {
+        std::uint32_t vertexCount = 0;
+        std::uint32_t indexCount = 0;
+        std::uint32_t stride = 0;
+        std::uint32_t attributeCount = 0;
+        float positionOffset[3] = { 0.0f, 0.0f, 0.0f };
+        float positionScale = 1.0f;
+        std::uint32_t lodCount = 0;// 0 = a single level over every index
+        std::uint32_t reserved = 0;
+    };
+
+    struct CookedMeshAttribute
+    {
+        std::uint32_t location = 0;
+        std::int32_t components = 0;
+        std::uint32_t type = 0;
+        std::uint32_t flags = 0;// bit 0 normalized, bit 1 integer
+        std::uint32_t offset = 0;
+    };
+
+    struct CookedMeshLod
+    {
+        std::uint32_t firstIndex = 0;
+        std::uint32_t indexCount = 0;
+        float error = 0.0f;// model units
+    };
+
+    static_assert(sizeof(PackHeader) == 32 && sizeof(PackEntry) == 48, "Pack structs must match the file layout");
+
+    constexpr std::uint64_t fnv1a64(const std::byte* data, const std::size_t size,
+                                    std::uint64_t hash = 0xcbf29ce484222325ull)
+    {
+        for(std::size_t i = 0; i < size; i++)
+        {
+            hash ^= static_cast<std::uint64_t>( data[i] );
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    constexpr std::uint64_t fnv1a64(const std::string_view text, std::uint64_t hash = 0xcbf29ce484222325ull)
+    {
+        for(const char c : text)
+        {
+            hash ^= static_cast<std::uint64_t>( static_cast<unsigned char>( c ) );
+            hash *= 0x100000001b3ull;
+        }
+        return hash;
+    }
+}
@@ -0,0 +1,89 @@
+#include <ProgramPipeline.h>
+#include <iostream>
+
+namespace core
+{
+    namespace
+    {
+        // What bind() last set, a program is assumed current until bind() has cleared it
+        unsigned int g_BoundPipeline = 0;
+        bool g_ProgramMayBeCurrent = true;
+    }
+
+    ProgramPipeline::ProgramPipeline(const ShaderStage& vertexStage, const ShaderStage& fragmentStage)
+    {
+        glCreateProgramPipelines(1, &m_Pipeline);
+        glUseProgramStages(m_Pipeline, vertexStage.getStageBit(), vertexStage.getProgramID());
+        glUseProgramStages(m_Pipeline, fragmentStage.getStageBit(), fragmentStage.getProgramID());
+    }
+
+    ProgramPipeline::~ProgramPipeline()
+    {
+        // The name can come back for a new pipeline, which then has to be bound for real
+        if(g_BoundPipeline == m_Pipeline) g_BoundPipeline = 0;
+        glDeleteProgramPipelines(1, &m_Pipeline);
+    }
+
+    void ProgramPipeline::bind() const
+    {
+        if(g_ProgramMayBeCurrent)
+        {
+            glUseProgram(0);
+            g_ProgramMayBeCurrent = false;
+        }
+        if(g_BoundPipeline != m_Pipeline)
+        {
+            glBindProgramPipeline(m_Pipeline);
+            g_BoundPipeline = m_Pipeline;
+        }
+    }
+
+    void ProgramPipeline::invalidateBinding()
+    {
+        g_BoundPipeline = 0;
+        g_ProgramMayBeCurrent = true;
+    }
+
+    bool ProgramPipeline::validate() const
+    {
+        int success;
+        glValidateProgramPipeline(m_Pipeline);
+        glGetProgramPipelineiv(m_Pipeline, GL_VALIDATE_STATUS, &success);
+        if(!success)
+        {
+            char infoLog[512];
+            glGetProgramPipelineInfoLog(m_Pipeline, 512, nullptr, infoLog);
+            std::cerr << "[ProgramPipeline] Error: Pipeline failed to validate: \n"
+                    << infoLog << '\n';
+            return false;
+        }
+        return true;
+    }
+
+    unsigned int ProgramPipeline::getPipelineID() const { return m_Pipeline; }
+
+    const ProgramPipeline& PipelineCache::get(const ShaderStage& vertexStage, const ShaderStage& fragmentStage)
+    {
+        // Stage ids are 32 bit so the pair packs into one key
+        const std::uint64_t key = static_cast<std::uint64_t>( vertexStage.getId() ) << 32 | fragmentStage.getId();
+
+        auto& pipeline = m_Pipelines[key];
+        if(!pipeline)
+        {
+            pipeline = std::make_unique<ProgramPipeline>(vertexStage, fragmentStage);
+        }
+        return *pipeline;
+    }
+
+    void PipelineCache::bind(const ShaderStage& vertexStage, const ShaderStage& fragmentStage)
+    {
+        get(vertexStage, fragmentStage).bind();
+    }
+
+    std::size_t PipelineCache::size() const { return m_Pipelines.size(); }
+
+    void PipelineCache::clear()
+    {
+        m_Pipelines.clear();
+    }
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <ShaderStage.h>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+namespace core
+{
+    // A program pipeline object combining a vertex and a fragment ShaderStage
+    class ProgramPipeline
+    {
+    private:
+        unsigned int m_Pipeline = 0;
+
+    public:
+        ProgramPipeline(const ShaderStage& vertexStage, const ShaderStage& fragmentStage);
+
+        ProgramPipeline(const ProgramPipeline&) = delete;
+
+        ProgramPipeline& operator=(const ProgramPipeline&) = delete;
+
+        ~ProgramPipeline();
+
+        /* Binds the pipeline, skipping the calls when it already is. A program set with
+         * glUseProgram would take priority, so it is cleared first unless none can be current. */
+        void bind() const;
+
+        // Forget the tracked binding, call after glUseProgram or glBindProgramPipeline outside this class
+        static void invalidateBinding();
+
+        // Checks the stages' interfaces match, returns false and logs on failure
+        [[nodiscard]] bool validate() const;
+
+        [[nodiscard]] unsigned int getPipelineID() const;
+    };
+
+    /* Caches one pipeline object per vertex/fragment stage pair so new permutations
+     * only cost a pipeline object, never another program link. Keyed on the stages' ids,
+     * which are never reused, so a recycled program name can't return a stale pipeline. */
+    class PipelineCache
+    {
+    private:
+        std::unordered_map<std::uint64_t, std::unique_ptr<ProgramPipeline>> m_Pipelines;
+
+    public:
+        PipelineCache() = default;
+
+        PipelineCache(const PipelineCache&) = delete;
+
+        PipelineCache& operator=(const PipelineCache&) = delete;
+
+        // Returns the pipeline for this stage pair, creating it on first use
+        const ProgramPipeline& get(const ShaderStage& vertexStage, const ShaderStage& fragmentStage);
+
+        // Binds the pipeline for this stage pair
+        void bind(const ShaderStage& vertexStage, const ShaderStage& fragmentStage);
+
+        [[nodiscard]] std::size_t size() const;
+
+        void clear();
+    };
+}
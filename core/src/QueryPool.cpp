@@ -0,0 +1,34 @@
+#include <QueryPool.h>
+#include <algorithm>
+
+namespace core
+{
+    QueryPool::QueryPool(const unsigned int target, const std::size_t blockSize)
+        : m_Target(target), m_BlockSize(std::max<std::size_t>(1, blockSize)) {}
+
+    QueryPool::~QueryPool()
+    {
+        if(!m_Queries.empty()) glDeleteQueries(static_cast<GLsizei>( m_Queries.size() ), m_Queries.data());
+    }
+
+    unsigned int QueryPool::acquire()
+    {
+        if(m_Free.empty())
+        {
+            const std::size_t first = m_Queries.size();
+            m_Queries.resize(first + m_BlockSize);
+            glCreateQueries(m_Target, static_cast<GLsizei>( m_BlockSize ), m_Queries.data() + first);
+            // Reversed so the lowest names are handed out first
+            m_Free.assign(m_Queries.rbegin(), m_Queries.rbegin() + static_cast<std::ptrdiff_t>( m_BlockSize ));
+        }
+
+        const unsigned int query = m_Free.back();
+        m_Free.pop_back();
+        return query;
+    }
+
+    void QueryPool::release(const unsigned int query)
+    {
+        m_Free.push_back(query);
+    }
+}
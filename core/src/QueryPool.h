@@ -0,0 +1,39 @@
+#pragma once
+#include <glad/gl.h>
+#include <cstddef>
+#include <vector>
+
+namespace core
+{
+    /* Recycles GL query objects of one target. Queries are created a block at a time and
+     * returned to a free list instead of being deleted, so issuing thousands of them a frame
+     * never goes back to the driver for names. A released query may still be in flight,
+     * beginning it again simply drops the old result. */
+    class QueryPool
+    {
+    private:
+        unsigned int m_Target = 0;
+        std::size_t m_BlockSize = 0;
+        std::vector<unsigned int> m_Queries;// every query the pool created
+        std::vector<unsigned int> m_Free;
+
+    public:
+        explicit QueryPool(unsigned int target, std::size_t blockSize = 256);
+
+        QueryPool(const QueryPool&) = delete;
+
+        QueryPool& operator=(const QueryPool&) = delete;
+
+        ~QueryPool();
+
+        [[nodiscard]] unsigned int acquire();
+
+        void release(unsigned int query);
+
+        [[nodiscard]] unsigned int getTarget() const { return m_Target; }
+
+        [[nodiscard]] std::size_t getAllocatedCount() const { return m_Queries.size(); }
+
+        [[nodiscard]] std::size_t getInUseCount() const { return m_Queries.size() - m_Free.size(); }
+    };
+}
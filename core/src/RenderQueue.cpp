@@ -0,0 +1,194 @@
+#include <RenderQueue.h>
+#include <JobSystem.h>
+#include <algorithm>
+#include <bit>
+#include <chrono>
+
+namespace core
+{
+    namespace
+    {
+        RenderQueue* s_MainQueue = nullptr;
+
+        constexpr std::size_t Radix = 256;
+        // Below this std::sort wins, the radix sort's eight histogram clears aren't free
+        constexpr std::size_t RadixThreshold = 256;
+        // From here each pass's histograms and scatter are split into ChunkSize jobs
+        constexpr std::size_t ParallelThreshold = 32768;
+        constexpr std::size_t ChunkSize = 16384;
+
+        constexpr std::uint64_t DepthMask = (std::uint64_t(1) << RenderQueue::DepthBits) - 1;
+
+        std::uint64_t layerBits(const std::uint32_t pass, const bool translucent)
+        {
+            return (static_cast<std::uint64_t>( std::min(pass, RenderQueue::MaxPass) ) << 60) | (static_cast<std::uint64_t>( translucent ) << 59);
+        }
+
+        std::uint64_t id(const std::uint32_t value) { return value & RenderQueue::MaxId; }
+    }
+
+    RenderQueue::~RenderQueue()
+    {
+        if(s_MainQueue == this) s_MainQueue = nullptr;
+    }
+
+    void RenderQueue::clear()
+    {
+        m_Stats = m_Frame;
+        m_Frame = {};
+        m_Packets.clear();
+        m_Items.clear();
+    }
+
+    void RenderQueue::push(const DrawPacket& packet)
+    {
+        m_Items.push_back({ packet.key, static_cast<std::uint32_t>( m_Packets.size() ) });
+        m_Packets.push_back(packet);
+        if(isTranslucent(packet.key)) m_Frame.translucent++;
+    }
+
+    void RenderQueue::push(const std::span<const DrawPacket> packets)
+    {
+        m_Packets.reserve(m_Packets.size() + packets.size());
+        m_Items.reserve(m_Items.size() + packets.size());
+        for(const DrawPacket& packet : packets)
+            push(packet);
+    }
+
+    void RenderQueue::sort(JobSystem* jobs)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        if(m_Items.size() < RadixThreshold)
+        {
+            // The packet index breaks ties, which keeps equal keys in push order like the radix sort
+            std::sort(m_Items.begin(), m_Items.end(), [](const SortItem& a, const SortItem& b)
+            {
+                return a.key != b.key ? a.key < b.key : a.packet < b.packet;
+            });
+        }
+        else
+        {
+            radixSort(jobs);
+        }
+        m_Frame.sortMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        m_Frame.sorted = true;
+    }
+
+    void RenderQueue::radixSort(JobSystem* jobs)
+    {
+        const std::size_t count = m_Items.size();
+
+        // Bytes where every key agrees would be a pass that copies the array in the same order
+        std::uint64_t varying = 0;
+        const std::uint64_t firstKey = m_Items[0].key;
+        for(const SortItem& item : m_Items)
+            varying |= item.key ^ firstKey;
+
+        const bool parallel = jobs != nullptr && count >= ParallelThreshold;
+        const std::size_t chunkSize = parallel ? ChunkSize : count;
+        m_Frame.sortedInParallel = parallel;
+        const std::size_t chunks = (count + chunkSize - 1) / chunkSize;
+        m_Scratch.resize(count);
+        m_Histograms.resize(chunks * Radix);
+
+        for(unsigned int shift = 0; shift < 64; shift += 8)
+        {
+            if(((varying >> shift) & 0xFF) == 0) continue;
+
+            const SortItem* source = m_Items.data();
+            SortItem* target = m_Scratch.data();
+            std::uint32_t* histograms = m_Histograms.data();
+
+            const auto countChunks = [=](const std::size_t first, const std::size_t last)
+            {
+                for(std::size_t chunk = first; chunk < last; chunk++)
+                {
+                    std::uint32_t* histogram = histograms + chunk * Radix;
+                    std::fill_n(histogram, Radix, 0u);
+                    const std::size_t end = std::min(count, (chunk + 1) * chunkSize);
+                    for(std::size_t i = chunk * chunkSize; i < end; i++)
+                        histogram[(source[i].key >> shift) & 0xFF]++;
+                }
+            };
+
+            // Chunk c's items with digit d go after every smaller digit and after chunks < c with digit d
+            const auto scatterChunks = [=](const std::size_t first, const std::size_t last)
+            {
+                for(std::size_t chunk = first; chunk < last; chunk++)
+                {
+                    std::uint32_t* offsets = histograms + chunk * Radix;
+                    const std::size_t end = std::min(count, (chunk + 1) * chunkSize);
+                    for(std::size_t i = chunk * chunkSize; i < end; i++)
+                        target[offsets[(source[i].key >> shift) & 0xFF]++] = source[i];
+                }
+            };
+
+            if(parallel)
+                jobs->parallelFor(chunks, 1, countChunks);
+            else
+                countChunks(0, chunks);
+
+            std::uint32_t offset = 0;
+            for(std::size_t digit = 0; digit < Radix; digit++)
+            {
+                for(std::size_t chunk = 0; chunk < chunks; chunk++)
+                {
+                    std::uint32_t& slot = histograms[chunk * Radix + digit];
+                    const std::uint32_t digitCount = slot;
+                    slot = offset;
+                    offset += digitCount;
+                }
+            }
+
+            if(parallel)
+                jobs->parallelFor(chunks, 1, scatterChunks);
+            else
+                scatterChunks(0, chunks);
+
+            m_Items.swap(m_Scratch);
+        }
+    }
+
+    void RenderQueue::countInsertionOrder()
+    {
+        RenderStateCounts& counts = m_Frame.insertionOrder;
+        counts = {};
+        const DrawPacket* previous = nullptr;
+        for(const DrawPacket& packet : m_Packets)
+        {
+            if(previous == nullptr || layer(packet.key) != layer(previous->key)) counts.passes++;
+            if(previous == nullptr || packet.shader != previous->shader) counts.shaders++;
+            if(previous == nullptr || packet.material != previous->material) counts.materials++;
+            if(previous == nullptr || packet.texture != previous->texture) counts.textures++;
+            if(previous == nullptr || packet.mesh != previous->mesh) counts.meshes++;
+            previous = &packet;
+        }
+        m_Frame.packets = m_Packets.size();
+        m_Frame.submitted = {};
+    }
+
+    const RenderQueueStats& RenderQueue::getStats() const { return m_Stats; }
+
+    std::uint64_t RenderQueue::makeOpaqueKey(const std::uint32_t pass, const std::uint32_t shader, const std::uint32_t material,
+                                             const std::uint32_t texture, const float depth)
+    {
+        return layerBits(pass, false) | (id(shader) << 47) | (id(material) << 35) | (id(texture) << 23) | quantizeDepth(depth);
+    }
+
+    std::uint64_t RenderQueue::makeTranslucentKey(const std::uint32_t pass, const std::uint32_t shader, const std::uint32_t material,
+                                                  const std::uint32_t texture, const float depth)
+    {
+        const std::uint64_t farFirst = DepthMask - quantizeDepth(depth);
+        return layerBits(pass, true) | (farFirst << 36) | (id(shader) << 24) | (id(material) << 12) | id(texture);
+    }
+
+    std::uint32_t RenderQueue::quantizeDepth(const float depth)
+    {
+        // Positive floats order like their bits, NaN and negatives land on 0
+        const float clamped = depth > 0.0f ? depth : 0.0f;
+        return std::bit_cast<std::uint32_t>( clamped ) >> (32 - 1 - DepthBits);
+    }
+
+    RenderQueue* RenderQueue::getMain() { return s_MainQueue; }
+    void RenderQueue::setMain(RenderQueue* queue) { s_MainQueue = queue; }
+}
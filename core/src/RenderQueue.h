@@ -0,0 +1,194 @@
+#pragma once
+#include <glad/gl.h>
+#include <Mesh.h>
+#include <Shader.h>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace core
+{
+    class JobSystem;
+
+    /* One draw. key decides the order, the rest is what the queue binds: shader, texture on
+     * unit 0 and mesh are only rebound when they differ from the previous packet's.
+     * material is the caller's id, the same one that went into the key, and userData comes
+     * back untouched at submit (an object index, say). */
+    struct DrawPacket
+    {
+        std::uint64_t key = 0;
+        const Shader* shader = nullptr;
+        const Mesh* mesh = nullptr;
+        unsigned int texture = 0;// GL name, 0 leaves unit 0 as it is
+        std::uint32_t material = 0;
+        std::uint32_t lod = 0;
+        std::uint32_t userData = 0;
+    };
+
+    // What changed since the previous packet, passed to the submit callback
+    enum RenderStateChange : std::uint32_t
+    {
+        PassChanged = 1 << 0,// pass or opaque/translucent, switch blending and depth writes here
+        ShaderChanged = 1 << 1,
+        MaterialChanged = 1 << 2,
+        TextureChanged = 1 << 3,
+        MeshChanged = 1 << 4
+    };
+
+    struct RenderStateCounts
+    {
+        std::size_t passes = 0;
+        std::size_t shaders = 0;
+        std::size_t materials = 0;
+        std::size_t textures = 0;
+        std::size_t meshes = 0;
+
+        [[nodiscard]] std::size_t getTotal() const { return passes + shaders + materials + textures + meshes; }
+    };
+
+    // One frame of submission
+    struct RenderQueueStats
+    {
+        std::size_t packets = 0;
+        std::size_t translucent = 0;
+        RenderStateCounts insertionOrder;// had the packets been drawn as they were pushed
+        RenderStateCounts submitted;     // what submit() actually changed
+        double sortMs = 0.0;
+        bool sorted = false;
+        bool sortedInParallel = false;// big enough queue sorted with a JobSystem
+    };
+
+    /* Collects a frame's draws as DrawPackets and submits them ordered by a 64-bit sort key,
+     * so draws sharing a shader, material and texture end up next to each other and state is
+     * only changed between runs.
+     * Opaque keys, from the top bit down:
+     *   pass 4 | translucent 0 | shader 12 | material 12 | texture 12 | depth 23
+     * state first, then front to back within a state for early-Z. Translucent keys:
+     *   pass 4 | translucent 1 | inverted depth 23 | shader 12 | material 12 | texture 12
+     * back to front, which blending needs, state only breaks ties. Ids are dense caller ids
+     * below 4096, depth is view space distance (negative clamps to 0).
+     * sort() is an LSD radix sort over the keys, 8 bits a pass, skipping the bytes every key
+     * shares; big queues build histograms and scatter on a JobSystem. Nothing is allocated
+     * once the queue has seen its largest frame. */
+    class RenderQueue
+    {
+    public:
+        static constexpr unsigned int PassBits = 4;
+        static constexpr unsigned int IdBits = 12;
+        static constexpr unsigned int DepthBits = 23;
+        static constexpr std::uint32_t MaxId = (1u << IdBits) - 1;
+        static constexpr std::uint32_t MaxPass = (1u << PassBits) - 1;
+
+    private:
+        struct SortItem
+        {
+            std::uint64_t key;
+            std::uint32_t packet;
+        };
+
+        std::vector<DrawPacket> m_Packets;
+        std::vector<SortItem> m_Items;
+        std::vector<SortItem> m_Scratch;
+        std::vector<std::uint32_t> m_Histograms;// per chunk and digit value, for the parallel sort
+        RenderQueueStats m_Frame;
+        RenderQueueStats m_Stats;
+
+        void radixSort(JobSystem* jobs);
+        void countInsertionOrder();
+
+        // The key's top bits: pass and the translucent flag
+        static std::uint64_t layer(std::uint64_t key) { return key >> (63 - PassBits); }
+
+    public:
+        RenderQueue() = default;
+
+        RenderQueue(const RenderQueue&) = delete;
+
+        RenderQueue& operator=(const RenderQueue&) = delete;
+
+        ~RenderQueue();
+
+        // Publishes the last frame's stats and empties the queue, call once per frame before pushing
+        void clear();
+
+        void push(const DrawPacket& packet);
+
+        void push(std::span<const DrawPacket> packets);
+
+        /* Orders the packets by key, stable for equal keys. jobs nullptr sorts on the calling
+         * thread. Without a sort, submit() goes in push order. */
+        void sort(JobSystem* jobs = nullptr);
+
+        /* Binds each packet's state where it changed, calls draw(packet, changes) with
+         * changes a RenderStateChange mask, then draws the packet's mesh level. The callback
+         * sets uniforms: per shader ones on ShaderChanged, material ones on MaterialChanged
+         * or ShaderChanged, the model matrix every time. */
+        template <typename Function>
+        void submit(const Function& draw);
+
+        [[nodiscard]] std::size_t getSize() const { return m_Packets.size(); }
+
+        [[nodiscard]] std::span<const DrawPacket> getPackets() const { return m_Packets; }
+
+        // The last finished frame
+        [[nodiscard]] const RenderQueueStats& getStats() const;
+
+        static std::uint64_t makeOpaqueKey(std::uint32_t pass, std::uint32_t shader, std::uint32_t material, std::uint32_t texture,
+                                           float depth);
+
+        static std::uint64_t makeTranslucentKey(std::uint32_t pass, std::uint32_t shader, std::uint32_t material, std::uint32_t texture,
+                                                float depth);
+
+        // Order preserving DepthBits wide depth: the float's bits without sign and low mantissa
+        static std::uint32_t quantizeDepth(float depth);
+
+        [[nodiscard]] static bool isTranslucent(const std::uint64_t key) { return (layer(key) & 1) != 0; }
+
+        // The queue the FPS overlay reports, nullptr if none. The queue unregisters itself when destroyed
+        [[nodiscard]] static RenderQueue* getMain();
+
+        static void setMain(RenderQueue* queue);
+    };
+
+    template <typename Function>
+    void RenderQueue::submit(const Function& draw)
+    {
+        countInsertionOrder();
+
+        const DrawPacket* previous = nullptr;
+        RenderStateCounts& counts = m_Frame.submitted;
+        for(const SortItem& item : m_Items)
+        {
+            const DrawPacket& packet = m_Packets[item.packet];
+            std::uint32_t changes = 0;
+            if(previous == nullptr || layer(packet.key) != layer(previous->key)) changes |= PassChanged;
+            if(previous == nullptr || packet.shader != previous->shader) changes |= ShaderChanged;
+            if(previous == nullptr || packet.material != previous->material) changes |= MaterialChanged;
+            if(previous == nullptr || packet.texture != previous->texture) changes |= TextureChanged;
+            if(previous == nullptr || packet.mesh != previous->mesh) changes |= MeshChanged;
+            previous = &packet;
+
+            if((changes & PassChanged) != 0) counts.passes++;
+            if((changes & ShaderChanged) != 0)
+            {
+                counts.shaders++;
+                if(packet.shader != nullptr) packet.shader->use();
+            }
+            if((changes & MaterialChanged) != 0) counts.materials++;
+            if((changes & TextureChanged) != 0)
+            {
+                counts.textures++;
+                if(packet.texture != 0) glBindTextureUnit(0, packet.texture);
+            }
+            if((changes & MeshChanged) != 0)
+            {
+                counts.meshes++;
+                if(packet.mesh != nullptr) packet.mesh->bind();
+            }
+
+            draw(packet, changes);
+            if(packet.mesh != nullptr) packet.mesh->drawBound(packet.lod);
+        }
+    }
+}
@@ -1,41 +1,95 @@
 #include <glad/gl.h>
 #include <Shader.h>
+#include <ProgramPipeline.h>
+#include <VirtualFileSystem.h>
+#include <filesystem>
 #include <iostream>
-#include <fstream>
-#include <sstream>
+#include <set>
+#include <utility>
+
+namespace
+{
+    // Inlines #include "file" (relative to the including file), each file at most once, the same
+    // way AssetCooker resolves them for packs. Cooked sources have none left
+    bool appendSource(const std::filesystem::path& path, std::set<std::string>& included, std::string& out)
+    {
+        const std::string name = path.lexically_normal().generic_string();
+        if(!included.insert(name).second) return true;
+
+        const core::vfs::FileView file = core::vfs::get().read(name);
+        if(!file)
+        {
+            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ:: " << name << std::endl;
+            return false;
+        }
+
+        const std::string_view text = file.getText();
+        int lineNumber = 0;
+        for(std::size_t begin = 0; begin < text.size();)
+        {
+            const std::size_t newline = text.find('\n', begin);
+            const std::size_t end = newline == std::string_view::npos ? text.size() : newline;
+            const std::string_view line = text.substr(begin, end - begin);
+            begin = end + 1;
+            lineNumber++;
+
+            const std::size_t start = line.find_first_not_of(" \t");
+            if(start != std::string_view::npos && line.substr(start).starts_with("#include"))
+            {
+                const std::size_t open = line.find('"', start);
+                const std::size_t close = open == std::string_view::npos ? open : line.find('"', open + 1);
+                if(close == std::string_view::npos)
+                {
+                    std::cerr << "[Shader] Error: Malformed #include in " << name << '\n';
+                    return false;
+                }
+
+                if(!appendSource(path.parent_path() / line.substr(open + 1, close - open - 1), included, out)) return false;
+                // Puts the line numbers back for the including file
+                out += "#line " + std::to_string(lineNumber + 1) + '\n';
+                continue;
+            }
+            out += line;
+            out += '\n';
+        }
+        return true;
+    }
+}
 
 namespace core
 {
     Shader::Shader(const char* vertexPath, const char* fragmentPath)
     {
         // retrieve the vertex/fragment source code from filePath
-        std::string vertexCode;
-        std::string fragmentCode;
-        std::ifstream vShaderFile;
-        std::ifstream fShaderFile;
-
-        // ensure ifstream objects can throw exceptions:
-        vShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        fShaderFile.exceptions(std::ifstream::failbit | std::ifstream::badbit);
-        try
-        {
-            // open files
-            vShaderFile.open(vertexPath);
-            fShaderFile.open(fragmentPath);
-            std::stringstream vShaderStream, fShaderStream;
-            // read file's buffer contents into streams
-            vShaderStream << vShaderFile.rdbuf();
-            fShaderStream << fShaderFile.rdbuf();
-            // close file handlers
-            vShaderFile.close();
-            fShaderFile.close();
-            // convert stream into string
-            vertexCode = vShaderStream.str();
-            fragmentCode = fShaderStream.str();
-        } catch(const std::ifstream::failure& e)
+        const std::string vertexCode = loadSource(vertexPath);
+        const std::string fragmentCode = loadSource(fragmentPath);
+        linkGLSL(vertexCode, fragmentCode);
+    }
+
+    Shader::Shader(const SpirvShaderOptions& options)
+    {
+        if(supportsSpirv())
         {
-            std::cout << "ERROR::SHADER::FILE_NOT_SUCCESSFULLY_READ:: " << e.what() << std::endl;
+            const std::vector<char> vertexBinary = loadBinary(options.vertexSpirvPath.c_str());
+            const std::vector<char> fragmentBinary = loadBinary(options.fragmentSpirvPath.c_str());
+
+            if(!vertexBinary.empty() && !fragmentBinary.empty())
+            {
+                linkSpirv(vertexBinary, fragmentBinary, options);
+                return;
+            }
+            std::cerr << "[Shader] Warning: Missing SPIR-V module, using GLSL fallback" << '\n';
         }
+
+        // Specialization constants become #defines so the GLSL fallback sees the same values
+        const std::string vertexCode = injectDefines(loadSource(options.vertexFallbackPath.c_str()), options.constants);
+        const std::string fragmentCode = injectDefines(loadSource(options.fragmentFallbackPath.c_str()),
+                                                       options.constants);
+        linkGLSL(vertexCode, fragmentCode);
+    }
+
+    void Shader::linkGLSL(const std::string& vertexCode, const std::string& fragmentCode)
+    {
         const char* vShaderCode = vertexCode.c_str();
         const char* fShaderCode = fragmentCode.c_str();
 
@@ -51,6 +105,45 @@ namespace core
         glCompileShader(fragmentShader);
         checkShaderCompileStatus(fragmentShader);
 
+        linkProgram(vertexShader, fragmentShader);
+    }
+
+    void Shader::linkSpirv(const std::vector<char>& vertexBinary, const std::vector<char>& fragmentBinary,
+                           const SpirvShaderOptions& options)
+    {
+        std::vector<unsigned int> indices;
+        std::vector<unsigned int> values;
+        for(const auto& constant : options.constants)
+        {
+            indices.push_back(constant.id);
+            values.push_back(constant.value);
+        }
+
+        // Loads a module and picks its entry point, no GLSL parsing happens here
+        auto specialize = [&](const unsigned int type, const std::vector<char>& binary)
+        {
+            const unsigned int shader = glCreateShader(type);
+            glShaderBinary(1, &shader, GL_SHADER_BINARY_FORMAT_SPIR_V, binary.data(),
+                           static_cast<GLsizei>( binary.size() ));
+
+            const auto count = static_cast<GLuint>( indices.size() );
+            if(GLAD_GL_VERSION_4_6)
+                glSpecializeShader(shader, options.entryPoint.c_str(), count, indices.data(), values.data());
+            else
+                glSpecializeShaderARB(shader, options.entryPoint.c_str(), count, indices.data(), values.data());
+
+            // specialization sets the compile status just like glCompileShader would
+            checkShaderCompileStatus(shader);
+            return shader;
+        };
+
+        const unsigned int vertexShader = specialize(GL_VERTEX_SHADER, vertexBinary);
+        const unsigned int fragmentShader = specialize(GL_FRAGMENT_SHADER, fragmentBinary);
+        linkProgram(vertexShader, fragmentShader);
+    }
+
+    void Shader::linkProgram(const unsigned int vertexShader, const unsigned int fragmentShader)
+    {
         // creates shader program and attaches vertex and fragment shaders
         m_ShaderProgram = glCreateProgram();
         glAttachShader(m_ShaderProgram, vertexShader);
@@ -62,6 +155,69 @@ namespace core
         glDeleteShader(fragmentShader);
     }
 
+    bool Shader::supportsSpirv()
+    {
+        return GLAD_GL_VERSION_4_6 || GLAD_GL_ARB_gl_spirv;
+    }
+
+    std::vector<char> Shader::loadBinary(const char* path)
+    {
+        const vfs::FileView file = vfs::get().read(path);
+        if(!file)
+        {
+            std::cerr << "[Shader] Error: Failed to open SPIR-V module: " << path << std::endl;
+            return {};
+        }
+
+        // SPIR-V is a stream of 32 bit words
+        if(file.getSize() == 0 || file.getSize() % 4 != 0)
+        {
+            std::cerr << "[Shader] Error: Invalid SPIR-V module size: " << path << std::endl;
+            return {};
+        }
+
+        const std::string_view bytes = file.getText();
+        return { bytes.begin(), bytes.end() };
+    }
+
+    std::string Shader::injectDefines(const std::string& source, const std::vector<SpecializationConstant>& constants)
+    {
+        if(constants.empty()) return source;
+
+        std::string defines;
+        for(const auto& constant : constants)
+        {
+            if(constant.name.empty()) continue;
+            defines += "#define " + constant.name + " " + std::to_string(constant.value) + "\n";
+        }
+
+        // #version has to stay the first line, so the defines go straight after it
+        std::size_t insertAt = 0;
+        if(source.starts_with("#version"))
+        {
+            const std::size_t lineEnd = source.find('\n');
+            insertAt = lineEnd == std::string::npos ? source.size() : lineEnd + 1;
+        }
+
+        std::string result = source;
+        result.insert(insertAt, defines);
+        return result;
+    }
+
+    Shader::Shader(const unsigned int program)
+        : m_ShaderProgram(program)
+    {
+    }
+
+    std::string Shader::loadSource(const char* path)
+    {
+        // Resolved through the mounts, so cooked lessons get their preprocessed shaders from assets.pak
+        std::set<std::string> included;
+        std::string source;
+        if(!appendSource(path, included, source)) return {};
+        return source;
+    }
+
     // deletes shader program when a class goes out of scope
     Shader::~Shader()
     {
@@ -72,31 +228,33 @@ namespace core
     void Shader::use() const
     {
         glUseProgram(m_ShaderProgram);
+        ProgramPipeline::invalidateBinding();
     }
 
     // Caches uniform location to avoid getting it every frame
-    int Shader::getUniformLocation(const std::string& name) const
+    int Shader::getUniformLocation(const std::string_view name) const
     {
-        // Check if we already have this location in our cache
-        if(m_UniformLocationCache.contains(name))
+        // Heterogeneous lookup, a cached name costs a hash and no allocation
+        if(const auto it = m_UniformLocationCache.find(name); it != m_UniformLocationCache.end())
         {
-            // O(1) time
-            return m_UniformLocationCache[name];
+            return it->second;
         }
 
-        // If not, retrieve it from OpenGL
-        const int location = glGetUniformLocation(m_ShaderProgram, name.c_str());
+        // If not, retrieve it from OpenGL, which needs a null terminated copy of the name
+        std::string key(name);
+        const int location = glGetUniformLocation(m_ShaderProgram, key.c_str());
         if(location == -1)
         {
-            std::cerr << "Warning: uniform '" << name << "' not found!" << std::endl;
+            std::cerr << "Warning: uniform '" << key << "' not found!" << std::endl;
         }
 
-        // Add the location to our cache for future calls
-        m_UniformLocationCache[name] = location;
+        m_UniformLocationCache.emplace(std::move(key), location);
         return location;
     }
 
 
+    unsigned int Shader::getProgramID() const { return m_ShaderProgram; }
+
     void Shader::checkShaderCompileStatus(const unsigned int shader) const
     {
         int success;
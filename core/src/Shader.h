@@ -1,7 +1,9 @@
 ﻿#pragma once
 #include <glm/glm.hpp>
 #include <glm/gtc/type_ptr.hpp>
+#include <functional>
 #include <string>
+#include <string_view>
 #include <unordered_map>
 #include <vector>
 #include <type_traits>
@@ -19,16 +21,69 @@ inline constexpr bool is_vector_v = is_vector<T>::value;
 
 namespace core
 {
+    // Lets maps keyed by std::string be searched with a string_view or literal, no temporary string is built
+    struct StringHash
+    {
+        using is_transparent = void;
+
+        std::size_t operator()(const std::string_view value) const { return std::hash<std::string_view>{}(value); }
+    };
+
+    // A SPIR-V specialization constant, the name is only used as a #define by the GLSL fallback
+    struct SpecializationConstant
+    {
+        unsigned int id = 0;
+        unsigned int value = 0;
+        std::string name;
+    };
+
+    struct SpirvShaderOptions
+    {
+        // Precompiled modules (glslangValidator -G), loaded when ARB_gl_spirv / GL 4.6 is present
+        std::string vertexSpirvPath;
+        std::string fragmentSpirvPath;
+        // GLSL sources compiled instead when the driver can't ingest SPIR-V
+        std::string vertexFallbackPath;
+        std::string fragmentFallbackPath;
+        std::vector<SpecializationConstant> constants;
+        std::string entryPoint = "main";
+    };
+
     class Shader
     {
     private:
         unsigned int m_ShaderProgram;
         // Cache for uniform locations to improve performance
-        mutable std::unordered_map<std::string, int> m_UniformLocationCache;
+        mutable std::unordered_map<std::string, int, StringHash, std::equal_to<>> m_UniformLocationCache;
+
+        void linkGLSL(const std::string& vertexCode, const std::string& fragmentCode);
+
+        void linkSpirv(const std::vector<char>& vertexBinary, const std::vector<char>& fragmentBinary,
+                       const SpirvShaderOptions& options);
+
+        void linkProgram(unsigned int vertexShader, unsigned int fragmentShader);
+
+        static std::vector<char> loadBinary(const char* path);
+
+        static std::string injectDefines(const std::string& source,
+                                         const std::vector<SpecializationConstant>& constants);
 
     public:
         Shader(const char* vertexPath, const char* fragmentPath);
 
+        /* Builds the program from SPIR-V modules specialized with options.constants.
+         * SPIR-V drops uniform names, so uniforms need layout(location = N) and the
+         * location overload of setUniform. */
+        explicit Shader(const SpirvShaderOptions& options);
+
+        // Takes ownership of an already linked program (used by ShaderLibrary batch compiles)
+        explicit Shader(unsigned int program);
+
+        // Only one object may own (and delete) a given program
+        Shader(const Shader&) = delete;
+
+        Shader& operator=(const Shader&) = delete;
+
         // deletes shader program when a class goes out of scope
         ~Shader();
 
@@ -36,10 +91,15 @@ namespace core
         void use() const;
 
         template <typename T>
-        void setUniform(const std::string& name, const T& value) const
+        void setUniform(const std::string_view name, const T& value) const
         {
-            int location = getUniformLocation(name);
+            setUniform(getUniformLocation(name), value);
+        }
 
+        // Sets a uniform by explicit location, needed for SPIR-V programs
+        template <typename T>
+        void setUniform(const int location, const T& value) const
+        {
             // checks if the type is vector
             if constexpr(is_vector_v<T>)
             {
@@ -91,8 +151,16 @@ namespace core
             }
         }
 
-        // Caches uniform location to avoid getting it every frame
-        int getUniformLocation(const std::string& name) const;
+        // Caches uniform location to avoid getting it every frame, only the first lookup of a name allocates
+        int getUniformLocation(std::string_view name) const;
+
+        [[nodiscard]] unsigned int getProgramID() const;
+
+        // True when the context can take SPIR-V modules (GL 4.6 or ARB_gl_spirv)
+        static bool supportsSpirv();
+
+        // Reads a shader source file into a string with its #includes inlined, returns an empty string on failure
+        static std::string loadSource(const char* path);
 
         void checkShaderCompileStatus(unsigned int shader) const;
 
@@ -0,0 +1,253 @@
+#include <glad/gl.h>
+#include <GLFW/glfw3.h>
+#include <ShaderLibrary.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+namespace core
+{
+    namespace
+    {
+        using Clock = std::chrono::steady_clock;
+
+        // Everything needed to follow one program through the batch
+        struct ProgramJob
+        {
+            const std::string* name = nullptr;
+            std::string vertexCode;
+            std::string fragmentCode;
+            unsigned int vertexShader = 0;
+            unsigned int fragmentShader = 0;
+            unsigned int program = 0;
+            Clock::time_point submitTime;
+            double elapsedMs = 0.0;
+            bool done = false;
+        };
+
+        double millisecondsSince(const Clock::time_point start)
+        {
+            return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+        }
+
+        // Issues the compile and link without asking for any status, so the driver never has to block
+        void submitProgram(ProgramJob& job)
+        {
+            const char* vShaderCode = job.vertexCode.c_str();
+            const char* fShaderCode = job.fragmentCode.c_str();
+            job.submitTime = Clock::now();
+
+            job.vertexShader = glCreateShader(GL_VERTEX_SHADER);
+            glShaderSource(job.vertexShader, 1, &vShaderCode, nullptr);
+            glCompileShader(job.vertexShader);
+
+            job.fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+            glShaderSource(job.fragmentShader, 1, &fShaderCode, nullptr);
+            glCompileShader(job.fragmentShader);
+
+            // Linking a program with failed shaders is legal, it just fails the link status
+            job.program = glCreateProgram();
+            glAttachShader(job.program, job.vertexShader);
+            glAttachShader(job.program, job.fragmentShader);
+            glLinkProgram(job.program);
+        }
+
+        bool hasParallelCompileExtension()
+        {
+            return GLAD_GL_KHR_parallel_shader_compile || GLAD_GL_ARB_parallel_shader_compile;
+        }
+
+        // Submits every program up front and then polls GL_COMPLETION_STATUS_KHR until all are linked
+        void compileWithParallelExtension(std::vector<ProgramJob>& jobs)
+        {
+            // 0xFFFFFFFF lets the driver pick its own number of compiler threads
+            if(GLAD_GL_KHR_parallel_shader_compile)
+                glMaxShaderCompilerThreadsKHR(0xFFFFFFFFu);
+            else
+                glMaxShaderCompilerThreadsARB(0xFFFFFFFFu);
+
+            for(auto& job : jobs)
+                submitProgram(job);
+
+            std::size_t remaining = jobs.size();
+            while(remaining > 0)
+            {
+                bool progressed = false;
+                for(auto& job : jobs)
+                {
+                    if(job.done) continue;
+
+                    int complete = GL_FALSE;
+                    glGetProgramiv(job.program, GL_COMPLETION_STATUS_KHR, &complete);
+                    if(complete == GL_TRUE)
+                    {
+                        job.elapsedMs = millisecondsSince(job.submitTime);
+                        job.done = true;
+                        progressed = true;
+                        remaining--;
+                    }
+                }
+                if(!progressed) std::this_thread::yield();
+            }
+        }
+
+        // Creates an invisible window whose context shares objects with the current one
+        GLFWwindow* createSharedContext(GLFWwindow* mainContext)
+        {
+            glfwDefaultWindowHints();
+            glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+            glfwWindowHint(GLFW_CONTEXT_CREATION_API, glfwGetWindowAttrib(mainContext, GLFW_CONTEXT_CREATION_API));
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, glfwGetWindowAttrib(mainContext, GLFW_CONTEXT_VERSION_MAJOR));
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, glfwGetWindowAttrib(mainContext, GLFW_CONTEXT_VERSION_MINOR));
+            glfwWindowHint(GLFW_OPENGL_PROFILE, glfwGetWindowAttrib(mainContext, GLFW_OPENGL_PROFILE));
+            GLFWwindow* context = glfwCreateWindow(1, 1, "ShaderLibrary Worker", nullptr, mainContext);
+            glfwDefaultWindowHints();
+            return context;
+        }
+
+        /* Fallback for drivers without the extension: each worker owns a shared context and
+         * compiles whole programs, querying the link status to wait for its own results. */
+        unsigned int compileWithWorkerContexts(std::vector<ProgramJob>& jobs)
+        {
+            GLFWwindow* mainContext = glfwGetCurrentContext();
+            const unsigned int hardwareThreads = std::max(1u, std::thread::hardware_concurrency());
+            const auto wanted = static_cast<unsigned int>( std::min<std::size_t>(jobs.size(), hardwareThreads) );
+
+            // GLFW windows may only be created on the main thread, so contexts are made up front
+            std::vector<GLFWwindow*> contexts;
+            if(mainContext != nullptr && wanted > 1)
+            {
+                for(unsigned int i = 0; i < wanted; i++)
+                {
+                    GLFWwindow* context = createSharedContext(mainContext);
+                    if(context == nullptr) break;
+                    contexts.push_back(context);
+                }
+            }
+
+            std::atomic<std::size_t> nextJob{ 0 };
+            auto compileJobs = [&jobs, &nextJob]()
+            {
+                for(std::size_t i = nextJob++; i < jobs.size(); i = nextJob++)
+                {
+                    ProgramJob& job = jobs[i];
+                    submitProgram(job);
+                    int linked = GL_FALSE;
+                    glGetProgramiv(job.program, GL_LINK_STATUS, &linked);
+                    job.elapsedMs = millisecondsSince(job.submitTime);
+                    job.done = true;
+                }
+            };
+
+            if(contexts.empty())
+            {
+                compileJobs();
+                return 0;
+            }
+
+            std::vector<std::thread> workers;
+            workers.reserve(contexts.size());
+            for(GLFWwindow* context : contexts)
+            {
+                workers.emplace_back([context, &compileJobs]()
+                {
+                    glfwMakeContextCurrent(context);
+                    compileJobs();
+                    // Programs must be complete before another context is allowed to use them
+                    glFinish();
+                    glfwMakeContextCurrent(nullptr);
+                });
+            }
+            for(auto& worker : workers)
+                worker.join();
+
+            for(GLFWwindow* context : contexts)
+                glfwDestroyWindow(context);
+            glfwMakeContextCurrent(mainContext);
+
+            return static_cast<unsigned int>( contexts.size() );
+        }
+    }
+
+    void ShaderLibrary::add(const std::string& name, const std::string& vertexPath, const std::string& fragmentPath)
+    {
+        m_Pending.push_back({ name, vertexPath, fragmentPath });
+    }
+
+    ShaderCompileStats ShaderLibrary::compileAll()
+    {
+        ShaderCompileStats stats{};
+        stats.programCount = m_Pending.size();
+        if(m_Pending.empty())
+        {
+            m_LastStats = stats;
+            return stats;
+        }
+
+        const auto batchStart = Clock::now();
+
+        std::vector<ProgramJob> jobs(m_Pending.size());
+        for(std::size_t i = 0; i < m_Pending.size(); i++)
+        {
+            jobs[i].name = &m_Pending[i].name;
+            jobs[i].vertexCode = Shader::loadSource(m_Pending[i].vertexPath.c_str());
+            jobs[i].fragmentCode = Shader::loadSource(m_Pending[i].fragmentPath.c_str());
+        }
+
+        if(hasParallelCompileExtension())
+        {
+            stats.parallelExtension = true;
+            compileWithParallelExtension(jobs);
+        } else
+        {
+            stats.workerThreads = compileWithWorkerContexts(jobs);
+        }
+
+        // Status checks only happen now, after every compile has finished
+        for(auto& job : jobs)
+        {
+            auto shader = std::make_unique<Shader>(job.program);
+            shader->checkShaderCompileStatus(job.vertexShader);
+            shader->checkShaderCompileStatus(job.fragmentShader);
+            shader->checkShaderProgramStatus(job.program);
+
+            glDetachShader(job.program, job.vertexShader);
+            glDetachShader(job.program, job.fragmentShader);
+            glDeleteShader(job.vertexShader);
+            glDeleteShader(job.fragmentShader);
+
+            stats.summedTimeMs += job.elapsedMs;
+            m_Shaders[*job.name] = std::move(shader);
+        }
+        m_Pending.clear();
+
+        stats.wallTimeMs = millisecondsSince(batchStart);
+        m_LastStats = stats;
+
+        std::cerr << "[ShaderLibrary]: Compiled " << stats.programCount << " programs in "
+                << stats.wallTimeMs << " ms (sum of per-program times " << stats.summedTimeMs << " ms, "
+                << (stats.parallelExtension ? "parallel_shader_compile" : "worker contexts: ")
+                << (stats.parallelExtension ? "" : std::to_string(stats.workerThreads)) << ")" << '\n';
+        return stats;
+    }
+
+    bool ShaderLibrary::contains(const std::string& name) const
+    {
+        return m_Shaders.contains(name);
+    }
+
+    const Shader& ShaderLibrary::get(const std::string& name) const
+    {
+        const auto it = m_Shaders.find(name);
+        if(it == m_Shaders.end())
+        {
+            throw std::runtime_error("[ShaderLibrary]: Shader '" + name + "' has not been compiled");
+        }
+        return *it->second;
+    }
+
+    const ShaderCompileStats& ShaderLibrary::getLastStats() const { return m_LastStats; }
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <Shader.h>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace core
+{
+    // Timings of the last compileAll() call, used to see how much the compiles overlapped
+    struct ShaderCompileStats
+    {
+        std::size_t programCount = 0;
+        double wallTimeMs = 0.0;     // time for the whole batch
+        double summedTimeMs = 0.0;   // sum of each program's own compile + link time
+        unsigned int workerThreads = 0;
+        bool parallelExtension = false;// true when KHR/ARB_parallel_shader_compile was used
+    };
+
+    /* Collects every shader program a lesson needs and compiles them in one batch.
+     * With KHR_parallel_shader_compile all compiles and links are submitted first
+     * and only then polled, so the driver's compiler threads work on them together.
+     * Without the extension the batch is split across hidden shared-context windows. */
+    class ShaderLibrary
+    {
+    private:
+        struct ShaderSource
+        {
+            std::string name;
+            std::string vertexPath;
+            std::string fragmentPath;
+        };
+
+        std::vector<ShaderSource> m_Pending;
+        std::unordered_map<std::string, std::unique_ptr<Shader>> m_Shaders;
+        ShaderCompileStats m_LastStats;
+
+    public:
+        ShaderLibrary() = default;
+
+        ShaderLibrary(const ShaderLibrary&) = delete;
+
+        ShaderLibrary& operator=(const ShaderLibrary&) = delete;
+
+        // Queues a program, nothing is compiled until compileAll()
+        void add(const std::string& name, const std::string& vertexPath, const std::string& fragmentPath);
+
+        // Compiles and links every queued program, needs a current GL context
+        ShaderCompileStats compileAll();
+
+        [[nodiscard]] bool contains(const std::string& name) const;
+
+        // Throws std::runtime_error if the program was never compiled
+        [[nodiscard]] const Shader& get(const std::string& name) const;
+
+        [[nodiscard]] const ShaderCompileStats& getLastStats() const;
+    };
+}
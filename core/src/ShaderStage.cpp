@@ -0,0 +1,78 @@
+#include <ShaderStage.h>
+#include <iostream>
+#include <utility>
+
+namespace core
+{
+    namespace
+    {
+        std::atomic<std::uint32_t> g_NextStageId{ 1 };
+    }
+
+    ShaderStage::ShaderStage(const unsigned int type, const char* path)
+        : m_Type(type), m_Id(g_NextStageId.fetch_add(1, std::memory_order_relaxed))
+    {
+        const std::string source = Shader::loadSource(path);
+        const char* code = source.c_str();
+
+        // Compiles and links the stage into its own separable program in one call
+        m_Program = glCreateShaderProgramv(m_Type, 1, &code);
+
+        int success;
+        glGetProgramiv(m_Program, GL_LINK_STATUS, &success);
+        if(!success)
+        {
+            // glCreateShaderProgramv appends the compile log to the program's info log
+            char infoLog[512];
+            glGetProgramInfoLog(m_Program, 512, nullptr, infoLog);
+            std::cerr << "[ShaderStage] Error: " << path << " failed to build: \n"
+                    << infoLog << '\n';
+        }
+    }
+
+    ShaderStage::~ShaderStage()
+    {
+        glDeleteProgram(m_Program);
+    }
+
+    int ShaderStage::getUniformLocation(const std::string_view name) const
+    {
+        // Heterogeneous lookup, a cached name costs a hash and no allocation
+        if(const auto it = m_UniformLocationCache.find(name); it != m_UniformLocationCache.end())
+        {
+            return it->second;
+        }
+
+        // If not, retrieve it from OpenGL, which needs a null terminated copy of the name
+        std::string key(name);
+        const int location = glGetUniformLocation(m_Program, key.c_str());
+        if(location == -1)
+        {
+            std::cerr << "Warning: uniform '" << key << "' not found!" << std::endl;
+        }
+
+        m_UniformLocationCache.emplace(std::move(key), location);
+        return location;
+    }
+
+    unsigned int ShaderStage::getProgramID() const { return m_Program; }
+    unsigned int ShaderStage::getType() const { return m_Type; }
+    std::uint32_t ShaderStage::getId() const { return m_Id; }
+
+    unsigned int ShaderStage::getStageBit() const
+    {
+        switch(m_Type)
+        {
+            case GL_VERTEX_SHADER :
+                return GL_VERTEX_SHADER_BIT;
+            case GL_FRAGMENT_SHADER :
+                return GL_FRAGMENT_SHADER_BIT;
+            case GL_GEOMETRY_SHADER :
+                return GL_GEOMETRY_SHADER_BIT;
+            case GL_COMPUTE_SHADER :
+                return GL_COMPUTE_SHADER_BIT;
+            default :
+                return 0;
+        }
+    }
+}
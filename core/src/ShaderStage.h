@@ -0,0 +1,107 @@
+#pragma once
+#include <glad/gl.h>
+#include <Shader.h>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace core
+{
+    /* A single separable shader stage (ARB_separate_shader_objects).
+     * Each stage is its own program object made with glCreateShaderProgramv, so one vertex
+     * stage can be shared by many fragment stages without relinking. Uniforms are written
+     * with glProgramUniform*, which doesn't need the program to be bound.
+     * Note: GLSL vertex stages should redeclare gl_PerVertex to be portable across drivers. */
+    class ShaderStage
+    {
+    private:
+        unsigned int m_Program = 0;
+        unsigned int m_Type = 0;// GL_VERTEX_SHADER or GL_FRAGMENT_SHADER
+        std::uint32_t m_Id = 0;
+        // Cache for uniform locations to improve performance
+        mutable std::unordered_map<std::string, int, StringHash, std::equal_to<>> m_UniformLocationCache;
+
+    public:
+        ShaderStage(unsigned int type, const char* path);
+
+        ShaderStage(const ShaderStage&) = delete;
+
+        ShaderStage& operator=(const ShaderStage&) = delete;
+
+        ~ShaderStage();
+
+        template <typename T>
+        void setUniform(const std::string_view name, const T& value) const
+        {
+            const int location = getUniformLocation(name);
+
+            // checks if the type is vector
+            if constexpr(is_vector_v<T>)
+            {
+                // V is the type inside the vector (e.g., float or glm::vec3)
+                using V = T::value_type;
+                const GLsizei count = static_cast<GLsizei>( value.size() );
+
+                if constexpr(std::is_same_v<V, float>)
+                    glProgramUniform1fv(m_Program, location, count, value.data());
+                else if constexpr(std::is_same_v<V, int>)
+                    glProgramUniform1iv(m_Program, location, count, value.data());
+                else if constexpr(std::is_same_v<V, unsigned int>)
+                    glProgramUniform1uiv(m_Program, location, count, value.data());
+                else if constexpr(std::is_same_v<V, glm::vec2>)
+                    glProgramUniform2fv(m_Program, location, count, glm::value_ptr(value[0]));
+                else if constexpr(std::is_same_v<V, glm::vec3>)
+                    glProgramUniform3fv(m_Program, location, count, glm::value_ptr(value[0]));
+                else if constexpr(std::is_same_v<V, glm::vec4>)
+                    glProgramUniform4fv(m_Program, location, count, glm::value_ptr(value[0]));
+                else if constexpr(std::is_same_v<V, glm::mat4>)
+                    glProgramUniformMatrix4fv(m_Program, location, count, GL_FALSE, glm::value_ptr(value[0]));
+            } else
+            {
+                if constexpr(std::is_same_v<T, bool> || std::is_same_v<T, int>)
+                {
+                    glProgramUniform1i(m_Program, location, static_cast<int>( value ));
+                } else if constexpr(std::is_same_v<T, unsigned int>)
+                {
+                    glProgramUniform1ui(m_Program, location, value);
+                } else if constexpr(std::is_same_v<T, float>)
+                {
+                    glProgramUniform1f(m_Program, location, value);
+                } else if constexpr(std::is_same_v<T, glm::vec2>)
+                {
+                    glProgramUniform2fv(m_Program, location, 1, glm::value_ptr(value));
+                } else if constexpr(std::is_same_v<T, glm::ivec2>)
+                {
+                    glProgramUniform2iv(m_Program, location, 1, glm::value_ptr(value));
+                } else if constexpr(std::is_same_v<T, glm::vec3>)
+                {
+                    glProgramUniform3fv(m_Program, location, 1, glm::value_ptr(value));
+                } else if constexpr(std::is_same_v<T, glm::vec4>)
+                {
+                    glProgramUniform4fv(m_Program, location, 1, glm::value_ptr(value));
+                } else if constexpr(std::is_same_v<T, glm::mat4>)
+                {
+                    glProgramUniformMatrix4fv(m_Program, location, 1, GL_FALSE, glm::value_ptr(value));
+                } else
+                {
+                    static_assert(sizeof(T) == 0, "Unsupported uniform type used in ShaderStage::setUniform");
+                }
+            }
+        }
+
+        // Caches uniform location to avoid getting it every frame, only the first lookup of a name allocates
+        int getUniformLocation(std::string_view name) const;
+
+        [[nodiscard]] unsigned int getProgramID() const;
+
+        [[nodiscard]] unsigned int getType() const;
+
+        // Unique for the process lifetime, unlike program names which GL reuses after deletion
+        [[nodiscard]] std::uint32_t getId() const;
+
+        // GL_VERTEX_SHADER_BIT / GL_FRAGMENT_SHADER_BIT used by glUseProgramStages
+        [[nodiscard]] unsigned int getStageBit() const;
+    };
+}
@@ -0,0 +1,162 @@
+#include <StreamBuffer.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+namespace core
+{
+    namespace
+    {
+        StreamBuffer* s_MainBuffer = nullptr;
+
+        constexpr std::size_t VertexAlignment = 16;
+        // Regions start on a boundary every usage accepts
+        constexpr std::size_t RegionAlignment = 256;
+        // Waits are sliced, so a lost context can't hang the frame in one call
+        constexpr GLuint64 WaitSliceNs = 1'000'000;
+
+        std::size_t alignUp(const std::size_t value, const std::size_t alignment)
+        {
+            return (value + alignment - 1) / alignment * alignment;
+        }
+
+        std::size_t queryAlignment(const GLenum name)
+        {
+            GLint alignment = 0;
+            glGetIntegerv(name, &alignment);
+            return std::max<std::size_t>(static_cast<std::size_t>( alignment ), 4);
+        }
+    }
+
+    StreamBuffer::StreamBuffer(const StreamBufferOptions& options)
+        : m_Options(options)
+    {
+        if(m_Options.framesInFlight == 0 || m_Options.bytesPerFrame == 0)
+            throw std::runtime_error("[StreamBuffer]: Needs at least one frame of at least one byte");
+
+        m_UniformAlignment = queryAlignment(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT);
+        m_StorageAlignment = queryAlignment(GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT);
+        m_RegionSize = alignUp(m_Options.bytesPerFrame, std::max({ RegionAlignment, m_UniformAlignment, m_StorageAlignment }));
+        m_Fences.assign(m_Options.framesInFlight, nullptr);
+
+        constexpr GLbitfield Flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        const std::size_t size = m_RegionSize * m_Options.framesInFlight;
+        glCreateBuffers(1, &m_Buffer);
+        glNamedBufferStorage(m_Buffer, static_cast<GLsizeiptr>( size ), nullptr, Flags);
+        m_Mapped = static_cast<std::byte *>( glMapNamedBufferRange(m_Buffer, 0, static_cast<GLsizeiptr>( size ), Flags) );
+        if(m_Mapped == nullptr)
+        {
+            glDeleteBuffers(1, &m_Buffer);
+            throw std::runtime_error("[StreamBuffer]: Could not map the buffer persistently");
+        }
+
+        m_Frame.capacityBytes = m_RegionSize;
+        m_Stats.capacityBytes = m_RegionSize;
+        // beginFrame() moves on first, so the first frame gets region 0
+        m_Region = m_Options.framesInFlight - 1;
+    }
+
+    StreamBuffer::~StreamBuffer()
+    {
+        if(s_MainBuffer == this) s_MainBuffer = nullptr;
+        for(const GLsync fence : m_Fences)
+            if(fence != nullptr) glDeleteSync(fence);
+        glUnmapNamedBuffer(m_Buffer);
+        glDeleteBuffers(1, &m_Buffer);
+    }
+
+    void StreamBuffer::beginFrame()
+    {
+        m_Stats = m_Frame;
+        m_Frame.usedBytes = 0;
+        m_Frame.failedAllocations = 0;
+        m_Frame.stallMs = 0.0;
+
+        m_Region = (m_Region + 1) % m_Fences.size();
+        m_Offset = 0;
+
+        GLsync& fence = m_Fences[m_Region];
+        if(fence == nullptr) return;
+
+        // The common case: the GPU finished this region long ago and nothing is timed
+        GLenum status = glClientWaitSync(fence, 0, 0);
+        if(status == GL_TIMEOUT_EXPIRED)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            do
+            {
+                status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, WaitSliceNs);
+            } while(status == GL_TIMEOUT_EXPIRED);
+            m_Frame.stallMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            m_Frame.stalledFrames++;
+        }
+        if(status == GL_WAIT_FAILED)
+            std::cerr << "[StreamBuffer] Warning: Waiting on region " << m_Region << " failed, its data may be overwritten in use" << '\n';
+
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    void StreamBuffer::endFrame()
+    {
+        GLsync& fence = m_Fences[m_Region];
+        if(fence != nullptr) glDeleteSync(fence);
+        fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    }
+
+    StreamAllocation StreamBuffer::allocate(const std::size_t size, const StreamUsage usage)
+    {
+        if(size == 0) return {};
+        const std::size_t offset = alignUp(m_Offset, alignmentFor(usage));
+        if(offset + size > m_RegionSize)
+        {
+            m_Frame.failedAllocations++;
+            if(!m_Warned)
+            {
+                std::cerr << "[StreamBuffer] Warning: " << size << " bytes don't fit the " << m_RegionSize
+                          << " byte frame region, raise StreamBufferOptions::bytesPerFrame" << '\n';
+                m_Warned = true;
+            }
+            return {};
+        }
+
+        m_Offset = offset + size;
+        m_Frame.usedBytes = m_Offset;
+        m_Frame.highWaterBytes = std::max(m_Frame.highWaterBytes, m_Offset);
+
+        const std::size_t bufferOffset = m_Region * m_RegionSize + offset;
+        return { m_Mapped + bufferOffset, m_Buffer, bufferOffset, size };
+    }
+
+    StreamAllocation StreamBuffer::upload(const void* data, const std::size_t size, const StreamUsage usage)
+    {
+        const StreamAllocation allocation = allocate(size, usage);
+        if(allocation.isValid()) std::memcpy(allocation.data, data, size);
+        return allocation;
+    }
+
+    void StreamBuffer::bind(const unsigned int target, const unsigned int index, const StreamAllocation& allocation)
+    {
+        glBindBufferRange(target, index, allocation.buffer, static_cast<GLintptr>( allocation.offset ), static_cast<GLsizeiptr>( allocation.size ));
+    }
+
+    std::size_t StreamBuffer::alignmentFor(const StreamUsage usage) const
+    {
+        switch(usage)
+        {
+            case StreamUsage::Uniform: return m_UniformAlignment;
+            case StreamUsage::Storage: return m_StorageAlignment;
+            case StreamUsage::Vertex: return VertexAlignment;
+        }
+        return RegionAlignment;
+    }
+
+    unsigned int StreamBuffer::getBuffer() const { return m_Buffer; }
+    const StreamBufferOptions& StreamBuffer::getOptions() const { return m_Options; }
+    const StreamBufferStats& StreamBuffer::getStats() const { return m_Stats; }
+
+    StreamBuffer* StreamBuffer::getMain() { return s_MainBuffer; }
+    void StreamBuffer::setMain(StreamBuffer* buffer) { s_MainBuffer = buffer; }
+}
@@ -0,0 +1,124 @@
+#pragma once
+#include <glad/gl.h>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace core
+{
+    struct StreamBufferOptions
+    {
+        // Room for one frame's dynamic data, allocations past it fail
+        std::size_t bytesPerFrame = 4 * 1024 * 1024;
+        // Regions the GPU may still be reading while the CPU writes the next one, 3 rarely stalls
+        unsigned int framesInFlight = 3;
+    };
+
+    // What the data is bound as, which decides the alignment
+    enum class StreamUsage
+    {
+        Uniform,// GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+        Storage,// GL_SHADER_STORAGE_BUFFER_OFFSET_ALIGNMENT
+        Vertex  // 16, enough for any attribute and for vec4 reads
+    };
+
+    // A piece of this frame's region. data stays writable until the region comes around again
+    struct StreamAllocation
+    {
+        void* data = nullptr;
+        unsigned int buffer = 0;
+        std::size_t offset = 0;// from the start of the buffer, what glBindBufferRange and vertex offsets take
+        std::size_t size = 0;
+
+        [[nodiscard]] bool isValid() const { return data != nullptr; }
+    };
+
+    struct StreamBufferStats
+    {
+        std::size_t usedBytes = 0;     // the last finished frame
+        std::size_t highWaterBytes = 0;// the most any frame has used so far
+        std::size_t capacityBytes = 0; // per frame
+        std::size_t failedAllocations = 0;
+        double stallMs = 0.0;          // waiting for the GPU to release the frame's region
+        std::size_t stalledFrames = 0; // since the buffer was created
+    };
+
+    /* Streams per-frame data (uniform blocks, instance matrices, debug lines) through one
+     * immutable buffer that stays mapped persistent and coherent, so writing is a memcpy and
+     * no driver call re-specifies or synchronises on the storage. The buffer is split into
+     * framesInFlight regions used round robin: endFrame() puts a fence after the frame's
+     * commands, and beginFrame() waits on the region's fence from framesInFlight frames ago
+     * before handing it out again. The wait only happens when the CPU is that far ahead of
+     * the GPU, getStats() reports how long it took.
+     * allocate() is for the GL thread, but the memory it returns can be filled by any thread
+     * as long as that is done before the commands reading it are issued. */
+    class StreamBuffer
+    {
+    private:
+        StreamBufferOptions m_Options;
+        unsigned int m_Buffer = 0;
+        std::byte* m_Mapped = nullptr;
+        std::size_t m_RegionSize = 0;
+        std::vector<GLsync> m_Fences;// one per region, nullptr once waited on
+        std::size_t m_Region = 0;
+        std::size_t m_Offset = 0;    // within the current region
+        std::size_t m_UniformAlignment = 256;
+        std::size_t m_StorageAlignment = 256;
+        bool m_Warned = false;
+        StreamBufferStats m_Frame;
+        StreamBufferStats m_Stats;
+
+        [[nodiscard]] std::size_t alignmentFor(StreamUsage usage) const;
+
+    public:
+        explicit StreamBuffer(const StreamBufferOptions& options = {});
+
+        StreamBuffer(const StreamBuffer&) = delete;
+
+        StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+        ~StreamBuffer();
+
+        // Moves to the next region, waiting for the GPU if it still reads it, and publishes the last frame's stats
+        void beginFrame();
+
+        // Fences the region, call once the frame's last command that reads from it is issued
+        void endFrame();
+
+        // Invalid when the region is full, the warning is printed once
+        StreamAllocation allocate(std::size_t size, StreamUsage usage);
+
+        // allocate and copy, for data that is already in memory
+        StreamAllocation upload(const void* data, std::size_t size, StreamUsage usage);
+
+        template <typename T>
+        std::span<T> allocateArray(std::size_t count, StreamUsage usage, StreamAllocation* allocation = nullptr);
+
+        // glBindBufferRange of an allocation, target GL_UNIFORM_BUFFER or GL_SHADER_STORAGE_BUFFER
+        static void bind(unsigned int target, unsigned int index, const StreamAllocation& allocation);
+
+        [[nodiscard]] unsigned int getBuffer() const;
+
+        [[nodiscard]] const StreamBufferOptions& getOptions() const;
+
+        // The last finished frame, from its beginFrame() wait to its last allocation
+        [[nodiscard]] const StreamBufferStats& getStats() const;
+
+        // The stream buffer the FPS overlay reports, nullptr if none. The buffer unregisters itself when destroyed
+        [[nodiscard]] static StreamBuffer* getMain();
+
+        static void setMain(StreamBuffer* buffer);
+    };
+
+    template <typename T>
+    std::span<T> StreamBuffer::allocateArray(const std::size_t count, const StreamUsage usage, StreamAllocation* allocation)
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Stream buffer data is copied to the GPU as bytes");
+        const StreamAllocation result = allocate(sizeof(T) * count, usage);
+        if(allocation != nullptr) *allocation = result;
+        if(!result.isValid()) return {};
+        return { static_cast<T *>( result.data ), count };
+    }
+}
@@ -1,4 +1,6 @@
 #include <Texture.h>
+#include <VirtualFileSystem.h>
+#include <algorithm>
 #include <iostream>
 
 
@@ -15,6 +17,14 @@ namespace core
           m_Width(0),
           m_Height(0)
     {
+        // Cooked textures are already decoded and flipped, with the whole mip chain baked
+        CookedTexture cooked;
+        if(vfs::get().readTexture(path, cooked))
+        {
+            uploadCooked(cooked, params);
+            return;
+        }
+
         const ImageLoader img(path);
         if(!img.imageLoaded())
         {
@@ -50,6 +60,40 @@ namespace core
         glBindTexture(GL_TEXTURE_2D, 0);
     }
 
+    void Texture::uploadCooked(const CookedTexture& cooked, const TextureParameters& params)
+    {
+        static constexpr unsigned int formats[] = { GL_RED, GL_RG, GL_RGB, GL_RGBA };
+        static constexpr unsigned int internalFormats[] = { GL_R8, GL_RG8, GL_RGB8, GL_RGBA8 };
+        if(cooked.channels < 1 || cooked.channels > 4)
+        {
+            std::cerr << "[Texture] Error: Unsupported image format: " << m_Filepath << std::endl;
+            return;
+        }
+        m_Width = cooked.width;
+        m_Height = cooked.height;
+
+        glGenTextures(1, & m_TextureID);
+        glBindTexture(GL_TEXTURE_2D, m_TextureID);
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, params.minFilter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, params.magFilter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, params.wrapS);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, params.wrapT);
+
+        // Levels are tightly packed, RGB rows aren't 4 byte aligned
+        const auto format = formats[cooked.channels - 1];
+        const auto levels = static_cast<int>( cooked.levels.size() );
+        glTexStorage2D(GL_TEXTURE_2D, levels, internalFormats[cooked.channels - 1], m_Width, m_Height);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        for(int level = 0; level < levels; level++)
+        {
+            glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, std::max(1, m_Width >> level), std::max(1, m_Height >> level),
+                            format, GL_UNSIGNED_BYTE, cooked.levels[static_cast<std::size_t>( level )].data());
+        }
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
     void Texture::bindTexture(const unsigned int slot) const
     {
         glActiveTexture(GL_TEXTURE0 + slot);
@@ -58,4 +102,5 @@ namespace core
 
     int Texture::getWidth() const { return m_Width; }
     int Texture::getHeight() const { return m_Height; }
+    unsigned int Texture::getID() const { return m_TextureID; }
 }
@@ -14,6 +14,8 @@ namespace core
         unsigned int magFilter = GL_LINEAR;
     };
 
+    struct CookedTexture;
+
     class Texture
     {
         std::string m_Filepath;
@@ -21,6 +23,8 @@ namespace core
         int m_Width;
         int m_Height;
 
+        void uploadCooked(const CookedTexture& cooked, const TextureParameters& params);
+
     public:
         // Deletes copy constructor (no texture object can delete same id)
         Texture& operator=(const Texture&) = delete;
@@ -36,5 +40,8 @@ namespace core
         int getWidth() const;
 
         int getHeight() const;
+
+        // The GL name, for code that binds textures itself (RenderQueue)
+        unsigned int getID() const;
     };
 }
@@ -0,0 +1,236 @@
+#include <TransformHierarchy.h>
+#include <MathSIMD.h>
+#include <algorithm>
+#include <atomic>
+#include <stdexcept>
+
+namespace core
+{
+    TransformHierarchy::Node TransformHierarchy::create(const Transform& local, const Node parent)
+    {
+        if(parent != NoNode && !isAlive(parent))
+            throw std::runtime_error("[TransformHierarchy]: Parent node doesn't exist");
+
+        Node node;
+        if(!m_FreeNodes.empty())
+        {
+            node = m_FreeNodes.back();
+            m_FreeNodes.pop_back();
+        }
+        else
+        {
+            node = static_cast<Node>( m_Parents.size() );
+            m_Parents.push_back(NoNode);
+            m_Positions.push_back(NoNode);
+            m_Depths.push_back(0);
+        }
+
+        // Appended out of order, the next update() sorts it into its level
+        m_Parents[node] = parent;
+        m_Positions[node] = static_cast<std::uint32_t>( m_Nodes.size() );
+        m_Depths[node] = parent == NoNode ? 0 : m_Depths[parent] + 1;
+        m_Locals.push_back(local);
+        m_Worlds.emplace_back(1.0f);
+        m_ParentPositions.push_back(NoNode);
+        m_Dirty.push_back(0);
+        m_Nodes.push_back(node);
+        m_OrderChanged = true;
+        markDirty(node);
+        return node;
+    }
+
+    void TransformHierarchy::destroy(const Node node)
+    {
+        if(!isAlive(node)) return;
+        if(m_OrderChanged) rebuildOrder();
+
+        // Breadth-first order puts every descendant after its parent, one pass finds them all
+        std::vector<std::uint8_t> dead(m_Nodes.size(), 0);
+        for(std::size_t position = m_Positions[node]; position < m_Nodes.size(); position++)
+        {
+            const std::uint32_t parent = m_ParentPositions[position];
+            if(position != m_Positions[node] && (parent == NoNode || !dead[parent])) continue;
+
+            dead[position] = 1;
+            const Node removed = m_Nodes[position];
+            m_Positions[removed] = NoNode;
+            m_Parents[removed] = NoNode;
+            m_FreeNodes.push_back(removed);
+        }
+        m_OrderChanged = true;
+    }
+
+    void TransformHierarchy::setParent(const Node node, const Node parent)
+    {
+        if(!isAlive(node) || (parent != NoNode && !isAlive(parent)))
+            throw std::runtime_error("[TransformHierarchy]: setParent on a node that doesn't exist");
+        for(Node ancestor = parent; ancestor != NoNode; ancestor = m_Parents[ancestor])
+        {
+            if(ancestor == node)
+                throw std::runtime_error("[TransformHierarchy]: setParent would make a node its own ancestor");
+        }
+
+        m_Parents[node] = parent;
+        m_OrderChanged = true;
+        markDirty(node);
+    }
+
+    void TransformHierarchy::setLocal(const Node node, const Transform& local)
+    {
+        m_Locals[m_Positions[node]] = local;
+        markDirty(node);
+    }
+
+    void TransformHierarchy::setPosition(const Node node, const glm::vec3& position)
+    {
+        m_Locals[m_Positions[node]].position = position;
+        markDirty(node);
+    }
+
+    void TransformHierarchy::setRotation(const Node node, const glm::quat& rotation)
+    {
+        m_Locals[m_Positions[node]].rotation = rotation;
+        markDirty(node);
+    }
+
+    void TransformHierarchy::setScale(const Node node, const glm::vec3& scale)
+    {
+        m_Locals[m_Positions[node]].scale = scale;
+        markDirty(node);
+    }
+
+    void TransformHierarchy::markDirty(const Node node)
+    {
+        m_Dirty[m_Positions[node]] = 1;
+        m_FirstDirtyDepth = std::min(m_FirstDirtyDepth, m_Depths[node]);
+    }
+
+    void TransformHierarchy::rebuildOrder()
+    {
+        // Depths can be stale after setParent(), recompute them walking up to the nearest known one
+        std::vector<std::uint8_t> known(m_Parents.size(), 0);
+        std::vector<Node> chain;
+        std::uint32_t maxDepth = 0;
+        for(std::size_t position = 0; position < m_Nodes.size(); position++)
+        {
+            const Node node = m_Nodes[position];
+            if(m_Positions[node] != position) continue;// destroyed, or the handle was reused since
+
+            chain.clear();
+            Node current = node;
+            while(current != NoNode && !known[current])
+            {
+                chain.push_back(current);
+                current = m_Parents[current];
+            }
+            std::uint32_t depth = current == NoNode ? 0 : m_Depths[current] + 1;
+            for(auto it = chain.rbegin(); it != chain.rend(); ++it)
+            {
+                m_Depths[*it] = depth++;
+                known[*it] = 1;
+            }
+            maxDepth = std::max(maxDepth, m_Depths[node]);
+        }
+
+        // Counting sort by depth, stable so nodes keep their neighbours from last time
+        std::vector<std::uint32_t> levels(static_cast<std::size_t>( maxDepth ) + 2, 0);
+        std::size_t liveCount = 0;
+        for(std::size_t position = 0; position < m_Nodes.size(); position++)
+        {
+            const Node node = m_Nodes[position];
+            if(m_Positions[node] != position) continue;
+            levels[m_Depths[node] + 1]++;
+            liveCount++;
+        }
+        if(liveCount == 0) levels.assign(1, 0);
+        for(std::size_t depth = 1; depth < levels.size(); depth++)
+            levels[depth] += levels[depth - 1];
+
+        std::vector<Transform> locals(liveCount);
+        std::vector<glm::mat4> worlds(liveCount);
+        std::vector<std::uint8_t> dirty(liveCount);
+        std::vector<Node> nodes(liveCount);
+        std::vector<std::uint32_t> next(levels.begin(), levels.end() - 1);
+        for(std::size_t position = 0; position < m_Nodes.size(); position++)
+        {
+            const Node node = m_Nodes[position];
+            if(m_Positions[node] != position) continue;
+            const std::uint32_t target = next[m_Depths[node]]++;
+            locals[target] = m_Locals[position];
+            worlds[target] = m_Worlds[position];
+            dirty[target] = m_Dirty[position];
+            nodes[target] = node;
+        }
+        for(std::uint32_t position = 0; position < liveCount; position++)
+            m_Positions[nodes[position]] = position;
+
+        m_ParentPositions.assign(liveCount, NoNode);
+        m_FirstDirtyDepth = NoNode;
+        for(std::uint32_t position = 0; position < liveCount; position++)
+        {
+            const Node parent = m_Parents[nodes[position]];
+            if(parent != NoNode) m_ParentPositions[position] = m_Positions[parent];
+            if(dirty[position]) m_FirstDirtyDepth = std::min(m_FirstDirtyDepth, m_Depths[nodes[position]]);
+        }
+
+        m_Locals = std::move(locals);
+        m_Worlds = std::move(worlds);
+        m_Dirty = std::move(dirty);
+        m_Nodes = std::move(nodes);
+        m_Levels = std::move(levels);
+        m_OrderChanged = false;
+    }
+
+    void TransformHierarchy::update(JobSystem* jobs)
+    {
+        m_UpdatedCount = 0;
+        if(m_OrderChanged) rebuildOrder();
+        if(m_FirstDirtyDepth == NoNode) return;
+
+        std::atomic<std::size_t> updated{ 0 };
+        auto updateRange = [this, &updated](const std::size_t begin, const std::size_t end)
+        {
+            std::size_t count = 0;
+            for(std::size_t position = begin; position < end; position++)
+            {
+                // The parent's level is already done, so its flag already includes its own ancestors
+                const std::uint32_t parent = m_ParentPositions[position];
+                if(parent != NoNode && m_Dirty[parent]) m_Dirty[position] = 1;
+                if(!m_Dirty[position]) continue;
+
+                const Transform& local = m_Locals[position];
+                const glm::mat4 matrix = simd::composeTRS(local.position, local.rotation, local.scale);
+                m_Worlds[position] = parent == NoNode ? matrix : simd::multiply(m_Worlds[parent], matrix);
+                count++;
+            }
+            updated.fetch_add(count, std::memory_order_relaxed);
+        };
+
+        for(std::size_t depth = m_FirstDirtyDepth; depth + 1 < m_Levels.size(); depth++)
+        {
+            const std::size_t begin = m_Levels[depth];
+            const std::size_t count = m_Levels[depth + 1] - begin;
+            if(jobs != nullptr && count >= m_ParallelThreshold)
+                jobs->parallelFor(count, 0, [&updateRange, begin](const std::size_t first, const std::size_t last)
+                {
+                    updateRange(begin + first, begin + last);
+                });
+            else
+                updateRange(begin, begin + count);
+        }
+
+        std::fill(m_Dirty.begin() + m_Levels[m_FirstDirtyDepth], m_Dirty.end(), 0);
+        m_FirstDirtyDepth = NoNode;
+        m_UpdatedCount = updated.load(std::memory_order_relaxed);
+    }
+
+    bool TransformHierarchy::isAlive(const Node node) const
+    {
+        return node < m_Positions.size() && m_Positions[node] != NoNode;
+    }
+
+    TransformHierarchy::Node TransformHierarchy::getParent(const Node node) const { return m_Parents[node]; }
+    const Transform& TransformHierarchy::getLocal(const Node node) const { return m_Locals[m_Positions[node]]; }
+    const glm::mat4& TransformHierarchy::getWorld(const Node node) const { return m_Worlds[m_Positions[node]]; }
+    std::span<const glm::mat4> TransformHierarchy::getWorldMatrices() const { return m_Worlds; }
+}
@@ -0,0 +1,99 @@
+#pragma once
+#include <Components.h>
+#include <JobSystem.h>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace core
+{
+    /* Parent-child transforms with world matrices cached between frames. Nodes are kept in
+     * breadth-first order (all roots, then every depth-1 node, ...), so by the time a level is
+     * processed its parents' world matrices are final and the level can be split across threads.
+     * Changing a node's local transform marks it dirty, update() pushes that flag down to its
+     * children and only recomputes what is dirty. With nothing changed update() returns at once.
+     * Not thread safe, call everything from one thread; update() fans out internally. */
+    class TransformHierarchy
+    {
+    public:
+        using Node = std::uint32_t;
+
+        static constexpr Node NoNode = 0xFFFFFFFF;
+
+    private:
+        // Per handle, stable while the node lives
+        std::vector<Node> m_Parents;
+        std::vector<std::uint32_t> m_Positions;// into the arrays below
+        std::vector<std::uint32_t> m_Depths;
+        std::vector<Node> m_FreeNodes;
+
+        // Per position, in breadth-first order once the order is rebuilt
+        std::vector<Transform> m_Locals;
+        std::vector<glm::mat4> m_Worlds;
+        std::vector<std::uint32_t> m_ParentPositions;
+        std::vector<std::uint8_t> m_Dirty;
+        std::vector<Node> m_Nodes;
+        std::vector<std::uint32_t> m_Levels;// first position of each depth, plus the end
+
+        bool m_OrderChanged = false;
+        std::uint32_t m_FirstDirtyDepth = NoNode;
+        std::size_t m_UpdatedCount = 0;
+        std::size_t m_ParallelThreshold = 4096;
+
+        // Sorts the live nodes by depth, keeping their previous order within a level
+        void rebuildOrder();
+
+        void markDirty(Node node);
+
+    public:
+        TransformHierarchy() = default;
+
+        TransformHierarchy(const TransformHierarchy&) = delete;
+
+        TransformHierarchy& operator=(const TransformHierarchy&) = delete;
+
+        Node create(const Transform& local = {}, Node parent = NoNode);
+
+        // Destroys the node and everything below it
+        void destroy(Node node);
+
+        // NoNode makes it a root, throws if parent is the node itself or one of its descendants
+        void setParent(Node node, Node parent);
+
+        void setLocal(Node node, const Transform& local);
+
+        void setPosition(Node node, const glm::vec3& position);
+
+        void setRotation(Node node, const glm::quat& rotation);
+
+        void setScale(Node node, const glm::vec3& scale);
+
+        /* Recomputes the world matrix of every dirty node and of everything below one. Levels
+         * with at least getParallelThreshold() nodes are split over jobs when given. */
+        void update(JobSystem* jobs = nullptr);
+
+        [[nodiscard]] bool isAlive(Node node) const;
+
+        [[nodiscard]] Node getParent(Node node) const;
+
+        [[nodiscard]] const Transform& getLocal(Node node) const;
+
+        // As of the last update()
+        [[nodiscard]] const glm::mat4& getWorld(Node node) const;
+
+        // Every world matrix in breadth-first order, valid until the next structural change
+        [[nodiscard]] std::span<const glm::mat4> getWorldMatrices() const;
+
+        [[nodiscard]] std::size_t getNodeCount() const { return m_Nodes.size(); }
+
+        [[nodiscard]] std::size_t getDepthCount() const { return m_Levels.empty() ? 0 : m_Levels.size() - 1; }
+
+        // World matrices the last update() recomputed
+        [[nodiscard]] std::size_t getUpdatedCount() const { return m_UpdatedCount; }
+
+        [[nodiscard]] std::size_t getParallelThreshold() const { return m_ParallelThreshold; }
+
+        void setParallelThreshold(std::size_t threshold) { m_ParallelThreshold = threshold; }
+    };
+}
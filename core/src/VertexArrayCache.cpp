@@ -0,0 +1,49 @@
+#include <VertexArrayCache.h>
+
+namespace core
+{
+    VertexArrayCache::~VertexArrayCache()
+    {
+        for(const auto& [layout, vertexArray] : m_VertexArrays)
+        {
+            glDeleteVertexArrays(1, &vertexArray);
+        }
+    }
+
+    unsigned int VertexArrayCache::get(const VertexLayoutDesc& layout)
+    {
+        if(const auto it = m_VertexArrays.find(layout); it != m_VertexArrays.end())
+        {
+            return it->second;
+        }
+
+        unsigned int vertexArray;
+        glCreateVertexArrays(1, &vertexArray);
+
+        for(const auto& attr : layout.attributes)
+        {
+            glEnableVertexArrayAttrib(vertexArray, attr.location);
+            if(attr.integer)
+                glVertexArrayAttribIFormat(vertexArray, attr.location, attr.components, attr.type, attr.offset);
+            else
+                glVertexArrayAttribFormat(vertexArray, attr.location, attr.components, attr.type,
+                                          attr.normalized ? GL_TRUE : GL_FALSE, attr.offset);
+            glVertexArrayAttribBinding(vertexArray, attr.location, 0);
+        }
+
+        m_VertexArrays.emplace(layout, vertexArray);
+        return vertexArray;
+    }
+
+    void VertexArrayCache::bind(const unsigned int vertexArray, const unsigned int vertexBuffer, const unsigned int stride,
+                                const unsigned int elementBuffer, const GLintptr offset)
+    {
+        glVertexArrayVertexBuffer(vertexArray, 0, vertexBuffer, offset,
+                                  static_cast<GLsizei>( stride ));
+        if(elementBuffer != 0)
+            glVertexArrayElementBuffer(vertexArray, elementBuffer);
+        glBindVertexArray(vertexArray);
+    }
+
+    std::size_t VertexArrayCache::size() const { return m_VertexArrays.size(); }
+}
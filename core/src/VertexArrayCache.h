@@ -0,0 +1,39 @@
+#pragma once
+#include <VertexLayout.h>
+#include <unordered_map>
+
+namespace core
+{
+    /* Hands out one vertex array object per distinct layout.
+     * The attribute formats are set once with the DSA calls and every attribute reads from
+     * binding 0, so drawing a different buffer only swaps the binding, never the layout. */
+    class VertexArrayCache
+    {
+    private:
+        std::unordered_map<VertexLayoutDesc, unsigned int, VertexLayoutDescHash> m_VertexArrays;
+
+    public:
+        VertexArrayCache() = default;
+
+        VertexArrayCache(const VertexArrayCache&) = delete;
+
+        VertexArrayCache& operator=(const VertexArrayCache&) = delete;
+
+        ~VertexArrayCache();
+
+        // Returns the shared VAO for this layout, creating it on first use
+        unsigned int get(const VertexLayoutDesc& layout);
+
+        template <typename Layout>
+        unsigned int get()
+        {
+            return get(Layout::desc());
+        }
+
+        // Points binding 0 of the VAO at the buffers and binds it for drawing
+        static void bind(unsigned int vertexArray, unsigned int vertexBuffer, unsigned int stride,
+                         unsigned int elementBuffer = 0, GLintptr offset = 0);
+
+        [[nodiscard]] std::size_t size() const;
+    };
+}
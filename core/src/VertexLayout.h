@@ -0,0 +1,238 @@
+#pragma once
+#include <glad/gl.h>
+#include <glm/glm.hpp>
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <vector>
+
+namespace core
+{
+    // Describes how one C++ attribute type is read by the vertex fetcher
+    template <typename T>
+    struct VertexAttribTraits
+    {
+        static_assert(sizeof(T) == 0, "Unsupported vertex attribute type used in VertexLayout");
+    };
+
+    template <>
+    struct VertexAttribTraits<float>
+    {
+        static constexpr int components = 1;
+        static constexpr unsigned int glType = GL_FLOAT;
+        static constexpr bool normalized = false;
+        static constexpr bool integer = false;
+    };
+
+    template <>
+    struct VertexAttribTraits<glm::vec2>
+    {
+        static constexpr int components = 2;
+        static constexpr unsigned int glType = GL_FLOAT;
+        static constexpr bool normalized = false;
+        static constexpr bool integer = false;
+    };
+
+    template <>
+    struct VertexAttribTraits<glm::vec3>
+    {
+        static constexpr int components = 3;
+        static constexpr unsigned int glType = GL_FLOAT;
+        static constexpr bool normalized = false;
+        static constexpr bool integer = false;
+    };
+
+    template <>
+    struct VertexAttribTraits<glm::vec4>
+    {
+        static constexpr int components = 4;
+        static constexpr unsigned int glType = GL_FLOAT;
+        static constexpr bool normalized = false;
+        static constexpr bool integer = false;
+    };
+
+    template <>
+    struct VertexAttribTraits<int>
+    {
+        static constexpr int components = 1;
+        static constexpr unsigned int glType = GL_INT;
+        static constexpr bool normalized = false;
+        static constexpr bool integer = true;
+    };
+
+    template <>
+    struct VertexAttribTraits<unsigned int>
+    {
+        static constexpr int components = 1;
+        static constexpr unsigned int glType = GL_UNSIGNED_INT;
+        static constexpr bool normalized = false;
+        static constexpr bool integer = true;
+    };
+
+    struct VertexAttribute
+    {
+        unsigned int location = 0;
+        int components = 0;
+        unsigned int type = GL_FLOAT;
+        bool normalized = false;
+        bool integer = false;// integer attributes use glVertexArrayAttribIFormat
+        unsigned int offset = 0;
+
+        bool operator==(const VertexAttribute&) const = default;
+    };
+
+    // Runtime form of a layout, used as the key when sharing vertex array objects
+    struct VertexLayoutDesc
+    {
+        std::vector<VertexAttribute> attributes;
+        unsigned int stride = 0;
+
+        bool operator==(const VertexLayoutDesc&) const = default;
+    };
+
+    struct VertexLayoutDescHash
+    {
+        std::size_t operator()(const VertexLayoutDesc& desc) const noexcept
+        {
+            std::size_t seed = std::hash<unsigned int>{}(desc.stride);
+            auto combine = [&seed](const std::size_t value)
+            {
+                seed ^= value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2);
+            };
+            for(const auto& attr : desc.attributes)
+            {
+                combine(attr.location);
+                combine(static_cast<std::size_t>( attr.components ));
+                combine(attr.type);
+                combine(attr.offset);
+                combine(static_cast<std::size_t>( attr.normalized ) << 1 | static_cast<std::size_t>( attr.integer ));
+            }
+            return seed;
+        }
+    };
+
+    /* Compile-time vertex layout from a list of attribute types, packed in order with
+     * locations 0, 1, 2... Only the types are known, so describes() can't tell two members
+     * of the same size apart: prefer VertexLayoutOf for vertex structs, this form is for
+     * formats without one (e.g. PackedVertexLayout). */
+    template <typename... Attrs>
+    struct VertexLayout
+    {
+        static constexpr std::size_t Count = sizeof...(Attrs);
+        static constexpr unsigned int Stride = (0u + ... + static_cast<unsigned int>( sizeof(Attrs) ));
+
+        static constexpr std::array<unsigned int, Count> Offsets = []
+        {
+            std::array<unsigned int, Count> offsets{};
+            unsigned int offset = 0;
+            std::size_t i = 0;
+            ((offsets[i++] = offset, offset += static_cast<unsigned int>( sizeof(Attrs) )), ...);
+            return offsets;
+        }();
+
+        static constexpr std::array<VertexAttribute, Count> Attributes = []
+        {
+            std::array<VertexAttribute, Count> attributes{};
+            std::size_t i = 0;
+            ((attributes[i] = VertexAttribute{
+                static_cast<unsigned int>( i ),
+                VertexAttribTraits<Attrs>::components,
+                VertexAttribTraits<Attrs>::glType,
+                VertexAttribTraits<Attrs>::normalized,
+                VertexAttribTraits<Attrs>::integer,
+                Offsets[i]
+            }, i++), ...);
+            return attributes;
+        }();
+
+        // True when Vertex has no padding the layout doesn't know about
+        template <typename Vertex>
+        static constexpr bool describes()
+        {
+            return std::is_standard_layout_v<Vertex> && sizeof(Vertex) == Stride;
+        }
+
+        static VertexLayoutDesc desc()
+        {
+            return { std::vector<VertexAttribute>(Attributes.begin(), Attributes.end()), Stride };
+        }
+    };
+
+    template <typename M>
+    struct MemberPointerTraits;
+
+    template <typename C, typename T>
+    struct MemberPointerTraits<T C::*>
+    {
+        using Class = C;
+        using Type = T;
+    };
+
+    template <auto Member>
+    using MemberType = typename MemberPointerTraits<decltype(Member)>::Type;
+
+    /* Vertex layout read off the vertex struct's members, listed in location order:
+     *   struct Vertex { glm::vec3 position; glm::vec3 normal; };
+     *   using Layout = core::VertexLayoutOf<&Vertex::position, &Vertex::normal>;
+     * Types and offsets come from the members, so the layout follows the struct whatever
+     * its member order. It doesn't compile unless every member is listed exactly once and
+     * the struct has no padding. */
+    template <auto First, auto... Rest>
+    struct VertexLayoutOf
+    {
+        using Vertex = typename MemberPointerTraits<decltype(First)>::Class;
+
+        static_assert((std::is_same_v<typename MemberPointerTraits<decltype(Rest)>::Class, Vertex> && ...),
+                      "Every attribute must be a member of the same vertex struct");
+        static_assert(std::is_standard_layout_v<Vertex>, "Vertex structs need a standard layout");
+
+        static constexpr std::size_t Count = 1 + sizeof...(Rest);
+        static constexpr unsigned int Stride = sizeof(Vertex);
+
+    private:
+        template <auto A, auto B>
+        static constexpr bool same()
+        {
+            if constexpr(std::is_same_v<decltype(A), decltype(B)>) return A == B;
+            else return false;
+        }
+
+        template <auto Member, auto... Others>
+        static constexpr bool distinct()
+        {
+            if constexpr(sizeof...(Others) == 0) return true;
+            else return (!same<Member, Others>() && ...) && distinct<Others...>();
+        }
+
+        template <auto Member>
+        static VertexAttribute attribute(const unsigned int location, const Vertex& sample)
+        {
+            using T = MemberType<Member>;
+            const auto offset = reinterpret_cast<const std::byte *>( &(sample.*Member) ) - reinterpret_cast<const std::byte *>( &sample );
+            return { location, VertexAttribTraits<T>::components, VertexAttribTraits<T>::glType, VertexAttribTraits<T>::normalized,
+                     VertexAttribTraits<T>::integer, static_cast<unsigned int>( offset ) };
+        }
+
+    public:
+        static_assert(distinct<First, Rest...>(), "A vertex member is listed twice");
+        static_assert((sizeof(MemberType<First>) + ... + sizeof(MemberType<Rest>)) == sizeof(Vertex),
+                      "Every vertex member needs an attribute and the struct can't have padding");
+
+        template <typename V>
+        static constexpr bool describes()
+        {
+            return std::is_same_v<V, Vertex>;
+        }
+
+        static VertexLayoutDesc desc()
+        {
+            static const Vertex sample{};
+            VertexLayoutDesc layout{ {}, Stride };
+            unsigned int location = 0;
+            layout.attributes.push_back(attribute<First>(location++, sample));
+            (layout.attributes.push_back(attribute<Rest>(location++, sample)), ...);
+            return layout;
+        }
+    };
+}
@@ -0,0 +1,412 @@
+#include <VertexPacking.h>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// MSVC has no __F16C__ macro, but every AVX2 target it builds for has F16C
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+#define CORE_HAS_F16C 1
+#endif
+
+namespace core
+{
+    namespace
+    {
+        // Role of a source attribute when packing, decided by its location
+        enum class AttributeRole { Position, Normal, TexCoord, Other };
+
+        AttributeRole roleOf(const VertexAttribute& attr)
+        {
+            if(attr.type != GL_FLOAT || attr.integer) return AttributeRole::Other;
+            if(attr.location == 0 && attr.components >= 3) return AttributeRole::Position;
+            if(attr.location == 1 && attr.components >= 3) return AttributeRole::Normal;
+            if(attr.location == 2 && attr.components >= 2) return AttributeRole::TexCoord;
+            return AttributeRole::Other;
+        }
+
+        unsigned int glTypeSize(const unsigned int type)
+        {
+            switch(type)
+            {
+                case GL_BYTE :
+                case GL_UNSIGNED_BYTE :
+                    return 1;
+                case GL_SHORT :
+                case GL_UNSIGNED_SHORT :
+                case GL_HALF_FLOAT :
+                    return 2;
+                default :
+                    return 4;
+            }
+        }
+
+        unsigned int attributeSize(const VertexAttribute& attr)
+        {
+            if(attr.type == GL_INT_2_10_10_10_REV || attr.type == GL_UNSIGNED_INT_2_10_10_10_REV) return 4;
+            return static_cast<unsigned int>( attr.components ) * glTypeSize(attr.type);
+        }
+
+        template <typename Packed>
+        VertexAttribute packedAttribute(const unsigned int location)
+        {
+            return { location, VertexAttribTraits<Packed>::components, VertexAttribTraits<Packed>::glType,
+                     VertexAttribTraits<Packed>::normalized, VertexAttribTraits<Packed>::integer, 0 };
+        }
+
+        // Copies `components` floats of one attribute out of the interleaved vertices
+        std::vector<float> deinterleave(const MeshData& mesh, const VertexAttribute& attr, const int components)
+        {
+            const std::size_t count = mesh.vertexCount();
+            std::vector<float> stream(count * static_cast<std::size_t>( components ));
+            for(std::size_t v = 0; v < count; v++)
+            {
+                std::memcpy(stream.data() + v * static_cast<std::size_t>( components ),
+                            mesh.vertices.data() + v * mesh.layout.stride + attr.offset,
+                            sizeof(float) * static_cast<std::size_t>( components ));
+            }
+            return stream;
+        }
+
+        // nearbyint rounds half to even, the same as the SIMD conversions
+        std::int16_t toSnorm16(const float value)
+        {
+            return static_cast<std::int16_t>( std::nearbyint(std::clamp(value, -1.0f, 1.0f) * 32767.0f) );
+        }
+
+        // Scaled value that is already in [-32767, 32767] to a short
+        std::int16_t scaledToSnorm16(const float value)
+        {
+            return static_cast<std::int16_t>( std::nearbyint(std::clamp(value, -32767.0f, 32767.0f)) );
+        }
+    }
+
+    namespace packing
+    {
+        std::uint16_t floatToHalf(const float value)
+        {
+            std::uint32_t bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+
+            const auto sign = static_cast<std::uint16_t>( (bits >> 16) & 0x8000u );
+            const std::uint32_t rawExponent = (bits >> 23) & 0xFFu;
+            std::uint32_t mantissa = bits & 0x7FFFFFu;
+
+            // Inf and NaN keep their class
+            if(rawExponent == 0xFFu)
+                return static_cast<std::uint16_t>( sign | 0x7C00u | (mantissa != 0 ? 0x200u : 0u) );
+
+            const int exponent = static_cast<int>( rawExponent ) - 127 + 15;
+            if(exponent >= 31) return static_cast<std::uint16_t>( sign | 0x7C00u );
+
+            // Too small for a normal half: shift into a subnormal, or flush to zero
+            if(exponent <= 0)
+            {
+                if(exponent < -10) return sign;
+                mantissa |= 0x800000u;
+                const auto shift = static_cast<std::uint32_t>( 14 - exponent );
+                std::uint32_t half = mantissa >> shift;
+                const std::uint32_t remainder = mantissa & ((1u << shift) - 1u);
+                const std::uint32_t halfway = 1u << (shift - 1);
+                if(remainder > halfway || (remainder == halfway && (half & 1u))) half++;
+                return static_cast<std::uint16_t>( sign | half );
+            }
+
+            std::uint32_t half = static_cast<std::uint32_t>( exponent ) << 10 | mantissa >> 13;
+            // Round half to even, a carry into the exponent still gives the right result
+            const std::uint32_t remainder = mantissa & 0x1FFFu;
+            if(remainder > 0x1000u || (remainder == 0x1000u && (half & 1u))) half++;
+            return static_cast<std::uint16_t>( sign | half );
+        }
+
+        void packPositionsSnorm16(const float* xyz, const std::size_t count, const glm::vec3& offset,
+                                  const float invScale, PackedPosition* out)
+        {
+            std::size_t i = 0;
+#if defined(__AVX2__)
+            // 8 vertices per iteration: gather x/y/z lanes, quantise, then re-interleave as x y z w shorts
+            const __m256i gatherIndex = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+            const __m256 scale = _mm256_set1_ps(invScale * 32767.0f);
+            const __m256 limit = _mm256_set1_ps(32767.0f);
+            const __m256 negLimit = _mm256_set1_ps(-32767.0f);
+            const __m256 ox = _mm256_set1_ps(offset.x);
+            const __m256 oy = _mm256_set1_ps(offset.y);
+            const __m256 oz = _mm256_set1_ps(offset.z);
+            const __m256i lowMask = _mm256_set1_epi32(0xFFFF);
+            const __m256i wOne = _mm256_set1_epi32(32767 << 16);
+
+            for(; i + 8 <= count; i += 8)
+            {
+                const float* base = xyz + i * 3;
+                __m256 x = _mm256_mul_ps(_mm256_sub_ps(_mm256_i32gather_ps(base, gatherIndex, 4), ox), scale);
+                __m256 y = _mm256_mul_ps(_mm256_sub_ps(_mm256_i32gather_ps(base + 1, gatherIndex, 4), oy), scale);
+                __m256 z = _mm256_mul_ps(_mm256_sub_ps(_mm256_i32gather_ps(base + 2, gatherIndex, 4), oz), scale);
+                x = _mm256_min_ps(_mm256_max_ps(x, negLimit), limit);
+                y = _mm256_min_ps(_mm256_max_ps(y, negLimit), limit);
+                z = _mm256_min_ps(_mm256_max_ps(z, negLimit), limit);
+
+                const __m256i xy = _mm256_or_si256(_mm256_and_si256(_mm256_cvtps_epi32(x), lowMask),
+                                                   _mm256_slli_epi32(_mm256_cvtps_epi32(y), 16));
+                const __m256i zw = _mm256_or_si256(_mm256_and_si256(_mm256_cvtps_epi32(z), lowMask), wOne);
+
+                // unpack works per 128-bit lane: lo = v0 v1 | v4 v5, hi = v2 v3 | v6 v7
+                const __m256i lo = _mm256_unpacklo_epi32(xy, zw);
+                const __m256i hi = _mm256_unpackhi_epi32(xy, zw);
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>( out + i ), _mm256_permute2x128_si256(lo, hi, 0x20));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>( out + i + 4 ), _mm256_permute2x128_si256(lo, hi, 0x31));
+            }
+#endif
+            const float snormScale = invScale * 32767.0f;
+            for(; i < count; i++)
+            {
+                const float* p = xyz + i * 3;
+                out[i] = { scaledToSnorm16((p[0] - offset.x) * snormScale), scaledToSnorm16((p[1] - offset.y) * snormScale),
+                           scaledToSnorm16((p[2] - offset.z) * snormScale), 32767 };
+            }
+        }
+
+        void packPositionsHalf(const float* xyz, const std::size_t count, const glm::vec3& offset,
+                               const float invScale, HalfPosition* out)
+        {
+            std::size_t i = 0;
+#if defined(__AVX2__) && defined(CORE_HAS_F16C)
+            const __m256i gatherIndex = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+            const __m256 scale = _mm256_set1_ps(invScale);
+            const __m256 ox = _mm256_set1_ps(offset.x);
+            const __m256 oy = _mm256_set1_ps(offset.y);
+            const __m256 oz = _mm256_set1_ps(offset.z);
+            const __m128i wOne = _mm_set1_epi16(0x3C00);// 1.0 as a half
+
+            for(; i + 8 <= count; i += 8)
+            {
+                const float* base = xyz + i * 3;
+                const __m256 x = _mm256_mul_ps(_mm256_sub_ps(_mm256_i32gather_ps(base, gatherIndex, 4), ox), scale);
+                const __m256 y = _mm256_mul_ps(_mm256_sub_ps(_mm256_i32gather_ps(base + 1, gatherIndex, 4), oy), scale);
+                const __m256 z = _mm256_mul_ps(_mm256_sub_ps(_mm256_i32gather_ps(base + 2, gatherIndex, 4), oz), scale);
+
+                const __m128i hx = _mm256_cvtps_ph(x, _MM_FROUND_TO_NEAREST_INT);
+                const __m128i hy = _mm256_cvtps_ph(y, _MM_FROUND_TO_NEAREST_INT);
+                const __m128i hz = _mm256_cvtps_ph(z, _MM_FROUND_TO_NEAREST_INT);
+
+                const __m128i xyLo = _mm_unpacklo_epi16(hx, hy);
+                const __m128i xyHi = _mm_unpackhi_epi16(hx, hy);
+                const __m128i zwLo = _mm_unpacklo_epi16(hz, wOne);
+                const __m128i zwHi = _mm_unpackhi_epi16(hz, wOne);
+
+                auto* dst = reinterpret_cast<__m128i *>( out + i );
+                _mm_storeu_si128(dst + 0, _mm_unpacklo_epi32(xyLo, zwLo));
+                _mm_storeu_si128(dst + 1, _mm_unpackhi_epi32(xyLo, zwLo));
+                _mm_storeu_si128(dst + 2, _mm_unpacklo_epi32(xyHi, zwHi));
+                _mm_storeu_si128(dst + 3, _mm_unpackhi_epi32(xyHi, zwHi));
+            }
+#endif
+            for(; i < count; i++)
+            {
+                const float* p = xyz + i * 3;
+                out[i] = { floatToHalf((p[0] - offset.x) * invScale), floatToHalf((p[1] - offset.y) * invScale),
+                           floatToHalf((p[2] - offset.z) * invScale), 0x3C00 };
+            }
+        }
+
+        void packNormalsInt2101010(const float* xyz, const std::size_t count, PackedNormal* out)
+        {
+            std::size_t i = 0;
+#if defined(__AVX2__)
+            const __m256i gatherIndex = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+            const __m256 scale = _mm256_set1_ps(511.0f);
+            const __m256 one = _mm256_set1_ps(1.0f);
+            const __m256 negOne = _mm256_set1_ps(-1.0f);
+            const __m256i tenBits = _mm256_set1_epi32(0x3FF);
+
+            auto quantise = [&](const __m256 v)
+            {
+                const __m256 clamped = _mm256_min_ps(_mm256_max_ps(v, negOne), one);
+                return _mm256_and_si256(_mm256_cvtps_epi32(_mm256_mul_ps(clamped, scale)), tenBits);
+            };
+
+            for(; i + 8 <= count; i += 8)
+            {
+                const float* base = xyz + i * 3;
+                const __m256i x = quantise(_mm256_i32gather_ps(base, gatherIndex, 4));
+                const __m256i y = quantise(_mm256_i32gather_ps(base + 1, gatherIndex, 4));
+                const __m256i z = quantise(_mm256_i32gather_ps(base + 2, gatherIndex, 4));
+                const __m256i bits = _mm256_or_si256(x, _mm256_or_si256(_mm256_slli_epi32(y, 10), _mm256_slli_epi32(z, 20)));
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>( out + i ), bits);
+            }
+#endif
+            for(; i < count; i++)
+            {
+                const float* n = xyz + i * 3;
+                auto component = [](const float value)
+                {
+                    return static_cast<std::uint32_t>( static_cast<std::int32_t>( std::nearbyint(std::clamp(value, -1.0f, 1.0f) * 511.0f) ) ) & 0x3FFu;
+                };
+                out[i] = { component(n[0]) | component(n[1]) << 10 | component(n[2]) << 20 };
+            }
+        }
+
+        void packNormalsOctahedral(const float* xyz, const std::size_t count, OctNormal* out)
+        {
+            for(std::size_t i = 0; i < count; i++)
+            {
+                const float* n = xyz + i * 3;
+                const float l1 = std::abs(n[0]) + std::abs(n[1]) + std::abs(n[2]);
+                const float inverse = l1 > 0.0f ? 1.0f / l1 : 0.0f;
+                float u = n[0] * inverse;
+                float v = n[1] * inverse;
+
+                // The lower hemisphere is folded over the diagonals
+                if(n[2] < 0.0f)
+                {
+                    const float foldedU = (1.0f - std::abs(v)) * (u >= 0.0f ? 1.0f : -1.0f);
+                    const float foldedV = (1.0f - std::abs(u)) * (v >= 0.0f ? 1.0f : -1.0f);
+                    u = foldedU;
+                    v = foldedV;
+                }
+                out[i] = { toSnorm16(u), toSnorm16(v) };
+            }
+        }
+
+        void packTexCoordsUnorm16(const float* uv, const std::size_t count, PackedTexCoord* out)
+        {
+            const std::size_t floats = count * 2;
+            std::size_t i = 0;
+#if defined(__AVX2__)
+            const __m256 scale = _mm256_set1_ps(65535.0f);
+            const __m256 zero = _mm256_setzero_ps();
+            const __m256 one = _mm256_set1_ps(1.0f);
+
+            // The uv stream is contiguous, so 16 floats become 16 shorts (8 texcoords) per iteration
+            for(; i + 16 <= floats; i += 16)
+            {
+                const __m256 a = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(uv + i), zero), one);
+                const __m256 b = _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(uv + i + 8), zero), one);
+                const __m256i packed = _mm256_packus_epi32(_mm256_cvtps_epi32(_mm256_mul_ps(a, scale)),
+                                                           _mm256_cvtps_epi32(_mm256_mul_ps(b, scale)));
+                // packus interleaves the 128-bit lanes, this puts them back in order
+                _mm256_storeu_si256(reinterpret_cast<__m256i *>( out + i / 2 ),
+                                    _mm256_permute4x64_epi64(packed, _MM_SHUFFLE(3, 1, 2, 0)));
+            }
+#endif
+            for(; i < floats; i += 2)
+            {
+                out[i / 2] = { static_cast<std::uint16_t>( std::nearbyint(std::clamp(uv[i], 0.0f, 1.0f) * 65535.0f) ),
+                               static_cast<std::uint16_t>( std::nearbyint(std::clamp(uv[i + 1], 0.0f, 1.0f) * 65535.0f) ) };
+            }
+        }
+    }
+
+    MeshData packVertices(const MeshData& mesh, const VertexPackingOptions& options)
+    {
+        const std::size_t count = mesh.vertexCount();
+        MeshData packed{};
+        packed.indices = mesh.indices;
+        // Levels are index ranges, packing only rewrites the vertices so the chain carries over as is
+        packed.lods = mesh.lods;
+        packed.positionOffset = mesh.positionOffset;
+        packed.positionScale = mesh.positionScale;
+
+        // Works out the new layout and the bytes of every attribute, one stream per attribute
+        std::vector<std::vector<std::byte>> streams;
+        std::vector<unsigned int> sizes;
+        unsigned int stride = 0;
+
+        for(const auto& attr : mesh.layout.attributes)
+        {
+            VertexAttribute out = attr;
+            std::vector<std::byte> stream;
+            const AttributeRole role = roleOf(attr);
+
+            if(role == AttributeRole::Position && options.position != PositionFormat::Float)
+            {
+                const std::vector<float> positions = deinterleave(mesh, attr, 3);
+                glm::vec3 minimum(std::numeric_limits<float>::max());
+                glm::vec3 maximum(std::numeric_limits<float>::lowest());
+                for(std::size_t v = 0; v < count; v++)
+                {
+                    const glm::vec3 p(positions[v * 3], positions[v * 3 + 1], positions[v * 3 + 2]);
+                    minimum = glm::min(minimum, p);
+                    maximum = glm::max(maximum, p);
+                }
+
+                // One uniform scale keeps the model's normal matrix valid after dequantisation
+                const glm::vec3 halfExtent = count > 0 ? (maximum - minimum) * 0.5f : glm::vec3(0.0f);
+                const float scale = std::max({ halfExtent.x, halfExtent.y, halfExtent.z, 1e-6f });
+                packed.positionOffset = count > 0 ? (minimum + maximum) * 0.5f : glm::vec3(0.0f);
+                packed.positionScale = scale;
+
+                if(options.position == PositionFormat::Snorm16)
+                {
+                    out = packedAttribute<PackedPosition>(attr.location);
+                    stream.resize(count * sizeof(PackedPosition));
+                    packing::packPositionsSnorm16(positions.data(), count, packed.positionOffset, 1.0f / scale,
+                                                  reinterpret_cast<PackedPosition *>( stream.data() ));
+                } else
+                {
+                    out = packedAttribute<HalfPosition>(attr.location);
+                    stream.resize(count * sizeof(HalfPosition));
+                    packing::packPositionsHalf(positions.data(), count, packed.positionOffset, 1.0f / scale,
+                                               reinterpret_cast<HalfPosition *>( stream.data() ));
+                }
+            } else if(role == AttributeRole::Normal && options.normal != NormalFormat::Float)
+            {
+                const std::vector<float> normals = deinterleave(mesh, attr, 3);
+                if(options.normal == NormalFormat::Int2101010Rev)
+                {
+                    out = packedAttribute<PackedNormal>(attr.location);
+                    stream.resize(count * sizeof(PackedNormal));
+                    packing::packNormalsInt2101010(normals.data(), count,
+                                                   reinterpret_cast<PackedNormal *>( stream.data() ));
+                } else
+                {
+                    out = packedAttribute<OctNormal>(attr.location);
+                    stream.resize(count * sizeof(OctNormal));
+                    packing::packNormalsOctahedral(normals.data(), count, reinterpret_cast<OctNormal *>( stream.data() ));
+                }
+            } else if(role == AttributeRole::TexCoord && options.texCoord == TexCoordFormat::Unorm16)
+            {
+                const std::vector<float> texCoords = deinterleave(mesh, attr, 2);
+                out = packedAttribute<PackedTexCoord>(attr.location);
+                stream.resize(count * sizeof(PackedTexCoord));
+                packing::packTexCoordsUnorm16(texCoords.data(), count, reinterpret_cast<PackedTexCoord *>( stream.data() ));
+            } else
+            {
+                // Anything else (or a Float format) is copied as it is
+                const unsigned int size = attributeSize(attr);
+                stream.resize(count * size);
+                for(std::size_t v = 0; v < count; v++)
+                {
+                    std::memcpy(stream.data() + v * size, mesh.vertices.data() + v * mesh.layout.stride + attr.offset,
+                                size);
+                }
+            }
+
+            const unsigned int size = count > 0 ? static_cast<unsigned int>( stream.size() / count ) : attributeSize(out);
+            out.offset = stride;
+            // Keeps every attribute 4-byte aligned for the vertex fetcher
+            stride += (size + 3u) & ~3u;
+            packed.layout.attributes.push_back(out);
+            sizes.push_back(size);
+            streams.push_back(std::move(stream));
+        }
+        packed.layout.stride = stride;
+
+        packed.vertices.assign(count * stride, std::byte{ 0 });
+        for(std::size_t a = 0; a < streams.size(); a++)
+        {
+            const unsigned int offset = packed.layout.attributes[a].offset;
+            for(std::size_t v = 0; v < count; v++)
+            {
+                std::memcpy(packed.vertices.data() + v * stride + offset, streams[a].data() + v * sizes[a], sizes[a]);
+            }
+        }
+
+        std::cerr << "[VertexPacking]: " << mesh.layout.stride << " -> " << stride << " bytes per vertex" << '\n';
+        return packed;
+    }
+}
@@ -0,0 +1,129 @@
+#pragma once
+#include <MeshBuilder.h>
+#include <VertexLayout.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace core
+{
+    // 16-bit SNORM position, dequantised by Mesh::getDequantMatrix() (w is padding)
+    struct PackedPosition
+    {
+        std::int16_t x, y, z, w;
+    };
+
+    // Half float position, also relative to the mesh's dequant transform (w is padding)
+    struct HalfPosition
+    {
+        std::uint16_t x, y, z, w;
+    };
+
+    // Normal in GL_INT_2_10_10_10_REV, read back as a normalized vec4 (w unused)
+    struct PackedNormal
+    {
+        std::uint32_t bits;
+    };
+
+    /* Octahedral normal in two 16-bit SNORMs, has to be decoded in the shader:
+     *   vec3 n = vec3(e.xy, 1.0 - abs(e.x) - abs(e.y));
+     *   if(n.z < 0.0) n.xy = (1.0 - abs(n.yx)) * sign(n.xy);
+     *   n = normalize(n); */
+    struct OctNormal
+    {
+        std::int16_t x, y;
+    };
+
+    // Texture coordinates in [0, 1] as 16-bit UNORM
+    struct PackedTexCoord
+    {
+        std::uint16_t u, v;
+    };
+
+    template <>
+    struct VertexAttribTraits<PackedPosition>
+    {
+        static constexpr int components = 3;
+        static constexpr unsigned int glType = GL_SHORT;
+        static constexpr bool normalized = true;
+        static constexpr bool integer = false;
+    };
+
+    template <>
+    struct VertexAttribTraits<HalfPosition>
+    {
+        static constexpr int components = 3;
+        static constexpr unsigned int glType = GL_HALF_FLOAT;
+        static constexpr bool normalized = false;
+        static constexpr bool integer = false;
+    };
+
+    template <>
+    struct VertexAttribTraits<PackedNormal>
+    {
+        static constexpr int components = 4;
+        static constexpr unsigned int glType = GL_INT_2_10_10_10_REV;
+        static constexpr bool normalized = true;
+        static constexpr bool integer = false;
+    };
+
+    template <>
+    struct VertexAttribTraits<OctNormal>
+    {
+        static constexpr int components = 2;
+        static constexpr unsigned int glType = GL_SHORT;
+        static constexpr bool normalized = true;
+        static constexpr bool integer = false;
+    };
+
+    template <>
+    struct VertexAttribTraits<PackedTexCoord>
+    {
+        static constexpr int components = 2;
+        static constexpr unsigned int glType = GL_UNSIGNED_SHORT;
+        static constexpr bool normalized = true;
+        static constexpr bool integer = false;
+    };
+
+    // 16 bytes per vertex instead of 32 for position + normal + uv
+    using PackedVertexLayout = VertexLayout<PackedPosition, PackedNormal, PackedTexCoord>;
+
+    enum class PositionFormat { Float, Snorm16, Half };
+
+    enum class NormalFormat { Float, Int2101010Rev, Octahedral16 };
+
+    enum class TexCoordFormat { Float, Unorm16 };
+
+    struct VertexPackingOptions
+    {
+        PositionFormat position = PositionFormat::Snorm16;
+        NormalFormat normal = NormalFormat::Int2101010Rev;
+        TexCoordFormat texCoord = TexCoordFormat::Unorm16;
+    };
+
+    /* Repacks a float mesh into compact attributes. Positions are read from location 0
+     * (vec3), normals from location 1 (vec3) and texcoords from location 2 (vec2), other
+     * attributes are copied unchanged. Quantised positions are stored relative to the mesh
+     * bounds with one uniform scale, written to positionOffset/positionScale. */
+    MeshData packVertices(const MeshData& mesh, const VertexPackingOptions& options = {});
+
+    // Bulk pack kernels (AVX2 + F16C in Release builds, scalar otherwise)
+    namespace packing
+    {
+        // (p - offset) * invScale to 16-bit SNORM, xyz holds count tightly packed vec3s
+        void packPositionsSnorm16(const float* xyz, std::size_t count, const glm::vec3& offset, float invScale,
+                                  PackedPosition* out);
+
+        void packPositionsHalf(const float* xyz, std::size_t count, const glm::vec3& offset, float invScale,
+                               HalfPosition* out);
+
+        // Unit normals to 10:10:10:2 signed normalized
+        void packNormalsInt2101010(const float* xyz, std::size_t count, PackedNormal* out);
+
+        void packNormalsOctahedral(const float* xyz, std::size_t count, OctNormal* out);
+
+        // uv holds count vec2s, values are clamped to [0, 1]
+        void packTexCoordsUnorm16(const float* uv, std::size_t count, PackedTexCoord* out);
+
+        std::uint16_t floatToHalf(float value);
+    }
+}
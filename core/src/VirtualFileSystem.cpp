@@ -0,0 +1,567 @@
+#include <VirtualFileSystem.h>
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <utility>
+
+#if defined(CORE_HAS_IO_URING)
+#include <liburing.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace core::vfs
+{
+    namespace fs = std::filesystem;
+
+    namespace
+    {
+        std::string joinPath(const std::string& mountPoint, const std::string_view path)
+        {
+            if(mountPoint.empty()) return std::string(path);
+            std::string joined = mountPoint;
+            joined += '/';
+            joined += path;
+            return joined;
+        }
+
+        std::string normalizeMountPoint(const std::string& mountPoint)
+        {
+            std::string normalized = PackFile::normalizePath(mountPoint);
+            while(!normalized.empty() && normalized.back() == '/')
+                normalized.pop_back();
+            return normalized;
+        }
+
+        // The part of path below mountPoint, false when it lies outside it
+        bool stripMountPoint(const std::string& mountPoint, const std::string_view path, std::string_view& relative)
+        {
+            if(mountPoint.empty())
+            {
+                relative = path;
+                return true;
+            }
+            if(path.size() <= mountPoint.size() || !path.starts_with(mountPoint) || path[mountPoint.size()] != '/')
+                return false;
+            relative = path.substr(mountPoint.size() + 1);
+            return true;
+        }
+
+        // Touches one byte per page so the data is resident before the polling thread reads it
+        void prefault(const std::span<const std::byte> data)
+        {
+            constexpr std::size_t pageSize = 4096;
+            for(std::size_t offset = 0; offset < data.size(); offset += pageSize)
+                static_cast<void>( *static_cast<const volatile std::byte *>( &data[offset] ) );
+        }
+    }
+
+    FileView::FileView(std::shared_ptr<const void> owner, const std::span<const std::byte> data)
+        : m_Owner(std::move(owner)),
+          m_Data(data)
+    {
+    }
+
+    bool FileView::isValid() const { return m_Owner != nullptr; }
+    std::span<const std::byte> FileView::getData() const { return m_Data; }
+    std::size_t FileView::getSize() const { return m_Data.size(); }
+
+    std::string_view FileView::getText() const
+    {
+        return { reinterpret_cast<const char *>( m_Data.data() ), m_Data.size() };
+    }
+
+    std::size_t FileSystem::PathHash::operator()(const std::string_view path) const
+    {
+        return static_cast<std::size_t>( fnv1a64(path) );
+    }
+
+    bool FileSystem::mountDirectory(const std::string& directory, const MountOptions& options)
+    {
+        std::error_code error;
+        if(!fs::is_directory(directory, error))
+        {
+            std::cerr << "[VirtualFileSystem] Error: " << directory << " is not a directory" << '\n';
+            return false;
+        }
+
+        std::unique_lock lock(m_Mutex);
+        m_Mounts.push_back({ directory, normalizeMountPoint(options.mountPoint), nullptr, options.index });
+        if(options.index) indexMount(m_Mounts.size() - 1);
+        return true;
+    }
+
+    bool FileSystem::mountPack(const std::string& packPath, const MountOptions& options)
+    {
+        auto pack = std::make_shared<PackFile>();
+        if(!pack->open(packPath)) return false;
+
+        std::unique_lock lock(m_Mutex);
+        // Packs are always indexed, their TOC is already in memory
+        m_Mounts.push_back({ packPath, normalizeMountPoint(options.mountPoint), std::move(pack), true });
+        indexMount(m_Mounts.size() - 1);
+        return true;
+    }
+
+    bool FileSystem::unmount(const std::string& source)
+    {
+        std::unique_lock lock(m_Mutex);
+        const auto removed = std::erase_if(m_Mounts, [&source](const Mount& mount) { return mount.source == source; });
+        if(removed == 0) return false;
+
+        // Mount indices shift, so the TOC is rebuilt in overlay order
+        m_Toc.clear();
+        for(std::size_t i = 0; i < m_Mounts.size(); i++)
+        {
+            if(m_Mounts[i].indexed) indexMount(i);
+        }
+        return true;
+    }
+
+    void FileSystem::unmountAll()
+    {
+        std::unique_lock lock(m_Mutex);
+        m_Mounts.clear();
+        m_Toc.clear();
+    }
+
+    void FileSystem::indexMount(const std::size_t mount)
+    {
+        const Mount& target = m_Mounts[mount];
+        if(target.pack)
+        {
+            for(const PackEntry& entry : target.pack->getEntries())
+                m_Toc.insert_or_assign(joinPath(target.mountPoint, target.pack->getName(entry)), TocEntry{ mount, &entry });
+            return;
+        }
+
+        std::error_code error;
+        const fs::path root(target.source);
+        for(auto it = fs::recursive_directory_iterator(root, fs::directory_options::skip_permission_denied, error);
+            it != fs::recursive_directory_iterator(); it.increment(error))
+        {
+            if(error) break;
+            if(!it->is_regular_file(error)) continue;
+            const std::string relative = it->path().lexically_relative(root).generic_string();
+            m_Toc.insert_or_assign(joinPath(target.mountPoint, relative), TocEntry{ mount, nullptr });
+        }
+    }
+
+    bool FileSystem::resolveNormalized(const std::string& path, ResolvedFile& file) const
+    {
+        const auto found = m_Toc.find(std::string_view(path));
+
+        /* A TOC hit only has to be checked against unindexed directories mounted above it.
+         * On a miss every directory is checked on disk, newest first, which also finds files
+         * created after their directory was indexed. */
+        const std::size_t lowest = found != m_Toc.end() ? found->second.mount + 1 : 0;
+        for(std::size_t i = m_Mounts.size(); i-- > lowest;)
+        {
+            const Mount& mount = m_Mounts[i];
+            if(mount.pack || (found != m_Toc.end() && mount.indexed)) continue;
+
+            std::string_view relative;
+            if(!stripMountPoint(mount.mountPoint, path, relative)) continue;
+
+            std::error_code error;
+            const fs::path candidate = fs::path(mount.source) / fs::path(relative);
+            if(fs::is_regular_file(candidate, error))
+            {
+                file = { nullptr, nullptr, candidate.string() };
+                return true;
+            }
+        }
+
+        if(found == m_Toc.end()) return false;
+
+        const Mount& mount = m_Mounts[found->second.mount];
+        if(mount.pack)
+        {
+            file = { mount.pack, found->second.entry, {} };
+            return true;
+        }
+
+        std::string_view relative;
+        stripMountPoint(mount.mountPoint, path, relative);
+        file = { nullptr, nullptr, (fs::path(mount.source) / fs::path(relative)).string() };
+        return true;
+    }
+
+    bool FileSystem::resolve(const std::string_view path, ResolvedFile& file) const
+    {
+        const std::string normalized = PackFile::normalizePath(path);
+        std::shared_lock lock(m_Mutex);
+        return resolveNormalized(normalized, file);
+    }
+
+    bool FileSystem::exists(const std::string_view path) const
+    {
+        ResolvedFile file;
+        return resolve(path, file);
+    }
+
+    FileView FileSystem::read(const std::string_view path) const
+    {
+        ResolvedFile file;
+        if(!resolve(path, file)) return {};
+
+        if(file.pack) return { file.pack, file.pack->getData(*file.entry) };
+
+        auto mapping = std::make_shared<MappedFile>();
+        if(!mapping->open(file.filepath)) return {};
+        const std::span<const std::byte> data = mapping->getData();
+        return { std::move(mapping), data };
+    }
+
+    bool FileSystem::readTexture(const std::string_view path, CookedTexture& texture) const
+    {
+        ResolvedFile file;
+        return resolve(path, file) && file.pack && file.pack->readTexture(*file.entry, texture);
+    }
+
+    bool FileSystem::readMesh(const std::string_view path, MeshData& mesh) const
+    {
+        ResolvedFile file;
+        return resolve(path, file) && file.pack && file.pack->readMesh(*file.entry, mesh);
+    }
+
+    std::size_t FileSystem::getMountCount() const
+    {
+        std::shared_lock lock(m_Mutex);
+        return m_Mounts.size();
+    }
+
+    std::size_t FileSystem::getIndexedFileCount() const
+    {
+        std::shared_lock lock(m_Mutex);
+        return m_Toc.size();
+    }
+
+    FileSystem& get()
+    {
+        // Magic static, so the default mounts happen exactly once even when loaders race
+        static FileSystem fileSystem;
+        [[maybe_unused]] static const bool mounted = []
+        {
+            std::error_code error;
+            fileSystem.mountDirectory(".", { .mountPoint = "", .index = false });
+            if(fs::is_directory("assets", error)) fileSystem.mountDirectory("assets", { .mountPoint = "assets" });
+            if(fs::is_regular_file("assets.pak", error)) fileSystem.mountPack("assets.pak");
+            return true;
+        }();
+        return fileSystem;
+    }
+
+#if defined(CORE_HAS_IO_URING)
+    namespace
+    {
+        // One read's length is an unsigned int, and Linux stops a read at 2 GiB anyway
+        constexpr std::size_t MaxReadBytes = std::size_t(1) << 30;
+
+        // A free submission slot, flushing the queued ones first when the ring is full. nullptr if still full
+        io_uring_sqe* acquireSqe(io_uring* ring)
+        {
+            if(io_uring_sqe* sqe = io_uring_get_sqe(ring); sqe != nullptr) return sqe;
+            io_uring_submit(ring);
+            return io_uring_get_sqe(ring);
+        }
+
+        // The next piece of buffer from done, at most MaxReadBytes of it
+        void prepareRead(io_uring_sqe* sqe, const int fd, std::vector<std::byte>& buffer, const std::size_t done)
+        {
+            const std::size_t size = std::min(buffer.size() - done, MaxReadBytes);
+            io_uring_prep_read(sqe, fd, buffer.data() + done, static_cast<unsigned int>( size ), static_cast<std::uint64_t>( done ));
+        }
+
+        // Blocking fallback for the rest of a read when the ring has no slot left, false on an error
+        bool readRemaining(const int fd, std::vector<std::byte>& buffer, std::size_t& done)
+        {
+            while(done < buffer.size())
+            {
+                const ssize_t result = pread(fd, buffer.data() + done, std::min(buffer.size() - done, MaxReadBytes), static_cast<off_t>( done ));
+                if(result < 0) return false;
+                if(result == 0)
+                {
+                    // The file shrank since it was opened
+                    buffer.resize(done);
+                    break;
+                }
+                done += static_cast<std::size_t>( result );
+            }
+            return true;
+        }
+    }
+#endif
+
+    struct AsyncReader::UringRead
+    {
+        Request request;
+        int fd = -1;
+        std::shared_ptr<std::vector<std::byte>> buffer;
+        std::size_t done = 0;
+    };
+
+    AsyncReader::AsyncReader(const FileSystem& fileSystem, const unsigned int queueDepth, unsigned int workerThreads)
+        : m_FileSystem(fileSystem),
+          m_QueueDepth(std::max(1u, queueDepth))
+    {
+#if defined(CORE_HAS_IO_URING)
+        auto* ring = new io_uring{};
+        const int result = io_uring_queue_init(m_QueueDepth, ring, 0);
+        if(result == 0)
+        {
+            m_Ring = ring;
+            return;
+        }
+        // Seccomp filters and older kernels refuse the ring, the thread pool still works there
+        std::cerr << "[AsyncReader]: io_uring unavailable (" << -result << "), using worker threads" << '\n';
+        delete ring;
+#endif
+        if(workerThreads == 0) workerThreads = std::max(1u, std::thread::hardware_concurrency() / 2);
+        for(unsigned int i = 0; i < workerThreads; i++)
+            m_Workers.emplace_back(&AsyncReader::workerLoop, this);
+    }
+
+    AsyncReader::~AsyncReader()
+    {
+        {
+            std::lock_guard lock(m_Mutex);
+            m_Stopping = true;
+            m_Queued.clear();
+        }
+        m_QueueChanged.notify_all();
+        for(std::thread& worker : m_Workers)
+            worker.join();
+
+#if defined(CORE_HAS_IO_URING)
+        if(m_Ring != nullptr)
+        {
+            // The kernel may still be writing into buffers, they can only go once it is done
+            // A failed wait won't succeed later, exiting the ring cancels what is left
+            while(!m_InFlight.empty())
+                if(!reapUring(true)) break;
+            auto* ring = static_cast<io_uring *>( m_Ring );
+            io_uring_queue_exit(ring);
+            delete ring;
+        }
+#endif
+    }
+
+    void AsyncReader::read(std::string path, Callback callback)
+    {
+        {
+            std::lock_guard lock(m_Mutex);
+            m_Queued.push_back({ std::move(path), std::move(callback), {} });
+        }
+        m_Pending++;
+        if(m_Ring != nullptr) submitUring();
+        else m_QueueChanged.notify_one();
+    }
+
+    void AsyncReader::workerLoop()
+    {
+        while(true)
+        {
+            Request request;
+            {
+                std::unique_lock lock(m_Mutex);
+                m_QueueChanged.wait(lock, [this] { return m_Stopping || !m_Queued.empty(); });
+                if(m_Stopping) return;
+                request = std::move(m_Queued.front());
+                m_Queued.pop_front();
+            }
+
+            request.file = m_FileSystem.read(request.path);
+            prefault(request.file.getData());
+
+            {
+                std::lock_guard lock(m_Mutex);
+                m_Finished.push_back(std::move(request));
+            }
+            m_ReadFinished.notify_all();
+        }
+    }
+
+    std::size_t AsyncReader::poll()
+    {
+        if(m_Ring != nullptr)
+        {
+            reapUring(false);
+            submitUring();
+        }
+
+        std::vector<Request> finished;
+        {
+            std::lock_guard lock(m_Mutex);
+            finished.swap(m_Finished);
+        }
+        for(Request& request : finished)
+        {
+            if(request.callback) request.callback(request.path, request.file);
+            m_Pending--;
+        }
+        return finished.size();
+    }
+
+    void AsyncReader::waitIdle()
+    {
+        while(m_Pending > 0)
+        {
+            if(poll() > 0) continue;
+            if(m_Ring != nullptr)
+            {
+                reapUring(true);
+                continue;
+            }
+            std::unique_lock lock(m_Mutex);
+            m_ReadFinished.wait(lock, [this] { return !m_Finished.empty(); });
+        }
+    }
+
+    void AsyncReader::submitUring()
+    {
+#if defined(CORE_HAS_IO_URING)
+        auto* ring = static_cast<io_uring *>( m_Ring );
+        bool submitted = false;
+        while(!m_Queued.empty() && m_InFlight.size() < m_QueueDepth)
+        {
+            auto read = std::make_unique<UringRead>();
+            read->request = std::move(m_Queued.front());
+            m_Queued.pop_front();
+
+            ResolvedFile file;
+            if(!m_FileSystem.resolve(read->request.path, file))
+            {
+                m_Finished.push_back(std::move(read->request));
+                continue;
+            }
+
+            if(file.pack)
+            {
+                // Pack entries are already mapped, the kernel only has to start paging them in
+                read->request.file = { file.pack, file.pack->getData(*file.entry) };
+            } else
+            {
+                read->fd = ::open(file.filepath.c_str(), O_RDONLY | O_CLOEXEC);
+                struct stat info{};
+                if(read->fd < 0 || fstat(read->fd, &info) != 0)
+                {
+                    std::cerr << "[AsyncReader] Error: Could not open " << file.filepath << '\n';
+                    if(read->fd >= 0) close(read->fd);
+                    m_Finished.push_back(std::move(read->request));
+                    continue;
+                }
+                read->buffer = std::make_shared<std::vector<std::byte>>(static_cast<std::size_t>( info.st_size ));
+                if(read->buffer->empty())
+                {
+                    close(read->fd);
+                    read->request.file = { read->buffer, {} };
+                    m_Finished.push_back(std::move(read->request));
+                    continue;
+                }
+            }
+
+            // Only taken once there is something to submit, an unprepared slot would still go to the kernel
+            io_uring_sqe* sqe = acquireSqe(ring);
+            if(sqe == nullptr)
+            {
+                // Still full after flushing, the request waits for the next poll
+                if(read->fd >= 0) close(read->fd);
+                read->request.file = {};
+                m_Queued.push_front(std::move(read->request));
+                break;
+            }
+
+            if(file.pack)
+            {
+                const std::span<const std::byte> data = read->request.file.getData();
+                const auto begin = reinterpret_cast<std::uintptr_t>( data.data() ) & ~std::uintptr_t(4095);
+                const auto end = reinterpret_cast<std::uintptr_t>( data.data() + data.size() );
+                io_uring_prep_madvise(sqe, reinterpret_cast<void *>( begin ), static_cast<off_t>( end - begin ),
+                                      MADV_WILLNEED);
+            } else
+            {
+                prepareRead(sqe, read->fd, *read->buffer, 0);
+            }
+            io_uring_sqe_set_data(sqe, read.get());
+            m_InFlight.push_back(std::move(read));
+            submitted = true;
+        }
+        if(submitted) io_uring_submit(ring);
+#endif
+    }
+
+    bool AsyncReader::reapUring(const bool wait)
+    {
+#if defined(CORE_HAS_IO_URING)
+        auto* ring = static_cast<io_uring *>( m_Ring );
+        io_uring_cqe* cqe = nullptr;
+        if(wait && !m_InFlight.empty())
+        {
+            int result = 0;
+            do
+            {
+                result = io_uring_wait_cqe(ring, &cqe);
+            } while(result == -EINTR);
+            if(result != 0) return false;
+        }
+
+        bool resubmitted = false;
+        while(io_uring_peek_cqe(ring, &cqe) == 0)
+        {
+            auto* read = static_cast<UringRead *>( io_uring_cqe_get_data(cqe) );
+            const int result = cqe->res;
+            io_uring_cqe_seen(ring, cqe);
+
+            bool failed = result < 0;
+            int error = -result;
+            if(read->fd >= 0 && result > 0)
+            {
+                read->done += static_cast<std::size_t>( result );
+                if(read->done < read->buffer->size())
+                {
+                    // Short read or a split one, ask for the rest from where it stopped
+                    if(io_uring_sqe* sqe = acquireSqe(ring); sqe != nullptr)
+                    {
+                        prepareRead(sqe, read->fd, *read->buffer, read->done);
+                        io_uring_sqe_set_data(sqe, read);
+                        resubmitted = true;
+                        continue;
+                    }
+                    failed = !readRemaining(read->fd, *read->buffer, read->done);
+                    error = errno;
+                }
+            } else if(read->fd >= 0 && result == 0)
+            {
+                // End of file before the size fstat gave, the file shrank in between
+                read->buffer->resize(read->done);
+            }
+
+            if(read->fd >= 0)
+            {
+                close(read->fd);
+                if(!failed) read->request.file = { read->buffer, { read->buffer->data(), read->buffer->size() } };
+                else std::cerr << "[AsyncReader] Error: Reading " << read->request.path << " failed (" << error << ")" << '\n';
+            }
+            finishUring(*read);
+        }
+        if(resubmitted) io_uring_submit(ring);
+#else
+        static_cast<void>( wait );
+#endif
+        return true;
+    }
+
+    void AsyncReader::finishUring(UringRead& read)
+    {
+        m_Finished.push_back(std::move(read.request));
+        std::erase_if(m_InFlight, [&read](const std::unique_ptr<UringRead>& inFlight) { return inFlight.get() == &read; });
+    }
+
+    std::size_t AsyncReader::getPendingCount() const { return m_Pending; }
+    bool AsyncReader::usesIoUring() const { return m_Ring != nullptr; }
+}
@@ -0,0 +1,203 @@
+#pragma once
+#include <PackFile.h>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace core::vfs
+{
+    /* The bytes of one file, viewed where they already are. The owner keeps whatever backs
+     * the span alive (the pack it sits in, the mapping of a loose file or the buffer an async
+     * read filled), so a view stays valid after its mount is gone. */
+    class FileView
+    {
+    private:
+        std::shared_ptr<const void> m_Owner;
+        std::span<const std::byte> m_Data;
+
+    public:
+        FileView() = default;
+
+        FileView(std::shared_ptr<const void> owner, std::span<const std::byte> data);
+
+        // False when nothing had the file, a found file can still be empty
+        [[nodiscard]] bool isValid() const;
+
+        explicit operator bool() const { return isValid(); }
+
+        [[nodiscard]] std::span<const std::byte> getData() const;
+
+        [[nodiscard]] std::string_view getText() const;
+
+        [[nodiscard]] std::size_t getSize() const;
+    };
+
+    struct MountOptions
+    {
+        // Prefix the mounted files appear under, empty mounts them at the root
+        std::string mountPoint;
+        // Directories are scanned into the TOC when mounted, unindexed ones are checked on disk per lookup
+        bool index = true;
+    };
+
+    // Where a path resolved to, an entry of a mounted pack or a file on disk
+    struct ResolvedFile
+    {
+        std::shared_ptr<const PackFile> pack;
+        const PackEntry* entry = nullptr;
+        std::string filepath;
+    };
+
+    /* Directories and asset_cooker packs mounted on top of each other. Every indexed file
+     * goes into one hashed TOC that records which mount wins, so resolving a path is a
+     * single hash lookup however many mounts there are. Later mounts overlay earlier ones.
+     * Lookups may run on any thread, mounting takes an exclusive lock. */
+    class FileSystem
+    {
+    private:
+        struct Mount
+        {
+            std::string source;// directory or pack path as it was mounted
+            std::string mountPoint;
+            std::shared_ptr<const PackFile> pack;
+            bool indexed = false;
+        };
+
+        struct TocEntry
+        {
+            std::size_t mount = 0;
+            const PackEntry* entry = nullptr;
+        };
+
+        struct PathHash
+        {
+            using is_transparent = void;
+
+            std::size_t operator()(std::string_view path) const;
+        };
+
+        std::vector<Mount> m_Mounts;
+        std::unordered_map<std::string, TocEntry, PathHash, std::equal_to<>> m_Toc;
+        mutable std::shared_mutex m_Mutex;
+
+        void indexMount(std::size_t mount);
+
+        bool resolveNormalized(const std::string& path, ResolvedFile& file) const;
+
+    public:
+        FileSystem() = default;
+
+        FileSystem(const FileSystem&) = delete;
+
+        FileSystem& operator=(const FileSystem&) = delete;
+
+        bool mountDirectory(const std::string& directory, const MountOptions& options = {});
+
+        bool mountPack(const std::string& packPath, const MountOptions& options = {});
+
+        // Removes every mount of that directory or pack, views already handed out stay valid
+        bool unmount(const std::string& source);
+
+        void unmountAll();
+
+        [[nodiscard]] bool exists(std::string_view path) const;
+
+        bool resolve(std::string_view path, ResolvedFile& file) const;
+
+        // Views the file inside its pack or maps it from disk, invalid when no mount has it
+        [[nodiscard]] FileView read(std::string_view path) const;
+
+        // Only succeed when the path resolves to a cooked entry of a mounted pack
+        bool readTexture(std::string_view path, CookedTexture& texture) const;
+
+        bool readMesh(std::string_view path, MeshData& mesh) const;
+
+        [[nodiscard]] std::size_t getMountCount() const;
+
+        [[nodiscard]] std::size_t getIndexedFileCount() const;
+    };
+
+    /* The filesystem the engine loaders read through. On first use it mounts the working
+     * directory unindexed as the last resort, ./assets indexed as "assets" and assets.pak
+     * on top, so cooked lessons read from their pack and everything else from loose files. */
+    FileSystem& get();
+
+    /* Streams files without blocking the frame and hands them back on the thread that polls,
+     * so the upload that follows stays on the GL thread. With io_uring (CORE_HAS_IO_URING)
+     * the kernel reads loose files into their own buffers and pack entries get a read-ahead
+     * hint. Without it, or when the ring can't be created, a few worker threads map the files
+     * and fault their pages in instead. read() and poll() belong to one thread. */
+    class AsyncReader
+    {
+    public:
+        using Callback = std::function<void(const std::string& path, const FileView& file)>;
+
+    private:
+        struct Request
+        {
+            std::string path;
+            Callback callback;
+            FileView file;
+        };
+
+        struct UringRead;
+
+        const FileSystem& m_FileSystem;
+        unsigned int m_QueueDepth = 0;
+        std::size_t m_Pending = 0;
+
+        std::deque<Request> m_Queued;
+        std::vector<Request> m_Finished;
+        std::mutex m_Mutex;
+        std::condition_variable m_QueueChanged;
+        std::condition_variable m_ReadFinished;
+        bool m_Stopping = false;
+        std::vector<std::thread> m_Workers;
+
+        void* m_Ring = nullptr;
+        std::vector<std::unique_ptr<UringRead>> m_InFlight;
+
+        void workerLoop();
+
+        void submitUring();
+
+        // False when waiting for a completion failed
+        bool reapUring(bool wait);
+
+        void finishUring(UringRead& read);
+
+    public:
+        // workerThreads only matters for the thread pool (0 = half the hardware threads)
+        explicit AsyncReader(const FileSystem& fileSystem = get(), unsigned int queueDepth = 64,
+                             unsigned int workerThreads = 0);
+
+        AsyncReader(const AsyncReader&) = delete;
+
+        AsyncReader& operator=(const AsyncReader&) = delete;
+
+        // Waits for reads the kernel or a worker already started, their callbacks never run
+        ~AsyncReader();
+
+        void read(std::string path, Callback callback);
+
+        // Runs the callbacks of finished reads, call it once a frame. Returns how many ran
+        std::size_t poll();
+
+        // Blocks until every read so far has finished and its callback has run
+        void waitIdle();
+
+        [[nodiscard]] std::size_t getPendingCount() const;
+
+        [[nodiscard]] bool usesIoUring() const;
+    };
+}
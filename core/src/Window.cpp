@@ -1,4 +1,5 @@
 #include <Window.h>
+#include <AllocationTracker.h>
 #include <GLFW/glfw3.h>
 #include <iostream>
 #include <stdexcept>
@@ -107,6 +108,12 @@ namespace core
         glfwSetWindowUserPointer(m_Window, this);
         initImGui();
         m_LastFrameTime = glfwGetTime();
+
+        m_FrameArena = std::make_unique<FrameArena>(FrameArenaOptions{
+            .bytesPerThread = m_Options.frameArenaBytes,
+            .framesInFlight = m_Options.framesInFlight
+        });
+        FrameArena::setMain(m_FrameArena.get());
     }
 
 
@@ -153,7 +160,13 @@ namespace core
         glClearColor(colour.r, colour.g, colour.b, colour.a);
     }
 
-    void Window::swapBuffers() const { glfwSwapBuffers(m_Window); }
+    void Window::swapBuffers() const
+    {
+        glfwSwapBuffers(m_Window);
+        m_FrameArena->nextFrame();
+        AllocationTracker::nextFrame();
+    }
+
     void Window::pollEvents() { glfwPollEvents(); }
     [[nodiscard]] bool Window::shouldClose() const { return glfwWindowShouldClose(m_Window); }
 
@@ -180,5 +193,6 @@ namespace core
         glfwGetFramebufferSize(m_Window, & w, & h);
         return h;
     }
-}
 
+    FrameArena& Window::getFrameArena() const { return *m_FrameArena; }
+}
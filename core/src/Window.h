@@ -1,6 +1,8 @@
 #pragma once
 #include <glad/gl.h>
 #include <GLFW/glfw3.h>
+#include <FrameArena.h>
+#include <memory>
 #include <string>
 #include <glm/glm.hpp>
 
@@ -24,6 +26,9 @@ namespace core
         int height = 600;
         bool vSync = true;
         GLProfile profile = GLProfile::Core;
+        // Transient per-frame memory, rewound by swapBuffers()
+        std::size_t frameArenaBytes = 4 * 1024 * 1024;// per thread and frame
+        unsigned int framesInFlight = 2;
     };
 
     class Window
@@ -34,6 +39,7 @@ namespace core
         // Variables for tracking window timings essential for physics
         double m_LastFrameTime = 0.0;// Double for precision
         float m_DeltaTime = 0.0f;    // Float for game logic
+        std::unique_ptr<FrameArena> m_FrameArena;
 
         static void initGLFW();
         void initGLAD() const;
@@ -65,6 +71,7 @@ namespace core
 
         void setClearColour(const glm::vec4& colour) const;
 
+        // Presents the frame, moves the frame arena on and closes the allocation tracker's frame
         void swapBuffers() const;
 
         static void pollEvents();
@@ -87,5 +94,7 @@ namespace core
         [[nodiscard]] int getFramebufferWidth() const;
 
         [[nodiscard]] int getFramebufferHeight() const;
+
+        [[nodiscard]] FrameArena& getFrameArena() const;
     };
 }
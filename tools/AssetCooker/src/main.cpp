@@ -0,0 +1,591 @@
+#include <GltfLoader.h>
+#include <JobSystem.h>
+#include <MeshBuilder.h>
+#include <MeshSimplifier.h>
+#include <PackFormat.h>
+#include <stb_image.h>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/* Cooks a lesson's assets/ folder into one assets.pak (see PackFormat.h):
+ *   - shaders get their #includes resolved and comments stripped
+ *   - images are decoded, flipped for OpenGL and get their whole mip chain baked
+ *   - .glb meshes are flattened into one welded, cache optimised MeshData with a chain of
+ *     simplified LODs (MeshSimplifier), each with its geometric error
+ *   - everything else is stored as it is
+ *
+ * usage: asset_cooker <asset dir> <output.pak> [--cache <dir>] [--prefix <name>]
+ *
+ * Cooked textures and meshes are cached by the hash of their source bytes, so only changed
+ * files are cooked again. When every entry matches the existing pack it isn't rewritten,
+ * only touched so the build system sees it as up to date. */
+
+namespace fs = std::filesystem;
+
+namespace
+{
+    // Bump when a cooked format changes, it is part of every cache key
+    constexpr std::uint64_t CookerVersion = 2;
+
+    struct CookedAsset
+    {
+        std::string name;
+        core::PackEntryType type = core::PackEntryType::Raw;
+        std::uint64_t contentHash = 0;
+        std::vector<std::byte> data;
+    };
+
+    struct CookStats
+    {
+        std::size_t cooked = 0;
+        std::size_t cached = 0;
+    };
+
+    std::vector<std::byte> readFile(const fs::path& path)
+    {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if(!file.is_open()) throw std::runtime_error("[AssetCooker]: Could not read " + path.string());
+
+        std::vector<std::byte> bytes(static_cast<std::size_t>( file.tellg() ));
+        file.seekg(0);
+        file.read(reinterpret_cast<char *>( bytes.data() ), static_cast<std::streamsize>( bytes.size() ));
+        return bytes;
+    }
+
+    void writeFile(const fs::path& path, const std::vector<std::byte>& bytes)
+    {
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        if(!file.is_open()) throw std::runtime_error("[AssetCooker]: Could not write " + path.string());
+        file.write(reinterpret_cast<const char *>( bytes.data() ), static_cast<std::streamsize>( bytes.size() ));
+    }
+
+    template <typename T>
+    void append(std::vector<std::byte>& out, const T& value)
+    {
+        const auto* bytes = reinterpret_cast<const std::byte *>( &value );
+        out.insert(out.end(), bytes, bytes + sizeof(T));
+    }
+
+    std::string toLower(std::string text)
+    {
+        std::transform(text.begin(), text.end(), text.begin(),
+                       [](const unsigned char c) { return static_cast<char>( std::tolower(c) ); });
+        return text;
+    }
+
+    std::string toHex(const std::uint64_t value)
+    {
+        std::ostringstream stream;
+        stream << std::hex << value;
+        return stream.str();
+    }
+
+    core::PackEntryType classify(const fs::path& path)
+    {
+        const std::string ext = toLower(path.extension().string());
+        if(ext == ".vert" || ext == ".frag" || ext == ".geom" || ext == ".comp" || ext == ".tesc" ||
+           ext == ".tese" || ext == ".glsl")
+            return core::PackEntryType::Shader;
+        if(ext == ".png" || ext == ".jpg" || ext == ".jpeg" || ext == ".bmp" || ext == ".tga")
+            return core::PackEntryType::Texture;
+        if(ext == ".glb")
+            return core::PackEntryType::Mesh;
+        return core::PackEntryType::Raw;
+    }
+
+    // Removes // and /* */ comments but keeps the newlines, so compile errors still point at the right line
+    std::string stripComments(const std::string& source)
+    {
+        std::string out;
+        out.reserve(source.size());
+        for(std::size_t i = 0; i < source.size(); i++)
+        {
+            if(source.compare(i, 2, "//") == 0)
+            {
+                while(i < source.size() && source[i] != '\n') i++;
+                if(i < source.size()) out += '\n';
+            } else if(source.compare(i, 2, "/*") == 0)
+            {
+                const std::size_t end = source.find("*/", i + 2);
+                const std::size_t stop = end == std::string::npos ? source.size() : end + 2;
+                out.append(static_cast<std::size_t>( std::count(source.begin() + static_cast<std::ptrdiff_t>( i ),
+                                                                source.begin() + static_cast<std::ptrdiff_t>( stop ), '\n') ), '\n');
+                i = stop - 1;
+            } else
+            {
+                out += source[i];
+            }
+        }
+
+        // Trailing whitespace goes too
+        std::string trimmed;
+        trimmed.reserve(out.size());
+        std::istringstream lines(out);
+        for(std::string line; std::getline(lines, line);)
+        {
+            line.erase(line.find_last_not_of(" \t\r") + 1);
+            trimmed += line;
+            trimmed += '\n';
+        }
+        return trimmed;
+    }
+
+    // Inlines #include "file" (relative to the including file), each file at most once
+    std::string resolveIncludes(const fs::path& path, std::set<fs::path>& included)
+    {
+        const fs::path canonical = fs::weakly_canonical(path);
+        if(!included.insert(canonical).second) return {};
+
+        const std::vector<std::byte> bytes = readFile(path);
+        std::istringstream source(std::string(reinterpret_cast<const char *>( bytes.data() ), bytes.size()));
+        std::string out;
+        int lineNumber = 0;
+        for(std::string line; std::getline(source, line);)
+        {
+            lineNumber++;
+            const std::size_t start = line.find_first_not_of(" \t");
+            if(start != std::string::npos && line.compare(start, 8, "#include") == 0)
+            {
+                const std::size_t open = line.find('"', start);
+                const std::size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+                if(close == std::string::npos)
+                    throw std::runtime_error("[AssetCooker]: Malformed #include in " + path.string());
+
+                out += resolveIncludes(path.parent_path() / line.substr(open + 1, close - open - 1), included);
+                // Puts the line numbers back for the including file
+                out += "#line " + std::to_string(lineNumber + 1) + '\n';
+                continue;
+            }
+            out += line;
+            out += '\n';
+        }
+        return out;
+    }
+
+    std::vector<std::byte> cookShader(const fs::path& path)
+    {
+        std::set<fs::path> included;
+        const std::string source = stripComments(resolveIncludes(path, included));
+        const auto* bytes = reinterpret_cast<const std::byte *>( source.data() );
+        return { bytes, bytes + source.size() };
+    }
+
+    // 2x2 box filter, odd edges reuse their last row/column
+    std::vector<unsigned char> downsample(const unsigned char* pixels, const int width, const int height,
+                                          const int channels)
+    {
+        const int outWidth = std::max(1, width / 2);
+        const int outHeight = std::max(1, height / 2);
+        std::vector<unsigned char> out(static_cast<std::size_t>( outWidth * outHeight * channels ));
+        for(int y = 0; y < outHeight; y++)
+        {
+            const int y0 = std::min(y * 2, height - 1);
+            const int y1 = std::min(y * 2 + 1, height - 1);
+            for(int x = 0; x < outWidth; x++)
+            {
+                const int x0 = std::min(x * 2, width - 1);
+                const int x1 = std::min(x * 2 + 1, width - 1);
+                for(int c = 0; c < channels; c++)
+                {
+                    const int sum = pixels[(y0 * width + x0) * channels + c] + pixels[(y0 * width + x1) * channels + c] +
+                                    pixels[(y1 * width + x0) * channels + c] + pixels[(y1 * width + x1) * channels + c];
+                    out[static_cast<std::size_t>( (y * outWidth + x) * channels + c )] = static_cast<unsigned char>( (sum + 2) / 4 );
+                }
+            }
+        }
+        return out;
+    }
+
+    std::vector<std::byte> cookTexture(const fs::path& path)
+    {
+        int width = 0, height = 0, channels = 0;
+        // Same orientation as ImageLoader, so cooked and loose textures look identical
+        stbi_set_flip_vertically_on_load(true);
+        unsigned char* pixels = stbi_load(path.string().c_str(), &width, &height, &channels, 0);
+        if(pixels == nullptr)
+            throw std::runtime_error("[AssetCooker]: Could not decode " + path.string());
+
+        core::CookedTextureHeader header;
+        header.width = static_cast<std::uint32_t>( width );
+        header.height = static_cast<std::uint32_t>( height );
+        header.channels = static_cast<std::uint32_t>( channels );
+        header.levels = 1;
+        for(int size = std::max(width, height); size > 1; size /= 2)
+            header.levels++;
+
+        std::vector<std::byte> out;
+        append(out, header);
+        std::vector<unsigned char> level(pixels, pixels + static_cast<std::size_t>( width * height * channels ));
+        stbi_image_free(pixels);
+
+        for(std::uint32_t i = 0; i < header.levels; i++)
+        {
+            const auto* bytes = reinterpret_cast<const std::byte *>( level.data() );
+            out.insert(out.end(), bytes, bytes + level.size());
+            if(i + 1 < header.levels)
+            {
+                level = downsample(level.data(), width, height, channels);
+                width = std::max(1, width / 2);
+                height = std::max(1, height / 2);
+            }
+        }
+        return out;
+    }
+
+    // One component of a glTF accessor as float, normalized integers are mapped to [0, 1] / [-1, 1]
+    float readComponent(const std::byte* data, const unsigned int type, const bool normalized)
+    {
+        switch(type)
+        {
+            case GL_FLOAT:
+            {
+                float value;
+                std::memcpy(&value, data, sizeof(value));
+                return value;
+            }
+            case GL_UNSIGNED_BYTE:
+            {
+                const auto value = static_cast<float>( std::to_integer<std::uint8_t>(*data) );
+                return normalized ? value / 255.0f : value;
+            }
+            case GL_BYTE:
+            {
+                const auto value = static_cast<float>( static_cast<std::int8_t>( std::to_integer<std::uint8_t>(*data) ) );
+                return normalized ? std::max(value / 127.0f, -1.0f) : value;
+            }
+            case GL_UNSIGNED_SHORT:
+            {
+                std::uint16_t value;
+                std::memcpy(&value, data, sizeof(value));
+                return normalized ? static_cast<float>( value ) / 65535.0f : static_cast<float>( value );
+            }
+            case GL_SHORT:
+            {
+                std::int16_t value;
+                std::memcpy(&value, data, sizeof(value));
+                return normalized ? std::max(static_cast<float>( value ) / 32767.0f, -1.0f) : static_cast<float>( value );
+            }
+            case GL_UNSIGNED_INT:
+            {
+                std::uint32_t value;
+                std::memcpy(&value, data, sizeof(value));
+                return static_cast<float>( value );
+            }
+            default: return 0.0f;
+        }
+    }
+
+    std::size_t componentBytes(const unsigned int type)
+    {
+        return type == GL_BYTE || type == GL_UNSIGNED_BYTE ? 1 : type == GL_SHORT || type == GL_UNSIGNED_SHORT ? 2 : 4;
+    }
+
+    glm::vec3 readAttribute(const core::GltfAsset& asset, const core::GltfAttribute& attr, const std::size_t vertex)
+    {
+        const std::byte* element = asset.ranges[attr.range].data() + attr.offset + vertex * attr.stride;
+        glm::vec3 value(0.0f);
+        for(int c = 0; c < std::min(attr.components, 3); c++)
+            value[c] = readComponent(element + static_cast<std::size_t>( c ) * componentBytes(attr.type), attr.type, attr.normalized);
+        return value;
+    }
+
+    std::uint32_t readIndex(const core::GltfAsset& asset, const core::GltfPrimitive& primitive, const std::size_t i)
+    {
+        const std::byte* data = asset.ranges[primitive.indexRange].data() + primitive.indexOffset;
+        if(primitive.indexType == GL_UNSIGNED_SHORT)
+        {
+            std::uint16_t value;
+            std::memcpy(&value, data + i * sizeof(value), sizeof(value));
+            return value;
+        }
+        std::uint32_t value;
+        std::memcpy(&value, data + i * sizeof(value), sizeof(value));
+        return value;
+    }
+
+    // Flattens every triangle draw of the scene into one position/normal/uv mesh in world space
+    std::vector<std::byte> cookMesh(const fs::path& path, core::JobSystem& jobs)
+    {
+        const core::GltfAsset asset = core::loadGlb(path.string(), { .logStats = false });
+
+        struct Vertex
+        {
+            glm::vec3 position;
+            glm::vec3 normal;
+            glm::vec2 texCoord;
+        };
+        using Layout = core::VertexLayoutOf<&Vertex::position, &Vertex::normal, &Vertex::texCoord>;
+
+        std::vector<Vertex> soup;
+        for(const core::GltfDrawItem& item : asset.drawItems)
+        {
+            const core::GltfPrimitive& primitive = asset.primitives[item.primitive];
+            if(primitive.mode != GL_TRIANGLES)
+            {
+                std::cerr << "[AssetCooker]: Skipping non triangle-list primitive in " << path.string() << '\n';
+                continue;
+            }
+
+            const core::GltfAttribute* attributes[3] = {};
+            for(const core::GltfAttribute& attr : primitive.attributes)
+                if(attr.location < 3) attributes[attr.location] = &attr;
+            if(attributes[0] == nullptr)
+            {
+                std::cerr << "[AssetCooker]: Skipping primitive without POSITION in " << path.string() << '\n';
+                continue;
+            }
+
+            const glm::mat3 normalMatrix = glm::transpose(glm::inverse(glm::mat3(item.transform)));
+            const std::size_t count = primitive.indexed ? primitive.indexCount : primitive.vertexCount;
+            const std::size_t first = soup.size();
+            for(std::size_t i = 0; i < count; i++)
+            {
+                const std::size_t index = primitive.indexed ? readIndex(asset, primitive, i) : i;
+                if(index >= primitive.vertexCount)
+                    throw std::runtime_error("[AssetCooker]: Index out of range in " + path.string());
+
+                Vertex vertex{};
+                vertex.position = glm::vec3(item.transform * glm::vec4(readAttribute(asset, *attributes[0], index), 1.0f));
+                if(attributes[1] != nullptr) vertex.normal = glm::normalize(normalMatrix * readAttribute(asset, *attributes[1], index));
+                if(attributes[2] != nullptr) vertex.texCoord = glm::vec2(readAttribute(asset, *attributes[2], index));
+                soup.push_back(vertex);
+            }
+
+            // Flat normals for primitives that come without any
+            if(attributes[1] == nullptr)
+            {
+                for(std::size_t t = first; t + 2 < soup.size(); t += 3)
+                {
+                    const glm::vec3 normal = glm::normalize(glm::cross(soup[t + 1].position - soup[t].position,
+                                                                       soup[t + 2].position - soup[t].position));
+                    soup[t].normal = soup[t + 1].normal = soup[t + 2].normal = normal;
+                }
+            }
+        }
+
+        core::MeshBuilder builder(Layout::desc());
+        builder.addTriangleList(soup.data(), soup.size());
+        core::MeshData mesh = builder.build({ .logStats = false });
+        core::MeshSimplifier::generateLods(mesh, {}, &jobs);
+
+        core::CookedMeshHeader header;
+        header.vertexCount = static_cast<std::uint32_t>( mesh.vertexCount() );
+        header.indexCount = static_cast<std::uint32_t>( mesh.indices.size() );
+        header.stride = mesh.layout.stride;
+        header.attributeCount = static_cast<std::uint32_t>( mesh.layout.attributes.size() );
+        header.lodCount = static_cast<std::uint32_t>( mesh.lods.size() );
+
+        std::vector<std::byte> out;
+        append(out, header);
+        for(const core::VertexAttribute& attr : mesh.layout.attributes)
+        {
+            append(out, core::CookedMeshAttribute{
+                attr.location, attr.components, attr.type,
+                (attr.normalized ? 1u : 0u) | (attr.integer ? 2u : 0u), attr.offset
+            });
+        }
+        out.insert(out.end(), mesh.vertices.begin(), mesh.vertices.end());
+        const auto* indices = reinterpret_cast<const std::byte *>( mesh.indices.data() );
+        out.insert(out.end(), indices, indices + mesh.indices.size() * sizeof(unsigned int));
+        for(const core::MeshLod& lod : mesh.lods)
+            append(out, core::CookedMeshLod{ lod.firstIndex, lod.indexCount, lod.error });
+        return out;
+    }
+
+    CookedAsset cookAsset(const fs::path& source, std::string name, const fs::path& cacheDir, CookStats& stats, core::JobSystem& jobs)
+    {
+        CookedAsset asset;
+        asset.name = std::move(name);
+        asset.type = classify(source);
+
+        // Shader preprocessing is cheap and depends on included files, so it always runs
+        if(asset.type == core::PackEntryType::Shader)
+        {
+            asset.data = cookShader(source);
+            asset.contentHash = core::fnv1a64(asset.data.data(), asset.data.size());
+            stats.cooked++;
+            return asset;
+        }
+
+        const std::vector<std::byte> bytes = readFile(source);
+        std::uint64_t key = core::fnv1a64(bytes.data(), bytes.size());
+        key = core::fnv1a64(reinterpret_cast<const std::byte *>( &CookerVersion ), sizeof(CookerVersion), key);
+        key = core::fnv1a64(reinterpret_cast<const std::byte *>( &asset.type ), sizeof(asset.type), key);
+        asset.contentHash = key;
+
+        if(asset.type == core::PackEntryType::Raw)
+        {
+            asset.data = bytes;
+            return asset;
+        }
+
+        const fs::path cached = cacheDir / (toHex(key) + ".cooked");
+        if(!cacheDir.empty() && fs::exists(cached))
+        {
+            asset.data = readFile(cached);
+            stats.cached++;
+            return asset;
+        }
+
+        asset.data = asset.type == core::PackEntryType::Texture ? cookTexture(source) : cookMesh(source, jobs);
+        if(!cacheDir.empty()) writeFile(cached, asset.data);
+        stats.cooked++;
+        return asset;
+    }
+
+    // True when the existing pack already holds exactly these entries
+    bool packIsCurrent(const fs::path& output, const std::vector<CookedAsset>& assets)
+    {
+        if(!fs::exists(output)) return false;
+
+        std::ifstream file(output, std::ios::binary);
+        core::PackHeader header;
+        if(!file.read(reinterpret_cast<char *>( &header ), sizeof(header)) || header.magic != core::PackMagic ||
+           header.version != core::PackVersion || header.entryCount != assets.size())
+            return false;
+
+        std::vector<core::PackEntry> entries(header.entryCount);
+        file.seekg(static_cast<std::streamoff>( header.tocOffset ));
+        if(!file.read(reinterpret_cast<char *>( entries.data() ), static_cast<std::streamsize>( entries.size() * sizeof(core::PackEntry) )))
+            return false;
+
+        for(std::size_t i = 0; i < assets.size(); i++)
+        {
+            if(entries[i].pathHash != core::fnv1a64(assets[i].name) || entries[i].contentHash != assets[i].contentHash)
+                return false;
+        }
+        return true;
+    }
+
+    void writePack(const fs::path& output, const std::vector<CookedAsset>& assets)
+    {
+        auto align = [](const std::size_t value) { return (value + core::PackAlignment - 1) & ~(core::PackAlignment - 1); };
+
+        core::PackHeader header;
+        header.entryCount = static_cast<std::uint32_t>( assets.size() );
+        header.tocOffset = align(sizeof(header));
+        header.namesOffset = header.tocOffset + assets.size() * sizeof(core::PackEntry);
+
+        std::string names;
+        for(const CookedAsset& asset : assets)
+            names += asset.name;
+
+        std::vector<core::PackEntry> entries;
+        std::size_t offset = align(header.namesOffset + names.size());
+        std::size_t nameOffset = 0;
+        for(const CookedAsset& asset : assets)
+        {
+            core::PackEntry entry;
+            entry.pathHash = core::fnv1a64(asset.name);
+            entry.contentHash = asset.contentHash;
+            entry.offset = offset;
+            entry.size = asset.data.size();
+            entry.nameOffset = static_cast<std::uint32_t>( nameOffset );
+            entry.nameLength = static_cast<std::uint32_t>( asset.name.size() );
+            entry.type = asset.type;
+            entries.push_back(entry);
+
+            nameOffset += asset.name.size();
+            offset = align(offset + asset.data.size());
+        }
+
+        std::vector<std::byte> pack;
+        pack.reserve(offset);
+        append(pack, header);
+        pack.resize(header.tocOffset);
+        for(const core::PackEntry& entry : entries)
+            append(pack, entry);
+        const auto* nameBytes = reinterpret_cast<const std::byte *>( names.data() );
+        pack.insert(pack.end(), nameBytes, nameBytes + names.size());
+        for(std::size_t i = 0; i < assets.size(); i++)
+        {
+            pack.resize(entries[i].offset);
+            pack.insert(pack.end(), assets[i].data.begin(), assets[i].data.end());
+        }
+
+        // Written next to the output and renamed, a running lesson never sees a half written pack
+        const fs::path temporary = output.string() + ".tmp";
+        writeFile(temporary, pack);
+        fs::rename(temporary, output);
+    }
+}
+
+int main(const int argc, char** argv)
+{
+    fs::path inputDir;
+    fs::path output;
+    fs::path cacheDir;
+    std::string prefix = "assets";
+
+    for(int i = 1; i < argc; i++)
+    {
+        const std::string arg = argv[i];
+        if(arg == "--cache" && i + 1 < argc)
+            cacheDir = argv[++i];
+        else if(arg == "--prefix" && i + 1 < argc)
+            prefix = argv[++i];
+        else if(inputDir.empty())
+            inputDir = arg;
+        else
+            output = arg;
+    }
+    if(inputDir.empty() || output.empty())
+    {
+        std::cerr << "usage: asset_cooker <asset dir> <output.pak> [--cache <dir>] [--prefix <name>]" << '\n';
+        return 1;
+    }
+
+    try
+    {
+        if(!cacheDir.empty()) fs::create_directories(cacheDir);
+        if(output.has_parent_path()) fs::create_directories(output.parent_path());
+
+        std::vector<fs::path> sources;
+        for(const auto& file : fs::recursive_directory_iterator(inputDir))
+        {
+            if(file.is_regular_file() && file.path().filename() != ".gitkeep")
+                sources.push_back(file.path());
+        }
+
+        // Simplifying meshes is the slow part of a cook, it runs on every core
+        core::JobSystem jobs;
+        CookStats stats;
+        std::vector<CookedAsset> assets;
+        for(const fs::path& source : sources)
+        {
+            // Entries are named the way lessons open them, e.g. "assets/shaders/cube.vert"
+            const std::string name = (fs::path(prefix) / fs::relative(source, inputDir)).generic_string();
+            assets.push_back(cookAsset(source, name, cacheDir, stats, jobs));
+        }
+
+        // The TOC is sorted by path hash, PackFile binary searches it
+        std::sort(assets.begin(), assets.end(), [](const CookedAsset& a, const CookedAsset& b)
+        {
+            return core::fnv1a64(a.name) < core::fnv1a64(b.name);
+        });
+
+        if(packIsCurrent(output, assets))
+        {
+            fs::last_write_time(output, fs::file_time_type::clock::now());
+            std::cout << "[AssetCooker]: " << output.string() << " is up to date" << '\n';
+            return 0;
+        }
+
+        writePack(output, assets);
+        std::cout << "[AssetCooker]: Wrote " << assets.size() << " assets to " << output.string() << " ("
+                << stats.cooked << " cooked, " << stats.cached << " from cache)" << '\n';
+    } catch(const std::exception& e)
+    {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+    return 0;
+}